@@ -2,12 +2,34 @@
 #ifndef CKTAP_PLATFORM_IOS_SIMULATOR
 
 // Reuse source files by including them here
+#include "../../src/cpp/core.cpp"
 #include "../../src/cpp/enums.cpp"
 #include "../../src/cpp/exports.cpp"
+#include "../../src/cpp/internal/audit_log.cpp"
+#include "../../src/cpp/internal/card_cache.cpp"
 #include "../../src/cpp/internal/card_operation.cpp"
+#include "../../src/cpp/internal/card_pipeline.cpp"
+#include "../../src/cpp/internal/card_snapshot.cpp"
+#include "../../src/cpp/internal/change_tracking.cpp"
+#include "../../src/cpp/internal/codecs.cpp"
+#include "../../src/cpp/internal/cpu_features.cpp"
+#include "../../src/cpp/internal/deadlines.cpp"
 #include "../../src/cpp/internal/exceptions.cpp"
 #include "../../src/cpp/internal/globals.cpp"
+#include "../../src/cpp/internal/hashing.cpp"
+#include "../../src/cpp/internal/metrics.cpp"
+#include "../../src/cpp/internal/pcsc_readers.cpp"
+#include "../../src/cpp/internal/prewarm.cpp"
+#include "../../src/cpp/internal/secure_memory.cpp"
+#include "../../src/cpp/internal/session_pool.cpp"
+#include "../../src/cpp/internal/slot_table.cpp"
+#include "../../src/cpp/internal/slot_verification.cpp"
 #include "../../src/cpp/internal/tap_protocol_thread.cpp"
+#include "../../src/cpp/internal/thread_state.cpp"
+#include "../../src/cpp/internal/transport_buffer.cpp"
 #include "../../src/cpp/internal/utils.cpp"
+#include "../../src/cpp/internal/watchdog.cpp"
+#include "../../src/cpp/internal/worker_scheduling.cpp"
+#include "../../src/cpp/internal/wif_export.cpp"
 
 #endif
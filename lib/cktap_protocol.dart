@@ -14,6 +14,14 @@ class CKTap {
     Implementation.instance;
   }
 
+  /// Frees this isolate's native context and the cards registered with it.
+  /// Cards read before calling this can't be used afterwards, the library is
+  /// initialized again the next time it's needed. Otherwise the context is
+  /// freed when the isolate exits
+  static void dispose() {
+    Implementation.disposeInstance();
+  }
+
   /// Checks if the given payload is that of a Satscard. The authenticity of an
   /// NFC device can only be confirmed by communicating via NFC
   static bool isLikelySatscard(String ndefRecordPayload) => ndefRecordPayload
@@ -74,7 +74,7 @@ class TapProtoException implements CKTapException {
 
   factory TapProtoException.fromNative() {
     ensureNativeThreadState(CKTapThreadState.tapProtocolError);
-    final exception = nativeLibrary.Core_getTapProtoException();
+    final exception = nativeLibrary.Core_getTapProtoException(nativeContext);
     final message = dartStringFromCString(exception.message);
     nativeLibrary.Utility_freeCKTapProtoException(exception);
     return TapProtoException.fromCode(exception.code, message);
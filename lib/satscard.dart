@@ -5,6 +5,7 @@ import 'package:cktap_protocol/cktapcard.dart';
 import 'package:cktap_protocol/src/implementation.dart';
 import 'package:cktap_protocol/src/error/validation.dart';
 import 'package:cktap_protocol/src/native/bindings.dart';
+import 'package:cktap_protocol/src/native/library.dart';
 import 'package:cktap_protocol/src/native/translations.dart';
 import 'package:cktap_transport/cktap_transport.dart';
 
@@ -77,7 +78,7 @@ class Satscard extends CKTapCard {
   /// Performs a quick sync of mutable fields with the native implementation
   Future<T> _sync<T>(T value) async =>
       Implementation.instance.performNativeOperation((b) async {
-        final params = b.Satscard_createSyncParams(handle);
+        final params = b.Satscard_createSyncParams(nativeContext, handle);
         try {
           ensureStatus(params.status);
           isCertsChecked = params.baseParams.isCertsChecked > 0;
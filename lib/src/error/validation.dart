@@ -18,7 +18,7 @@ void ensure(int interfaceErrorCode, [CKTapProtoException? e]) {
 }
 
 void ensureNativeThreadState(int expectedState) {
-  final threadState = nativeLibrary.Core_getThreadState();
+  final threadState = nativeLibrary.Core_getThreadState(nativeContext);
   if (threadState != expectedState) {
     throw InvalidThreadStateError(expectedState, threadState);
   }
@@ -26,7 +26,7 @@ void ensureNativeThreadState(int expectedState) {
 
 void ensureNativeThreadStates(Iterable<int> allowedStates) {
   assert(allowedStates.isNotEmpty);
-  final threadState = nativeLibrary.Core_getThreadState();
+  final threadState = nativeLibrary.Core_getThreadState(nativeContext);
 
   int lastState = 0;
   for (final allowedState in allowedStates) {
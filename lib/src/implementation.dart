@@ -13,26 +13,48 @@ import 'package:cktap_transport/cktap_transport.dart';
 
 /// Interfaces with a native implementation of the tap protocol to perform
 /// various operations on Coinkite NFC devices
-class Implementation {
+class Implementation implements Finalizable {
   /// A copy of bindings to the native C++ library
   final NativeBindings bindings;
 
+  /// This isolate's native engine, statics are per-isolate so each isolate
+  /// gets its own and never shares a session or card registry with another
+  final Pointer<CKTapContext> context;
+
   /// See [Implementation.performAsyncOperation]
   bool _isPerformingNativeAction = false;
 
+  /// Set once [dispose] has destroyed [context]
+  bool _isDisposed = false;
+
   /// The most recent cleanup operation
   Future? _cleanupFuture;
 
   /// A singleton for use across the plugin
   static Implementation? _staticInstance;
 
+  /// Destroys the context of an instance which is garbage collected or whose
+  /// isolate exits without calling [dispose], so isolates don't leak contexts
+  static NativeFinalizer? _contextFinalizer;
+
   /// Initializes the shared instance and thus the library itself
   static Implementation get instance =>
       _staticInstance ??= Implementation._initialize();
 
-  /// Will initialize the library with the given bindings
-  Implementation(this.bindings) {
-    ensure(bindings.Core_initializeLibrary());
+  /// Will create a native context with the given bindings
+  Implementation(this.bindings) : context = bindings.Core_createContext() {
+    if (context == nullptr) {
+      ensure(CKTapInterfaceErrorCode.threadAllocationFailed);
+    }
+    _contextFinalizer ??=
+        NativeFinalizer(bindings.addresses.Core_destroyContext.cast());
+    _contextFinalizer!.attach(this, context.cast(), detach: this);
+  }
+
+  /// Destroys the shared instance's context if it has been created, the next
+  /// use of [instance] creates a new one
+  static void disposeInstance() {
+    _staticInstance?.dispose();
   }
 
   /// Loads the required native DLLs initializes the library
@@ -53,9 +75,9 @@ class Implementation {
 
   Future<WaitResponse> cktapcardWait(Transport nfc, int handle, CardType type) {
     return _performAsyncCardOperation(handle, type, (lib) {
-      ensure(lib.CKTapCard_beginWait());
+      ensure(lib.CKTapCard_beginWait(context));
       return processTransportRequests(nfc).then((_) {
-        var response = lib.CKTapCard_getWaitResponse();
+        var response = lib.CKTapCard_getWaitResponse(context);
         ensureStatus(response.status, free: true);
         return WaitResponse(response.success > 0, response.authDelay);
       });
@@ -72,9 +94,9 @@ class Implementation {
 
   Future<bool> satscardCertificateCheck(Transport nfc, int handle) {
     return _performAsyncCardOperation(handle, CardType.satscard, (lib) {
-      ensure(lib.Satscard_beginCertificateCheck());
+      ensure(lib.Satscard_beginCertificateCheck(context));
       return processTransportRequests(nfc).then((_) {
-        var response = lib.Satscard_getCertificateCheckResponse();
+        var response = lib.Satscard_getCertificateCheckResponse(context);
         ensureStatus(response.status, free: true);
         return response.isCertsChecked > 0;
       });
@@ -83,7 +105,7 @@ class Implementation {
 
   Future<Slot> satscardGetActiveSlot(int satscard) {
     return performNativeOperation((lib) async {
-      var response = lib.Satscard_getActiveSlot(satscard);
+      var response = lib.Satscard_getActiveSlot(context, satscard);
       ensureStatus(response.status, free: true);
       return Slot(response.params);
     });
@@ -96,9 +118,9 @@ class Implementation {
       try {
         return await _performAsyncCardOperation(handle, CardType.satscard,
             (lib) {
-          ensure(lib.Satscard_beginGetSlot(slot, nativeSpendCode));
+          ensure(lib.Satscard_beginGetSlot(context, slot, nativeSpendCode));
           return processTransportRequests(nfc).then((_) {
-            var response = lib.Satscard_getGetSlotResponse(handle);
+            var response = lib.Satscard_getGetSlotResponse(context, handle);
             try {
               ensureStatus(response.status);
               return Slot(response.params);
@@ -120,9 +142,9 @@ class Implementation {
       try {
         return await _performAsyncCardOperation(handle, CardType.satscard,
             (lib) {
-          ensure(lib.Satscard_beginListSlots(nativeSpendCode, limit));
+          ensure(lib.Satscard_beginListSlots(context, nativeSpendCode, limit));
           return processTransportRequests(nfc).then((_) {
-            var response = lib.Satscard_getListSlotsResponse(handle);
+            var response = lib.Satscard_getListSlotsResponse(context, handle);
             try {
               ensureStatus(response.status);
               return List<Slot>.generate(
@@ -146,9 +168,10 @@ class Implementation {
       try {
         return await _performAsyncCardOperation(handle, CardType.satscard,
             (lib) {
-          ensure(lib.Satscard_beginNew(nativeChainCode, nativeSpendCode));
+          ensure(
+              lib.Satscard_beginNew(context, nativeChainCode, nativeSpendCode));
           return processTransportRequests(nfc).then((_) {
-            var response = lib.Satscard_getNewResponse(handle);
+            var response = lib.Satscard_getNewResponse(context, handle);
             try {
               ensureStatus(response.status);
               return Slot(response.params);
@@ -170,9 +193,9 @@ class Implementation {
       try {
         return await _performAsyncCardOperation(handle, CardType.satscard,
             (lib) {
-          ensure(lib.Satscard_beginUnseal(nativeSpendCode));
+          ensure(lib.Satscard_beginUnseal(context, nativeSpendCode));
           return processTransportRequests(nfc).then((_) {
-            var response = lib.Satscard_getUnsealResponse(handle);
+            var response = lib.Satscard_getUnsealResponse(context, handle);
             try {
               ensureStatus(response.status);
               return Slot(response.params);
@@ -189,7 +212,7 @@ class Implementation {
 
   Future<String> slotToWif(int satscard, int slot) {
     return performNativeOperation((lib) async {
-      var response = lib.Satscard_slotToWif(satscard, slot);
+      var response = lib.Satscard_slotToWif(context, satscard, slot);
       try {
         ensureStatus(response.status);
         return dartStringFromCString(response.wif);
@@ -199,6 +222,26 @@ class Implementation {
     });
   }
 
+  /// Cancels any operation in progress and destroys the native context now
+  /// rather than when this instance is collected. Neither this instance nor
+  /// the cards read through it can be used afterwards
+  void dispose() {
+    if (_isDisposed) {
+      return;
+    }
+    if (_isPerformingNativeAction || _cleanupFuture != null) {
+      throw ProtocolConcurrencyError(
+          "Attempt to dispose of CKTap during a native action");
+    }
+
+    _isDisposed = true;
+    _contextFinalizer?.detach(this);
+    bindings.Core_destroyContext(context);
+    if (identical(_staticInstance, this)) {
+      _staticInstance = null;
+    }
+  }
+
   Future<void> _awaitCleanup() async {
     if (_cleanupFuture == null) {
       return;
@@ -232,6 +275,9 @@ class Implementation {
         throw ProtocolConcurrencyError(
             "Attempt to perform a concurrent native action in CKTap");
       }
+      if (_isDisposed) {
+        throw StateError("CKTap was used after being disposed of");
+      }
 
       // Cleanup is a special case where we can just safely wait for cleanup if
       // the user of the library tries performing a second action too quickly
@@ -31,203 +31,654 @@ class NativeBindings {
 
   /// ----------------------------------------------
   /// CKTapCard:
-  int CKTapCard_beginWait() {
-    return _CKTapCard_beginWait();
+  int CKTapCard_beginWait(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _CKTapCard_beginWait(
+      context,
+    );
   }
 
-  late final _CKTapCard_beginWaitPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>('CKTapCard_beginWait');
-  late final _CKTapCard_beginWait =
-      _CKTapCard_beginWaitPtr.asFunction<int Function()>();
+  late final _CKTapCard_beginWaitPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('CKTapCard_beginWait');
+  late final _CKTapCard_beginWait = _CKTapCard_beginWaitPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>)>();
 
-  WaitResponseParams CKTapCard_getWaitResponse() {
-    return _CKTapCard_getWaitResponse();
+  WaitResponseParams CKTapCard_getWaitResponse(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _CKTapCard_getWaitResponse(
+      context,
+    );
   }
 
-  late final _CKTapCard_getWaitResponsePtr =
-      _lookup<ffi.NativeFunction<WaitResponseParams Function()>>(
-          'CKTapCard_getWaitResponse');
+  late final _CKTapCard_getWaitResponsePtr = _lookup<
+      ffi.NativeFunction<
+          WaitResponseParams Function(
+              ffi.Pointer<CKTapContext>)>>('CKTapCard_getWaitResponse');
   late final _CKTapCard_getWaitResponse =
-      _CKTapCard_getWaitResponsePtr.asFunction<WaitResponseParams Function()>();
+      _CKTapCard_getWaitResponsePtr.asFunction<
+          WaitResponseParams Function(ffi.Pointer<CKTapContext>)>();
 
   /// Ensures that the transport response buffer will be appropriately sized
   /// Returns a pointer to the buffer if valid, nullptr if not
   ffi.Pointer<ffi.Uint8> Core_allocateTransportResponseBuffer(
+    ffi.Pointer<CKTapContext> context,
     int sizeInBytes,
   ) {
     return _Core_allocateTransportResponseBuffer(
+      context,
       sizeInBytes,
     );
   }
 
-  late final _Core_allocateTransportResponseBufferPtr =
-      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Uint8> Function(ffi.Int32)>>(
-          'Core_allocateTransportResponseBuffer');
+  late final _Core_allocateTransportResponseBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Core_allocateTransportResponseBuffer');
   late final _Core_allocateTransportResponseBuffer =
       _Core_allocateTransportResponseBufferPtr.asFunction<
-          ffi.Pointer<ffi.Uint8> Function(int)>();
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<CKTapContext>, int)>();
 
   /// Attempts to perform an initial handshake with a CKTapCard
   int Core_beginAsyncHandshake(
+    ffi.Pointer<CKTapContext> context,
     int cardType,
   ) {
     return _Core_beginAsyncHandshake(
+      context,
       cardType,
     );
   }
 
-  late final _Core_beginAsyncHandshakePtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32)>>(
-          'Core_beginAsyncHandshake');
+  late final _Core_beginAsyncHandshakePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Core_beginAsyncHandshake');
   late final _Core_beginAsyncHandshake =
-      _Core_beginAsyncHandshakePtr.asFunction<int Function(int)>();
+      _Core_beginAsyncHandshakePtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Flushes and closes the context's audit log, its operations are no longer recorded
+  void Core_closeAuditLog(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_closeAuditLog(
+      context,
+    );
+  }
+
+  late final _Core_closeAuditLogPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<CKTapContext>)>>(
+          'Core_closeAuditLog');
+  late final _Core_closeAuditLog = _Core_closeAuditLogPtr.asFunction<
+      void Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Creates an engine context with its own native thread, card registry, pipeline, audit log, scheduling and watchdog
+  /// timeout, returns null if it couldn't be allocated. Every isolate should create its own and pass it to each call
+  /// below that takes one, contexts only share the secure pool, the session pool, the metrics totals and the readers.
+  /// Passing them null fails with invalidContext rather than falling back to a shared context
+  ffi.Pointer<CKTapContext> Core_createContext() {
+    return _Core_createContext();
+  }
+
+  late final _Core_createContextPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<CKTapContext> Function()>>(
+          'Core_createContext');
+  late final _Core_createContext =
+      _Core_createContextPtr.asFunction<ffi.Pointer<CKTapContext> Function()>();
+
+  /// Cancels any operation in progress and frees the context, it mustn't be used again
+  void Core_destroyContext(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_destroyContext(
+      context,
+    );
+  }
+
+  late final _Core_destroyContextPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<CKTapContext>)>>(
+          'Core_destroyContext');
+  late final _Core_destroyContext = _Core_destroyContextPtr.asFunction<
+      void Function(ffi.Pointer<CKTapContext>)>();
 
   /// Must be called last to store and retrieve Satscard/Tapsigner data
-  CKTapOperationResponse Core_endOperation() {
-    return _Core_endOperation();
+  CKTapOperationResponse Core_endOperation(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_endOperation(
+      context,
+    );
   }
 
-  late final _Core_endOperationPtr =
-      _lookup<ffi.NativeFunction<CKTapOperationResponse Function()>>(
-          'Core_endOperation');
-  late final _Core_endOperation =
-      _Core_endOperationPtr.asFunction<CKTapOperationResponse Function()>();
+  late final _Core_endOperationPtr = _lookup<
+      ffi.NativeFunction<
+          CKTapOperationResponse Function(
+              ffi.Pointer<CKTapContext>)>>('Core_endOperation');
+  late final _Core_endOperation = _Core_endOperationPtr.asFunction<
+      CKTapOperationResponse Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Used instead of [Core_endOperation] when cards are tapped back-to-back. Hands the card from the finished handshake
+  /// to a worker for post-processing and resets the native thread, so [Core_beginAsyncHandshake] can be called for
+  /// the next card straight away
+  CKTapPipelineTicket Core_enqueuePipelinedCard(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_enqueuePipelinedCard(
+      context,
+    );
+  }
+
+  late final _Core_enqueuePipelinedCardPtr = _lookup<
+      ffi.NativeFunction<
+          CKTapPipelineTicket Function(
+              ffi.Pointer<CKTapContext>)>>('Core_enqueuePipelinedCard');
+  late final _Core_enqueuePipelinedCard =
+      _Core_enqueuePipelinedCardPtr.asFunction<
+          CKTapPipelineTicket Function(ffi.Pointer<CKTapContext>)>();
 
   /// Must be called at the end of every async action
-  int Core_finalizeAsyncAction() {
-    return _Core_finalizeAsyncAction();
+  int Core_finalizeAsyncAction(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_finalizeAsyncAction(
+      context,
+    );
   }
 
-  late final _Core_finalizeAsyncActionPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
-          'Core_finalizeAsyncAction');
+  late final _Core_finalizeAsyncActionPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_finalizeAsyncAction');
   late final _Core_finalizeAsyncAction =
-      _Core_finalizeAsyncActionPtr.asFunction<int Function()>();
+      _Core_finalizeAsyncActionPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>)>();
 
   /// Informs the native thread that it's now safe to read the previously allocated buffer
-  int Core_finalizeTransportResponse() {
-    return _Core_finalizeTransportResponse();
+  int Core_finalizeTransportResponse(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_finalizeTransportResponse(
+      context,
+    );
   }
 
-  late final _Core_finalizeTransportResponsePtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
-          'Core_finalizeTransportResponse');
+  late final _Core_finalizeTransportResponsePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_finalizeTransportResponse');
   late final _Core_finalizeTransportResponse =
-      _Core_finalizeTransportResponsePtr.asFunction<int Function()>();
+      _Core_finalizeTransportResponsePtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Lists every card which changed after the given version along with what changed, so only those cards need to be
+  /// synced. Pass 0 to list everything then pass the returned version next time. Note: must use
+  /// [Utility_freeCKTapChangedCards] when you are finished using the data to deallocate memory
+  CKTapChangedCards Core_getChangedCardsSince(
+    ffi.Pointer<CKTapContext> context,
+    int version,
+  ) {
+    return _Core_getChangedCardsSince(
+      context,
+      version,
+    );
+  }
+
+  late final _Core_getChangedCardsSincePtr = _lookup<
+      ffi.NativeFunction<
+          CKTapChangedCards Function(
+              ffi.Pointer<CKTapContext>, ffi.Int64)>>('Core_getChangedCardsSince');
+  late final _Core_getChangedCardsSince =
+      _Core_getChangedCardsSincePtr.asFunction<
+          CKTapChangedCards Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Gets a snapshot of the context's performance counters alongside the process-wide ones, see CKTapMetrics
+  CKTapMetrics Core_getMetrics(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_getMetrics(
+      context,
+    );
+  }
+
+  late final _Core_getMetricsPtr = _lookup<
+      ffi.NativeFunction<
+          CKTapMetrics Function(
+              ffi.Pointer<CKTapContext>)>>('Core_getMetrics');
+  late final _Core_getMetrics = _Core_getMetricsPtr.asFunction<
+      CKTapMetrics Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Gets the report of the most recent prewarm and registers the cached cards once it has finished. Pass a non-zero
+  /// [wait] to block until it's done
+  CKTapPrewarmReport Core_getPrewarmReport(
+    ffi.Pointer<CKTapContext> context,
+    int wait,
+  ) {
+    return _Core_getPrewarmReport(
+      context,
+      wait,
+    );
+  }
+
+  late final _Core_getPrewarmReportPtr = _lookup<
+      ffi.NativeFunction<
+          CKTapPrewarmReport Function(
+              ffi.Pointer<CKTapContext>, ffi.Int8)>>('Core_getPrewarmReport');
+  late final _Core_getPrewarmReport = _Core_getPrewarmReportPtr.asFunction<
+      CKTapPrewarmReport Function(ffi.Pointer<CKTapContext>, int)>();
 
   /// Gets the most recent tap_protocol::TapProtoException ONLY if the current thread state is
   /// CKTapThreadState::tapProtocolError
-  CKTapProtoException Core_getTapProtoException() {
-    return _Core_getTapProtoException();
+  CKTapProtoException Core_getTapProtoException(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_getTapProtoException(
+      context,
+    );
   }
 
-  late final _Core_getTapProtoExceptionPtr =
-      _lookup<ffi.NativeFunction<CKTapProtoException Function()>>(
-          'Core_getTapProtoException');
-  late final _Core_getTapProtoException = _Core_getTapProtoExceptionPtr
-      .asFunction<CKTapProtoException Function()>();
+  late final _Core_getTapProtoExceptionPtr = _lookup<
+      ffi.NativeFunction<
+          CKTapProtoException Function(
+              ffi.Pointer<CKTapContext>)>>('Core_getTapProtoException');
+  late final _Core_getTapProtoException =
+      _Core_getTapProtoExceptionPtr.asFunction<
+          CKTapProtoException Function(ffi.Pointer<CKTapContext>)>();
 
   /// Gets the current native thread state atomically
-  int Core_getThreadState() {
-    return _Core_getThreadState();
+  int Core_getThreadState(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_getThreadState(
+      context,
+    );
   }
 
-  late final _Core_getThreadStatePtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>('Core_getThreadState');
-  late final _Core_getThreadState =
-      _Core_getThreadStatePtr.asFunction<int Function()>();
+  late final _Core_getThreadStatePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_getThreadState');
+  late final _Core_getThreadState = _Core_getThreadStatePtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>)>();
 
   /// Retrieves the size of the current transport request in bytes
   /// Returns 0 if the native thread isn't ready or is invalid
-  int Core_getTransportRequestLength() {
-    return _Core_getTransportRequestLength();
+  int Core_getTransportRequestLength(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_getTransportRequestLength(
+      context,
+    );
   }
 
-  late final _Core_getTransportRequestLengthPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
-          'Core_getTransportRequestLength');
+  late final _Core_getTransportRequestLengthPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_getTransportRequestLength');
   late final _Core_getTransportRequestLength =
-      _Core_getTransportRequestLengthPtr.asFunction<int Function()>();
+      _Core_getTransportRequestLengthPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>)>();
 
   /// Retrieves a pointer to the current transport request
   /// Returns nullptr if the native thread isn't ready or is invalid
-  ffi.Pointer<ffi.Uint8> Core_getTransportRequestPointer() {
-    return _Core_getTransportRequestPointer();
+  ffi.Pointer<ffi.Uint8> Core_getTransportRequestPointer(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_getTransportRequestPointer(
+      context,
+    );
   }
 
-  late final _Core_getTransportRequestPointerPtr =
-      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Uint8> Function()>>(
-          'Core_getTransportRequestPointer');
+  late final _Core_getTransportRequestPointerPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(
+              ffi.Pointer<CKTapContext>)>>('Core_getTransportRequestPointer');
   late final _Core_getTransportRequestPointer =
       _Core_getTransportRequestPointerPtr.asFunction<
-          ffi.Pointer<ffi.Uint8> Function()>();
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<CKTapContext>)>();
 
-  /// Ensures the library and native thread are initialized
-  int Core_initializeLibrary() {
-    return _Core_initializeLibrary();
+  /// Must be called first to restore the native thread to its initial state. Returns operationStillInProgress
+  /// straight away while a cancelled operation is unwinding, rather than waiting for it
+  int Core_newOperation(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_newOperation(
+      context,
+    );
   }
 
-  late final _Core_initializeLibraryPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
-          'Core_initializeLibrary');
-  late final _Core_initializeLibrary =
-      _Core_initializeLibraryPtr.asFunction<int Function()>();
+  late final _Core_newOperationPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_newOperation');
+  late final _Core_newOperation = _Core_newOperationPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Records every card operation of the context from now on, including those of the PC/SC readers started from it, in
+  /// the memory-mapped log at [path]. A new log is created with room for [capacity] records, or 65536 when it's 0, while
+  /// an existing one is appended to. Opening another log closes this one, it's also closed once the context is destroyed
+  /// and the readers started from it have stopped. See tools/audit_log_reader.cpp to read it
+  int Core_openAuditLog(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Char> path,
+    int capacity,
+  ) {
+    return _Core_openAuditLog(
+      context,
+      path,
+      capacity,
+    );
+  }
 
-  /// Must be called first to restore the native thread to its initial state
-  int Core_newOperation() {
-    return _Core_newOperation();
+  late final _Core_openAuditLogPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>, ffi.Int64)>>('Core_openAuditLog');
+  late final _Core_openAuditLog = _Core_openAuditLogPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>, int)>();
+
+  /// Registers every card whose post-processing has finished, in the order they were enqueued. Pass a non-zero [wait]
+  /// to block until every enqueued card is done. Note: must use [Utility_freeCKTapPipelinedCards] when you are
+  /// finished using the data to deallocate memory
+  CKTapPipelinedCards Core_pollPipelinedCards(
+    ffi.Pointer<CKTapContext> context,
+    int wait,
+  ) {
+    return _Core_pollPipelinedCards(
+      context,
+      wait,
+    );
   }
 
-  late final _Core_newOperationPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>('Core_newOperation');
-  late final _Core_newOperation =
-      _Core_newOperationPtr.asFunction<int Function()>();
+  late final _Core_pollPipelinedCardsPtr = _lookup<
+      ffi.NativeFunction<
+          CKTapPipelinedCards Function(
+              ffi.Pointer<CKTapContext>, ffi.Int8)>>('Core_pollPipelinedCards');
+  late final _Core_pollPipelinedCards = _Core_pollPipelinedCardsPtr.asFunction<
+      CKTapPipelinedCards Function(ffi.Pointer<CKTapContext>, int)>();
 
   /// Searches for the specified card and gives the native thread access so
   /// further operations can be performed on it
   int Core_prepareCardOperation(
+    ffi.Pointer<CKTapContext> context,
     int handle,
     int cardType,
   ) {
     return _Core_prepareCardOperation(
+      context,
       handle,
       cardType,
     );
   }
 
-  late final _Core_prepareCardOperationPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32, ffi.Int32)>>(
-          'Core_prepareCardOperation');
+  late final _Core_prepareCardOperationPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32, ffi.Int32)>>('Core_prepareCardOperation');
   late final _Core_prepareCardOperation =
-      _Core_prepareCardOperationPtr.asFunction<int Function(int, int)>();
+      _Core_prepareCardOperationPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, int, int)>();
+
+  /// Initializes the library if needed, reserves the registry then pays the one-time costs of the first tap on a
+  /// background thread: starting a thread, the crypto used for slots and WIFs, the secure pool and reading the card
+  /// cache. Fails with prewarmAlreadyRunning until the previous prewarm's report has been fetched
+  int Core_prewarm(
+    ffi.Pointer<CKTapContext> context,
+    CKTapPrewarmOptions options,
+  ) {
+    return _Core_prewarm(
+      context,
+      options,
+    );
+  }
 
-  /// Signals cancellation of the current operation, causing the thread to enter a
-  /// resettable state
-  int Core_requestCancelOperation() {
-    return _Core_requestCancelOperation();
+  late final _Core_prewarmPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, CKTapPrewarmOptions)>>('Core_prewarm');
+  late final _Core_prewarm = _Core_prewarmPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>, CKTapPrewarmOptions)>();
+
+  /// Signals cancellation of the current operation, causing the thread to enter a resettable state. Never waits,
+  /// returns operationStillInProgress until the operation has unwound so the host can call it again to poll
+  int Core_requestCancelOperation(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_requestCancelOperation(
+      context,
+    );
   }
 
-  late final _Core_requestCancelOperationPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
-          'Core_requestCancelOperation');
+  late final _Core_requestCancelOperationPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_requestCancelOperation');
   late final _Core_requestCancelOperation =
-      _Core_requestCancelOperationPtr.asFunction<int Function()>();
+      _Core_requestCancelOperationPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Zeroes the context's performance counters and the process-wide ones
+  void Core_resetMetrics(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_resetMetrics(
+      context,
+    );
+  }
+
+  late final _Core_resetMetricsPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<CKTapContext>)>>(
+          'Core_resetMetrics');
+  late final _Core_resetMetrics = _Core_resetMetricsPtr.asFunction<
+      void Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Writes every registered card to [path] for a later Core_prewarm. Private keys are never written
+  int Core_saveCardCache(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Char> path,
+  ) {
+    return _Core_saveCardCache(
+      context,
+      path,
+    );
+  }
+
+  late final _Core_saveCardCachePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>)>>('Core_saveCardCache');
+  late final _Core_saveCardCache = _Core_saveCardCachePtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>)>();
+
+  /// Sets how many of the most recently used cards keep their live tap_protocol object between operations, so going
+  /// back to one of them needs no handshake. Each attached card holds a few KiB more than a detached one. Defaults to
+  /// 4, 0 detaches every card once its operation ends. Takes effect straight away unless an operation is in progress
+  int Core_setAttachedCardLimit(
+    ffi.Pointer<CKTapContext> context,
+    int cardCount,
+  ) {
+    return _Core_setAttachedCardLimit(
+      context,
+      cardCount,
+    );
+  }
+
+  late final _Core_setAttachedCardLimitPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Core_setAttachedCardLimit');
+  late final _Core_setAttachedCardLimit =
+      _Core_setAttachedCardLimitPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Configures the time limits of subsequent operations. [operationTimeoutMs] bounds a whole operation and 0
+  /// disables it, [transportTimeoutMs] bounds each message and 0 restores the default of one minute. When
+  /// [isAdaptive] is set each message's timeout is derived from recent round trip times instead
+  int Core_setOperationDeadline(
+    ffi.Pointer<CKTapContext> context,
+    int operationTimeoutMs,
+    int transportTimeoutMs,
+    int isAdaptive,
+  ) {
+    return _Core_setOperationDeadline(
+      context,
+      operationTimeoutMs,
+      transportTimeoutMs,
+      isAdaptive,
+    );
+  }
+
+  late final _Core_setOperationDeadlinePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32, ffi.Int32, ffi.Int8)>>('Core_setOperationDeadline');
+  late final _Core_setOperationDeadline =
+      _Core_setOperationDeadlinePtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, int, int, int)>();
+
+  /// Runs the card operations of every context as fibers on [threadCount] shared workers instead of a thread per
+  /// operation, so many sessions waiting on their hosts need few threads. 0 restores a thread per operation, which is
+  /// the default. Fails with sessionPoolNotSupported on builds without CKTAP_ENABLE_SESSION_POOL
+  int Core_setSessionPoolThreads(
+    int threadCount,
+  ) {
+    return _Core_setSessionPoolThreads(
+      threadCount,
+    );
+  }
 
-  int Satscard_beginCertificateCheck() {
-    return _Satscard_beginCertificateCheck();
+  late final _Core_setSessionPoolThreadsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32)>>(
+          'Core_setSessionPoolThreads');
+  late final _Core_setSessionPoolThreads =
+      _Core_setSessionPoolThreadsPtr.asFunction<int Function(int)>();
+
+  /// Has a native watchdog cancel any of the context's operations, including those of the PC/SC readers started from
+  /// it, that has made no progress for [stallTimeoutMs], such as when the host stops answering transport requests. The
+  /// operation fails with sessionStalled and Core_newOperation succeeds once it has unwound. Must be at least 250, 0
+  /// leaves the context's operations alone, which is the default
+  int Core_setWatchdogOptions(
+    ffi.Pointer<CKTapContext> context,
+    int stallTimeoutMs,
+  ) {
+    return _Core_setWatchdogOptions(
+      context,
+      stallTimeoutMs,
+    );
+  }
+
+  late final _Core_setWatchdogOptionsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Core_setWatchdogOptions');
+  late final _Core_setWatchdogOptions = _Core_setWatchdogOptionsPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Sets the priority and CPU affinity of the threads which run the context's card sessions, both the protocol thread
+  /// of each operation and each PC/SC reader started from it, so they aren't delayed by rendering on a loaded device.
+  /// Refused changes leave the scheduling as it was, except SCHED_FIFO which falls back to the nice value and returns
+  /// workerSchedulingNotPermitted. Check the wake latency jitter in Core_getMetrics to see the effect
+  int Core_setWorkerSchedulingOptions(
+    ffi.Pointer<CKTapContext> context,
+    CKTapWorkerSchedulingOptions options,
+  ) {
+    return _Core_setWorkerSchedulingOptions(
+      context,
+      options,
+    );
   }
 
-  late final _Satscard_beginCertificateCheckPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
-          'Satscard_beginCertificateCheck');
+  late final _Core_setWorkerSchedulingOptionsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, CKTapWorkerSchedulingOptions)>>('Core_setWorkerSchedulingOptions');
+  late final _Core_setWorkerSchedulingOptions =
+      _Core_setWorkerSchedulingOptionsPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, CKTapWorkerSchedulingOptions)>();
+
+  /// Flushes the context's audit log to storage. Records survive the app crashing without this, only power loss needs it
+  int Core_syncAuditLog(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Core_syncAuditLog(
+      context,
+    );
+  }
+
+  late final _Core_syncAuditLogPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Core_syncAuditLog');
+  late final _Core_syncAuditLog = _Core_syncAuditLogPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>)>();
+
+  /// Per-reader session counts and the combined throughput since the readers were started. Note: must use
+  /// [Utility_freeCKTapReaderStatsList] when you are finished using the data to deallocate memory
+  CKTapReaderStatsList Reader_getStats() {
+    return _Reader_getStats();
+  }
+
+  late final _Reader_getStatsPtr =
+      _lookup<ffi.NativeFunction<CKTapReaderStatsList Function()>>(
+          'Reader_getStats');
+  late final _Reader_getStats =
+      _Reader_getStatsPtr.asFunction<CKTapReaderStatsList Function()>();
+
+  /// Starts a native worker for every connected PC/SC reader, each one performing a handshake with the given card type
+  /// on every card placed on it. The cards are added through the pipeline of [context], see [Core_pollPipelinedCards]. Only
+  /// available in Linux builds with CKTAP_ENABLE_PCSC, otherwise returns pcscNotAvailable
+  int Reader_startAll(
+    ffi.Pointer<CKTapContext> context,
+    int cardType,
+  ) {
+    return _Reader_startAll(
+      context,
+      cardType,
+    );
+  }
+
+  late final _Reader_startAllPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Reader_startAll');
+  late final _Reader_startAll = _Reader_startAllPtr.asFunction<
+      int Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Cancels any session in progress and waits for every reader worker to exit
+  int Reader_stopAll() {
+    return _Reader_stopAll();
+  }
+
+  late final _Reader_stopAllPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>('Reader_stopAll');
+  late final _Reader_stopAll = _Reader_stopAllPtr.asFunction<int Function()>();
+
+  int Satscard_beginCertificateCheck(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Satscard_beginCertificateCheck(
+      context,
+    );
+  }
+
+  late final _Satscard_beginCertificateCheckPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>)>>('Satscard_beginCertificateCheck');
   late final _Satscard_beginCertificateCheck =
-      _Satscard_beginCertificateCheckPtr.asFunction<int Function()>();
+      _Satscard_beginCertificateCheckPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>)>();
 
   int Satscard_beginGetSlot(
+    ffi.Pointer<CKTapContext> context,
     int slot,
     ffi.Pointer<ffi.Char> spendCode,
   ) {
     return _Satscard_beginGetSlot(
+      context,
       slot,
       spendCode,
     );
@@ -236,15 +687,17 @@ class NativeBindings {
   late final _Satscard_beginGetSlotPtr = _lookup<
       ffi.NativeFunction<
           ffi.Int32 Function(
-              ffi.Int32, ffi.Pointer<ffi.Char>)>>('Satscard_beginGetSlot');
+              ffi.Pointer<CKTapContext>, ffi.Int32, ffi.Pointer<ffi.Char>)>>('Satscard_beginGetSlot');
   late final _Satscard_beginGetSlot = _Satscard_beginGetSlotPtr.asFunction<
-      int Function(int, ffi.Pointer<ffi.Char>)>();
+      int Function(ffi.Pointer<CKTapContext>, int, ffi.Pointer<ffi.Char>)>();
 
   int Satscard_beginListSlots(
+    ffi.Pointer<CKTapContext> context,
     ffi.Pointer<ffi.Char> spendCode,
     int limit,
   ) {
     return _Satscard_beginListSlots(
+      context,
       spendCode,
       limit,
     );
@@ -253,15 +706,17 @@ class NativeBindings {
   late final _Satscard_beginListSlotsPtr = _lookup<
       ffi.NativeFunction<
           ffi.Int32 Function(
-              ffi.Pointer<ffi.Char>, ffi.Int32)>>('Satscard_beginListSlots');
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>, ffi.Int32)>>('Satscard_beginListSlots');
   late final _Satscard_beginListSlots = _Satscard_beginListSlotsPtr.asFunction<
-      int Function(ffi.Pointer<ffi.Char>, int)>();
+      int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>, int)>();
 
   int Satscard_beginNew(
+    ffi.Pointer<CKTapContext> context,
     ffi.Pointer<ffi.Char> chainCode,
     ffi.Pointer<ffi.Char> spendCode,
   ) {
     return _Satscard_beginNew(
+      context,
       chainCode,
       spendCode,
     );
@@ -269,183 +724,360 @@ class NativeBindings {
 
   late final _Satscard_beginNewPtr = _lookup<
       ffi.NativeFunction<
-          ffi.Int32 Function(ffi.Pointer<ffi.Char>,
-              ffi.Pointer<ffi.Char>)>>('Satscard_beginNew');
-  late final _Satscard_beginNew = _Satscard_beginNewPtr.asFunction<
-      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>>('Satscard_beginNew');
+  late final _Satscard_beginNew =
+      _Satscard_beginNewPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
 
   int Satscard_beginUnseal(
+    ffi.Pointer<CKTapContext> context,
     ffi.Pointer<ffi.Char> spendCode,
   ) {
     return _Satscard_beginUnseal(
+      context,
       spendCode,
     );
   }
 
-  late final _Satscard_beginUnsealPtr =
-      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<ffi.Char>)>>(
-          'Satscard_beginUnseal');
+  late final _Satscard_beginUnsealPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>)>>('Satscard_beginUnseal');
   late final _Satscard_beginUnseal = _Satscard_beginUnsealPtr.asFunction<
-      int Function(ffi.Pointer<ffi.Char>)>();
+      int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Char>)>();
 
   /// Gets a C representation of parameters required to construct a [Satscard] in dart. Note: must use
   /// [Utility_freeSatscardConstructorParams] when you are finished using the data to deallocate memory
   SatscardConstructorParams Satscard_createConstructorParams(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_createConstructorParams(
+      context,
       handle,
     );
   }
 
   late final _Satscard_createConstructorParamsPtr = _lookup<
-          ffi.NativeFunction<SatscardConstructorParams Function(ffi.Int32)>>(
-      'Satscard_createConstructorParams');
+      ffi.NativeFunction<
+          SatscardConstructorParams Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_createConstructorParams');
   late final _Satscard_createConstructorParams =
       _Satscard_createConstructorParamsPtr.asFunction<
-          SatscardConstructorParams Function(int)>();
+          SatscardConstructorParams Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Batch versions of the above which fill `outParams[i]` for each `handles[i]`. Both arrays are owned by the caller
+  /// and must hold at least `count` elements. Each element has its own status, use the matching
+  /// Utility_free*Batch function to free the contents of every element at once
+  int Satscard_createConstructorParamsBatch(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Int32> handles,
+    int count,
+    ffi.Pointer<SatscardConstructorParams> outParams,
+  ) {
+    return _Satscard_createConstructorParamsBatch(
+      context,
+      handles,
+      count,
+      outParams,
+    );
+  }
+
+  late final _Satscard_createConstructorParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, ffi.Int32, ffi.Pointer<SatscardConstructorParams>)>>('Satscard_createConstructorParamsBatch');
+  late final _Satscard_createConstructorParamsBatch =
+      _Satscard_createConstructorParamsBatchPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, int, ffi.Pointer<SatscardConstructorParams>)>();
 
   SatscardSyncParams Satscard_createSyncParams(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_createSyncParams(
+      context,
       handle,
     );
   }
 
-  late final _Satscard_createSyncParamsPtr =
-      _lookup<ffi.NativeFunction<SatscardSyncParams Function(ffi.Int32)>>(
-          'Satscard_createSyncParams');
-  late final _Satscard_createSyncParams = _Satscard_createSyncParamsPtr
-      .asFunction<SatscardSyncParams Function(int)>();
+  late final _Satscard_createSyncParamsPtr = _lookup<
+      ffi.NativeFunction<
+          SatscardSyncParams Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_createSyncParams');
+  late final _Satscard_createSyncParams =
+      _Satscard_createSyncParamsPtr.asFunction<
+          SatscardSyncParams Function(ffi.Pointer<CKTapContext>, int)>();
+
+  int Satscard_createSyncParamsBatch(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Int32> handles,
+    int count,
+    ffi.Pointer<SatscardSyncParams> outParams,
+  ) {
+    return _Satscard_createSyncParamsBatch(
+      context,
+      handles,
+      count,
+      outParams,
+    );
+  }
+
+  late final _Satscard_createSyncParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, ffi.Int32, ffi.Pointer<SatscardSyncParams>)>>('Satscard_createSyncParamsBatch');
+  late final _Satscard_createSyncParamsBatch =
+      _Satscard_createSyncParamsBatchPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, int, ffi.Pointer<SatscardSyncParams>)>();
+
+  /// Converts every unsealed slot of the given satscards to a WIF in parallel, pass a null `handles` to export every
+  /// registered satscard. Reports how long the conversion took along with its throughput. Note: must use
+  /// [Utility_freeSatscardWifBatch] when you are finished using the data to zero and deallocate memory
+  SatscardWifBatch Satscard_exportWifsBatch(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Int32> handles,
+    int count,
+  ) {
+    return _Satscard_exportWifsBatch(
+      context,
+      handles,
+      count,
+    );
+  }
+
+  late final _Satscard_exportWifsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          SatscardWifBatch Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, ffi.Int32)>>('Satscard_exportWifsBatch');
+  late final _Satscard_exportWifsBatch =
+      _Satscard_exportWifsBatchPtr.asFunction<
+          SatscardWifBatch Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, int)>();
 
   SatscardSlotResponse Satscard_getActiveSlot(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_getActiveSlot(
+      context,
       handle,
     );
   }
 
-  late final _Satscard_getActiveSlotPtr =
-      _lookup<ffi.NativeFunction<SatscardSlotResponse Function(ffi.Int32)>>(
-          'Satscard_getActiveSlot');
+  late final _Satscard_getActiveSlotPtr = _lookup<
+      ffi.NativeFunction<
+          SatscardSlotResponse Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_getActiveSlot');
   late final _Satscard_getActiveSlot = _Satscard_getActiveSlotPtr.asFunction<
-      SatscardSlotResponse Function(int)>();
+      SatscardSlotResponse Function(ffi.Pointer<CKTapContext>, int)>();
 
-  CertificateCheckParams Satscard_getCertificateCheckResponse() {
-    return _Satscard_getCertificateCheckResponse();
+  CertificateCheckParams Satscard_getCertificateCheckResponse(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Satscard_getCertificateCheckResponse(
+      context,
+    );
   }
 
-  late final _Satscard_getCertificateCheckResponsePtr =
-      _lookup<ffi.NativeFunction<CertificateCheckParams Function()>>(
-          'Satscard_getCertificateCheckResponse');
+  late final _Satscard_getCertificateCheckResponsePtr = _lookup<
+      ffi.NativeFunction<
+          CertificateCheckParams Function(
+              ffi.Pointer<CKTapContext>)>>('Satscard_getCertificateCheckResponse');
   late final _Satscard_getCertificateCheckResponse =
       _Satscard_getCertificateCheckResponsePtr.asFunction<
-          CertificateCheckParams Function()>();
+          CertificateCheckParams Function(ffi.Pointer<CKTapContext>)>();
 
   SatscardSlotResponse Satscard_getGetSlotResponse(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_getGetSlotResponse(
+      context,
       handle,
     );
   }
 
-  late final _Satscard_getGetSlotResponsePtr =
-      _lookup<ffi.NativeFunction<SatscardSlotResponse Function(ffi.Int32)>>(
-          'Satscard_getGetSlotResponse');
-  late final _Satscard_getGetSlotResponse = _Satscard_getGetSlotResponsePtr
-      .asFunction<SatscardSlotResponse Function(int)>();
+  late final _Satscard_getGetSlotResponsePtr = _lookup<
+      ffi.NativeFunction<
+          SatscardSlotResponse Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_getGetSlotResponse');
+  late final _Satscard_getGetSlotResponse =
+      _Satscard_getGetSlotResponsePtr.asFunction<
+          SatscardSlotResponse Function(ffi.Pointer<CKTapContext>, int)>();
 
   SatscardListSlotsParams Satscard_getListSlotsResponse(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_getListSlotsResponse(
+      context,
       handle,
     );
   }
 
-  late final _Satscard_getListSlotsResponsePtr =
-      _lookup<ffi.NativeFunction<SatscardListSlotsParams Function(ffi.Int32)>>(
-          'Satscard_getListSlotsResponse');
-  late final _Satscard_getListSlotsResponse = _Satscard_getListSlotsResponsePtr
-      .asFunction<SatscardListSlotsParams Function(int)>();
+  late final _Satscard_getListSlotsResponsePtr = _lookup<
+      ffi.NativeFunction<
+          SatscardListSlotsParams Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_getListSlotsResponse');
+  late final _Satscard_getListSlotsResponse =
+      _Satscard_getListSlotsResponsePtr.asFunction<
+          SatscardListSlotsParams Function(ffi.Pointer<CKTapContext>, int)>();
 
   SatscardSlotResponse Satscard_getNewResponse(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_getNewResponse(
+      context,
       handle,
     );
   }
 
-  late final _Satscard_getNewResponsePtr =
-      _lookup<ffi.NativeFunction<SatscardSlotResponse Function(ffi.Int32)>>(
-          'Satscard_getNewResponse');
+  late final _Satscard_getNewResponsePtr = _lookup<
+      ffi.NativeFunction<
+          SatscardSlotResponse Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_getNewResponse');
   late final _Satscard_getNewResponse = _Satscard_getNewResponsePtr.asFunction<
-      SatscardSlotResponse Function(int)>();
+      SatscardSlotResponse Function(ffi.Pointer<CKTapContext>, int)>();
 
   SatscardSlotResponse Satscard_getUnsealResponse(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Satscard_getUnsealResponse(
+      context,
       handle,
     );
   }
 
-  late final _Satscard_getUnsealResponsePtr =
-      _lookup<ffi.NativeFunction<SatscardSlotResponse Function(ffi.Int32)>>(
-          'Satscard_getUnsealResponse');
-  late final _Satscard_getUnsealResponse = _Satscard_getUnsealResponsePtr
-      .asFunction<SatscardSlotResponse Function(int)>();
+  late final _Satscard_getUnsealResponsePtr = _lookup<
+      ffi.NativeFunction<
+          SatscardSlotResponse Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Satscard_getUnsealResponse');
+  late final _Satscard_getUnsealResponse =
+      _Satscard_getUnsealResponsePtr.asFunction<
+          SatscardSlotResponse Function(ffi.Pointer<CKTapContext>, int)>();
 
   SlotToWifResponse Satscard_slotToWif(
+    ffi.Pointer<CKTapContext> context,
     int handle,
     int index,
   ) {
     return _Satscard_slotToWif(
+      context,
       handle,
       index,
     );
   }
 
   late final _Satscard_slotToWifPtr = _lookup<
-          ffi.NativeFunction<SlotToWifResponse Function(ffi.Int32, ffi.Int32)>>(
-      'Satscard_slotToWif');
-  late final _Satscard_slotToWif =
-      _Satscard_slotToWifPtr.asFunction<SlotToWifResponse Function(int, int)>();
+      ffi.NativeFunction<
+          SlotToWifResponse Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32, ffi.Int32)>>('Satscard_slotToWif');
+  late final _Satscard_slotToWif = _Satscard_slotToWifPtr.asFunction<
+      SlotToWifResponse Function(ffi.Pointer<CKTapContext>, int, int)>();
+
+  /// Checks that every stored slot's address was derived from its public key, across every registered satscard.
+  /// Note: must use [Utility_freeSlotAddressVerification] when you are finished using the data to deallocate memory
+  SlotAddressVerification Satscard_verifySlotAddresses(
+    ffi.Pointer<CKTapContext> context,
+  ) {
+    return _Satscard_verifySlotAddresses(
+      context,
+    );
+  }
+
+  late final _Satscard_verifySlotAddressesPtr = _lookup<
+      ffi.NativeFunction<
+          SlotAddressVerification Function(
+              ffi.Pointer<CKTapContext>)>>('Satscard_verifySlotAddresses');
+  late final _Satscard_verifySlotAddresses =
+      _Satscard_verifySlotAddressesPtr.asFunction<
+          SlotAddressVerification Function(ffi.Pointer<CKTapContext>)>();
 
   /// Gets a C representation of parameters required to construct a [Tapsigner] in dart. Note: must use
   /// [Utility_freeTapsignerConstructorParams] when you are finished using the data to deallocate memory
   TapsignerConstructorParams Tapsigner_createConstructorParams(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Tapsigner_createConstructorParams(
+      context,
       handle,
     );
   }
 
   late final _Tapsigner_createConstructorParamsPtr = _lookup<
-          ffi.NativeFunction<TapsignerConstructorParams Function(ffi.Int32)>>(
-      'Tapsigner_createConstructorParams');
+      ffi.NativeFunction<
+          TapsignerConstructorParams Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Tapsigner_createConstructorParams');
   late final _Tapsigner_createConstructorParams =
       _Tapsigner_createConstructorParamsPtr.asFunction<
-          TapsignerConstructorParams Function(int)>();
+          TapsignerConstructorParams Function(ffi.Pointer<CKTapContext>, int)>();
+
+  /// Batch versions of the above, see [Satscard_createConstructorParamsBatch] for details
+  int Tapsigner_createConstructorParamsBatch(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Int32> handles,
+    int count,
+    ffi.Pointer<TapsignerConstructorParams> outParams,
+  ) {
+    return _Tapsigner_createConstructorParamsBatch(
+      context,
+      handles,
+      count,
+      outParams,
+    );
+  }
+
+  late final _Tapsigner_createConstructorParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, ffi.Int32, ffi.Pointer<TapsignerConstructorParams>)>>('Tapsigner_createConstructorParamsBatch');
+  late final _Tapsigner_createConstructorParamsBatch =
+      _Tapsigner_createConstructorParamsBatchPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, int, ffi.Pointer<TapsignerConstructorParams>)>();
 
   TapsignerSyncParams Tapsigner_createSyncParams(
+    ffi.Pointer<CKTapContext> context,
     int handle,
   ) {
     return _Tapsigner_createSyncParams(
+      context,
       handle,
     );
   }
 
-  late final _Tapsigner_createSyncParamsPtr =
-      _lookup<ffi.NativeFunction<TapsignerSyncParams Function(ffi.Int32)>>(
-          'Tapsigner_createSyncParams');
-  late final _Tapsigner_createSyncParams = _Tapsigner_createSyncParamsPtr
-      .asFunction<TapsignerSyncParams Function(int)>();
+  late final _Tapsigner_createSyncParamsPtr = _lookup<
+      ffi.NativeFunction<
+          TapsignerSyncParams Function(
+              ffi.Pointer<CKTapContext>, ffi.Int32)>>('Tapsigner_createSyncParams');
+  late final _Tapsigner_createSyncParams =
+      _Tapsigner_createSyncParamsPtr.asFunction<
+          TapsignerSyncParams Function(ffi.Pointer<CKTapContext>, int)>();
+
+  int Tapsigner_createSyncParamsBatch(
+    ffi.Pointer<CKTapContext> context,
+    ffi.Pointer<ffi.Int32> handles,
+    int count,
+    ffi.Pointer<TapsignerSyncParams> outParams,
+  ) {
+    return _Tapsigner_createSyncParamsBatch(
+      context,
+      handles,
+      count,
+      outParams,
+    );
+  }
+
+  late final _Tapsigner_createSyncParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, ffi.Int32, ffi.Pointer<TapsignerSyncParams>)>>('Tapsigner_createSyncParamsBatch');
+  late final _Tapsigner_createSyncParamsBatch =
+      _Tapsigner_createSyncParamsBatchPtr.asFunction<
+          int Function(ffi.Pointer<CKTapContext>, ffi.Pointer<ffi.Int32>, int, ffi.Pointer<TapsignerSyncParams>)>();
 
   /// ----------------------------------------------
   /// Utility:
@@ -463,6 +1095,21 @@ class NativeBindings {
   late final _Utility_freeCBinaryArray =
       _Utility_freeCBinaryArrayPtr.asFunction<void Function(CBinaryArray)>();
 
+  void Utility_freeCKTapChangedCards(
+    CKTapChangedCards changedCards,
+  ) {
+    return _Utility_freeCKTapChangedCards(
+      changedCards,
+    );
+  }
+
+  late final _Utility_freeCKTapChangedCardsPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(CKTapChangedCards)>>(
+          'Utility_freeCKTapChangedCards');
+  late final _Utility_freeCKTapChangedCards =
+      _Utility_freeCKTapChangedCardsPtr.asFunction<
+          void Function(CKTapChangedCards)>();
+
   void Utility_freeCKTapInterfaceStatus(
     CKTapInterfaceStatus status,
   ) {
@@ -478,6 +1125,21 @@ class NativeBindings {
       _Utility_freeCKTapInterfaceStatusPtr.asFunction<
           void Function(CKTapInterfaceStatus)>();
 
+  void Utility_freeCKTapPipelinedCards(
+    CKTapPipelinedCards cards,
+  ) {
+    return _Utility_freeCKTapPipelinedCards(
+      cards,
+    );
+  }
+
+  late final _Utility_freeCKTapPipelinedCardsPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(CKTapPipelinedCards)>>(
+          'Utility_freeCKTapPipelinedCards');
+  late final _Utility_freeCKTapPipelinedCards =
+      _Utility_freeCKTapPipelinedCardsPtr.asFunction<
+          void Function(CKTapPipelinedCards)>();
+
   void Utility_freeCKTapProtoException(
     CKTapProtoException exception,
   ) {
@@ -493,6 +1155,21 @@ class NativeBindings {
       _Utility_freeCKTapProtoExceptionPtr.asFunction<
           void Function(CKTapProtoException)>();
 
+  void Utility_freeCKTapReaderStatsList(
+    CKTapReaderStatsList list,
+  ) {
+    return _Utility_freeCKTapReaderStatsList(
+      list,
+    );
+  }
+
+  late final _Utility_freeCKTapReaderStatsListPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(CKTapReaderStatsList)>>(
+          'Utility_freeCKTapReaderStatsList');
+  late final _Utility_freeCKTapReaderStatsList =
+      _Utility_freeCKTapReaderStatsListPtr.asFunction<
+          void Function(CKTapReaderStatsList)>();
+
   void Utility_freeCString(
     ffi.Pointer<ffi.Char> cString,
   ) {
@@ -522,6 +1199,24 @@ class NativeBindings {
       _Utility_freeSatscardConstructorParamsPtr.asFunction<
           void Function(SatscardConstructorParams)>();
 
+  void Utility_freeSatscardConstructorParamsBatch(
+    ffi.Pointer<SatscardConstructorParams> params,
+    int count,
+  ) {
+    return _Utility_freeSatscardConstructorParamsBatch(
+      params,
+      count,
+    );
+  }
+
+  late final _Utility_freeSatscardConstructorParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<SatscardConstructorParams>, ffi.Int32)>>('Utility_freeSatscardConstructorParamsBatch');
+  late final _Utility_freeSatscardConstructorParamsBatch =
+      _Utility_freeSatscardConstructorParamsBatchPtr.asFunction<
+          void Function(ffi.Pointer<SatscardConstructorParams>, int)>();
+
   void Utility_freeSatscardListSlotsParams(
     SatscardListSlotsParams params,
   ) {
@@ -567,6 +1262,54 @@ class NativeBindings {
       _Utility_freeSatscardSyncParamsPtr.asFunction<
           void Function(SatscardSyncParams)>();
 
+  void Utility_freeSatscardSyncParamsBatch(
+    ffi.Pointer<SatscardSyncParams> params,
+    int count,
+  ) {
+    return _Utility_freeSatscardSyncParamsBatch(
+      params,
+      count,
+    );
+  }
+
+  late final _Utility_freeSatscardSyncParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<SatscardSyncParams>, ffi.Int32)>>('Utility_freeSatscardSyncParamsBatch');
+  late final _Utility_freeSatscardSyncParamsBatch =
+      _Utility_freeSatscardSyncParamsBatchPtr.asFunction<
+          void Function(ffi.Pointer<SatscardSyncParams>, int)>();
+
+  void Utility_freeSatscardWifBatch(
+    SatscardWifBatch batch,
+  ) {
+    return _Utility_freeSatscardWifBatch(
+      batch,
+    );
+  }
+
+  late final _Utility_freeSatscardWifBatchPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(SatscardWifBatch)>>(
+          'Utility_freeSatscardWifBatch');
+  late final _Utility_freeSatscardWifBatch =
+      _Utility_freeSatscardWifBatchPtr.asFunction<
+          void Function(SatscardWifBatch)>();
+
+  void Utility_freeSlotAddressVerification(
+    SlotAddressVerification verification,
+  ) {
+    return _Utility_freeSlotAddressVerification(
+      verification,
+    );
+  }
+
+  late final _Utility_freeSlotAddressVerificationPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(SlotAddressVerification)>>(
+          'Utility_freeSlotAddressVerification');
+  late final _Utility_freeSlotAddressVerification =
+      _Utility_freeSlotAddressVerificationPtr.asFunction<
+          void Function(SlotAddressVerification)>();
+
   void Utility_freeSlotConstructorParams(
     SlotConstructorParams params,
   ) {
@@ -611,6 +1354,24 @@ class NativeBindings {
       _Utility_freeTapsignerConstructorParamsPtr.asFunction<
           void Function(TapsignerConstructorParams)>();
 
+  void Utility_freeTapsignerConstructorParamsBatch(
+    ffi.Pointer<TapsignerConstructorParams> params,
+    int count,
+  ) {
+    return _Utility_freeTapsignerConstructorParamsBatch(
+      params,
+      count,
+    );
+  }
+
+  late final _Utility_freeTapsignerConstructorParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<TapsignerConstructorParams>, ffi.Int32)>>('Utility_freeTapsignerConstructorParamsBatch');
+  late final _Utility_freeTapsignerConstructorParamsBatch =
+      _Utility_freeTapsignerConstructorParamsBatchPtr.asFunction<
+          void Function(ffi.Pointer<TapsignerConstructorParams>, int)>();
+
   void Utility_freeTapsignerSyncParams(
     TapsignerSyncParams params,
   ) {
@@ -625,6 +1386,34 @@ class NativeBindings {
   late final _Utility_freeTapsignerSyncParams =
       _Utility_freeTapsignerSyncParamsPtr.asFunction<
           void Function(TapsignerSyncParams)>();
+
+  void Utility_freeTapsignerSyncParamsBatch(
+    ffi.Pointer<TapsignerSyncParams> params,
+    int count,
+  ) {
+    return _Utility_freeTapsignerSyncParamsBatch(
+      params,
+      count,
+    );
+  }
+
+  late final _Utility_freeTapsignerSyncParamsBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<TapsignerSyncParams>, ffi.Int32)>>('Utility_freeTapsignerSyncParamsBatch');
+  late final _Utility_freeTapsignerSyncParamsBatch =
+      _Utility_freeTapsignerSyncParamsBatchPtr.asFunction<
+          void Function(ffi.Pointer<TapsignerSyncParams>, int)>();
+
+  late final addresses = _SymbolAddresses(this);
+}
+
+class _SymbolAddresses {
+  final NativeBindings _library;
+  _SymbolAddresses(this._library);
+  ffi.Pointer<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<CKTapContext>)>>
+      get Core_destroyContext => _library._Core_destroyContextPtr;
 }
 
 class CBinaryArray extends ffi.Struct {
@@ -634,6 +1423,28 @@ class CBinaryArray extends ffi.Struct {
   external int length;
 }
 
+/// @brief Bit flags describing what changed on a card, see Core_getChangedCardsSince
+abstract class CKTapCardChange {
+  static const int cardAdded = 1;
+  static const int certsCheckedChanged = 2;
+  static const int needSetupChanged = 4;
+  static const int authDelayChanged = 8;
+  static const int activeSlotChanged = 16;
+  static const int slotUsageChanged = 32;
+  static const int slotsChanged = 64;
+  static const int numberOfBackupsChanged = 128;
+  static const int derivationPathChanged = 256;
+}
+
+/// A card which changed after the version given to Core_getChangedCardsSince
+class CKTapCardChangeEntry extends ffi.Struct {
+  external CKTapCardHandle handle;
+
+  /// Bitwise OR of every CKTapCardChange which applies
+  @ffi.Int32()
+  external int changes;
+}
+
 class CKTapCardConstructorParams extends ffi.Struct {
   @ffi.Int32()
   external int handle;
@@ -689,6 +1500,23 @@ abstract class CKTapCardType {
   static const int tapsigner = 2;
 }
 
+class CKTapChangedCards extends ffi.Struct {
+  external CKTapInterfaceStatus status;
+
+  /// Pass this to the next call to only receive newer changes
+  @ffi.Int64()
+  external int version;
+
+  external ffi.Pointer<CKTapCardChangeEntry> array;
+
+  @ffi.Int32()
+  external int length;
+}
+
+/// An engine context, opaque to Dart. Each isolate creates its own with Core_createContext so its sessions and card
+/// registry are never seen by another
+class CKTapContext extends ffi.Opaque {}
+
 /// @brief Represents errors that may occur when the library is used incorrectly
 abstract class CKTapInterfaceErrorCode {
   static const int pending = 0;
@@ -728,6 +1556,26 @@ abstract class CKTapInterfaceErrorCode {
   static const int unknownSatscardHandle = 34;
   static const int unknownSlotForGivenSatscardHandle = 35;
   static const int unknownTapsignerHandle = 36;
+  static const int invalidOperationDeadline = 37;
+  static const int invalidBatchArguments = 38;
+  static const int wrongCardForOperation = 39;
+  static const int pipelineQueueFull = 40;
+  static const int pcscNotAvailable = 41;
+  static const int pcscReaderError = 42;
+  static const int sessionPoolNotSupported = 43;
+  static const int daemonConnectionFailed = 44;
+  static const int daemonProtocolError = 45;
+  static const int cardCacheUnreadable = 46;
+  static const int cardCacheUnwritable = 47;
+  static const int prewarmAlreadyRunning = 48;
+  static const int auditLogIncompatible = 49;
+  static const int auditLogUnavailable = 50;
+  static const int sessionStalled = 51;
+  static const int invalidWorkerSchedulingOptions = 52;
+  static const int workerSchedulingNotPermitted = 53;
+  static const int workerSchedulingNotSupported = 54;
+  static const int invalidAttachedCardLimit = 55;
+  static const int invalidContext = 56;
 }
 
 /// Used when accessing tap_protocol methods that can throw
@@ -738,6 +1586,91 @@ class CKTapInterfaceStatus extends ffi.Struct {
   external CKTapProtoException exception;
 }
 
+/// Performance counters gathered by the native library
+class CKTapMetrics extends ffi.Struct {
+  /// Allocation counts are only gathered when built with CKTAP_TRACK_ALLOCATIONS
+  @ffi.Int8()
+  external int isAllocationTrackingEnabled;
+
+  @ffi.Int64()
+  external int totalAllocations;
+
+  /// Allocations made since the most recent call to Core_newOperation
+  @ffi.Int64()
+  external int operationAllocations;
+
+  /// Thread state changes rejected by the transition table
+  @ffi.Int64()
+  external int illegalStateTransitions;
+
+  /// Thread state changes which had to be retried because the other thread changed the state first
+  @ffi.Int64()
+  external int contendedStateTransitions;
+
+  /// Time between the most recent transport request and its response
+  @ffi.Int64()
+  external int lastRoundTripMicros;
+
+  /// The per-message timeout most recently applied, changes over time when adaptive
+  @ffi.Int64()
+  external int transportTimeoutMicros;
+
+  /// Time between a cancellation request and the protocol thread stopping
+  @ffi.Int64()
+  external int lastCancellationLatencyMicros;
+
+  @ffi.Int64()
+  external int maxCancellationLatencyMicros;
+
+  /// Memory locked into RAM by the secure pool which holds private keys and WIFs
+  @ffi.Int64()
+  external int securePoolBytesLocked;
+
+  /// Secrets which the secure pool couldn't hold and were copied to the regular heap instead. They're still
+  /// zeroed when freed but may be swapped to disk, so this should stay at zero
+  @ffi.Int64()
+  external int securePoolFallbacks;
+
+  /// Operations recorded in the audit log, and those which were lost because it was full
+  @ffi.Int64()
+  external int auditRecordsWritten;
+
+  @ffi.Int64()
+  external int auditRecordsDropped;
+
+  /// Operations the watchdog cancelled because they stopped making progress, see Core_setWatchdogOptions
+  @ffi.Int64()
+  external int watchdogInterventions;
+
+  /// Spread of the transport round trips, the jitter is their standard deviation
+  @ffi.Int64()
+  external int roundTripSamples;
+
+  @ffi.Int64()
+  external int meanRoundTripMicros;
+
+  @ffi.Int64()
+  external int roundTripJitterMicros;
+
+  @ffi.Int64()
+  external int maxRoundTripMicros;
+
+  /// Time between the host delivering a transport response and the protocol thread waking to process it, one sample
+  /// per round trip. Shows how long the worker waits for a CPU, see Core_setWorkerSchedulingOptions
+  @ffi.Int64()
+  external int meanWakeLatencyMicros;
+
+  @ffi.Int64()
+  external int wakeLatencyJitterMicros;
+
+  @ffi.Int64()
+  external int maxWakeLatencyMicros;
+
+  /// Times a worker thread couldn't be given the requested scheduling, including SCHED_FIFO falling back to nice
+  @ffi.Int64()
+  external int workerSchedulingFailures;
+}
+
 class CKTapOperationResponse extends ffi.Struct {
   external CKTapCardHandle handle;
 
@@ -745,6 +1678,96 @@ class CKTapOperationResponse extends ffi.Struct {
   external int errorCode;
 }
 
+/// Returned by Core_enqueuePipelinedCard, the ticket identifies the card in Core_pollPipelinedCards
+class CKTapPipelineTicket extends ffi.Struct {
+  @ffi.Int64()
+  external int ticket;
+
+  @ffi.Int32()
+  external int errorCode;
+}
+
+/// A card which finished post-processing and was added to the registry
+class CKTapPipelinedCard extends ffi.Struct {
+  @ffi.Int64()
+  external int ticket;
+
+  external CKTapOperationResponse response;
+
+  /// Set when the satscard's active slot had a public key, `isActiveSlotVerified` is then whether its address
+  /// matched the one derived from that key
+  @ffi.Int8()
+  external int isActiveSlotChecked;
+
+  @ffi.Int8()
+  external int isActiveSlotVerified;
+
+  /// Only the params matching `response.handle.type` are filled
+  external SatscardConstructorParams satscard;
+
+  external TapsignerConstructorParams tapsigner;
+
+  /// Time spent on the worker, from submission until the card was ready to register
+  @ffi.Int64()
+  external int processingMicros;
+}
+
+class CKTapPipelinedCards extends ffi.Struct {
+  external CKTapInterfaceStatus status;
+
+  external ffi.Pointer<CKTapPipelinedCard> array;
+
+  @ffi.Int32()
+  external int length;
+
+  /// Cards which are still being processed, poll again to receive them
+  @ffi.Int32()
+  external int pendingCount;
+}
+
+/// Passed to Core_prewarm, a zero count reserves nothing and a null path skips the card cache
+class CKTapPrewarmOptions extends ffi.Struct {
+  /// How many cards the registry should have room for without growing
+  @ffi.Int32()
+  external int expectedSatscards;
+
+  @ffi.Int32()
+  external int expectedTapsigners;
+
+  /// A cache written by Core_saveCardCache, a missing file isn't an error
+  external ffi.Pointer<ffi.Char> cardCachePath;
+}
+
+/// How long each part of Core_prewarm took, in microseconds
+class CKTapPrewarmReport extends ffi.Struct {
+  /// Pending whilst the prewarm is still running
+  @ffi.Int32()
+  external int errorCode;
+
+  @ffi.Int64()
+  external int elapsedMicros;
+
+  @ffi.Int64()
+  external int threadMicros;
+
+  @ffi.Int64()
+  external int cryptoMicros;
+
+  @ffi.Int64()
+  external int secureMemoryMicros;
+
+  /// Reading the card cache and registering its cards
+  @ffi.Int64()
+  external int cardCacheMicros;
+
+  /// Cards added from the cache, cards which were already registered aren't counted
+  @ffi.Int32()
+  external int cachedSatscards;
+
+  @ffi.Int32()
+  external int cachedTapsigners;
+}
+
 class CKTapProtoException extends ffi.Struct {
   @ffi.Int32()
   external int code;
@@ -797,6 +1820,45 @@ abstract class CKTapProtoExceptionErrorCode {
   static const int INVALID_SLOT = 628;
 }
 
+/// One PC/SC reader driven by its own native worker, see Reader_startAll
+class CKTapReaderStats extends ffi.Struct {
+  external ffi.Pointer<ffi.Char> name;
+
+  @ffi.Int8()
+  external int isRunning;
+
+  /// Handshakes whose card was handed to the pipeline
+  @ffi.Int64()
+  external int completedSessions;
+
+  @ffi.Int64()
+  external int failedSessions;
+
+  /// The error of the most recent failed session
+  @ffi.Int32()
+  external int lastError;
+
+  @ffi.Int64()
+  external int averageSessionMicros;
+}
+
+class CKTapReaderStatsList extends ffi.Struct {
+  external CKTapInterfaceStatus status;
+
+  external ffi.Pointer<CKTapReaderStats> array;
+
+  @ffi.Int32()
+  external int length;
+
+  /// Time since the readers were started
+  @ffi.Int64()
+  external int elapsedMicros;
+
+  /// Completed sessions per minute across every reader
+  @ffi.Int64()
+  external int cardsPerMinute;
+}
+
 /// @brief Mirrors tap_protocol::Satscard::SlotStatus
 abstract class CKTapSatscardSlotStatus {
   static const int UNUSED = 0;
@@ -829,6 +1891,25 @@ abstract class CKTapThreadState {
   static const int transportException = 13;
 }
 
+/// Passed to Core_setWorkerSchedulingOptions, zeroing every field restores the default scheduling
+class CKTapWorkerSchedulingOptions extends ffi.Struct {
+  /// From -20 to 19, lower runs sooner. Going below 0 usually needs CAP_SYS_NICE or a raised RLIMIT_NICE
+  @ffi.Int32()
+  external int niceValue;
+
+  /// Runs the workers with SCHED_FIFO at [realtimePriority], they fall back to [niceValue] where it isn't permitted
+  @ffi.Int8()
+  external int useRealtimeScheduling;
+
+  /// From 1 to 99, 0 uses the lowest
+  @ffi.Int32()
+  external int realtimePriority;
+
+  /// Bit n allows the workers to run on CPU n, 0 allows every CPU the process may use
+  @ffi.Uint64()
+  external int cpuAffinityMask;
+}
+
 class CertificateCheckParams extends ffi.Struct {
   external CKTapInterfaceStatus status;
 
@@ -884,6 +1965,54 @@ class SatscardSyncParams extends ffi.Struct {
   external int isUsedUp;
 }
 
+class SatscardWifBatch extends ffi.Struct {
+  external CKTapInterfaceStatus status;
+
+  external ffi.Pointer<SlotWifEntry> array;
+
+  @ffi.Int32()
+  external int length;
+
+  /// Holds every WIF in the batch, locked into RAM and zeroed when the batch is freed
+  external ffi.Pointer<ffi.Char> buffer;
+
+  @ffi.Int32()
+  external int workerCount;
+
+  @ffi.Int64()
+  external int elapsedMicros;
+
+  @ffi.Int64()
+  external int slotsPerSecond;
+}
+
+class SlotAddressVerification extends ffi.Struct {
+  external CKTapInterfaceStatus status;
+
+  /// Bit `handle * slotsPerCard + slotIndex`, least significant bit first, is set when that slot's address
+  /// matches the one derived from its public key
+  external CBinaryArray passed;
+
+  /// Same layout as `passed`, set for every stored slot which was checked
+  external CBinaryArray checked;
+
+  @ffi.Int32()
+  external int slotsPerCard;
+
+  @ffi.Int32()
+  external int checkedCount;
+
+  @ffi.Int32()
+  external int failedCount;
+
+  /// Whether SHA-256 ran on the CPU's SHA extensions
+  @ffi.Int8()
+  external int isHardwareHashingEnabled;
+
+  @ffi.Int64()
+  external int elapsedMicros;
+}
+
 class SlotConstructorParams extends ffi.Struct {
   @ffi.Int32()
   external int satscardHandle;
@@ -912,6 +2041,18 @@ class SlotToWifResponse extends ffi.Struct {
   external ffi.Pointer<ffi.Char> wif;
 }
 
+/// One slot converted by Satscard_exportWifsBatch
+class SlotWifEntry extends ffi.Struct {
+  @ffi.Int32()
+  external int satscardHandle;
+
+  @ffi.Int32()
+  external int slotIndex;
+
+  /// Points into the batch's locked buffer, null if this slot couldn't be converted
+  external ffi.Pointer<ffi.Char> wif;
+}
+
 class TapsignerConstructorParams extends ffi.Struct {
   external CKTapInterfaceStatus status;
 
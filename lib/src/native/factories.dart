@@ -20,7 +20,8 @@ CKTapCard makeCardOfType(int handle, CardType type) {
 }
 
 Satscard makeSatscardFromHandle(int handle) {
-  final params = nativeLibrary.Satscard_createConstructorParams(handle);
+  final params =
+      nativeLibrary.Satscard_createConstructorParams(nativeContext, handle);
   try {
     if (params.status.errorCode ==
         CKTapInterfaceErrorCode.unknownSatscardHandle) {
@@ -36,7 +37,8 @@ Satscard makeSatscardFromHandle(int handle) {
 }
 
 Tapsigner makeTapsignerFromHandle(int handle) {
-  final params = nativeLibrary.Tapsigner_createConstructorParams(handle);
+  final params =
+      nativeLibrary.Tapsigner_createConstructorParams(nativeContext, handle);
   try {
     if (params.status.errorCode ==
         CKTapInterfaceErrorCode.unknownTapsignerHandle) {
@@ -7,6 +7,10 @@ import 'package:cktap_protocol/src/native/bindings.dart';
 /// Gets an instance of the native library bindings
 NativeBindings get nativeLibrary => Implementation.instance.bindings;
 
+/// Gets this isolate's native context, which every binding operating on cards
+/// takes
+Pointer<CKTapContext> get nativeContext => Implementation.instance.context;
+
 /// Loads the library of the given name in the expected format for the current platform
 DynamicLibrary loadLibrary(final String libName) {
   if (Platform.isMacOS || Platform.isIOS) {
@@ -28,9 +32,15 @@ final Map<int, String> tapInterfaceErrorLiteralMap = {
   CKTapInterfaceErrorCode.success: "success",
   CKTapInterfaceErrorCode.attemptToFinalizeActiveThread:
       "attemptToFinalizeActiveThread",
+  CKTapInterfaceErrorCode.auditLogIncompatible: "auditLogIncompatible",
+  CKTapInterfaceErrorCode.auditLogUnavailable: "auditLogUnavailable",
   CKTapInterfaceErrorCode.bindingNotImplemented: "bindingNotImplemented",
+  CKTapInterfaceErrorCode.cardCacheUnreadable: "cardCacheUnreadable",
+  CKTapInterfaceErrorCode.cardCacheUnwritable: "cardCacheUnwritable",
   CKTapInterfaceErrorCode.caughtTapProtocolException:
       "caughtTapProtocolException",
+  CKTapInterfaceErrorCode.daemonConnectionFailed: "daemonConnectionFailed",
+  CKTapInterfaceErrorCode.daemonProtocolError: "daemonProtocolError",
   CKTapInterfaceErrorCode.expectedSatscardButReceivedNothing:
       "expectedSatscardButReceivedNothing",
   CKTapInterfaceErrorCode.expectedTapsignerButReceivedNothing:
@@ -38,19 +48,31 @@ final Map<int, String> tapInterfaceErrorLiteralMap = {
   CKTapInterfaceErrorCode.failedToPerformHandshake: "failedToPerformHandshake",
   CKTapInterfaceErrorCode.failedToRetrieveValueFromFuture:
       "failedToRetrieveValueFromFuture",
+  CKTapInterfaceErrorCode.invalidBatchArguments: "invalidBatchArguments",
+  CKTapInterfaceErrorCode.invalidAttachedCardLimit: "invalidAttachedCardLimit",
+  CKTapInterfaceErrorCode.invalidContext: "invalidContext",
   CKTapInterfaceErrorCode.invalidCardDuringHandshake:
       "invalidCardDuringHandshake",
   CKTapInterfaceErrorCode.invalidCardOperation: "invalidCardOperation",
   CKTapInterfaceErrorCode.invalidHandlingOfCardDuringFinalization:
       "invalidHandlingOfCardDuringFinalization",
+  CKTapInterfaceErrorCode.invalidOperationDeadline: "invalidOperationDeadline",
   CKTapInterfaceErrorCode.invalidResponseFromCardOperation:
       "invalidResponseFromCardOperation",
   CKTapInterfaceErrorCode.invalidThreadStateDuringTransportSignaling:
       "invalidThreadStateDuringTransportSignaling",
+  CKTapInterfaceErrorCode.invalidWorkerSchedulingOptions:
+      "invalidWorkerSchedulingOptions",
   CKTapInterfaceErrorCode.libraryNotInitialized: "libraryNotInitialized",
   CKTapInterfaceErrorCode.operationCanceled: "operationCanceled",
   CKTapInterfaceErrorCode.operationFailed: "operationFailed",
   CKTapInterfaceErrorCode.operationStillInProgress: "operationStillInProgress",
+  CKTapInterfaceErrorCode.pcscNotAvailable: "pcscNotAvailable",
+  CKTapInterfaceErrorCode.pcscReaderError: "pcscReaderError",
+  CKTapInterfaceErrorCode.pipelineQueueFull: "pipelineQueueFull",
+  CKTapInterfaceErrorCode.prewarmAlreadyRunning: "prewarmAlreadyRunning",
+  CKTapInterfaceErrorCode.sessionPoolNotSupported: "sessionPoolNotSupported",
+  CKTapInterfaceErrorCode.sessionStalled: "sessionStalled",
   CKTapInterfaceErrorCode.threadAlreadyInUse: "threadAlreadyInUse",
   CKTapInterfaceErrorCode.threadAllocationFailed: "threadAllocationFailed",
   CKTapInterfaceErrorCode.threadNotReadyForResponse:
@@ -81,6 +103,11 @@ final Map<int, String> tapInterfaceErrorLiteralMap = {
   CKTapInterfaceErrorCode.unknownSlotForGivenSatscardHandle:
       "unknownSlotForGivenSatscardHandle",
   CKTapInterfaceErrorCode.unknownTapsignerHandle: "unknownTapsignerHandle",
+  CKTapInterfaceErrorCode.workerSchedulingNotPermitted:
+      "workerSchedulingNotPermitted",
+  CKTapInterfaceErrorCode.workerSchedulingNotSupported:
+      "workerSchedulingNotSupported",
+  CKTapInterfaceErrorCode.wrongCardForOperation: "wrongCardForOperation",
 };
 
 /// Maps Nunchuk tap_protocol error code numbers to a string-readable version
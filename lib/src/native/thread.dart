@@ -11,7 +11,12 @@ import 'package:cktap_protocol/src/native/factories.dart';
 import 'package:cktap_protocol/src/native/library.dart';
 import 'package:cktap_transport/cktap_transport.dart';
 
-/// Attempts to cancel the current operation and waits until it has
+/// How long to keep polling for a cancelled operation to unwind before giving up
+const Duration _cancellationUnwindTimeout = Duration(milliseconds: 250);
+
+/// Attempts to cancel the current operation and waits until it has unwound.
+/// Core_requestCancelOperation never blocks, so it's polled here without
+/// holding up the isolate
 Future<void> cancelNativeOperation() async {
   return Future.sync(() async {
     // We don't need to do anything if the thread is inactive
@@ -19,17 +24,19 @@ Future<void> cancelNativeOperation() async {
       return;
     }
 
-    ensure(nativeLibrary.Core_requestCancelOperation());
-    final stopwatch = Stopwatch()..start();
-    while (_isNativeThreadActive()) {
-      if (stopwatch.elapsed.inSeconds >= 2) {
+    final unwindTimer = Stopwatch()..start();
+    var cancelCode = nativeLibrary.Core_requestCancelOperation(nativeContext);
+    while (cancelCode == CKTapInterfaceErrorCode.operationStillInProgress) {
+      if (unwindTimer.elapsed > _cancellationUnwindTimeout) {
         throw TimeoutException("CKTap couldn't cancel the native operation");
       }
-      await Future.delayed(const Duration(microseconds: 50));
+      await Future.delayed(const Duration(milliseconds: 1));
+      cancelCode = nativeLibrary.Core_requestCancelOperation(nativeContext);
     }
+    ensure(cancelCode);
 
     ensureNativeThreadState(CKTapThreadState.canceled);
-    var errorCode = nativeLibrary.Core_finalizeAsyncAction();
+    var errorCode = nativeLibrary.Core_finalizeAsyncAction(nativeContext);
     if (errorCode != CKTapInterfaceErrorCode.operationCanceled) {
       ensure(errorCode);
     }
@@ -39,9 +46,10 @@ Future<void> cancelNativeOperation() async {
 /// Tries to retrieve the card data from the native thread and return in a
 /// Dart-native format
 CKTapCard finalizeCardCreation() {
-  int threadState = nativeLibrary.Core_getThreadState();
+  int threadState = nativeLibrary.Core_getThreadState(nativeContext);
   if (threadState == CKTapThreadState.finished) {
-    CKTapOperationResponse response = nativeLibrary.Core_endOperation();
+    CKTapOperationResponse response =
+        nativeLibrary.Core_endOperation(nativeContext);
     ensure(response.errorCode);
 
     switch (response.handle.type) {
@@ -67,14 +75,15 @@ CKTapCard finalizeCardCreation() {
 /// Tells the native thread to start the handshaking process
 void prepareForCardHandshake(CardType type) {
   ensureNativeThreadState(CKTapThreadState.notStarted);
-  ensure(nativeLibrary.Core_beginAsyncHandshake(type.index));
+  ensure(nativeLibrary.Core_beginAsyncHandshake(nativeContext, type.index));
 }
 
 /// Prepares the native thread for performing a specific operation on an already
 /// constructed card
 void prepareForCardOperation(int handle, CardType type) {
   ensureNativeThreadState(CKTapThreadState.notStarted);
-  ensure(nativeLibrary.Core_prepareCardOperation(handle, type.index));
+  ensure(nativeLibrary.Core_prepareCardOperation(
+      nativeContext, handle, type.index));
 }
 
 /// Attempts to return the native thread to a workable clean state
@@ -83,7 +92,7 @@ void prepareNativeThread() {
     throw ProtocolConcurrencyError("Can't prepare the native thread");
   }
 
-  ensure(nativeLibrary.Core_newOperation());
+  ensure(nativeLibrary.Core_newOperation(nativeContext));
 }
 
 /// Handles the sending and receiving of data between the native library and an
@@ -98,7 +107,7 @@ Future<void> processTransportRequests(Transport transport) async {
 
     while (_isNativeThreadActive()) {
       // Allow the background thread to reach the desired state
-      if (nativeLibrary.Core_getThreadState() !=
+      if (nativeLibrary.Core_getThreadState(nativeContext) !=
           CKTapThreadState.transportRequestReady) {
         await Future.delayed(const Duration(microseconds: 50));
         continue;
@@ -112,23 +121,24 @@ Future<void> processTransportRequests(Transport transport) async {
       ensure(errorCode);
     }
 
-    if (nativeLibrary.Core_getThreadState() ==
+    if (nativeLibrary.Core_getThreadState(nativeContext) ==
         CKTapThreadState.invalidCardProduced) {
       throw InvalidCardException();
     }
-    ensure(nativeLibrary.Core_finalizeAsyncAction());
+    ensure(nativeLibrary.Core_finalizeAsyncAction(nativeContext));
   });
 }
 
 /// Converts the native transport request to a Dart readable format.
 /// Should only be called when there is a transport request ready.
 Uint8List _getNativeTransportRequest() {
-  assert(nativeLibrary.Core_getThreadState() ==
+  assert(nativeLibrary.Core_getThreadState(nativeContext) ==
       CKTapThreadState.transportRequestReady);
 
   Pointer<Uint8> requestPointer =
-      nativeLibrary.Core_getTransportRequestPointer();
-  int requestLength = nativeLibrary.Core_getTransportRequestLength();
+      nativeLibrary.Core_getTransportRequestPointer(nativeContext);
+  int requestLength =
+      nativeLibrary.Core_getTransportRequestLength(nativeContext);
   assert(requestPointer.address != 0);
   assert(requestLength != 0);
 
@@ -137,7 +147,7 @@ Uint8List _getNativeTransportRequest() {
 
 /// Stops transport request loops when given any "final" states"
 bool _isNativeThreadActive() {
-  int threadState = nativeLibrary.Core_getThreadState();
+  int threadState = nativeLibrary.Core_getThreadState(nativeContext);
   return threadState != CKTapThreadState.notStarted &&
       threadState < CKTapThreadState.finished;
 }
@@ -146,17 +156,18 @@ bool _isNativeThreadActive() {
 /// Should only be called when there is a transport request ready.
 int _setNativeTransportResponse(Uint8List response) {
   assert(response.isNotEmpty);
-  assert(nativeLibrary.Core_getThreadState() ==
+  assert(nativeLibrary.Core_getThreadState(nativeContext) ==
       CKTapThreadState.transportRequestReady);
 
   Pointer<Uint8> allocation =
-      nativeLibrary.Core_allocateTransportResponseBuffer(response.length);
+      nativeLibrary.Core_allocateTransportResponseBuffer(
+          nativeContext, response.length);
   assert(allocation.address != 0);
 
   var nativeResponse = allocation.asTypedList(response.length);
   nativeResponse.setAll(0, response);
 
-  var errorCode = nativeLibrary.Core_finalizeTransportResponse();
+  var errorCode = nativeLibrary.Core_finalizeTransportResponse(nativeContext);
   ensure(CKTapInterfaceErrorCode.success);
 
   return errorCode;
@@ -3,6 +3,7 @@ import 'package:cktap_protocol/cktapcard.dart';
 import 'package:cktap_protocol/src/implementation.dart';
 import 'package:cktap_protocol/src/error/validation.dart';
 import 'package:cktap_protocol/src/native/bindings.dart';
+import 'package:cktap_protocol/src/native/library.dart';
 import 'package:cktap_protocol/src/native/translations.dart';
 import 'package:cktap_transport/cktap_transport.dart';
 
@@ -23,7 +24,7 @@ class Tapsigner extends CKTapCard {
   /// Performs a quick sync of mutable fields with the native implementation
   Future<T> _sync<T>(T value) async =>
       Implementation.instance.performNativeOperation((b) async {
-        final params = b.Tapsigner_createSyncParams(handle);
+        final params = b.Tapsigner_createSyncParams(nativeContext, handle);
         try {
           ensureStatus(params.status);
           isCertsChecked = params.baseParams.isCertsChecked > 0;
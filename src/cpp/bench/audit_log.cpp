@@ -0,0 +1,142 @@
+// Project
+#include <bench/bench_utils.h>
+#include <internal/audit_log.h>
+#include <internal/context_services.h>
+#include <internal/globals.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/// Times what the audit log adds to a card operation: appending a record with no log open, with one open and with
+/// several threads appending at once, reading the wall clock for a record's times, and a whole Wait on a scripted
+/// satscard with and without the log. The log is created at --path and removed again afterwards
+
+static void printAuditLogUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--appends N] [--threads N] [--operations N] [--path PATH]\n"
+        "  --appends     records appended per measurement, defaults to 200000\n"
+        "  --threads     threads appending at once, defaults to 4\n"
+        "  --operations  Waits timed with and without the log, defaults to 2000\n"
+        "  --path        where the log is created, defaults to cktap_bench_audit.log\n",
+        program);
+}
+
+static AuditRecord makeBenchRecord(const int64_t i) {
+    AuditRecord record{ };
+    record.startedMicros = i;
+    record.finishedMicros = i;
+    record.errorCode = CKTapInterfaceErrorCode::success;
+    record.operation = static_cast<uint16_t>(i % 7);
+    record.cardType = CKTapCardType::satscard;
+    record.slotIndex = static_cast<int8_t>(i % 10);
+    std::strncpy(record.ident.data(), "ABCDE-FGHIJ-KLMNO-PQRST", record.ident.size() - 1);
+    return record;
+}
+
+/// Appends [appends] records to [log] split between [threads] threads the way the protocol thread does, returning
+/// the wall-clock time per record
+static double measureAppendNanos(AuditLog& log, const int64_t appends, const int64_t threads) {
+    const auto perThread = appends / threads;
+    return measureNanosPerIteration(1, [&](int64_t) {
+        std::vector<std::thread> appenders{ };
+        for (int64_t t{ 0 }; t < threads; ++t) {
+            appenders.emplace_back([&log, perThread]() {
+                for (int64_t i{ 0 }; i < perThread; ++i) {
+                    if (log.isOpen()) {
+                        log.append(makeBenchRecord(i));
+                    }
+                }
+            });
+        }
+        for (auto& appender : appenders) {
+            appender.join();
+        }
+    }) / static_cast<double>(perThread * threads);
+}
+
+/// Runs [operations] Waits on the scripted satscard, returning the mean time of one or -1 if any failed
+static double measureWaitMicros(CKTapContext* context, const CKTapCardHandle card, const std::vector<uint8_t>& reply,
+                                const int64_t operations) {
+    bool isSuccess{ true };
+    const auto nanos = measureNanosPerIteration(operations, [&](int64_t) {
+        isSuccess = isSuccess &&
+            Core_newOperation(context) == CKTapInterfaceErrorCode::success &&
+            Core_prepareCardOperation(context, card.index, card.type) == CKTapInterfaceErrorCode::success &&
+            CKTapCard_beginWait(context) == CKTapInterfaceErrorCode::success &&
+            runScriptedOperation(context, reply) == CKTapInterfaceErrorCode::success;
+        Utility_freeCKTapInterfaceStatus(CKTapCard_getWaitResponse(context).status);
+    });
+    return isSuccess ? nanos / 1000.0 : -1;
+}
+
+int main(int argc, char** argv) {
+    int64_t appends{ 200000 };
+    int64_t threads{ 4 };
+    int64_t operations{ 2000 };
+    const char* path{ "cktap_bench_audit.log" };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--path") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (!readBenchArgument(argc, argv, i, "--appends", appends) &&
+                   !readBenchArgument(argc, argv, i, "--threads", threads) &&
+                   !readBenchArgument(argc, argv, i, "--operations", operations)) {
+            printAuditLogUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (appends <= 0 || threads <= 0 || operations <= 0 || appends < threads) {
+        printAuditLogUsage(argv[0]);
+        return 2;
+    }
+
+    auto* context = Core_createContext();
+    const auto reply = makeScriptedSatscardReply();
+    const auto card = registerScriptedSatscard(context, reply);
+    if (card.index < 0) {
+        std::fprintf(stderr, "unable to register the scripted satscard\n");
+        return 1;
+    }
+
+    // The context's own log, which its Waits are recorded in
+    auto& log = context->services->auditLog;
+    const auto closedNanos = measureAppendNanos(log, appends, 1);
+    const auto closedWaitMicros = measureWaitMicros(context, card, reply, operations);
+
+    // Room for every record below, so none are dropped
+    std::remove(path);
+    if (Core_openAuditLog(context, path, appends * 3 + operations) != CKTapInterfaceErrorCode::success) {
+        std::fprintf(stderr, "unable to open an audit log at %s\n", path);
+        return 1;
+    }
+    const auto firstNanos = measureAppendNanos(log, appends, 1);
+    const auto appendNanos = measureAppendNanos(log, appends, 1);
+    const auto concurrentNanos = measureAppendNanos(log, appends, threads);
+    const auto openWaitMicros = measureWaitMicros(context, card, reply, operations);
+    Core_closeAuditLog(context);
+    std::remove(path);
+    const auto written = log.recordsWritten();
+    const auto dropped = log.recordsDropped();
+    Core_destroyContext(context);
+    if (closedWaitMicros < 0 || openWaitMicros < 0) {
+        std::fprintf(stderr, "a scripted Wait failed\n");
+        return 1;
+    }
+
+    // Stored so the reads aren't optimized away
+    volatile int64_t timestamp{ 0 };
+    const auto timestampNanos = measureNanosPerIteration(appends, [&](int64_t) {
+        timestamp = auditTimestampMicros();
+    });
+
+    std::printf("no log open: %.1f ns per record\n", closedNanos);
+    std::printf("appending: %.1f ns per record, %.1f ns the first time through the mapping\n", appendNanos, firstNanos);
+    std::printf("appending from %lld threads: %.1f ns per record\n", static_cast<long long>(threads), concurrentNanos);
+    std::printf("reading the wall clock: %.1f ns\n", timestampNanos);
+    std::printf("Wait without a log: %.1f us, with one: %.1f us\n", closedWaitMicros, openWaitMicros);
+    std::printf("written %lld, dropped %lld\n", static_cast<long long>(written), static_cast<long long>(dropped));
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef __CKTAP_PROTOCOL__BENCH_BENCH_UTILS_H__
+#define __CKTAP_PROTOCOL__BENCH_BENCH_UTILS_H__
+
+// STL
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/// Helpers shared by the benchmark drivers built with CKTAP_BUILD_BENCHMARKS. Each driver prints plain text, one
+/// measurement per line, so results can be compared between builds by eye
+
+/// A numeric field of /proc/self/status such as VmRSS (in KiB) or Threads, -1 if it can't be read
+inline int64_t readProcessStatusField(const char* field) noexcept {
+    auto* file = std::fopen("/proc/self/status", "r");
+    if (file == nullptr) {
+        return -1;
+    }
+
+    char line[256];
+    int64_t value{ -1 };
+    const auto fieldLength = std::strlen(field);
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        if (std::strncmp(line, field, fieldLength) == 0 && line[fieldLength] == ':') {
+            value = std::strtoll(line + fieldLength + 1, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(file);
+    return value;
+}
+
+/// Runs [body] [iterations] times and returns the mean wall-clock time of one run in nanoseconds
+template <typename Body>
+double measureNanosPerIteration(const int64_t iterations, Body&& body) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t i{ 0 }; i < iterations; ++i) {
+        body(i);
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(iterations);
+}
+
+/// Reads the integer value following [argv[index]], leaving [value] unchanged and returning false if there's none
+inline bool readBenchArgument(const int argc, char** argv, int& index, const char* name, int64_t& value) noexcept {
+    if (std::strcmp(argv[index], name) != 0 || index + 1 >= argc) {
+        return false;
+    }
+    value = std::strtoll(argv[++index], nullptr, 10);
+    return true;
+}
+
+#endif // __CKTAP_PROTOCOL__BENCH_BENCH_UTILS_H__
@@ -0,0 +1,75 @@
+// Project
+#include <bench/bench_utils.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/// Registers many satscards, then reads every one of them back the ways a host refreshing its list of cards does:
+/// the active slot, the constructor params one card at a time, and the constructor params of every card in one batch.
+/// Reports the time per card of each along with the resident memory the registry costs per card
+
+static void printBulkReadsUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--cards N] [--passes N]\n"
+        "  --cards   satscards to register, defaults to 10000\n"
+        "  --passes  times every card is read, defaults to 10\n",
+        program);
+}
+
+int main(int argc, char** argv) {
+    int64_t cardCount{ 10000 };
+    int64_t passes{ 10 };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--cards", cardCount) &&
+            !readBenchArgument(argc, argv, i, "--passes", passes)) {
+            printBulkReadsUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (cardCount <= 0 || passes <= 0) {
+        printBulkReadsUsage(argv[0]);
+        return 2;
+    }
+
+    auto* context = Core_createContext();
+    const auto baseResidentKiB = readProcessStatusField("VmRSS");
+    std::vector<int32_t> handles{ };
+    handles.reserve(cardCount);
+    const auto registerStart = std::chrono::steady_clock::now();
+    for (int64_t i{ 0 }; i < cardCount; ++i) {
+        const auto card = registerScriptedSatscard(context, makeScriptedSatscardReply(static_cast<uint32_t>(i)));
+        if (card.index < 0 || card.index != static_cast<int32_t>(handles.size())) {
+            std::fprintf(stderr, "satscard %lld didn't register as a new card\n", static_cast<long long>(i));
+            return 1;
+        }
+        handles.push_back(card.index);
+    }
+    const auto registerMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registerStart).count();
+    const auto residentKiB = readProcessStatusField("VmRSS");
+
+    const auto readCount = cardCount * passes;
+    const auto activeSlotNanos = measureNanosPerIteration(readCount, [&](const int64_t i) {
+        Utility_freeSatscardSlotResponse(Satscard_getActiveSlot(context, handles[i % cardCount]));
+    });
+    const auto constructorNanos = measureNanosPerIteration(readCount, [&](const int64_t i) {
+        Utility_freeSatscardConstructorParams(Satscard_createConstructorParams(context, handles[i % cardCount]));
+    });
+
+    std::vector<SatscardConstructorParams> params(handles.size());
+    const auto batchNanos = measureNanosPerIteration(passes, [&](int64_t) {
+        Satscard_createConstructorParamsBatch(context, handles.data(), static_cast<int32_t>(cardCount), params.data());
+        Utility_freeSatscardConstructorParamsBatch(params.data(), static_cast<int32_t>(cardCount));
+    }) / static_cast<double>(cardCount);
+    Core_destroyContext(context);
+
+    std::printf("satscards %lld, %lld passes\n", static_cast<long long>(cardCount), static_cast<long long>(passes));
+    std::printf("registering: %.1f us per card, +%.2f KiB resident per card\n", registerMicros / cardCount,
+                static_cast<double>(residentKiB - baseResidentKiB) / cardCount);
+    std::printf("Satscard_getActiveSlot: %.1f ns per card\n", activeSlotNanos);
+    std::printf("Satscard_createConstructorParams: %.1f ns per card\n", constructorNanos);
+    std::printf("Satscard_createConstructorParamsBatch: %.1f ns per card\n", batchNanos);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Project
+#include <bench/bench_utils.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/// Times how quickly an operation waiting on its host ends after Core_requestCancelOperation, measured from the
+/// host's side until the thread reaches a terminal state, and what a failed call costs now that failures are returned
+/// as error codes rather than thrown. The operations are Waits on a scripted satscard
+
+constexpr int32_t unknownCardHandle = 1 << 20;
+
+static void printCancellationUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--cancellations N] [--iterations N]\n"
+        "  --cancellations  operations to cancel, defaults to 2000\n"
+        "  --iterations     failed calls to time, defaults to 1000000\n",
+        program);
+}
+
+/// Yields until [context]'s thread state satisfies [predicate], returning false if that takes too long
+template <typename Predicate>
+static bool waitForThreadState(CKTapContext* context, const Predicate& predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + scriptedOperationTimeout;
+    while (!predicate(Core_getThreadState(context))) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int64_t cancellations{ 2000 };
+    int64_t iterations{ 1000000 };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--cancellations", cancellations) &&
+            !readBenchArgument(argc, argv, i, "--iterations", iterations)) {
+            printCancellationUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (cancellations <= 0 || iterations <= 0) {
+        printCancellationUsage(argv[0]);
+        return 2;
+    }
+
+    auto* context = Core_createContext();
+    const auto reply = makeScriptedSatscardReply();
+    const auto card = registerScriptedSatscard(context, reply);
+    if (card.index < 0) {
+        std::fprintf(stderr, "unable to register the scripted satscard\n");
+        return 1;
+    }
+
+    Core_resetMetrics(context);
+    double totalMicros{ 0 };
+    double maxMicros{ 0 };
+    for (int64_t i{ 0 }; i < cancellations; ++i) {
+        if (Core_newOperation(context) != CKTapInterfaceErrorCode::success ||
+            Core_prepareCardOperation(context, card.index, card.type) != CKTapInterfaceErrorCode::success ||
+            CKTapCard_beginWait(context) != CKTapInterfaceErrorCode::success ||
+            !waitForThreadState(context, [](const CKTapThreadState state) { return state == CKTapThreadState::transportRequestReady; })) {
+            std::fprintf(stderr, "operation %lld didn't reach its first request\n", static_cast<long long>(i));
+            return 1;
+        }
+
+        const auto cancelTime = std::chrono::steady_clock::now();
+        Core_requestCancelOperation(context);
+        if (!waitForThreadState(context, [](const CKTapThreadState state) { return state >= CKTapThreadState::finished; })) {
+            std::fprintf(stderr, "operation %lld wasn't cancelled\n", static_cast<long long>(i));
+            return 1;
+        }
+        const auto micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - cancelTime).count();
+        totalMicros += micros;
+        maxMicros = std::max(maxMicros, micros);
+
+        const auto errorCode = Core_finalizeAsyncAction(context);
+        if (errorCode != CKTapInterfaceErrorCode::operationCanceled) {
+            std::fprintf(stderr, "operation %lld ended with %d rather than being cancelled\n", static_cast<long long>(i),
+                         errorCode);
+            return 1;
+        }
+    }
+    const auto metrics = Core_getMetrics(context);
+
+    const auto failedPrepareNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        Core_prepareCardOperation(context, unknownCardHandle, CKTapCardType::satscard);
+    });
+    const auto failedSlotNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        Utility_freeSatscardSlotResponse(Satscard_getActiveSlot(context, unknownCardHandle));
+    });
+    // For comparison, what each of those failures cost when it was thrown as an exception with a message
+    const auto thrownNanos = measureNanosPerIteration(iterations, [](const int64_t i) {
+        try {
+            throw std::runtime_error{ "Unknown satscard handle " + std::to_string(i) };
+        } catch (const std::exception&) { }
+    });
+    Core_destroyContext(context);
+
+    std::printf("cancellations %lld\n", static_cast<long long>(cancellations));
+    std::printf("cancel to terminal state, seen by the host: %.1f us mean, %.1f us max\n",
+                totalMicros / static_cast<double>(cancellations), maxMicros);
+    std::printf("cancel to terminal state, recorded by the thread: %lld us max\n",
+                static_cast<long long>(metrics.maxCancellationLatencyMicros));
+    std::printf("Core_prepareCardOperation on an unknown card: %.1f ns\n", failedPrepareNanos);
+    std::printf("Satscard_getActiveSlot on an unknown card: %.1f ns\n", failedSlotNanos);
+    std::printf("throwing and catching a runtime_error instead: %.1f ns\n", thrownNanos);
+    return 0;
+}
@@ -0,0 +1,178 @@
+// Project
+#include <bench/bench_utils.h>
+#include <daemon/client.h>
+#include <daemon/server.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Serves the engine from a DaemonServer on a thread of its own and measures what local clients see through the
+/// socket: handshakes relayed to scripted satscards, pings, ListSlots and ListCards from one client, then pings from
+/// several clients at once. Each line gives the requests per second and the 50th and 99th percentile latency. Only
+/// built with CKTAP_BUILD_DAEMON
+
+static void printDaemonUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--requests N] [--cards N] [--clients N] [--socket PATH]\n"
+        "  --requests  requests timed per measurement, defaults to 20000\n"
+        "  --cards     satscards registered through the daemon and listed, defaults to 1000\n"
+        "  --clients   clients pinging at once, defaults to 4\n"
+        "  --socket    where the daemon listens, defaults to /tmp/cktap_bench_daemon.sock\n",
+        program);
+}
+
+struct DaemonLatencies {
+    std::vector<int64_t> nanos{ };
+    double seconds{ 0 };
+};
+
+/// Runs [request] [count] times, timing each call. Returns false if any call failed
+template <typename Request>
+static bool measureDaemonRequests(const int64_t count, DaemonLatencies& latencies, Request&& request) {
+    latencies.nanos.reserve(latencies.nanos.size() + count);
+    const auto start = std::chrono::steady_clock::now();
+    auto previous = start;
+    for (int64_t i{ 0 }; i < count; ++i) {
+        if (!request(i)) {
+            return false;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        latencies.nanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - previous).count());
+        previous = now;
+    }
+    latencies.seconds += std::chrono::duration<double>(previous - start).count();
+    return true;
+}
+
+static void printDaemonLatencies(const char* name, DaemonLatencies& latencies) {
+    auto& nanos = latencies.nanos;
+    std::sort(nanos.begin(), nanos.end());
+    const auto percentile = [&](const size_t percent) {
+        return static_cast<double>(nanos[std::min(nanos.size() - 1, nanos.size() * percent / 100)]) / 1000.0;
+    };
+    std::printf("%s: %.0f requests per second, p50 %.1f us, p99 %.1f us\n", name,
+                static_cast<double>(nanos.size()) / latencies.seconds, percentile(50), percentile(99));
+}
+
+int main(int argc, char** argv) {
+    int64_t requests{ 20000 };
+    int64_t cardCount{ 1000 };
+    int64_t clientCount{ 4 };
+    std::string socketPath{ "/tmp/cktap_bench_daemon.sock" };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (!readBenchArgument(argc, argv, i, "--requests", requests) &&
+                   !readBenchArgument(argc, argv, i, "--cards", cardCount) &&
+                   !readBenchArgument(argc, argv, i, "--clients", clientCount)) {
+            printDaemonUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (requests <= 0 || cardCount <= 0 || clientCount <= 0) {
+        printDaemonUsage(argv[0]);
+        return 2;
+    }
+
+    if (cktap::initializeLibrary() != CKTapInterfaceErrorCode::success) {
+        std::fprintf(stderr, "failed to initialize the library\n");
+        return 1;
+    }
+    DaemonServer server{ socketPath };
+    if (!server.listen()) {
+        std::fprintf(stderr, "unable to listen on %s\n", socketPath.c_str());
+        return 1;
+    }
+    std::thread serverThread{ [&server]() { server.run(); } };
+    const auto stopServer = [&]() {
+        server.stop();
+        serverThread.join();
+        std::remove(socketPath.c_str());
+    };
+
+    auto client = DaemonClient::connect(socketPath);
+    if (!client) {
+        std::fprintf(stderr, "unable to connect to %s\n", socketPath.c_str());
+        stopServer();
+        return 1;
+    }
+
+    // Registers every card through the daemon, the client answering each request the way a phone holding it would
+    DaemonLatencies handshakes{ };
+    int32_t firstCard{ -1 };
+    std::vector<uint8_t> reply{ };
+    const cktap::TransportFunction transport = [&reply](cktap::ByteSpan, std::vector<uint8_t>& response) {
+        response.assign(reply.begin(), reply.end());
+        return true;
+    };
+    auto isSuccess = measureDaemonRequests(cardCount, handshakes, [&](const int64_t i) {
+        reply = makeScriptedSatscardReply(static_cast<uint32_t>(i));
+        const auto handle = client->handshake(CKTapCardType::satscard, transport);
+        firstCard = firstCard < 0 && handle ? handle->index : firstCard;
+        return static_cast<bool>(handle);
+    });
+
+    DaemonLatencies pings{ };
+    DaemonLatencies slotLists{ };
+    DaemonLatencies cardLists{ };
+    isSuccess = isSuccess &&
+        measureDaemonRequests(requests, pings, [&](int64_t) {
+            return client->ping() == CKTapInterfaceErrorCode::success;
+        }) &&
+        measureDaemonRequests(requests, slotLists, [&](int64_t) {
+            const auto slots = client->listSlots(firstCard);
+            return slots && !slots->empty();
+        }) &&
+        measureDaemonRequests(std::max<int64_t>(requests / 10, 1), cardLists, [&](int64_t) {
+            const auto cards = client->listCards();
+            return cards && cards->size() == static_cast<size_t>(cardCount);
+        });
+
+    // Every client pings from a thread of its own, the daemon answers them from its one thread in turn
+    std::vector<DaemonLatencies> clientPings(clientCount);
+    std::atomic<bool> isConcurrentSuccess{ isSuccess };
+    std::vector<std::thread> clients{ };
+    for (int64_t c{ 0 }; c < clientCount && isSuccess; ++c) {
+        clients.emplace_back([&, c]() {
+            auto pinger = DaemonClient::connect(socketPath);
+            if (!pinger || !measureDaemonRequests(requests / clientCount + 1, clientPings[c], [&](int64_t) {
+                return pinger->ping() == CKTapInterfaceErrorCode::success;
+            })) {
+                isConcurrentSuccess = false;
+            }
+        });
+    }
+    for (auto& pinger : clients) {
+        pinger.join();
+    }
+    stopServer();
+    if (!isSuccess || !isConcurrentSuccess) {
+        std::fprintf(stderr, "a request to the daemon failed\n");
+        return 1;
+    }
+
+    // Requests per second across the clients, counting each over the time it ran for
+    DaemonLatencies concurrentPings{ };
+    for (auto& pinger : clientPings) {
+        concurrentPings.nanos.insert(concurrentPings.nanos.end(), pinger.nanos.begin(), pinger.nanos.end());
+        concurrentPings.seconds = std::max(concurrentPings.seconds, pinger.seconds);
+    }
+
+    std::printf("satscards %lld, %lld requests per measurement\n", static_cast<long long>(cardCount),
+                static_cast<long long>(requests));
+    printDaemonLatencies("relayed handshake", handshakes);
+    printDaemonLatencies("ping", pings);
+    printDaemonLatencies("list slots", slotLists);
+    printDaemonLatencies("list cards", cardLists);
+    const auto concurrentName = "ping from " + std::to_string(clientCount) + " clients";
+    printDaemonLatencies(concurrentName.c_str(), concurrentPings);
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Project
+#include <bench/bench_utils.h>
+#include <internal/metrics.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <chrono>
+#include <cstdio>
+
+/// Times handing a finished ListSlots over to the host, the Satscard_getListSlotsResponse call which moves the slots
+/// out of the operation into the registry and the C structs, and freeing those structs again. The card operation
+/// itself runs against a scripted satscard and isn't timed. Allocations are reported on CKTAP_TRACK_ALLOCATIONS builds
+
+constexpr int32_t listSlotsLimit = 10;
+
+static void printListSlotsUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--iterations N]\n"
+        "  --iterations  ListSlots operations to retrieve, defaults to 1000\n",
+        program);
+}
+
+int main(int argc, char** argv) {
+    int64_t iterations{ 1000 };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--iterations", iterations) || iterations <= 0) {
+            printListSlotsUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    auto* context = Core_createContext();
+    const auto reply = makeScriptedSatscardReply();
+    const auto card = registerScriptedSatscard(context, reply);
+    if (card.index < 0) {
+        std::fprintf(stderr, "unable to register the scripted satscard\n");
+        return 1;
+    }
+
+    double retrieveNanos{ 0 };
+    double freeNanos{ 0 };
+    int64_t retrieveAllocations{ 0 };
+    int64_t slotCount{ 0 };
+    for (int64_t i{ 0 }; i < iterations; ++i) {
+        if (Core_newOperation(context) != CKTapInterfaceErrorCode::success ||
+            Core_prepareCardOperation(context, card.index, card.type) != CKTapInterfaceErrorCode::success ||
+            Satscard_beginListSlots(context, nullptr, listSlotsLimit) != CKTapInterfaceErrorCode::success ||
+            runScriptedOperation(context, reply) != CKTapInterfaceErrorCode::success) {
+            std::fprintf(stderr, "ListSlots %lld failed\n", static_cast<long long>(i));
+            return 1;
+        }
+
+        const auto allocationsBefore = threadAllocationCount();
+        const auto retrieveStart = std::chrono::steady_clock::now();
+        const auto params = Satscard_getListSlotsResponse(context, card.index);
+        const auto freeStart = std::chrono::steady_clock::now();
+        retrieveAllocations += threadAllocationCount() - allocationsBefore;
+        if (params.status.errorCode != CKTapInterfaceErrorCode::success) {
+            std::fprintf(stderr, "ListSlots %lld couldn't be retrieved, error %d\n", static_cast<long long>(i),
+                         params.status.errorCode);
+            return 1;
+        }
+        slotCount += params.length;
+
+        Utility_freeSatscardListSlotsParams(params);
+        const auto freeEnd = std::chrono::steady_clock::now();
+        retrieveNanos += std::chrono::duration<double, std::nano>(freeStart - retrieveStart).count();
+        freeNanos += std::chrono::duration<double, std::nano>(freeEnd - freeStart).count();
+    }
+    const auto isAllocationTrackingEnabled = Core_getMetrics(context).isAllocationTrackingEnabled != 0;
+    Core_destroyContext(context);
+
+    const auto count = static_cast<double>(iterations);
+    std::printf("ListSlots retrievals %lld, %.1f slots each\n", static_cast<long long>(iterations), slotCount / count);
+    std::printf("retrieving: %.0f ns per ListSlots\n", retrieveNanos / count);
+    std::printf("freeing: %.0f ns per ListSlots\n", freeNanos / count);
+    if (isAllocationTrackingEnabled) {
+        std::printf("allocations retrieving: %.1f per ListSlots\n", retrieveAllocations / count);
+    }
+    return 0;
+}
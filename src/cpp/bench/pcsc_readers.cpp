@@ -0,0 +1,99 @@
+// Project
+#include <bench/bench_utils.h>
+#include <exports.h>
+
+// STL
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+/// Runs the native PC/SC reader workers for a while and reports the cards per minute each reader managed, the way
+/// Reader_getStats sees them, next to how many cards the host collected through Core_pollPipelinedCards. Cards have
+/// to be placed on the readers while it runs, vsmartcard's virtual readers with a card emulator tapping repeatedly
+/// keep them busy without hardware. At most maxPipelinedCards cards wait for the host at once, so --poll-ms bounds
+/// the rate as well. Only built with CKTAP_ENABLE_PCSC
+
+static void printPcscReadersUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--seconds N] [--poll-ms N] [--card-type N]\n"
+        "  --seconds    how long the readers run, defaults to 60\n"
+        "  --poll-ms    time between the host's polls for cards, defaults to 10\n"
+        "  --card-type  the CKTapCardType each handshake expects, defaults to satscard\n",
+        program);
+}
+
+/// Frees a poll's cards, returning how many were registered
+static int64_t collectReaderCards(CKTapContext* context, const bool wait, int64_t& failed) {
+    const auto cards = Core_pollPipelinedCards(context, wait ? 1 : 0);
+    int64_t registered{ 0 };
+    for (int32_t i{ 0 }; i < cards.length; ++i) {
+        if (cards.array[i].response.errorCode == CKTapInterfaceErrorCode::success) {
+            ++registered;
+        } else {
+            ++failed;
+        }
+    }
+    Utility_freeCKTapPipelinedCards(cards);
+    return registered;
+}
+
+int main(int argc, char** argv) {
+    int64_t seconds{ 60 };
+    int64_t pollMillis{ 10 };
+    int64_t cardType{ CKTapCardType::satscard };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--seconds", seconds) &&
+            !readBenchArgument(argc, argv, i, "--poll-ms", pollMillis) &&
+            !readBenchArgument(argc, argv, i, "--card-type", cardType)) {
+            printPcscReadersUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (seconds <= 0 || pollMillis <= 0) {
+        printPcscReadersUsage(argv[0]);
+        return 2;
+    }
+
+    auto* context = Core_createContext();
+    const auto startError = Reader_startAll(context, static_cast<int32_t>(cardType));
+    if (startError != CKTapInterfaceErrorCode::success) {
+        std::fprintf(stderr, "unable to start the readers, error %d\n", startError);
+        Core_destroyContext(context);
+        return 1;
+    }
+
+    int64_t registered{ 0 };
+    int64_t failed{ 0 };
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ seconds };
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ pollMillis });
+        registered += collectReaderCards(context, false, failed);
+    }
+
+    // The stats are taken before stopping, which would cancel the sessions in progress and count them as failed
+    const auto stats = Reader_getStats();
+    Reader_stopAll();
+    registered += collectReaderCards(context, true, failed);
+    Core_destroyContext(context);
+    if (stats.status.errorCode != CKTapInterfaceErrorCode::success) {
+        std::fprintf(stderr, "unable to read the reader stats, error %d\n", stats.status.errorCode);
+        Utility_freeCKTapReaderStatsList(stats);
+        return 1;
+    }
+
+    std::printf("readers %d, %.1f s\n", stats.length, static_cast<double>(stats.elapsedMicros) / 1e6);
+    for (int32_t i{ 0 }; i < stats.length; ++i) {
+        const auto& reader = stats.array[i];
+        std::printf("%s: %lld sessions, %lld failed, %lld us per session\n", reader.name,
+                    static_cast<long long>(reader.completedSessions), static_cast<long long>(reader.failedSessions),
+                    static_cast<long long>(reader.averageSessionMicros));
+        if (reader.failedSessions > 0) {
+            std::printf("%s: last error %d\n", reader.name, reader.lastError);
+        }
+    }
+    std::printf("all readers: %lld cards per minute\n", static_cast<long long>(stats.cardsPerMinute));
+    std::printf("collected by the host: %lld cards, %lld failed\n", static_cast<long long>(registered),
+                static_cast<long long>(failed));
+    Utility_freeCKTapReaderStatsList(stats);
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Project
+#include <bench/bench_utils.h>
+#include <exports.h>
+#include <internal/utils.h>
+
+// STL
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/// Compares handing private keys and WIFs out of the locked secure pool against the regular heap they used to come
+/// from, each allocation followed by the free the host makes through the Utility exports. The first batch held at
+/// once includes mapping and locking the pool's chunks, later batches reuse them. A WIF on the heap is timed both
+/// as it used to be freed and wiped first, the way Utility_freeSlotToWifResponse frees one that fell back to the heap
+
+constexpr size_t benchPrivateKeySize = 32;
+constexpr char benchWif[]{ "KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn" };
+
+static void printSecurePoolUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--iterations N] [--batch N]\n"
+        "  --iterations  allocations timed one at a time, defaults to 1000000\n"
+        "  --batch       keys held at once, defaults to 1000\n",
+        program);
+}
+
+/// Allocates [batch] keys with [allocate] before freeing them all, returning the time per key
+template <typename Allocate>
+static double measureBatchNanos(const int64_t batch, const Allocate& allocate) {
+    const std::vector<uint8_t> privateKey(benchPrivateKeySize, 0x5A);
+    std::vector<CBinaryArray> arrays(static_cast<size_t>(batch));
+    return measureNanosPerIteration(1, [&](int64_t) {
+        for (auto& array : arrays) {
+            array = allocate(privateKey.data(), privateKey.size());
+        }
+        for (auto& array : arrays) {
+            freeCBinaryArray(array);
+        }
+    }) / static_cast<double>(batch);
+}
+
+int main(int argc, char** argv) {
+    int64_t iterations{ 1000000 };
+    int64_t batch{ 1000 };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--iterations", iterations) &&
+            !readBenchArgument(argc, argv, i, "--batch", batch)) {
+            printSecurePoolUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (iterations <= 0 || batch <= 0) {
+        printSecurePoolUsage(argv[0]);
+        return 2;
+    }
+
+    const auto firstBatchNanos = measureBatchNanos(batch, allocateSecureCBinaryArray);
+    const auto secureBatchNanos = measureBatchNanos(batch, allocateSecureCBinaryArray);
+    const auto heapBatchNanos = measureBatchNanos(batch, allocateCBinaryArray);
+
+    const std::vector<uint8_t> privateKey(benchPrivateKeySize, 0x5A);
+    const auto secureKeyNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        auto array = allocateSecureCBinaryArray(privateKey.data(), privateKey.size());
+        Utility_freeCBinaryArray(array);
+    });
+    const auto heapKeyNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        auto array = allocateCBinaryArray(privateKey.data(), privateKey.size());
+        Utility_freeCBinaryArray(array);
+    });
+
+    const auto wifLength = std::strlen(benchWif);
+    const auto secureWifNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        auto* wif = allocateSecureCString(benchWif, wifLength);
+        freeSecureCString(wif);
+    });
+    const auto heapWifNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        auto* wif = static_cast<char*>(std::malloc(wifLength + 1));
+        std::memcpy(wif, benchWif, wifLength + 1);
+        Utility_freeCString(wif);
+    });
+    const auto wipedHeapWifNanos = measureNanosPerIteration(iterations, [&](int64_t) {
+        auto* wif = static_cast<char*>(std::malloc(wifLength + 1));
+        std::memcpy(wif, benchWif, wifLength + 1);
+        freeSecureCString(wif);
+    });
+
+    // The pool is process-wide, a context is only needed to read the metrics
+    auto* context = Core_createContext();
+    const auto metrics = Core_getMetrics(context);
+    Core_destroyContext(context);
+    std::printf("private key, secure pool: %.1f ns per allocation and free\n", secureKeyNanos);
+    std::printf("private key, heap: %.1f ns per allocation and free\n", heapKeyNanos);
+    std::printf("WIF, secure pool: %.1f ns per allocation and free\n", secureWifNanos);
+    std::printf("WIF, heap: %.1f ns per allocation and free, %.1f ns wiped before the free\n", heapWifNanos,
+                wipedHeapWifNanos);
+    std::printf("%lld keys at once, secure pool: %.1f ns per key, %.1f ns the first time\n", static_cast<long long>(batch),
+                secureBatchNanos, firstBatchNanos);
+    std::printf("%lld keys at once, heap: %.1f ns per key\n", static_cast<long long>(batch), heapBatchNanos);
+    std::printf("locked: %lld bytes, fallbacks to the heap: %lld\n", static_cast<long long>(metrics.securePoolBytesLocked),
+                static_cast<long long>(metrics.securePoolFallbacks));
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Project
+#include <bench/bench_utils.h>
+#include <exports.h>
+
+// STL
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/// Opens many sessions which all wait on their host at once, then reports the threads and resident memory they
+/// cost and how long answering every one of them takes. Run it once with --pool-threads 0 for a thread per session
+/// and again with a few pool threads on a CKTAP_ENABLE_SESSION_POOL build to compare.
+///
+/// No card is needed. Each session's first request is answered with an "instruction not supported" status word,
+/// which tap_protocol rejects, so every session ends after exactly one round trip
+
+constexpr auto scalingSettleTimeout = std::chrono::seconds{ 30 };
+
+/// Polls until [predicate] holds for every context, returning false if that takes longer than the settle timeout
+template <typename Predicate>
+static bool waitForAllSessions(const std::vector<CKTapContext*>& contexts, const Predicate& predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + scalingSettleTimeout;
+    for (auto* context : contexts) {
+        while (!predicate(Core_getThreadState(context))) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+        }
+    }
+    return true;
+}
+
+static void printScalingUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--sessions N] [--pool-threads N]\n"
+        "  --sessions      sessions waiting at once, defaults to 1000\n"
+        "  --pool-threads  0 runs a thread per session, the default\n",
+        program);
+}
+
+int main(int argc, char** argv) {
+    int64_t sessionCount{ 1000 };
+    int64_t poolThreads{ 0 };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--sessions", sessionCount) &&
+            !readBenchArgument(argc, argv, i, "--pool-threads", poolThreads)) {
+            printScalingUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Taken first so the pool's own workers are counted
+    const auto baseThreads = readProcessStatusField("Threads");
+    const auto baseResidentKiB = readProcessStatusField("VmRSS");
+
+    const auto poolResult = Core_setSessionPoolThreads(static_cast<int32_t>(poolThreads));
+    if (poolResult != CKTapInterfaceErrorCode::success) {
+        std::fprintf(stderr, "unable to use %lld pool threads, error %d\n", static_cast<long long>(poolThreads), poolResult);
+        return 1;
+    }
+
+    std::vector<CKTapContext*> contexts{ };
+    contexts.reserve(sessionCount);
+    for (int64_t i{ 0 }; i < sessionCount; ++i) {
+        auto* context = Core_createContext();
+        if (context == nullptr ||
+            Core_newOperation(context) != CKTapInterfaceErrorCode::success ||
+            Core_beginAsyncHandshake(context, CKTapCardType::unknownCard) != CKTapInterfaceErrorCode::success) {
+            std::fprintf(stderr, "session %lld failed to start\n", static_cast<long long>(i));
+            return 1;
+        }
+        contexts.push_back(context);
+    }
+
+    if (!waitForAllSessions(contexts, [](const CKTapThreadState state) { return state == CKTapThreadState::transportRequestReady; })) {
+        std::fprintf(stderr, "sessions didn't all reach their first request\n");
+        return 1;
+    }
+
+    const auto waitingThreads = readProcessStatusField("Threads");
+    const auto waitingResidentKiB = readProcessStatusField("VmRSS");
+
+    const auto answerStart = std::chrono::steady_clock::now();
+    for (auto* context : contexts) {
+        auto* response = Core_allocateTransportResponseBuffer(context, 2);
+        response[0] = 0x6D;
+        response[1] = 0x00;
+        Core_finalizeTransportResponse(context);
+    }
+    if (!waitForAllSessions(contexts, [](const CKTapThreadState state) { return state >= CKTapThreadState::finished; })) {
+        std::fprintf(stderr, "sessions didn't all finish\n");
+        return 1;
+    }
+    const auto drainMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - answerStart).count();
+
+    for (auto* context : contexts) {
+        Core_finalizeAsyncAction(context);
+        Core_destroyContext(context);
+    }
+
+    std::printf("sessions %lld, pool threads %lld\n", static_cast<long long>(sessionCount), static_cast<long long>(poolThreads));
+    std::printf("threads while waiting: %lld (+%lld)\n", static_cast<long long>(waitingThreads),
+                static_cast<long long>(waitingThreads - baseThreads));
+    std::printf("resident while waiting: %lld KiB (+%.1f KiB per session)\n", static_cast<long long>(waitingResidentKiB),
+                static_cast<double>(waitingResidentKiB - baseResidentKiB) / sessionCount);
+    std::printf("answering every session: %.0f us (%.2f us per session)\n", drainMicros, drainMicros / sessionCount);
+    return 0;
+}
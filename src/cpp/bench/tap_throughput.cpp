@@ -0,0 +1,149 @@
+// Project
+#include <bench/bench_utils.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/// Taps satscards back to back and reports how many cards a minute get read and ready for the host, first one card
+/// at a time with Core_endOperation and the host building the card's params, then with Core_enqueuePipelinedCard
+/// handing that work to the pipeline whilst the next card's handshake runs. --round-trip-us holds every answer back
+/// to stand in for the NFC link, which leaves the pipeline more time to overlap. With no delay, or a single core,
+/// there's nothing to overlap and the pipeline only adds its handoff
+
+static void printTapThroughputUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--cards N] [--round-trip-us N]\n"
+        "  --cards          satscards tapped each way, defaults to 1000\n"
+        "  --round-trip-us  delay before answering each request, defaults to 1000\n",
+        program);
+}
+
+/// Answers every request of the running handshake with [reply] after [roundTrip], then finalizes it
+static CKTapInterfaceErrorCode runTappedHandshake(CKTapContext* context, const std::vector<uint8_t>& reply,
+                                                  const std::chrono::microseconds roundTrip) {
+    const auto deadline = std::chrono::steady_clock::now() + scriptedOperationTimeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto state = Core_getThreadState(context);
+        if (state >= CKTapThreadState::finished) {
+            return Core_finalizeAsyncAction(context);
+        }
+        if (state != CKTapThreadState::transportRequestReady) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (roundTrip.count() > 0) {
+            std::this_thread::sleep_for(roundTrip);
+        }
+        answerTransportRequest(context, reply);
+    }
+    cancelScriptedOperation(context);
+    return CKTapInterfaceErrorCode::operationStillInProgress;
+}
+
+static bool beginTap(CKTapContext* context, const std::vector<uint8_t>& reply, const std::chrono::microseconds roundTrip) {
+    return Core_newOperation(context) == CKTapInterfaceErrorCode::success &&
+        Core_beginAsyncHandshake(context, CKTapCardType::satscard) == CKTapInterfaceErrorCode::success &&
+        runTappedHandshake(context, reply, roundTrip) == CKTapInterfaceErrorCode::success;
+}
+
+/// Frees a poll's cards, returning how many were registered or -1 if any failed
+static int32_t collectPipelinedCards(CKTapContext* context, const bool wait) {
+    const auto cards = Core_pollPipelinedCards(context, wait ? 1 : 0);
+    auto count = cards.status.errorCode == CKTapInterfaceErrorCode::success ? cards.length : -1;
+    for (int32_t i{ 0 }; i < cards.length; ++i) {
+        if (cards.array[i].response.errorCode != CKTapInterfaceErrorCode::success) {
+            count = -1;
+        }
+    }
+    Utility_freeCKTapPipelinedCards(cards);
+    return count;
+}
+
+static double cardsPerMinute(const int64_t cardCount, const std::chrono::steady_clock::time_point start) {
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(cardCount) * 60.0 / seconds;
+}
+
+int main(int argc, char** argv) {
+    int64_t cardCount{ 1000 };
+    int64_t roundTripMicros{ 1000 };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (!readBenchArgument(argc, argv, i, "--cards", cardCount) &&
+            !readBenchArgument(argc, argv, i, "--round-trip-us", roundTripMicros)) {
+            printTapThroughputUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (cardCount <= 0 || roundTripMicros < 0) {
+        printTapThroughputUsage(argv[0]);
+        return 2;
+    }
+    const std::chrono::microseconds roundTrip{ roundTripMicros };
+
+    // Each way taps its own cards, so both register as many new cards as the other
+    std::vector<std::vector<uint8_t>> replies{ };
+    replies.reserve(cardCount * 2);
+    for (int64_t i{ 0 }; i < cardCount * 2; ++i) {
+        replies.push_back(makeScriptedSatscardReply(static_cast<uint32_t>(i)));
+    }
+    auto* sequentialContext = Core_createContext();
+    auto* pipelinedContext = Core_createContext();
+
+    const auto sequentialStart = std::chrono::steady_clock::now();
+    for (int64_t i{ 0 }; i < cardCount; ++i) {
+        if (!beginTap(sequentialContext, replies[i], roundTrip)) {
+            std::fprintf(stderr, "card %lld failed its handshake\n", static_cast<long long>(i));
+            return 1;
+        }
+        const auto response = Core_endOperation(sequentialContext);
+        if (response.errorCode != CKTapInterfaceErrorCode::success) {
+            std::fprintf(stderr, "card %lld couldn't be registered, error %d\n", static_cast<long long>(i), response.errorCode);
+            return 1;
+        }
+        Utility_freeSatscardConstructorParams(Satscard_createConstructorParams(sequentialContext, response.handle.index));
+        Utility_freeSatscardSlotResponse(Satscard_getActiveSlot(sequentialContext, response.handle.index));
+    }
+    const auto sequentialRate = cardsPerMinute(cardCount, sequentialStart);
+
+    int64_t registered{ 0 };
+    const auto pipelinedStart = std::chrono::steady_clock::now();
+    for (int64_t i{ 0 }; i < cardCount; ++i) {
+        if (!beginTap(pipelinedContext, replies[cardCount + i], roundTrip)) {
+            std::fprintf(stderr, "card %lld failed its handshake\n", static_cast<long long>(i));
+            return 1;
+        }
+
+        auto ticket = Core_enqueuePipelinedCard(pipelinedContext);
+        if (ticket.errorCode == CKTapInterfaceErrorCode::pipelineQueueFull) {
+            const auto count = collectPipelinedCards(pipelinedContext, true);
+            registered += count;
+            ticket = count >= 0 ? Core_enqueuePipelinedCard(pipelinedContext) : ticket;
+        }
+        const auto count = collectPipelinedCards(pipelinedContext, false);
+        if (ticket.errorCode != CKTapInterfaceErrorCode::success || count < 0) {
+            std::fprintf(stderr, "card %lld couldn't be pipelined, error %d\n", static_cast<long long>(i), ticket.errorCode);
+            return 1;
+        }
+        registered += count;
+    }
+    registered += collectPipelinedCards(pipelinedContext, true);
+    const auto pipelinedRate = cardsPerMinute(cardCount, pipelinedStart);
+    Core_destroyContext(sequentialContext);
+    Core_destroyContext(pipelinedContext);
+
+    if (registered != cardCount) {
+        std::fprintf(stderr, "only %lld of %lld pipelined cards were registered\n", static_cast<long long>(registered),
+                     static_cast<long long>(cardCount));
+        return 1;
+    }
+    std::printf("satscards %lld each way, %lld us per round trip\n", static_cast<long long>(cardCount),
+                static_cast<long long>(roundTripMicros));
+    std::printf("one at a time: %.0f cards per minute\n", sequentialRate);
+    std::printf("pipelined: %.0f cards per minute\n", pipelinedRate);
+    return 0;
+}
@@ -0,0 +1,715 @@
+#include <core.h>
+
+// Project
+#include <internal/card_operation.h>
+#include <internal/globals.h>
+#include <internal/secure_memory.h>
+#include <internal/tap_protocol_thread.h>
+
+// Third party
+#include <tap_protocol/cktapcard.h>
+
+// STL
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace cktap {
+
+/// How long a session sleeps between transport requests before checking on the protocol thread again
+constexpr auto sessionTransportWakeInterval = std::chrono::milliseconds{ 50 };
+/// How long a native host closing its session waits for the cancelled operation to unwind
+constexpr auto cancellationUnwindTimeout = std::chrono::milliseconds{ 250 };
+
+// ----------------------------------------------
+// SecretString:
+
+SecretString::SecretString(SecretString&& other) noexcept
+    : _length{ other._length } {
+    std::memcpy(_buffer, other._buffer, sizeof(_buffer));
+    other._clear();
+}
+
+SecretString& SecretString::operator=(SecretString&& other) noexcept {
+    if (this != &other) {
+        std::memcpy(_buffer, other._buffer, sizeof(_buffer));
+        _length = other._length;
+        other._clear();
+    }
+    return *this;
+}
+
+SecretString::~SecretString() {
+    _clear();
+}
+
+void SecretString::_clear() noexcept {
+    secureZero(_buffer, sizeof(_buffer));
+    _length = 0;
+}
+
+// ----------------------------------------------
+// Contexts:
+
+CKTapContext* createContext() noexcept {
+    auto* context = new (std::nothrow) CKTapContext{ };
+    if (context == nullptr) {
+        return nullptr;
+    }
+
+    const ContextBinding binding{ context };
+    if (initializeLibrary() != CKTapInterfaceErrorCode::success) {
+        delete context;
+        return nullptr;
+    }
+    return context;
+}
+
+void destroyContext(CKTapContext* context) noexcept {
+    if (context == nullptr) {
+        return;
+    }
+
+    {
+        const ContextBinding binding{ context };
+        if (isOperationActive()) {
+            cancelOperation();
+            finalizeOperation();
+        }
+    }
+    delete context;
+}
+
+ContextBinding::ContextBinding(CKTapContext* context) noexcept
+    : _previous{ bindContext(context) } {
+}
+
+ContextBinding::~ContextBinding() {
+    bindContext(_previous);
+}
+
+// ----------------------------------------------
+// Operations:
+
+CKTapInterfaceErrorCode initializeLibrary() noexcept {
+    auto& context = currentContext();
+    if (context.protocolThread == nullptr) {
+        try {
+            if (context.services == nullptr) {
+                context.services = std::make_shared<ContextServices>();
+            }
+        } catch (...) {
+            return CKTapInterfaceErrorCode::threadAllocationFailed;
+        }
+        context.protocolThread.reset(TapProtocolThread::createNew(context.services, context.operationMetrics));
+
+        if (context.protocolThread == nullptr) {
+            return CKTapInterfaceErrorCode::threadAllocationFailed;
+        }
+    }
+    return CKTapInterfaceErrorCode::success;
+}
+
+CKTapInterfaceErrorCode newOperation() noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    }
+    // Never waits, a cancelled operation, whether by the host or the watchdog, is reported as still unwinding so
+    // the host can try again in a moment rather than taking it for one in use
+    if (currentProtocolThread()->isThreadActive()) {
+        return currentProtocolThread()->isCancelRequested() ?
+            CKTapInterfaceErrorCode::operationStillInProgress :
+            CKTapInterfaceErrorCode::threadAlreadyInUse;
+    }
+
+    // Keep anything the previous operation reattached even if its response was never fetched
+    refreshOperationCard();
+    currentContext().operationCard = CKTapCardHandle{ -1, CKTapCardType::unknownCard };
+    return currentProtocolThread()->reset();
+}
+
+CKTapInterfaceErrorCode beginHandshake(const int32_t cardType) noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    } else if (currentProtocolThread()->hasStarted()) {
+        return CKTapInterfaceErrorCode::threadNotResetForHandshake;
+    }
+
+    if (!currentProtocolThread()->beginCardHandshake(cardType)) {
+        // The thread failed to start so we should diagnose why
+        return currentProtocolThread()->finalizeOperation() ?
+            currentProtocolThread()->getRecentErrorCode() :
+            CKTapInterfaceErrorCode::unknownErrorDuringHandshake;
+    }
+
+    return CKTapInterfaceErrorCode::success;
+}
+
+std::optional<ByteSpan> transportRequest() noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return { };
+    }
+
+    const auto request = currentProtocolThread()->getTransportRequest();
+    if (!request.has_value()) {
+        return { };
+    }
+    return ByteSpan{ request.value()->data(), request.value()->size() };
+}
+
+uint8_t* allocateTransportResponse(const size_t size) noexcept {
+    if (currentProtocolThread() == nullptr || size == 0) {
+        return nullptr;
+    }
+
+    try {
+        return currentProtocolThread()->allocateTransportResponseBuffer(size).value_or(nullptr);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+CKTapInterfaceErrorCode finalizeTransportResponse() noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::threadNotYetStarted;
+    }
+    if (currentProtocolThread()->getState() != CKTapThreadState::transportRequestReady) {
+        return CKTapInterfaceErrorCode::threadNotReadyForResponse;
+    }
+
+    return currentProtocolThread()->finalizeTransportResponse() ?
+        CKTapInterfaceErrorCode::success :
+        CKTapInterfaceErrorCode::threadResponseFinalizationFailed;
+}
+
+bool waitForTransportRequest(const std::chrono::steady_clock::time_point deadline) noexcept {
+    return currentProtocolThread() != nullptr && currentProtocolThread()->waitForTransportRequest(deadline);
+}
+
+bool isOperationActive() noexcept {
+    return currentProtocolThread() != nullptr && currentProtocolThread()->isThreadActive();
+}
+
+CKTapInterfaceErrorCode cancelOperation() noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    }
+
+    currentProtocolThread()->requestCancel();
+    return currentProtocolThread()->isThreadActive() ?
+        CKTapInterfaceErrorCode::operationStillInProgress :
+        CKTapInterfaceErrorCode::success;
+}
+
+bool waitForCancellation(const std::chrono::steady_clock::time_point deadline) noexcept {
+    return currentProtocolThread() == nullptr || currentProtocolThread()->waitForCancellation(deadline);
+}
+
+CKTapInterfaceErrorCode finalizeOperation() noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    }
+    if (!currentProtocolThread()->hasStarted()) {
+        return CKTapInterfaceErrorCode::threadNotYetStarted;
+    }
+    if (currentProtocolThread()->isThreadActive()) {
+        return CKTapInterfaceErrorCode::attemptToFinalizeActiveThread;
+    }
+
+    return currentProtocolThread()->finalizeOperation() ?
+        currentProtocolThread()->getRecentErrorCode() :
+        CKTapInterfaceErrorCode::unableToFinalizeAsyncAction;
+}
+
+Result<CKTapCardHandle> endOperation() noexcept {
+    using HandleResult = Result<CKTapCardHandle>;
+
+    if (currentProtocolThread() == nullptr) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::libraryNotInitialized);
+    }
+    if (!currentProtocolThread()->hasStarted()) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::threadNotYetStarted);
+    }
+    if (currentProtocolThread()->isThreadActive()) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::operationStillInProgress);
+    }
+    if (currentProtocolThread()->getRecentErrorCode() == CKTapInterfaceErrorCode::pending) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::threadNotYetFinalized);
+    }
+    if (currentProtocolThread()->hasFailed() || !currentProtocolThread()->getConstructedCardType().has_value()) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::operationFailed);
+    }
+
+    const auto type = currentProtocolThread()->getConstructedCardType().value();
+    size_t index;
+    if (type == CKTapCardType::tapsigner) {
+        auto tapsigner = currentProtocolThread()->releaseConstructedTapsigner();
+        if (!tapsigner) {
+            return HandleResult::failure(CKTapInterfaceErrorCode::expectedTapsignerButReceivedNothing);
+        }
+        index = updateVectorWithCard(currentContext().tapsigners, currentContext().tapsignerIdents, tapsigner);
+    } else if (type == CKTapCardType::satscard) {
+        auto satscard = currentProtocolThread()->releaseConstructedSatscard();
+        if (!satscard) {
+            return HandleResult::failure(CKTapInterfaceErrorCode::expectedSatscardButReceivedNothing);
+        }
+        index = updateVectorWithCard(currentContext().satscards, currentContext().satscardIdents, satscard);
+    } else {
+        return HandleResult::failure(CKTapInterfaceErrorCode::invalidCardDuringHandshake);
+    }
+
+    if (index == invalidIndex) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::invalidHandlingOfCardDuringFinalization);
+    }
+
+    markCardAdded(type, index);
+    detachIdleCards();
+    return HandleResult{ CKTapCardHandle{ static_cast<int32_t>(index), type } };
+}
+
+// ----------------------------------------------
+// Card operations:
+
+/// Gives the protocol thread the card's live object or, when it has been detached, what it needs to reattach it
+template <typename WrapperType>
+static bool prepareThreadForCard(const WrapperType& wrapper, const CKTapCardType type) noexcept {
+    if (wrapper.card) {
+        return currentProtocolThread()->prepareCardOperation(wrapper.card);
+    }
+
+    try {
+        return currentProtocolThread()->prepareDetachedCardOperation(type, wrapper.snapshot.ident.data());
+    } catch (...) {
+        return false;
+    }
+}
+
+template <typename Func>
+static CKTapInterfaceErrorCode startCardOperation(const Func& func) noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    } else if (currentProtocolThread()->getState() != CKTapThreadState::awaitingCardOperation) {
+        return CKTapInterfaceErrorCode::threadNotAwaitingCardOperation;
+    }
+
+    try {
+        return func(*currentProtocolThread()) ?
+            CKTapInterfaceErrorCode::success :
+            CKTapInterfaceErrorCode::invalidCardOperation;
+    } catch (...) {
+        return CKTapInterfaceErrorCode::unexpectedExceptionWhenStartingCardOperation;
+    }
+}
+
+/// Takes the response of the finished operation. The prepared card is refreshed whether or not the operation
+/// succeeded, operations change more than their response shows such as the auth delay after a wrong CVC
+template <CardOperation op>
+static Result<CardResponseType<op>> takeCardResponse() noexcept {
+    using ResponseResult = Result<CardResponseType<op>>;
+    auto* protocolThread = currentProtocolThread();
+    if (protocolThread == nullptr) {
+        return ResponseResult::failure(CKTapInterfaceErrorCode::libraryNotInitialized);
+    } else if (protocolThread->isThreadActive()) {
+        return ResponseResult::failure(CKTapInterfaceErrorCode::threadAlreadyInUse);
+    }
+
+    refreshOperationCard();
+    if (protocolThread->getState() == CKTapThreadState::tapProtocolError) {
+        return ResponseResult::failure(CKTapInterfaceErrorCode::caughtTapProtocolException);
+    }
+    const auto errorCode = protocolThread->getRecentErrorCode();
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return ResponseResult::failure(errorCode);
+    }
+    return protocolThread->takeResponse<op>();
+}
+
+/// Stores a slot read from the card in its satscard's slot table
+static CKTapInterfaceErrorCode storeSlot(const int32_t satscardHandle, tap_protocol::Satscard::Slot slot) noexcept {
+    if (storeSatscardSlot(satscardHandle, std::move(slot))) {
+        return CKTapInterfaceErrorCode::success;
+    }
+    const auto wrapper = findCardWrapper<tap_protocol::Satscard>(satscardHandle);
+    return wrapper ? CKTapInterfaceErrorCode::invalidResponseFromCardOperation : wrapper.error();
+}
+
+/// Stores a slot read from the card and returns a view of the stored copy
+static Result<SlotView> storeAndViewSlot(const int32_t satscardHandle, tap_protocol::Satscard::Slot slot) noexcept {
+    const auto index = slot.index;
+    const auto errorCode = storeSlot(satscardHandle, std::move(slot));
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return Result<SlotView>::failure(errorCode);
+    }
+    return storedSlot(satscardHandle, index);
+}
+
+template <CardOperation op>
+static Result<SlotView> takeSlotResponse(const int32_t satscardHandle) noexcept {
+    auto response = takeCardResponse<op>();
+    if (!response) {
+        return Result<SlotView>::failure(response.error());
+    }
+    return storeAndViewSlot(satscardHandle, std::move(*response));
+}
+
+CKTapInterfaceErrorCode prepareCardOperation(const CKTapCardHandle handle) noexcept {
+    if (currentProtocolThread() == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    } else if (currentProtocolThread()->isThreadActive()) {
+        return CKTapInterfaceErrorCode::threadAlreadyInUse;
+    }
+
+    switch (handle.type) {
+        case CKTapCardType::satscard: {
+            const auto wrapper = findCardWrapper<tap_protocol::Satscard>(handle.index);
+            if (!wrapper || !prepareThreadForCard(**wrapper, CKTapCardType::satscard)) {
+                return CKTapInterfaceErrorCode::unknownSatscardHandle;
+            }
+            break;
+        }
+        case CKTapCardType::tapsigner: {
+            const auto wrapper = findCardWrapper<tap_protocol::Tapsigner>(handle.index);
+            if (!wrapper || !prepareThreadForCard(**wrapper, CKTapCardType::tapsigner)) {
+                return CKTapInterfaceErrorCode::unknownTapsignerHandle;
+            }
+            break;
+        }
+        default:
+            return CKTapInterfaceErrorCode::invalidCardOperation;
+    }
+
+    currentContext().operationCard = handle;
+    return CKTapInterfaceErrorCode::success;
+}
+
+CKTapInterfaceErrorCode beginWait() noexcept {
+    return startCardOperation([](TapProtocolThread& thread) { return thread.beginCKTapCard_Wait(); });
+}
+
+CKTapInterfaceErrorCode beginCertificateCheck() noexcept {
+    return startCardOperation([](TapProtocolThread& thread) { return thread.beginSatscard_CertificateCheck(); });
+}
+
+CKTapInterfaceErrorCode beginGetSlot(const int32_t slot, const char* cvc) noexcept {
+    return startCardOperation([=](TapProtocolThread& thread) { return thread.beginSatscard_GetSlot(slot, cvc); });
+}
+
+CKTapInterfaceErrorCode beginListSlots(const char* cvc, const int32_t limit) noexcept {
+    return startCardOperation([=](TapProtocolThread& thread) { return thread.beginSatscard_ListSlots(cvc, limit); });
+}
+
+CKTapInterfaceErrorCode beginNewSlot(const char* chainCode, const char* cvc) noexcept {
+    return startCardOperation([=](TapProtocolThread& thread) { return thread.beginSatscard_New(chainCode, cvc); });
+}
+
+CKTapInterfaceErrorCode beginUnseal(const char* cvc) noexcept {
+    return startCardOperation([=](TapProtocolThread& thread) { return thread.beginSatscard_Unseal(cvc); });
+}
+
+Result<WaitResult> waitResult() noexcept {
+    const auto response = takeCardResponse<CardOperation::CKTapCard_Wait>();
+    if (!response) {
+        return Result<WaitResult>::failure(response.error());
+    }
+    return Result<WaitResult>{ WaitResult{ response->success, static_cast<int32_t>(response->auth_delay) } };
+}
+
+Result<bool> certificateCheckResult() noexcept {
+    return takeCardResponse<CardOperation::Satscard_CertificateCheck>();
+}
+
+Result<SlotView> getSlotResult(const int32_t satscardHandle) noexcept {
+    return takeSlotResponse<CardOperation::Satscard_GetSlot>(satscardHandle);
+}
+
+Result<SlotList> listSlotsResult(const int32_t satscardHandle) noexcept {
+    auto response = takeCardResponse<CardOperation::Satscard_ListSlots>();
+    if (!response) {
+        return Result<SlotList>::failure(response.error());
+    }
+
+    // Every slot is stored even after one fails so that none of their private keys are left behind. They're only
+    // viewed once all are stored, as storing one can move the others
+    std::array<int32_t, maxSatscardSlots> indices{ };
+    size_t storedCount{ 0 };
+    auto errorCode = CKTapInterfaceErrorCode::success;
+    for (auto& slot : *response) {
+        const auto index = slot.index;
+        const auto storeError = storeSlot(satscardHandle, std::move(slot));
+        if (storeError != CKTapInterfaceErrorCode::success) {
+            errorCode = storeError;
+        } else if (storedCount < indices.size()) {
+            indices[storedCount++] = index;
+        }
+    }
+
+    SlotList list{ };
+    for (size_t i{ 0 }; i < storedCount && errorCode == CKTapInterfaceErrorCode::success; ++i) {
+        auto stored = storedSlot(satscardHandle, indices[i]);
+        if (!stored) {
+            errorCode = stored.error();
+        } else {
+            list.slots[list.size++] = *stored;
+        }
+    }
+
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return Result<SlotList>::failure(errorCode);
+    }
+    return Result<SlotList>{ list };
+}
+
+Result<SlotView> newSlotResult(const int32_t satscardHandle) noexcept {
+    return takeSlotResponse<CardOperation::Satscard_New>(satscardHandle);
+}
+
+Result<SlotView> unsealResult(const int32_t satscardHandle) noexcept {
+    return takeSlotResponse<CardOperation::Satscard_Unseal>(satscardHandle);
+}
+
+std::optional<CKTapProtoException> tapProtocolException() noexcept {
+    CKTapProtoException exception{ };
+    if (currentProtocolThread() == nullptr || !currentProtocolThread()->getTapProtocolException(exception)) {
+        return { };
+    }
+    return exception;
+}
+
+// ----------------------------------------------
+// Session:
+
+Result<Session> Session::open() noexcept {
+    auto& context = currentContext();
+    if (context.isSessionOpen) {
+        return Result<Session>::failure(CKTapInterfaceErrorCode::threadAlreadyInUse);
+    }
+
+    const auto errorCode = initializeLibrary();
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return Result<Session>::failure(errorCode);
+    }
+
+    Session session{ };
+    session._context = &context;
+    context.isSessionOpen = true;
+    return Result<Session>{ std::move(session) };
+}
+
+Session::Session(Session&& other) noexcept
+    : _context{ std::exchange(other._context, nullptr) } {
+}
+
+Session& Session::operator=(Session&& other) noexcept {
+    if (this != &other) {
+        _close();
+        _context = std::exchange(other._context, nullptr);
+    }
+    return *this;
+}
+
+Session::~Session() {
+    _close();
+}
+
+Result<CKTapCardHandle> Session::handshake(const CKTapCardType type, const TransportFunction& transport) noexcept {
+    using HandleResult = Result<CKTapCardHandle>;
+    if (_context == nullptr) {
+        return HandleResult::failure(CKTapInterfaceErrorCode::threadNotYetStarted);
+    }
+    const ContextBinding binding{ _context };
+
+    auto errorCode = newOperation();
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        errorCode = beginHandshake(type);
+    }
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        errorCode = _runTransport(transport);
+    }
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return HandleResult::failure(errorCode);
+    }
+    return endOperation();
+}
+
+CKTapInterfaceErrorCode Session::run(const CKTapCardHandle card,
+                                     const std::function<CKTapInterfaceErrorCode()>& begin,
+                                     const TransportFunction& transport) noexcept {
+    if (_context == nullptr) {
+        return CKTapInterfaceErrorCode::threadNotYetStarted;
+    }
+    const ContextBinding binding{ _context };
+
+    auto errorCode = newOperation();
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        errorCode = prepareCardOperation(card);
+    }
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        try {
+            errorCode = begin();
+        } catch (...) {
+            errorCode = CKTapInterfaceErrorCode::unexpectedExceptionWhenStartingCardOperation;
+        }
+    }
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        // Don't leave the card prepared for an operation which never started
+        cancelOperation();
+        return errorCode;
+    }
+    return _runTransport(transport);
+}
+
+CKTapInterfaceErrorCode Session::_runTransport(const TransportFunction& transport) noexcept {
+    bool hasTransportFailed{ false };
+    std::vector<uint8_t> response{ };
+    while (currentProtocolThread()->isThreadActive()) {
+        // The request stays ready until the cancel unwinds the protocol thread, which only takes a moment
+        if (hasTransportFailed) {
+            currentProtocolThread()->waitForCancellation(std::chrono::steady_clock::now() + sessionTransportWakeInterval);
+            continue;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + sessionTransportWakeInterval;
+        if (!currentProtocolThread()->waitForTransportRequest(deadline)) {
+            continue;
+        }
+        const auto request = transportRequest();
+        if (!request.has_value()) {
+            continue;
+        }
+
+        response.clear();
+        bool isDelivered{ false };
+        try {
+            if (transport(*request, response)) {
+                auto* buffer = allocateTransportResponse(response.size());
+                if (buffer != nullptr) {
+                    std::memcpy(buffer, response.data(), response.size());
+                    isDelivered = finalizeTransportResponse() == CKTapInterfaceErrorCode::success;
+                }
+            }
+        } catch (...) { }
+
+        if (!isDelivered) {
+            hasTransportFailed = true;
+            currentProtocolThread()->requestCancel();
+        }
+    }
+    return finalizeOperation();
+}
+
+void Session::_close() noexcept {
+    if (_context == nullptr) {
+        return;
+    }
+
+    const ContextBinding binding{ _context };
+    if (isOperationActive()) {
+        cancelOperation();
+        waitForCancellation(std::chrono::steady_clock::now() + cancellationUnwindTimeout);
+        finalizeOperation();
+    }
+    _context->isSessionOpen = false;
+    _context = nullptr;
+}
+
+// ----------------------------------------------
+// Registry:
+
+size_t satscardCount() noexcept {
+    return currentContext().satscards.size();
+}
+
+size_t tapsignerCount() noexcept {
+    return currentContext().tapsigners.size();
+}
+
+Result<CardInfo> cardInfo(const CKTapCardHandle handle) noexcept {
+    CardInfo info{ };
+    info.handle = handle;
+    if (handle.type == CKTapCardType::satscard) {
+        const auto wrapper = findCardWrapper<tap_protocol::Satscard>(handle.index);
+        if (!wrapper) {
+            return Result<CardInfo>::failure(wrapper.error());
+        }
+        info.snapshot = (*wrapper)->snapshot;
+    } else if (handle.type == CKTapCardType::tapsigner) {
+        const auto wrapper = findCardWrapper<tap_protocol::Tapsigner>(handle.index);
+        if (!wrapper) {
+            return Result<CardInfo>::failure(wrapper.error());
+        }
+        info.snapshot = (*wrapper)->snapshot;
+        info.derivationPath = (*wrapper)->derivationPath;
+    } else {
+        return Result<CardInfo>::failure(CKTapInterfaceErrorCode::invalidCardOperation);
+    }
+    return Result<CardInfo>{ info };
+}
+
+Result<SlotView> storedSlot(const int32_t satscardHandle, const int32_t index) noexcept {
+    const auto wrapper = findCardWrapper<tap_protocol::Satscard>(satscardHandle);
+    if (!wrapper) {
+        return Result<SlotView>::failure(wrapper.error());
+    }
+
+    const auto& slots = (*wrapper)->slots;
+    if (!slots.contains(index)) {
+        return Result<SlotView>::failure(CKTapInterfaceErrorCode::unknownSlotForGivenSatscardHandle);
+    }
+
+    SlotView slot{ };
+    slot.index = index;
+    slot.status = slots.status(index);
+    slot.address = slots.address(index);
+    slot.publicKey = ByteSpan{ slots.publicKey(index), slots.publicKeyLength(index) };
+    slot.masterPublicKey = ByteSpan{ slots.masterPublicKey(index), slots.masterPublicKeyLength(index) };
+    slot.chainCode = ByteSpan{ slots.chainCode(index), slots.chainCodeLength(index) };
+    return Result<SlotView>{ slot };
+}
+
+Result<SecretString> slotWif(const int32_t satscardHandle, const int32_t index) noexcept {
+    const auto wrapper = findCardWrapper<tap_protocol::Satscard>(satscardHandle);
+    if (!wrapper) {
+        return Result<SecretString>::failure(wrapper.error());
+    }
+
+    const auto& slots = (*wrapper)->slots;
+    if (!slots.contains(index)) {
+        return Result<SecretString>::failure(CKTapInterfaceErrorCode::unknownSlotForGivenSatscardHandle);
+    }
+
+    SecretString wif{ };
+    try {
+        wif._length = slots.writeWif(index, wif._buffer, sizeof(wif._buffer));
+    } catch (...) { }
+    if (wif.empty()) {
+        return Result<SecretString>::failure(CKTapInterfaceErrorCode::operationFailed);
+    }
+    return Result<SecretString>{ std::move(wif) };
+}
+
+Result<SlotView> activeSlot(const int32_t satscardHandle) noexcept {
+    const auto wrapper = findCardWrapper<tap_protocol::Satscard>(satscardHandle);
+    if (!wrapper) {
+        return Result<SlotView>::failure(wrapper.error());
+    }
+
+    // Reading the active slot doesn't count as a change, so it's stored without marking the card as changed
+    if ((*wrapper)->card) {
+        try {
+            auto slot = (*wrapper)->card->GetActiveSlot();
+            const auto isStored = (*wrapper)->slots.store(slot);
+            secureZero(slot.privkey.data(), slot.privkey.size());
+            if (!isStored) {
+                return Result<SlotView>::failure(CKTapInterfaceErrorCode::invalidResponseFromCardOperation);
+            }
+            return storedSlot(satscardHandle, slot.index);
+        } catch (...) {
+            return Result<SlotView>::failure(CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction);
+        }
+    }
+    return storedSlot(satscardHandle, (*wrapper)->snapshot.activeSlotIndex);
+}
+
+} // namespace cktap
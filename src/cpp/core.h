@@ -0,0 +1,235 @@
+#ifndef __CKTAP_PROTOCOL__CORE_H__
+#define __CKTAP_PROTOCOL__CORE_H__
+
+// Project
+#include <enums.h>
+#include <internal/card_snapshot.h>
+#include <internal/result.h>
+#include <internal/slot_table.h>
+#include <structs.h>
+
+// STL
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/// The typed C++ API of the library, built into the cktap_protocol_core static library. Native consumers call it
+/// directly and exports.cpp adapts it to the C structs Dart needs. Everything below acts on the context bound to
+/// the calling thread, see [ContextBinding], and a context must only be used from one thread at a time
+namespace cktap {
+
+/// A read-only view of bytes, valid for as long as whatever it was taken from is unchanged
+class ByteSpan {
+public:
+
+    constexpr ByteSpan() noexcept = default;
+    constexpr ByteSpan(const uint8_t* data, const size_t size) noexcept : _data{ data }, _size{ size } { }
+
+    constexpr const uint8_t* data() const noexcept { return _data; }
+    constexpr size_t size() const noexcept { return _size; }
+    constexpr bool empty() const noexcept { return _size == 0; }
+    constexpr const uint8_t* begin() const noexcept { return _data; }
+    constexpr const uint8_t* end() const noexcept { return _data + _size; }
+    constexpr uint8_t operator[](const size_t index) const noexcept { return _data[index]; }
+
+private:
+
+    const uint8_t* _data{ nullptr };
+    size_t _size{ 0 };
+};
+
+/// A secret such as a WIF, held inline and zeroed when it's destroyed or moved from. It can't be copied
+class SecretString {
+public:
+
+    SecretString() noexcept = default;
+    SecretString(const SecretString&) = delete;
+    SecretString& operator=(const SecretString&) = delete;
+    SecretString(SecretString&& other) noexcept;
+    SecretString& operator=(SecretString&& other) noexcept;
+    ~SecretString();
+
+    const char* c_str() const noexcept { return _buffer; }
+    std::string_view view() const noexcept { return { _buffer, _length }; }
+    size_t size() const noexcept { return _length; }
+    bool empty() const noexcept { return _length == 0; }
+
+private:
+
+    friend Result<SecretString> slotWif(int32_t satscardHandle, int32_t index) noexcept;
+
+    void _clear() noexcept;
+
+    char _buffer[maxWifBufferSize]{ };
+    size_t _length{ 0 };
+};
+
+/// A copy of a registered card's snapshot, taking one never allocates
+struct CardInfo {
+    CKTapCardHandle handle{ -1, CKTapCardType::unknownCard };
+    CardSnapshot snapshot{ };
+    /// Only set for tapsigners, valid until the card is next updated. Views the whole stored path so it stays null
+    /// terminated
+    std::string_view derivationPath{ };
+
+    std::string_view ident() const noexcept { return snapshot.ident.data(); }
+    std::string_view appletVersion() const noexcept { return snapshot.appletVersion.data(); }
+};
+
+/// A slot stored in the registry. The views are valid until the satscard is next updated, the private key is
+/// deliberately left out, see [slotWif]
+struct SlotView {
+    int32_t index{ 0 };
+    CKTapSatscardSlotStatus status{ CKTapSatscardSlotStatus::UNUSED };
+    std::string_view address{ };
+    ByteSpan publicKey{ };
+    ByteSpan masterPublicKey{ };
+    ByteSpan chainCode{ };
+};
+
+/// Up to a satscard's worth of stored slots, taking one never allocates
+struct SlotList {
+    std::array<SlotView, maxSatscardSlots> slots{ };
+    size_t size{ 0 };
+
+    const SlotView* begin() const noexcept { return slots.data(); }
+    const SlotView* end() const noexcept { return slots.data() + size; }
+};
+
+/// The response to a wait, see [waitResult]
+struct WaitResult {
+    bool success{ false };
+    int32_t authDelay{ 0 };
+};
+
+// ----------------------------------------------
+// Contexts, each owns a protocol thread, a card registry and a pipeline. Threads which haven't bound one use the
+// process's default context
+
+/// A new context with its protocol thread already started, null if either couldn't be allocated
+CKTapContext* createContext() noexcept;
+/// Cancels anything the context is running and frees it. It mustn't be bound or have a [Session] open
+void destroyContext(CKTapContext* context) noexcept;
+
+/// Binds a context to the calling thread for as long as it's alive, restoring the previous one afterwards. Binding
+/// null selects the default context
+class ContextBinding {
+public:
+
+    explicit ContextBinding(CKTapContext* context) noexcept;
+    ContextBinding(const ContextBinding&) = delete;
+    ContextBinding& operator=(const ContextBinding&) = delete;
+    ~ContextBinding();
+
+private:
+
+    CKTapContext* _previous{ nullptr };
+};
+
+/// Starts the protocol thread of the bound context, [createContext] already does so for the contexts it returns
+CKTapInterfaceErrorCode initializeLibrary() noexcept;
+
+// ----------------------------------------------
+// Operations, the steps a host takes to drive the protocol thread. [Session] runs them for native hosts
+
+CKTapInterfaceErrorCode newOperation() noexcept;
+CKTapInterfaceErrorCode beginHandshake(int32_t cardType) noexcept;
+/// The request waiting to be sent to the card, if there is one. It's valid until the response is finalized
+std::optional<ByteSpan> transportRequest() noexcept;
+/// Where the host writes the card's reply before calling [finalizeTransportResponse], null on failure
+uint8_t* allocateTransportResponse(size_t size) noexcept;
+CKTapInterfaceErrorCode finalizeTransportResponse() noexcept;
+/// Blocks until a transport request is ready, the operation stops or [deadline] passes. Returns whether a request
+/// is ready
+bool waitForTransportRequest(std::chrono::steady_clock::time_point deadline) noexcept;
+bool isOperationActive() noexcept;
+/// Asks the running operation to stop without waiting for it to, returning operationStillInProgress while it's
+/// unwinding. A prepared operation which never started is withdrawn straight away. The operation still has to be
+/// finalized
+CKTapInterfaceErrorCode cancelOperation() noexcept;
+/// Blocks until a cancelled operation has unwound or [deadline] passes, for native hosts which can afford to wait.
+/// Returns whether the thread is free for the next operation
+bool waitForCancellation(std::chrono::steady_clock::time_point deadline) noexcept;
+/// Waits for the operation's result once the thread has stopped
+CKTapInterfaceErrorCode finalizeOperation() noexcept;
+/// Registers the card produced by a finished handshake
+Result<CKTapCardHandle> endOperation() noexcept;
+
+/// Sends [request] to the card and writes its reply into [response]. Returning false cancels the operation
+using TransportFunction = std::function<bool(ByteSpan request, std::vector<uint8_t>& response)>;
+
+/// Runs operations to completion on the caller's thread with a native transport, in the context bound when it was
+/// opened. Only one session can be open per context since they share its protocol thread, closing it cancels
+/// anything still running
+class Session {
+public:
+
+    static Result<Session> open() noexcept;
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+    Session(Session&& other) noexcept;
+    Session& operator=(Session&& other) noexcept;
+    ~Session();
+
+    Result<CKTapCardHandle> handshake(CKTapCardType type, const TransportFunction& transport) noexcept;
+    /// Prepares [card] then runs the card operation which [begin] starts, such as [beginUnseal]. The result is
+    /// collected afterwards with the matching function, such as [unsealResult], in the session's context
+    CKTapInterfaceErrorCode run(CKTapCardHandle card, const std::function<CKTapInterfaceErrorCode()>& begin,
+                                const TransportFunction& transport) noexcept;
+
+private:
+
+    Session() noexcept = default;
+
+    CKTapInterfaceErrorCode _runTransport(const TransportFunction& transport) noexcept;
+    void _close() noexcept;
+
+    CKTapContext* _context{ nullptr };
+};
+
+// ----------------------------------------------
+// Card operations. One is run by preparing a registered card, beginning the operation, driving it like a handshake
+// until [finalizeOperation] and then collecting its result once. Results holding slots store them in the registry
+// and return views of the stored copies, so private keys are only reachable through [slotWif]
+
+/// Points the protocol thread at a registered card for the next operation. A detached card is reattached with a
+/// handshake at the start of the operation
+CKTapInterfaceErrorCode prepareCardOperation(CKTapCardHandle handle) noexcept;
+CKTapInterfaceErrorCode beginWait() noexcept;
+CKTapInterfaceErrorCode beginCertificateCheck() noexcept;
+CKTapInterfaceErrorCode beginGetSlot(int32_t slot, const char* cvc) noexcept;
+CKTapInterfaceErrorCode beginListSlots(const char* cvc, int32_t limit) noexcept;
+CKTapInterfaceErrorCode beginNewSlot(const char* chainCode, const char* cvc) noexcept;
+CKTapInterfaceErrorCode beginUnseal(const char* cvc) noexcept;
+
+Result<WaitResult> waitResult() noexcept;
+/// Whether the satscard's certificates were verified
+Result<bool> certificateCheckResult() noexcept;
+Result<SlotView> getSlotResult(int32_t satscardHandle) noexcept;
+Result<SlotList> listSlotsResult(int32_t satscardHandle) noexcept;
+Result<SlotView> newSlotResult(int32_t satscardHandle) noexcept;
+Result<SlotView> unsealResult(int32_t satscardHandle) noexcept;
+/// The exception behind an operation which failed with caughtTapProtocolException. Its message is allocated and must
+/// be freed with Utility_freeCKTapProtoException
+std::optional<CKTapProtoException> tapProtocolException() noexcept;
+
+// ----------------------------------------------
+// Registry
+
+size_t satscardCount() noexcept;
+size_t tapsignerCount() noexcept;
+Result<CardInfo> cardInfo(CKTapCardHandle handle) noexcept;
+Result<SlotView> storedSlot(int32_t satscardHandle, int32_t index) noexcept;
+Result<SecretString> slotWif(int32_t satscardHandle, int32_t index) noexcept;
+/// The satscard's active slot, read from the live card when it's attached so the stored copy is refreshed first
+Result<SlotView> activeSlot(int32_t satscardHandle) noexcept;
+
+} // namespace cktap
+
+#endif // __CKTAP_PROTOCOL__CORE_H__
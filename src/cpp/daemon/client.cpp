@@ -0,0 +1,190 @@
+#include <daemon/client.h>
+
+// libc
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// STL
+#include <cstring>
+#include <utility>
+
+/// Handshakes wait on the card, so replies may take as long as a slow tap
+constexpr int daemonReplyTimeoutMs = 10000;
+
+Result<DaemonClient> DaemonClient::connect(const std::string& socketPath) noexcept {
+    sockaddr_un address{ };
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        return Result<DaemonClient>::failure(CKTapInterfaceErrorCode::daemonConnectionFailed);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return Result<DaemonClient>::failure(CKTapInterfaceErrorCode::daemonConnectionFailed);
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return Result<DaemonClient>::failure(CKTapInterfaceErrorCode::daemonConnectionFailed);
+    }
+
+    configureSocket(fd, daemonReplyTimeoutMs);
+    return Result<DaemonClient>{ DaemonClient{ fd } };
+}
+
+DaemonClient::DaemonClient(DaemonClient&& other) noexcept
+    : _socket{ std::exchange(other._socket, -1) } {
+}
+
+DaemonClient& DaemonClient::operator=(DaemonClient&& other) noexcept {
+    if (this != &other) {
+        _close();
+        _socket = std::exchange(other._socket, -1);
+    }
+    return *this;
+}
+
+DaemonClient::~DaemonClient() {
+    _close();
+}
+
+void DaemonClient::_close() noexcept {
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+}
+
+CKTapInterfaceErrorCode DaemonClient::ping() noexcept {
+    DaemonReplyHeader reply{ };
+    return _request(DaemonMessageType::ping, 0, nullptr, 0, reply);
+}
+
+Result<DaemonRecords<DaemonCardRecord>> DaemonClient::listCards() noexcept {
+    return _requestRecords<DaemonCardRecord>(DaemonMessageType::listCards, 0);
+}
+
+Result<DaemonRecords<DaemonSlotRecord>> DaemonClient::listSlots(const int32_t satscardHandle) noexcept {
+    return _requestRecords<DaemonSlotRecord>(DaemonMessageType::listSlots, satscardHandle);
+}
+
+Result<CKTapCardHandle> DaemonClient::handshake(const CKTapCardType type, const cktap::TransportFunction& transport) noexcept {
+    using HandleResult = Result<CKTapCardHandle>;
+
+    DaemonReplyHeader reply{ };
+    std::vector<uint8_t> request{ };
+    auto errorCode = _request(DaemonMessageType::beginHandshake, type, nullptr, 0, reply, &request);
+
+    std::vector<uint8_t> response{ };
+    while (errorCode == CKTapInterfaceErrorCode::success && (reply.flags & DaemonReplyFlags::awaitingTransportResponse) != 0) {
+        response.clear();
+        bool isDelivered{ false };
+        try {
+            isDelivered = transport(cktap::ByteSpan{ request.data(), request.size() }, response);
+        } catch (...) { }
+
+        if (!isDelivered) {
+            _request(DaemonMessageType::cancelOperation, 0, nullptr, 0, reply);
+            return HandleResult::failure(CKTapInterfaceErrorCode::operationCanceled);
+        }
+        errorCode = _request(DaemonMessageType::transportResponse, 0, response.data(), response.size(), reply, &request);
+    }
+
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return HandleResult::failure(errorCode);
+    }
+    return HandleResult{ reply.handle };
+}
+
+CKTapInterfaceErrorCode DaemonClient::startReaders(const CKTapCardType type) noexcept {
+    DaemonReplyHeader reply{ };
+    return _request(DaemonMessageType::startReaders, type, nullptr, 0, reply);
+}
+
+CKTapInterfaceErrorCode DaemonClient::stopReaders() noexcept {
+    DaemonReplyHeader reply{ };
+    return _request(DaemonMessageType::stopReaders, 0, nullptr, 0, reply);
+}
+
+Result<uint32_t> DaemonClient::pollReaders(const bool wait) noexcept {
+    DaemonReplyHeader reply{ };
+    const auto errorCode = _request(DaemonMessageType::pollReaders, wait ? 1 : 0, nullptr, 0, reply);
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return Result<uint32_t>::failure(errorCode);
+    }
+    return Result<uint32_t>{ reply.count };
+}
+
+CKTapInterfaceErrorCode DaemonClient::_request(const DaemonMessageType type, const int32_t argument, const uint8_t* data, const size_t length, DaemonReplyHeader& reply, std::vector<uint8_t>* payload, int* sharedFd) noexcept {
+    if (_socket < 0 || length > maxDaemonPayloadSize) {
+        return CKTapInterfaceErrorCode::daemonConnectionFailed;
+    }
+
+    DaemonRequestHeader request{ };
+    request.type = type;
+    request.argument = argument;
+    request.length = static_cast<uint32_t>(length);
+    if (!sendDaemonMessage(_socket, &request, sizeof(request), data, length)) {
+        _close();
+        return CKTapInterfaceErrorCode::daemonConnectionFailed;
+    }
+
+    int receivedFd{ -1 };
+    if (!receiveExact(_socket, &reply, sizeof(reply), &receivedFd)) {
+        _close();
+        return CKTapInterfaceErrorCode::daemonConnectionFailed;
+    }
+    if (sharedFd != nullptr) {
+        *sharedFd = receivedFd;
+    } else if (receivedFd >= 0) {
+        close(receivedFd);
+    }
+
+    // Anything out of step with the protocol leaves the stream unreadable, so the connection is dropped
+    if (reply.magic != daemonMagic || reply.type != type || reply.length > maxDaemonPayloadSize) {
+        _close();
+        return CKTapInterfaceErrorCode::daemonProtocolError;
+    }
+
+    try {
+        std::vector<uint8_t> discarded{ };
+        auto& output = payload != nullptr ? *payload : discarded;
+        output.resize(reply.length);
+        if (reply.length > 0 && !receiveExact(_socket, output.data(), output.size())) {
+            _close();
+            return CKTapInterfaceErrorCode::daemonConnectionFailed;
+        }
+    } catch (...) {
+        _close();
+        return CKTapInterfaceErrorCode::daemonConnectionFailed;
+    }
+    return reply.errorCode;
+}
+
+template <typename Record>
+Result<DaemonRecords<Record>> DaemonClient::_requestRecords(const DaemonMessageType type, const int32_t argument) noexcept {
+    using RecordsResult = Result<DaemonRecords<Record>>;
+
+    DaemonReplyHeader reply{ };
+    int sharedFd{ -1 };
+    const auto errorCode = _request(type, argument, nullptr, 0, reply, nullptr, &sharedFd);
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        if (sharedFd >= 0) {
+            close(sharedFd);
+        }
+        return RecordsResult::failure(errorCode);
+    }
+    if ((reply.flags & DaemonReplyFlags::hasSharedBuffer) == 0 || reply.count == 0) {
+        if (sharedFd >= 0) {
+            close(sharedFd);
+        }
+        return RecordsResult{ DaemonRecords<Record>{ } };
+    }
+
+    auto buffer = SharedBuffer::map(sharedFd, reply.count * sizeof(Record));
+    if (!buffer.isValid()) {
+        return RecordsResult::failure(CKTapInterfaceErrorCode::daemonProtocolError);
+    }
+    return RecordsResult{ DaemonRecords<Record>{ std::move(buffer) } };
+}
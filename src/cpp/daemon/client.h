@@ -0,0 +1,78 @@
+#ifndef __CKTAP_PROTOCOL__DAEMON_CLIENT_H__
+#define __CKTAP_PROTOCOL__DAEMON_CLIENT_H__
+
+// Project
+#include <core.h>
+#include <daemon/protocol.h>
+#include <daemon/socket_io.h>
+#include <internal/result.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Records read straight out of the shared buffer the daemon replied with. They stay valid for as long as this
+/// object is alive, whatever the daemon does in the meantime
+template <typename Record>
+class DaemonRecords {
+public:
+
+    DaemonRecords() noexcept = default;
+    explicit DaemonRecords(SharedBuffer buffer) noexcept : _buffer{ std::move(buffer) } { }
+
+    const Record* begin() const noexcept { return reinterpret_cast<const Record*>(_buffer.data()); }
+    const Record* end() const noexcept { return begin() + size(); }
+    size_t size() const noexcept { return _buffer.size() / sizeof(Record); }
+    bool empty() const noexcept { return size() == 0; }
+    const Record& operator[](const size_t index) const noexcept { return begin()[index]; }
+
+private:
+
+    SharedBuffer _buffer{ };
+};
+
+/// A connection to the daemon. Like the library itself a client must only be used from one thread at a time,
+/// open one per thread instead
+class DaemonClient {
+public:
+
+    static Result<DaemonClient> connect(const std::string& socketPath = defaultDaemonSocketPath) noexcept;
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+    DaemonClient(DaemonClient&& other) noexcept;
+    DaemonClient& operator=(DaemonClient&& other) noexcept;
+    ~DaemonClient();
+
+    CKTapInterfaceErrorCode ping() noexcept;
+    Result<DaemonRecords<DaemonCardRecord>> listCards() noexcept;
+    Result<DaemonRecords<DaemonSlotRecord>> listSlots(int32_t satscardHandle) noexcept;
+
+    /// Runs a handshake in the daemon, relaying its requests to the card through [transport]. The card is
+    /// registered in the daemon and can be used by every client once this returns its handle
+    Result<CKTapCardHandle> handshake(CKTapCardType type, const cktap::TransportFunction& transport) noexcept;
+
+    CKTapInterfaceErrorCode startReaders(CKTapCardType type) noexcept;
+    CKTapInterfaceErrorCode stopReaders() noexcept;
+    /// Registers the cards the daemon's readers have read, returning how many there were
+    Result<uint32_t> pollReaders(bool wait) noexcept;
+
+private:
+
+    explicit DaemonClient(int socket) noexcept : _socket{ socket } { }
+
+    /// Sends a request and reads its reply into [reply], [payload] and, when one is passed, [sharedFd]
+    CKTapInterfaceErrorCode _request(DaemonMessageType type, int32_t argument, const uint8_t* data, size_t length, DaemonReplyHeader& reply, std::vector<uint8_t>* payload = nullptr, int* sharedFd = nullptr) noexcept;
+
+    template <typename Record>
+    Result<DaemonRecords<Record>> _requestRecords(DaemonMessageType type, int32_t argument) noexcept;
+
+    void _close() noexcept;
+
+    int _socket{ -1 };
+};
+
+#endif // __CKTAP_PROTOCOL__DAEMON_CLIENT_H__
@@ -0,0 +1,81 @@
+// Project
+#include <core.h>
+#include <daemon/server.h>
+#include <internal/pcsc_readers.h>
+
+// libc
+#include <signal.h>
+
+// STL
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static DaemonServer* g_daemonServer{ nullptr };
+
+static void handleStopSignal(int) {
+    if (g_daemonServer != nullptr) {
+        g_daemonServer->stop();
+    }
+}
+
+static void printUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--socket PATH] [--readers satscard|tapsigner]\n"
+        "  --socket   where to listen, defaults to %s\n"
+        "  --readers  read every card placed on a PC/SC reader, needs a CKTAP_ENABLE_PCSC build\n",
+        program, defaultDaemonSocketPath);
+}
+
+int main(int argc, char** argv) {
+    std::string socketPath{ defaultDaemonSocketPath };
+    auto readerCardType = CKTapCardType::unknownCard;
+    for (int i{ 1 }; i < argc; ++i) {
+        const auto hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--socket") == 0 && hasValue) {
+            socketPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--readers") == 0 && hasValue) {
+            const std::string type{ argv[++i] };
+            readerCardType = type == "satscard" ? CKTapCardType::satscard :
+                type == "tapsigner" ? CKTapCardType::tapsigner :
+                CKTapCardType::unknownCard;
+            if (readerCardType == CKTapCardType::unknownCard) {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (cktap::initializeLibrary() != CKTapInterfaceErrorCode::success) {
+        std::fprintf(stderr, "failed to initialize the library\n");
+        return 1;
+    }
+
+    DaemonServer server{ socketPath };
+    if (!server.listen()) {
+        std::fprintf(stderr, "unable to listen on %s, is another daemon running?\n", socketPath.c_str());
+        return 1;
+    }
+
+    if (readerCardType != CKTapCardType::unknownCard) {
+        const auto errorCode = startReaderWorkers(readerCardType);
+        if (errorCode != CKTapInterfaceErrorCode::success) {
+            std::fprintf(stderr, "unable to start the readers (error %d)\n", static_cast<int>(errorCode));
+            return 1;
+        }
+    }
+
+    g_daemonServer = &server;
+    signal(SIGINT, handleStopSignal);
+    signal(SIGTERM, handleStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    server.run();
+
+    g_daemonServer = nullptr;
+    stopReaderWorkers();
+    return 0;
+}
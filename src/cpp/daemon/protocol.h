@@ -0,0 +1,90 @@
+#ifndef __CKTAP_PROTOCOL__DAEMON_PROTOCOL_H__
+#define __CKTAP_PROTOCOL__DAEMON_PROTOCOL_H__
+
+// Project
+#include <internal/card_snapshot.h>
+#include <internal/slot_table.h>
+#include <structs.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/// The daemon's wire protocol. Both ends are built from the same sources and run on the same machine, so every
+/// message is a fixed-size header in native byte order followed by an optional inline payload. Bulk results are
+/// written to a shared memory buffer instead, its file descriptor is passed alongside the reply
+
+constexpr uint32_t daemonMagic = 0x50544B43; // "CKTP"
+/// Inline payloads only ever carry APDUs, anything bigger is a broken or hostile client
+constexpr uint32_t maxDaemonPayloadSize = 64 * 1024;
+constexpr const char* defaultDaemonSocketPath = "/tmp/cktap_protocol.sock";
+
+enum class DaemonMessageType : uint16_t {
+    ping = 1,
+    /// Replies with a shared buffer of [DaemonCardRecord], one per registered card
+    listCards,
+    /// Replies with a shared buffer of [DaemonSlotRecord] for the satscard given as the argument
+    listSlots,
+    /// Starts a handshake with the card type given as the argument. The client relays the card, every reply
+    /// either carries the next request for the card or the handle of the registered card
+    beginHandshake,
+    /// The card's reply to the last transport request, as the payload
+    transportResponse,
+    cancelOperation,
+    /// Starts the PC/SC reader workers with the card type given as the argument
+    startReaders,
+    stopReaders,
+    /// Registers the cards read by the reader workers, the argument is whether to wait for pending cards
+    pollReaders,
+};
+
+enum DaemonReplyFlags : uint16_t {
+    /// The payload is a transport request which the client must answer with [DaemonMessageType::transportResponse]
+    awaitingTransportResponse = 1,
+    /// A shared buffer of [DaemonReplyHeader::count] records was passed with the reply
+    hasSharedBuffer = 2,
+};
+
+struct DaemonRequestHeader {
+    uint32_t magic{ daemonMagic };
+    DaemonMessageType type{ DaemonMessageType::ping };
+    uint16_t reserved{ 0 };
+    int32_t argument{ 0 };
+    uint32_t length{ 0 };
+};
+
+struct DaemonReplyHeader {
+    uint32_t magic{ daemonMagic };
+    DaemonMessageType type{ DaemonMessageType::ping };
+    uint16_t flags{ 0 };
+    CKTapInterfaceErrorCode errorCode{ CKTapInterfaceErrorCode::success };
+    CKTapCardHandle handle{ -1, CKTapCardType::unknownCard };
+    /// The number of records in the shared buffer, or the number of cards registered by [pollReaders]
+    uint32_t count{ 0 };
+    uint32_t length{ 0 };
+};
+
+struct DaemonCardRecord {
+    CKTapCardHandle handle;
+    CardSnapshot snapshot;
+};
+
+struct DaemonSlotRecord {
+    int32_t index;
+    CKTapSatscardSlotStatus status;
+    char address[slotAddressCapacity];
+    uint8_t publicKey[slotPublicKeySize];
+    uint8_t publicKeyLength;
+    uint8_t masterPublicKey[slotPublicKeySize];
+    uint8_t masterPublicKeyLength;
+    uint8_t chainCode[slotChainCodeSize];
+    uint8_t chainCodeLength;
+};
+
+static_assert(std::is_trivially_copyable_v<DaemonRequestHeader>);
+static_assert(std::is_trivially_copyable_v<DaemonReplyHeader>);
+static_assert(std::is_trivially_copyable_v<DaemonCardRecord>);
+static_assert(std::is_trivially_copyable_v<DaemonSlotRecord>);
+
+#endif // __CKTAP_PROTOCOL__DAEMON_PROTOCOL_H__
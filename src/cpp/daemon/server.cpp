@@ -0,0 +1,379 @@
+#include <daemon/server.h>
+
+// Project
+#include <core.h>
+#include <daemon/socket_io.h>
+#include <internal/card_pipeline.h>
+#include <internal/pcsc_readers.h>
+
+// libc
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+/// How long a blocked client may hold up the daemon in the middle of a message
+constexpr int daemonClientTimeoutMs = 2000;
+/// How long the protocol thread may take to produce its next request before the handshake is abandoned
+constexpr auto daemonHandshakeStepTimeout = std::chrono::seconds{ 5 };
+/// How often the loop wakes to check whether it was stopped
+constexpr int daemonPollIntervalMs = 250;
+constexpr int maxPendingDaemonConnections = 16;
+
+DaemonServer::DaemonServer(std::string socketPath) noexcept
+    : _socketPath{ std::move(socketPath) } {
+}
+
+DaemonServer::~DaemonServer() {
+    _abandonHandshake();
+    for (const auto client : _clients) {
+        close(client);
+    }
+    if (_listenSocket >= 0) {
+        close(_listenSocket);
+        unlink(_socketPath.c_str());
+    }
+}
+
+bool DaemonServer::listen() noexcept {
+    sockaddr_un address{ };
+    address.sun_family = AF_UNIX;
+    if (_socketPath.empty() || _socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, _socketPath.c_str(), _socketPath.size() + 1);
+
+    _listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_listenSocket < 0) {
+        return false;
+    }
+
+    // A socket nobody is listening on was left behind by a daemon which didn't exit cleanly
+    if (connect(_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        return false;
+    }
+    close(_listenSocket);
+    unlink(_socketPath.c_str());
+
+    _listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_listenSocket < 0) {
+        return false;
+    }
+    const auto previousMask = umask(S_IRWXG | S_IRWXO);
+    const auto isBound = bind(_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    umask(previousMask);
+
+    return isBound && ::listen(_listenSocket, maxPendingDaemonConnections) == 0;
+}
+
+void DaemonServer::run() noexcept {
+    _isRunning = true;
+
+    std::vector<pollfd> sockets{ };
+    while (_isRunning) {
+        sockets.clear();
+        sockets.push_back(pollfd{ _listenSocket, POLLIN, 0 });
+        for (const auto client : _clients) {
+            sockets.push_back(pollfd{ client, POLLIN, 0 });
+        }
+
+        if (poll(sockets.data(), sockets.size(), daemonPollIntervalMs) <= 0) {
+            continue;
+        }
+
+        for (size_t i{ 1 }; i < sockets.size(); ++i) {
+            if (sockets[i].revents == 0) {
+                continue;
+            }
+            if ((sockets[i].revents & POLLIN) == 0 || !_serve(sockets[i].fd)) {
+                _disconnect(sockets[i].fd);
+            }
+        }
+        if ((sockets[0].revents & POLLIN) != 0) {
+            _accept();
+        }
+    }
+}
+
+void DaemonServer::stop() noexcept {
+    _isRunning = false;
+}
+
+void DaemonServer::_accept() noexcept {
+    const auto client = accept(_listenSocket, nullptr, nullptr);
+    if (client < 0) {
+        return;
+    }
+
+    configureSocket(client, daemonClientTimeoutMs);
+    try {
+        _clients.push_back(client);
+    } catch (...) {
+        close(client);
+    }
+}
+
+bool DaemonServer::_serve(const int socket) noexcept {
+    DaemonRequestHeader request{ };
+    if (!receiveExact(socket, &request, sizeof(request))) {
+        return false;
+    }
+    if (request.magic != daemonMagic || request.length > maxDaemonPayloadSize) {
+        _replyWithError(socket, request.type, CKTapInterfaceErrorCode::daemonProtocolError);
+        return false;
+    }
+
+    std::vector<uint8_t> payload{ };
+    try {
+        payload.resize(request.length);
+    } catch (...) {
+        return false;
+    }
+    if (request.length > 0 && !receiveExact(socket, payload.data(), payload.size())) {
+        return false;
+    }
+
+    switch (request.type) {
+        case DaemonMessageType::ping: {
+            DaemonReplyHeader reply{ };
+            reply.type = request.type;
+            return _reply(socket, reply);
+        }
+        case DaemonMessageType::listCards:
+            return _listCards(socket);
+        case DaemonMessageType::listSlots:
+            return _listSlots(socket, request.argument);
+        case DaemonMessageType::beginHandshake:
+            return _beginHandshake(socket, request.argument);
+        case DaemonMessageType::transportResponse:
+            return socket == _handshakeOwner ?
+                _transportResponse(socket, payload) :
+                _replyWithError(socket, request.type, CKTapInterfaceErrorCode::threadNotReadyForResponse);
+        case DaemonMessageType::cancelOperation:
+            return _cancelOperation(socket);
+        case DaemonMessageType::startReaders:
+            return _replyWithError(socket, request.type, startReaderWorkers(request.argument));
+        case DaemonMessageType::stopReaders:
+            return _replyWithError(socket, request.type, stopReaderWorkers());
+        case DaemonMessageType::pollReaders:
+            return _pollReaders(socket, request.argument != 0);
+    }
+    return _replyWithError(socket, request.type, CKTapInterfaceErrorCode::daemonProtocolError);
+}
+
+void DaemonServer::_disconnect(const int socket) noexcept {
+    // The card is gone with its client, the protocol thread must be free for the next one
+    if (socket == _handshakeOwner) {
+        _abandonHandshake();
+    }
+
+    _clients.erase(std::remove(_clients.begin(), _clients.end(), socket), _clients.end());
+    close(socket);
+}
+
+bool DaemonServer::_reply(const int socket, DaemonReplyHeader& header, const uint8_t* payload, const size_t length, const int sharedFd) noexcept {
+    header.magic = daemonMagic;
+    header.length = static_cast<uint32_t>(length);
+    return sendDaemonMessage(socket, &header, sizeof(header), payload, length, sharedFd);
+}
+
+bool DaemonServer::_replyWithError(const int socket, const DaemonMessageType type, const CKTapInterfaceErrorCode errorCode) noexcept {
+    DaemonReplyHeader reply{ };
+    reply.type = type;
+    reply.errorCode = errorCode;
+    return _reply(socket, reply);
+}
+
+// ----------------------------------------------
+// Registry:
+
+bool DaemonServer::_listCards(const int socket) noexcept {
+    DaemonReplyHeader reply{ };
+    reply.type = DaemonMessageType::listCards;
+
+    const auto satscards = cktap::satscardCount();
+    const auto total = satscards + cktap::tapsignerCount();
+    if (total == 0) {
+        return _reply(socket, reply);
+    }
+
+    auto buffer = SharedBuffer::create(total * sizeof(DaemonCardRecord));
+    if (!buffer.isValid()) {
+        return _replyWithError(socket, reply.type, CKTapInterfaceErrorCode::operationFailed);
+    }
+
+    auto* records = reinterpret_cast<DaemonCardRecord*>(buffer.data());
+    for (size_t i{ 0 }; i < total; ++i) {
+        const auto isSatscard = i < satscards;
+        const auto index = static_cast<int32_t>(isSatscard ? i : i - satscards);
+        const auto info = cktap::cardInfo(CKTapCardHandle{ index, isSatscard ? CKTapCardType::satscard : CKTapCardType::tapsigner });
+        if (!info) {
+            return _replyWithError(socket, reply.type, info.error());
+        }
+        records[i].handle = info->handle;
+        records[i].snapshot = info->snapshot;
+    }
+
+    reply.flags = DaemonReplyFlags::hasSharedBuffer;
+    reply.count = static_cast<uint32_t>(total);
+    return _reply(socket, reply, nullptr, 0, buffer.fd());
+}
+
+bool DaemonServer::_listSlots(const int socket, const int32_t satscardHandle) noexcept {
+    DaemonReplyHeader reply{ };
+    reply.type = DaemonMessageType::listSlots;
+    reply.handle = CKTapCardHandle{ satscardHandle, CKTapCardType::satscard };
+
+    DaemonSlotRecord slots[maxSatscardSlots]{ };
+    uint32_t count{ 0 };
+    for (int32_t index{ 0 }; index < static_cast<int32_t>(maxSatscardSlots); ++index) {
+        const auto slot = cktap::storedSlot(satscardHandle, index);
+        if (!slot) {
+            if (slot.error() == CKTapInterfaceErrorCode::unknownSlotForGivenSatscardHandle) {
+                continue;
+            }
+            return _replyWithError(socket, reply.type, slot.error());
+        }
+
+        auto& record = slots[count++];
+        record.index = slot->index;
+        record.status = slot->status;
+        slot->address.copy(record.address, sizeof(record.address) - 1);
+        std::copy(slot->publicKey.begin(), slot->publicKey.end(), record.publicKey);
+        record.publicKeyLength = static_cast<uint8_t>(slot->publicKey.size());
+        std::copy(slot->masterPublicKey.begin(), slot->masterPublicKey.end(), record.masterPublicKey);
+        record.masterPublicKeyLength = static_cast<uint8_t>(slot->masterPublicKey.size());
+        std::copy(slot->chainCode.begin(), slot->chainCode.end(), record.chainCode);
+        record.chainCodeLength = static_cast<uint8_t>(slot->chainCode.size());
+    }
+    if (count == 0) {
+        return _reply(socket, reply);
+    }
+
+    auto buffer = SharedBuffer::create(count * sizeof(DaemonSlotRecord));
+    if (!buffer.isValid()) {
+        return _replyWithError(socket, reply.type, CKTapInterfaceErrorCode::operationFailed);
+    }
+    std::memcpy(buffer.data(), slots, buffer.size());
+
+    reply.flags = DaemonReplyFlags::hasSharedBuffer;
+    reply.count = count;
+    return _reply(socket, reply, nullptr, 0, buffer.fd());
+}
+
+bool DaemonServer::_pollReaders(const int socket, const bool wait) noexcept {
+    auto cards = pollPipelinedCards(wait);
+
+    DaemonReplyHeader reply{ };
+    reply.type = DaemonMessageType::pollReaders;
+    reply.errorCode = cards.status.errorCode;
+    reply.count = static_cast<uint32_t>(std::max(cards.length, 0));
+    freePipelinedCards(cards);
+    return _reply(socket, reply);
+}
+
+// ----------------------------------------------
+// Handshakes:
+
+bool DaemonServer::_beginHandshake(const int socket, const int32_t cardType) noexcept {
+    constexpr auto type = DaemonMessageType::beginHandshake;
+    if (_handshakeOwner >= 0) {
+        return _replyWithError(socket, type, CKTapInterfaceErrorCode::threadAlreadyInUse);
+    }
+
+    auto errorCode = cktap::newOperation();
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        errorCode = cktap::beginHandshake(cardType);
+    }
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return _replyWithError(socket, type, errorCode);
+    }
+
+    _handshakeOwner = socket;
+    return _advanceHandshake(socket, type);
+}
+
+bool DaemonServer::_transportResponse(const int socket, const std::vector<uint8_t>& response) noexcept {
+    constexpr auto type = DaemonMessageType::transportResponse;
+
+    auto* buffer = cktap::allocateTransportResponse(response.size());
+    auto errorCode = CKTapInterfaceErrorCode::threadResponseFinalizationFailed;
+    if (buffer != nullptr) {
+        std::memcpy(buffer, response.data(), response.size());
+        errorCode = cktap::finalizeTransportResponse();
+    }
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        _abandonHandshake();
+        return _replyWithError(socket, type, errorCode);
+    }
+    return _advanceHandshake(socket, type);
+}
+
+bool DaemonServer::_cancelOperation(const int socket) noexcept {
+    constexpr auto type = DaemonMessageType::cancelOperation;
+    if (socket != _handshakeOwner) {
+        return _replyWithError(socket, type, CKTapInterfaceErrorCode::threadNotYetStarted);
+    }
+
+    _abandonHandshake();
+    return _replyWithError(socket, type, CKTapInterfaceErrorCode::operationCanceled);
+}
+
+bool DaemonServer::_advanceHandshake(const int socket, const DaemonMessageType type) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + daemonHandshakeStepTimeout;
+    while (cktap::isOperationActive()) {
+        if (cktap::waitForTransportRequest(deadline)) {
+            const auto request = cktap::transportRequest();
+            if (!request.has_value()) {
+                continue;
+            }
+
+            DaemonReplyHeader reply{ };
+            reply.type = type;
+            reply.flags = DaemonReplyFlags::awaitingTransportResponse;
+            return _reply(socket, reply, request->data(), request->size());
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            _abandonHandshake();
+            return _replyWithError(socket, type, CKTapInterfaceErrorCode::timeoutDuringTransport);
+        }
+    }
+
+    _handshakeOwner = -1;
+    const auto errorCode = cktap::finalizeOperation();
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return _replyWithError(socket, type, errorCode);
+    }
+
+    const auto handle = cktap::endOperation();
+    if (!handle) {
+        return _replyWithError(socket, type, handle.error());
+    }
+
+    DaemonReplyHeader reply{ };
+    reply.type = type;
+    reply.handle = *handle;
+    return _reply(socket, reply);
+}
+
+void DaemonServer::_abandonHandshake() noexcept {
+    if (_handshakeOwner < 0) {
+        return;
+    }
+
+    // Doesn't wait for the cancel to unwind, which would hold up every other client. One starting the next
+    // handshake before then gets operationStillInProgress
+    _handshakeOwner = -1;
+    if (cktap::isOperationActive()) {
+        cktap::cancelOperation();
+    }
+    cktap::finalizeOperation();
+}
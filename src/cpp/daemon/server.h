@@ -0,0 +1,62 @@
+#ifndef __CKTAP_PROTOCOL__DAEMON_SERVER_H__
+#define __CKTAP_PROTOCOL__DAEMON_SERVER_H__
+
+// Project
+#include <daemon/protocol.h>
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Owns the library's protocol thread and registry on behalf of every local client. Clients are served one
+/// message at a time from a single thread, the same rule the FFI follows, so the engine needs no extra locking.
+/// Only one client can run a handshake at a time, the others get threadAlreadyInUse until it finishes
+class DaemonServer {
+public:
+
+    explicit DaemonServer(std::string socketPath) noexcept;
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+    ~DaemonServer();
+
+    /// Binds the socket, replacing a stale one left by a previous run. The socket is only accessible to the user
+    /// running the daemon
+    bool listen() noexcept;
+
+    /// Serves clients until [stop] is called
+    void run() noexcept;
+
+    /// Safe to call from a signal handler
+    void stop() noexcept;
+
+private:
+
+    void _accept() noexcept;
+    /// Reads and answers one message, returns false when the client should be dropped
+    bool _serve(int socket) noexcept;
+    void _disconnect(int socket) noexcept;
+
+    bool _reply(int socket, DaemonReplyHeader& header, const uint8_t* payload = nullptr, size_t length = 0, int sharedFd = -1) noexcept;
+    bool _replyWithError(int socket, DaemonMessageType type, CKTapInterfaceErrorCode errorCode) noexcept;
+
+    bool _listCards(int socket) noexcept;
+    bool _listSlots(int socket, int32_t satscardHandle) noexcept;
+    bool _beginHandshake(int socket, int32_t cardType) noexcept;
+    bool _transportResponse(int socket, const std::vector<uint8_t>& response) noexcept;
+    bool _cancelOperation(int socket) noexcept;
+    bool _pollReaders(int socket, bool wait) noexcept;
+    /// Runs the handshake until it needs the card again or finishes, then tells its client which happened
+    bool _advanceHandshake(int socket, DaemonMessageType type) noexcept;
+    void _abandonHandshake() noexcept;
+
+    std::string _socketPath;
+    int _listenSocket{ -1 };
+    std::atomic<bool> _isRunning{ false };
+    std::vector<int> _clients{ };
+    /// The client running the current handshake, -1 when there isn't one
+    int _handshakeOwner{ -1 };
+};
+
+#endif // __CKTAP_PROTOCOL__DAEMON_SERVER_H__
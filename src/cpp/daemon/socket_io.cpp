@@ -0,0 +1,209 @@
+#include <daemon/socket_io.h>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// STL
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(MSG_NOSIGNAL)
+constexpr int daemonSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int daemonSendFlags = 0;
+#endif
+
+/// Opens an anonymous file which only exists for as long as a descriptor refers to it
+static int openAnonymousFile() noexcept {
+#if defined(__linux__)
+    return memfd_create("cktap_protocol", MFD_CLOEXEC);
+#else
+    static std::atomic<uint32_t> nextName{ 0 };
+    const auto name = "/cktap_protocol." + std::to_string(getpid()) + "." + std::to_string(nextName++);
+    const auto fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd >= 0) {
+        shm_unlink(name.c_str());
+    }
+    return fd;
+#endif
+}
+
+// ----------------------------------------------
+// SharedBuffer:
+
+SharedBuffer SharedBuffer::create(const size_t size) noexcept {
+    SharedBuffer buffer{ };
+    if (size == 0) {
+        return buffer;
+    }
+
+    buffer._fd = openAnonymousFile();
+    if (buffer._fd < 0 || ftruncate(buffer._fd, static_cast<off_t>(size)) != 0) {
+        return SharedBuffer{ };
+    }
+
+    auto* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, buffer._fd, 0);
+    if (data == MAP_FAILED) {
+        return SharedBuffer{ };
+    }
+    buffer._data = static_cast<uint8_t*>(data);
+    buffer._size = size;
+    return buffer;
+}
+
+SharedBuffer SharedBuffer::map(const int fd, const size_t size) noexcept {
+    SharedBuffer buffer{ };
+    buffer._fd = fd;
+
+    // Mapping past the end of the file would fault on the first read of the missing pages
+    struct stat info{ };
+    if (fd < 0 || size == 0 || fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < size) {
+        return buffer;
+    }
+
+    auto* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+        buffer._data = static_cast<uint8_t*>(data);
+        buffer._size = size;
+    }
+    return buffer;
+}
+
+SharedBuffer::SharedBuffer(SharedBuffer&& other) noexcept
+    : _fd{ std::exchange(other._fd, -1) },
+      _data{ std::exchange(other._data, nullptr) },
+      _size{ std::exchange(other._size, 0) } {
+}
+
+SharedBuffer& SharedBuffer::operator=(SharedBuffer&& other) noexcept {
+    if (this != &other) {
+        _release();
+        _fd = std::exchange(other._fd, -1);
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+SharedBuffer::~SharedBuffer() {
+    _release();
+}
+
+void SharedBuffer::_release() noexcept {
+    if (_data != nullptr) {
+        munmap(_data, _size);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+    _fd = -1;
+    _data = nullptr;
+    _size = 0;
+}
+
+// ----------------------------------------------
+// Messages:
+
+bool sendDaemonMessage(const int socket, const void* header, const size_t headerSize, const uint8_t* payload, const size_t length, const int sharedFd) noexcept {
+    iovec parts[2]{ };
+    parts[0].iov_base = const_cast<void*>(header);
+    parts[0].iov_len = headerSize;
+    parts[1].iov_base = const_cast<uint8_t*>(payload);
+    parts[1].iov_len = payload != nullptr ? length : 0;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{ };
+    msghdr message{ };
+    message.msg_iov = parts;
+    message.msg_iovlen = parts[1].iov_len > 0 ? 2 : 1;
+    if (sharedFd >= 0) {
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        auto* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &sharedFd, sizeof(int));
+    }
+
+    while (message.msg_iovlen > 0) {
+        const auto sent = sendmsg(socket, &message, daemonSendFlags);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // The descriptor went out with the first bytes, a partial write only needs the remaining data
+        message.msg_control = nullptr;
+        message.msg_controllen = 0;
+        auto remaining = static_cast<size_t>(sent);
+        while (message.msg_iovlen > 0 && remaining >= message.msg_iov->iov_len) {
+            remaining -= message.msg_iov->iov_len;
+            ++message.msg_iov;
+            --message.msg_iovlen;
+        }
+        if (message.msg_iovlen > 0) {
+            message.msg_iov->iov_base = static_cast<uint8_t*>(message.msg_iov->iov_base) + remaining;
+            message.msg_iov->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+bool receiveExact(const int socket, void* data, const size_t size, int* receivedFd) noexcept {
+    auto* output = static_cast<uint8_t*>(data);
+    size_t received{ 0 };
+    while (received < size) {
+        iovec part{ output + received, size - received };
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{ };
+        msghdr message{ };
+        message.msg_iov = &part;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        const auto count = recvmsg(socket, &message, 0);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+
+        for (auto* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+            int fd;
+            std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+            if (receivedFd != nullptr && *receivedFd < 0) {
+                *receivedFd = fd;
+            } else {
+                close(fd);
+            }
+        }
+        received += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+void configureSocket(const int socket, const int timeoutMs) noexcept {
+    timeval timeout{ };
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#if defined(SO_NOSIGPIPE)
+    const int isEnabled{ 1 };
+    setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &isEnabled, sizeof(isEnabled));
+#endif
+}
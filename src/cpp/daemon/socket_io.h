@@ -0,0 +1,51 @@
+#ifndef __CKTAP_PROTOCOL__DAEMON_SOCKET_IO_H__
+#define __CKTAP_PROTOCOL__DAEMON_SOCKET_IO_H__
+
+// STL
+#include <cstddef>
+#include <cstdint>
+
+/// A read-write shared memory mapping backed by an anonymous file. The daemon fills one with a bulk result and
+/// passes its file descriptor to the client, which maps it read-only. Nothing is left behind in the filesystem
+class SharedBuffer {
+public:
+
+    /// Creates a buffer of [size] bytes, the result is invalid on failure
+    static SharedBuffer create(size_t size) noexcept;
+    /// Takes ownership of [fd] and maps [size] bytes of it read-only
+    static SharedBuffer map(int fd, size_t size) noexcept;
+
+    SharedBuffer() noexcept = default;
+    SharedBuffer(const SharedBuffer&) = delete;
+    SharedBuffer& operator=(const SharedBuffer&) = delete;
+    SharedBuffer(SharedBuffer&& other) noexcept;
+    SharedBuffer& operator=(SharedBuffer&& other) noexcept;
+    ~SharedBuffer();
+
+    bool isValid() const noexcept { return _fd >= 0 && _data != nullptr; }
+    int fd() const noexcept { return _fd; }
+    uint8_t* data() const noexcept { return _data; }
+    size_t size() const noexcept { return _size; }
+
+private:
+
+    void _release() noexcept;
+
+    int _fd{ -1 };
+    uint8_t* _data{ nullptr };
+    size_t _size{ 0 };
+};
+
+/// Sends [header] and [payload] as one message, passing [sharedFd] along with it when it isn't negative.
+/// Retries on partial writes and EINTR
+bool sendDaemonMessage(int socket, const void* header, size_t headerSize, const uint8_t* payload, size_t length, int sharedFd = -1) noexcept;
+
+/// Reads exactly [size] bytes. A file descriptor passed with them is stored in [receivedFd], which must start out
+/// negative, any other is closed. Fails on EOF, errors and timeouts
+bool receiveExact(int socket, void* data, size_t size, int* receivedFd = nullptr) noexcept;
+
+/// Fails the socket's blocking reads and writes after [timeoutMs] so a stalled peer can't hang the other end, and
+/// stops writes to a closed peer raising SIGPIPE where the platform allows it
+void configureSocket(int socket, int timeoutMs) noexcept;
+
+#endif // __CKTAP_PROTOCOL__DAEMON_SOCKET_IO_H__
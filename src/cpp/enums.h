@@ -7,6 +7,19 @@
 // libc
 #include <stdint.h>
 
+/// @brief Bit flags describing what changed on a card, see Core_getChangedCardsSince
+FFI_TYPE_EXPORT typedef enum CKTapCardChange {
+    cardAdded = 1,
+    certsCheckedChanged = 2,
+    needSetupChanged = 4,
+    authDelayChanged = 8,
+    activeSlotChanged = 16,
+    slotUsageChanged = 32,
+    slotsChanged = 64,
+    numberOfBackupsChanged = 128,
+    derivationPathChanged = 256,
+} CKTapCardChange;
+
 FFI_TYPE_EXPORT typedef enum CKTapCardType {
     unknownCard = 0,
     satscard = 1,
@@ -53,6 +66,28 @@ FFI_TYPE_EXPORT typedef enum CKTapInterfaceErrorCode {
     unknownSatscardHandle,
     unknownSlotForGivenSatscardHandle,
     unknownTapsignerHandle,
+
+    // Appended so the codes above keep their values for built bindings and the daemon
+    invalidOperationDeadline,
+    invalidBatchArguments,
+    wrongCardForOperation,
+    pipelineQueueFull,
+    pcscNotAvailable,
+    pcscReaderError,
+    sessionPoolNotSupported,
+    daemonConnectionFailed,
+    daemonProtocolError,
+    cardCacheUnreadable,
+    cardCacheUnwritable,
+    prewarmAlreadyRunning,
+    auditLogIncompatible,
+    auditLogUnavailable,
+    sessionStalled,
+    invalidWorkerSchedulingOptions,
+    workerSchedulingNotPermitted,
+    workerSchedulingNotSupported,
+    invalidAttachedCardLimit,
+    invalidContext,
 } CKTapInterfaceErrorCode;
 
 /// @brief Mirrors tap_protocol::TapProtoException
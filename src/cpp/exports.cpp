@@ -1,457 +1,779 @@
 #include <exports.h>
 
 // Project
+#include <core.h>
+#include <internal/audit_log.h>
+#include <internal/card_cache.h>
+#include <internal/card_pipeline.h>
+#include <internal/context_services.h>
 #include <internal/globals.h>
+#include <internal/metrics.h>
+#include <internal/pcsc_readers.h>
+#include <internal/prewarm.h>
+#include <internal/secure_memory.h>
+#include <internal/session_pool.h>
+#include <internal/slot_verification.h>
 #include <internal/tap_protocol_thread.h>
 #include <internal/utils.h>
+#include <internal/watchdog.h>
+#include <internal/wif_export.h>
 
 // Third party
 #include <tap_protocol/cktapcard.h>
 
 // STL
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 
 // ----------------------------------------------
 // Helpers:
 
-static CKTapInterfaceErrorCode beginCardOp(const std::function<bool ()>& func) noexcept {
-    if (g_protocolThread == nullptr) {
-        return CKTapInterfaceErrorCode::libraryNotInitialized;
-    } else if (g_protocolThread->getState() != CKTapThreadState::awaitingCardOperation) {
-        return CKTapInterfaceErrorCode::threadNotAwaitingCardOperation;
+/// Fills the status of a card operation's response, attaching the tap_protocol exception behind a failure
+static void fillOperationStatus(CKTapInterfaceStatus& status, const CKTapInterfaceErrorCode errorCode) noexcept {
+    status.errorCode = errorCode;
+    if (errorCode == CKTapInterfaceErrorCode::caughtTapProtocolException) {
+        status.exception = cktap::tapProtocolException().value_or(CKTapProtoException{ });
+    }
+}
+
+/// Fills the params of a slot stored in the registry, the private key comes from the stored copy
+static CKTapInterfaceErrorCode fillStoredSlotParams(SlotConstructorParams& params, const int32_t handle, const cktap::SlotView& slot) noexcept {
+    const auto wrapper = findCardWrapper<tap_protocol::Satscard>(handle);
+    if (!wrapper) {
+        return wrapper.error();
     }
+
     try {
-        return func() ?
-            CKTapInterfaceErrorCode::success :
-            CKTapInterfaceErrorCode::invalidCardOperation;
+        (*wrapper)->slots.fillConstructorParams(params, handle, slot.index);
+        return CKTapInterfaceErrorCode::success;
+    } catch (...) {
+        return CKTapInterfaceErrorCode::unexpectedExceptionWhenGettingCardOperationResult;
+    }
+}
+
+static SatscardSlotResponse makeSlotResponse(const int32_t handle, const Result<cktap::SlotView>& slot) noexcept {
+    SatscardSlotResponse response;
+    std::memset(&response, 0, sizeof(response));
+    fillOperationStatus(response.status, slot ? fillStoredSlotParams(response.params, handle, *slot) : slot.error());
+    return response;
+}
+
+/// Fills one element of a caller-provided array per handle so a whole collection of cards can be refreshed
+/// with a single FFI call. Each element carries its own status so one bad handle doesn't fail the batch
+template <typename Params, typename Fill>
+static CKTapInterfaceErrorCode fillParamsBatch(const int32_t* handles, const int32_t count, Params* outParams, const Fill& fill) noexcept {
+    if (count < 0 || (count > 0 && (handles == nullptr || outParams == nullptr))) {
+        return CKTapInterfaceErrorCode::invalidBatchArguments;
     }
-    catch (...) {
-        return CKTapInterfaceErrorCode::unexpectedExceptionWhenStartingCardOperation;
+
+    for (int32_t i{ 0 }; i < count; ++i) {
+        fill(handles[i], outParams[i]);
     }
+    return CKTapInterfaceErrorCode::success;
 }
 
-template <typename Return, CardOperation op>
-static Return getCardOpResponse(const std::function<void (Return&, CardResponseType<op>)>& func) noexcept {
-    Return r { };
-    std::memset(&r, 0, sizeof(r));
+/// Frees the contents of each element in a caller-provided array, the array itself is left alone
+template <typename Params, typename Free>
+static void freeParamsBatch(Params* params, const int32_t count, const Free& free) noexcept {
+    if (params == nullptr) {
+        return;
+    }
 
-    if (g_protocolThread == nullptr) {
-        r.status.errorCode = CKTapInterfaceErrorCode::libraryNotInitialized;
-    } else if (g_protocolThread->isThreadActive()) {
-        r.status.errorCode = CKTapInterfaceErrorCode::threadAlreadyInUse;
-    } else if (g_protocolThread->getState() == CKTapThreadState::tapProtocolError) {
-        r.status.errorCode = CKTapInterfaceErrorCode::caughtTapProtocolException;
-        g_protocolThread->getTapProtocolException(r.status.exception);
-    } else {
-        r.status.errorCode = g_protocolThread->getRecentErrorCode();
+    for (int32_t i{ 0 }; i < count; ++i) {
+        free(params[i]);
     }
+}
 
-    if (r.status.errorCode == CKTapInterfaceErrorCode::success) {
-        try {
-            if (const auto optional = g_protocolThread->getResponse<op>()) {
-                func(r, std::move(optional.value()));
-            } else {
-                r.status.errorCode = CKTapInterfaceErrorCode::invalidResponseFromCardOperation;
-            }
-        } catch (...) {
-            r.status.errorCode = CKTapInterfaceErrorCode::unexpectedExceptionWhenGettingCardOperationResult;
-        }
+template <typename Response, typename = void>
+constexpr bool hasResponseStatus = false;
+template <typename Response>
+constexpr bool hasResponseStatus<Response, std::void_t<decltype(std::declval<Response&>().status.errorCode)>> = true;
+template <typename Response, typename = void>
+constexpr bool hasResponseErrorCode = false;
+template <typename Response>
+constexpr bool hasResponseErrorCode<Response, std::void_t<decltype(std::declval<Response&>().errorCode)>> = true;
+
+/// The zeroed response of an export given a null context, failing with invalidContext where it has an error code.
+/// A host which destroyed its context gets an error rather than the default context, which only native hosts use
+template <typename Response>
+static Response rejectNullContext() noexcept {
+    Response response;
+    std::memset(&response, 0, sizeof(response));
+    if constexpr (hasResponseStatus<Response>) {
+        response.status.errorCode = CKTapInterfaceErrorCode::invalidContext;
+    } else if constexpr (hasResponseErrorCode<Response>) {
+        response.errorCode = CKTapInterfaceErrorCode::invalidContext;
     }
-    return r;
+    return response;
 }
 
 // ----------------------------------------------
 // Core Bindings:
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_initializeLibrary() {
-    if (g_protocolThread == nullptr) {
-        g_protocolThread.reset(TapProtocolThread::createNew());
+FFI_FUNC_EXPORT CKTapContext* Core_createContext() {
+    return cktap::createContext();
+}
 
-        if (g_protocolThread == nullptr) {
-            return CKTapInterfaceErrorCode::threadAllocationFailed;
-        }
+FFI_FUNC_EXPORT void Core_destroyContext(CKTapContext* context) {
+    cktap::destroyContext(context);
+}
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_newOperation(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
-    return CKTapInterfaceErrorCode::success;
+    const cktap::ContextBinding binding{ context };
+    return cktap::newOperation();
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_newOperation() {
-    if (g_protocolThread == nullptr) {
-        return CKTapInterfaceErrorCode::libraryNotInitialized;
+FFI_FUNC_EXPORT CKTapOperationResponse Core_endOperation(CKTapContext* context) {
+    if (context == nullptr) {
+        return rejectNullContext<CKTapOperationResponse>();
     }
-    if (g_protocolThread->isThreadActive()) {
-        return CKTapInterfaceErrorCode::threadAlreadyInUse;
+    const cktap::ContextBinding binding{ context };
+    const auto handle = cktap::endOperation();
+    if (!handle) {
+        return makeTapOperationResponse(handle.error());
     }
-
-    return g_protocolThread->reset();
+    return makeTapOperationResponse(CKTapInterfaceErrorCode::success, handle->index, handle->type);
 }
 
-FFI_FUNC_EXPORT CKTapOperationResponse Core_endOperation() {
-    if (g_protocolThread == nullptr) {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::libraryNotInitialized);
-    }
-    if (!g_protocolThread->hasStarted()) {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::threadNotYetStarted);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_requestCancelOperation(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
-    if (g_protocolThread->isThreadActive()) {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::operationStillInProgress);
+    const cktap::ContextBinding binding{ context };
+    return cktap::cancelOperation();
+}
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setOperationDeadline(
+    CKTapContext* context,
+    const int32_t operationTimeoutMs,
+    const int32_t transportTimeoutMs,
+    const int8_t isAdaptive) {
+
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
-    if (g_protocolThread->getRecentErrorCode() == CKTapInterfaceErrorCode::pending) {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::threadNotYetFinalized);
+    const cktap::ContextBinding binding{ context };
+    auto* protocolThread = currentProtocolThread();
+    if (protocolThread == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
     }
-    if (g_protocolThread->hasFailed() || !g_protocolThread->getConstructedCardType().has_value()) {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::operationFailed);
+    if (operationTimeoutMs < 0 || transportTimeoutMs < 0) {
+        return CKTapInterfaceErrorCode::invalidOperationDeadline;
     }
 
-    auto response = makeTapOperationResponse(g_protocolThread->getRecentErrorCode());
-    response.handle.type = g_protocolThread->getConstructedCardType().value();
-    size_t index;
-    if (response.handle.type == CKTapCardType::tapsigner) {
-        auto tapsigner = g_protocolThread->releaseConstructedTapsigner();
-        if (!tapsigner) {
-            return makeTapOperationResponse(CKTapInterfaceErrorCode::expectedTapsignerButReceivedNothing);
-        }
+    DeadlineOptions options{ };
+    options.operationTimeout = std::chrono::milliseconds{ operationTimeoutMs };
+    if (transportTimeoutMs > 0) {
+        options.transportTimeout = std::chrono::milliseconds{ transportTimeoutMs };
+    }
+    options.isTransportTimeoutAdaptive = isAdaptive != 0;
 
-        index = updateVectorWithCard(g_tapsigners, tapsigner);
-        response.handle.type = CKTapCardType::tapsigner;
-    } else if (response.handle.type == CKTapCardType::satscard) {
-        auto satscard = g_protocolThread->releaseConstructedSatscard();
-        if (!satscard) {
-            return makeTapOperationResponse(CKTapInterfaceErrorCode::expectedSatscardButReceivedNothing);
-        }
+    return protocolThread->setDeadlineOptions(options) ?
+        CKTapInterfaceErrorCode::success :
+        CKTapInterfaceErrorCode::threadAlreadyInUse;
+}
 
-        index = updateVectorWithCard(g_satscards, satscard);
-        response.handle.type = CKTapCardType::satscard;
-    } else {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::invalidCardDuringHandshake);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setAttachedCardLimit(CKTapContext* context, const int32_t cardCount) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    if (cardCount < 0) {
+        return CKTapInterfaceErrorCode::invalidAttachedCardLimit;
     }
 
-    if (index == invalidIndex) {
-        return makeTapOperationResponse(CKTapInterfaceErrorCode::invalidHandlingOfCardDuringFinalization);
+    currentContext().attachedCardLimit = static_cast<size_t>(cardCount);
+    // An operation in progress may be using a card about to be detached, the limit applies once it ends
+    if (!cktap::isOperationActive()) {
+        detachIdleCards();
     }
+    return CKTapInterfaceErrorCode::success;
+}
 
-    response.handle.index = static_cast<int32_t>(index);
-    return response;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setWatchdogOptions(CKTapContext* context, const int32_t stallTimeoutMs) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    } else if (context->services == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    }
+    return setWatchdogStallTimeout(*context->services, std::chrono::milliseconds{ stallTimeoutMs });
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_requestCancelOperation() {
-    if (g_protocolThread == nullptr) {
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setWorkerSchedulingOptions(CKTapContext* context, const CKTapWorkerSchedulingOptions options) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    } else if (context->services == nullptr) {
         return CKTapInterfaceErrorCode::libraryNotInitialized;
     }
+    return context->services->workerScheduling.setOptions(options);
+}
 
-    g_protocolThread->requestCancel();
-    return CKTapInterfaceErrorCode::success;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setSessionPoolThreads(const int32_t threadCount) {
+    return setSessionPoolThreads(threadCount);
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_prepareCardOperation(const int32_t handle, const int32_t cardType) {
-    if (g_protocolThread == nullptr) {
-        return CKTapInterfaceErrorCode::libraryNotInitialized;
-    } else if (g_protocolThread->isThreadActive()) {
-        return CKTapInterfaceErrorCode::threadAlreadyInUse;
-    }
-    switch (cardType) {
-        case CKTapCardType::satscard:
-            if (handle < 0 || handle >= g_satscards.size() ||
-                !g_protocolThread->prepareCardOperation(g_satscards[handle].card)) {
-                return CKTapInterfaceErrorCode::unknownSatscardHandle;
-            }
-            break;
-        case CKTapCardType::tapsigner:
-            if (handle < 0 || handle >= g_tapsigners.size() ||
-                !g_protocolThread->prepareCardOperation(g_tapsigners[handle].card)) {
-                return CKTapInterfaceErrorCode::unknownTapsignerHandle;
-            }
-            break;
-        default:
-            return CKTapInterfaceErrorCode::invalidCardOperation;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_prepareCardOperation(CKTapContext* context, const int32_t handle, const int32_t cardType) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
-    return CKTapInterfaceErrorCode::success;
+    const cktap::ContextBinding binding{ context };
+    return cktap::prepareCardOperation(CKTapCardHandle{ handle, static_cast<CKTapCardType>(cardType) });
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_beginAsyncHandshake(const int32_t cardType) {
-    if (g_protocolThread == nullptr) {
-        return CKTapInterfaceErrorCode::libraryNotInitialized;
-    } else if (g_protocolThread->hasStarted()) {
-        return CKTapInterfaceErrorCode::threadNotResetForHandshake;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_beginAsyncHandshake(CKTapContext* context, const int32_t cardType) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginHandshake(cardType);
+}
 
-    if (!g_protocolThread->beginCardHandshake(cardType)) {
-        // The thread failed to start so we should diagnose why
-        return g_protocolThread->finalizeOperation() ?
-            g_protocolThread->getRecentErrorCode() :
-            CKTapInterfaceErrorCode::unknownErrorDuringHandshake;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeAsyncAction(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
+    const cktap::ContextBinding binding{ context };
+    return cktap::finalizeOperation();
+}
 
-    return CKTapInterfaceErrorCode::success;
+FFI_FUNC_EXPORT const uint8_t* Core_getTransportRequestPointer(CKTapContext* context) {
+    if (context == nullptr) {
+        return nullptr;
+    }
+    const cktap::ContextBinding binding{ context };
+    const auto request = cktap::transportRequest();
+    return request.has_value() ? request->data() : nullptr;
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeAsyncAction() {
-    if (g_protocolThread == nullptr) {
-        return CKTapInterfaceErrorCode::libraryNotInitialized;
+FFI_FUNC_EXPORT int32_t Core_getTransportRequestLength(CKTapContext* context) {
+    if (context == nullptr) {
+        return 0;
     }
-    if (!g_protocolThread->hasStarted()) {
-        return CKTapInterfaceErrorCode::threadNotYetStarted;
+    const cktap::ContextBinding binding{ context };
+    const auto request = cktap::transportRequest();
+    return request.has_value() ? static_cast<int32_t>(request->size()) : 0;
+}
+
+FFI_FUNC_EXPORT uint8_t* Core_allocateTransportResponseBuffer(CKTapContext* context, const int32_t sizeInBytes) {
+    if (context == nullptr) {
+        return nullptr;
     }
-    if (g_protocolThread->isThreadActive()) {
-        return CKTapInterfaceErrorCode::attemptToFinalizeActiveThread;
+    const cktap::ContextBinding binding{ context };
+    if (sizeInBytes <= 0) {
+        return nullptr;
     }
+    return cktap::allocateTransportResponse(static_cast<size_t>(sizeInBytes));
+}
 
-    return g_protocolThread->finalizeOperation() ?
-        g_protocolThread->getRecentErrorCode() :
-        CKTapInterfaceErrorCode::unableToFinalizeAsyncAction;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeTransportResponse(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::finalizeTransportResponse();
 }
 
-FFI_FUNC_EXPORT const uint8_t* Core_getTransportRequestPointer() {
-    if (g_protocolThread == nullptr) {
-        return nullptr;
+FFI_FUNC_EXPORT CKTapThreadState Core_getThreadState(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapThreadState::notStarted;
+    }
+    const cktap::ContextBinding binding{ context };
+    auto* protocolThread = currentProtocolThread();
+    if (protocolThread == nullptr) {
+        return CKTapThreadState::notStarted;
     }
 
-    const auto optionalBytes = g_protocolThread->getTransportRequest();
-    return optionalBytes.has_value() ? optionalBytes.value()->data() : nullptr;
+    return protocolThread->getState();
 }
 
-FFI_FUNC_EXPORT int32_t Core_getTransportRequestLength() {
-    if (g_protocolThread == nullptr) {
-        return 0;
+FFI_FUNC_EXPORT CKTapProtoException Core_getTapProtoException(CKTapContext* context) {
+    if (context == nullptr) {
+        return rejectNullContext<CKTapProtoException>();
     }
+    const cktap::ContextBinding binding{ context };
+    return cktap::tapProtocolException().value_or(CKTapProtoException{ });
+}
 
-    const auto optionalBytes = g_protocolThread->getTransportRequest();
-    return optionalBytes.has_value() ? static_cast<int32_t>(optionalBytes.value()->size()) : 0;
+FFI_FUNC_EXPORT CKTapMetrics Core_getMetrics(CKTapContext* context) {
+    if (context == nullptr || context->services == nullptr) {
+        return rejectNullContext<CKTapMetrics>();
+    }
+    return makeMetricsSnapshot(context->operationMetrics, context->services->auditLog);
 }
 
-FFI_FUNC_EXPORT uint8_t* Core_allocateTransportResponseBuffer(const int32_t sizeInBytes) {
-    if (g_protocolThread == nullptr) {
-        return nullptr;
+FFI_FUNC_EXPORT void Core_resetMetrics(CKTapContext* context) {
+    if (context == nullptr || context->services == nullptr) {
+        return;
     }
-    if (sizeInBytes <= 0) {
-        return nullptr;
+    resetMetrics(context->operationMetrics, context->services->auditLog);
+}
+
+FFI_FUNC_EXPORT CKTapChangedCards Core_getChangedCardsSince(CKTapContext* context, const int64_t version) {
+    if (context == nullptr) {
+        return rejectNullContext<CKTapChangedCards>();
+    }
+    const cktap::ContextBinding binding{ context };
+    const auto& registry = currentContext();
+    CKTapChangedCards result;
+    std::memset(&result, 0, sizeof(result));
+    result.status.errorCode = CKTapInterfaceErrorCode::success;
+    result.version = static_cast<int64_t>(currentChangeVersion());
+
+    const auto since = static_cast<uint64_t>(std::max<int64_t>(version, 0));
+    size_t changedCount{ 0 };
+    const auto countChanged = [since, &changedCount](const auto& vector) {
+        for (const auto& wrapper : vector) {
+            changedCount += wrapper.changes.changesSince(since) != 0 ? 1 : 0;
+        }
+    };
+    countChanged(registry.satscards);
+    countChanged(registry.tapsigners);
+
+    if (changedCount == 0) {
+        return result;
     }
 
-    auto optionalBuffer = g_protocolThread->allocateTransportResponseBuffer(static_cast<size_t>(sizeInBytes));
-    return optionalBuffer.value_or(nullptr);
+    result.array = allocateCArray<CKTapCardChangeEntry>(changedCount);
+    if (result.array == nullptr) {
+        result.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+        return result;
+    }
+
+    const auto appendChanged = [since, &result](const auto& vector, const CKTapCardType type) {
+        for (size_t index{ 0 }; index < vector.size(); ++index) {
+            if (const auto changes = vector[index].changes.changesSince(since)) {
+                auto& entry = result.array[result.length++];
+                entry.handle = CKTapCardHandle{ static_cast<int32_t>(index), type };
+                entry.changes = static_cast<int32_t>(changes);
+            }
+        }
+    };
+    appendChanged(registry.satscards, CKTapCardType::satscard);
+    appendChanged(registry.tapsigners, CKTapCardType::tapsigner);
+    return result;
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeTransportResponse() {
-    if (g_protocolThread == nullptr) {
-        return CKTapInterfaceErrorCode::threadNotYetStarted;
+FFI_FUNC_EXPORT CKTapPipelineTicket Core_enqueuePipelinedCard(CKTapContext* context) {
+    if (context == nullptr) {
+        return rejectNullContext<CKTapPipelineTicket>();
     }
-    if (g_protocolThread->getState() != CKTapThreadState::transportRequestReady) {
-        return CKTapInterfaceErrorCode::threadNotReadyForResponse;
+    const cktap::ContextBinding binding{ context };
+    return enqueuePipelinedCard();
+}
+
+FFI_FUNC_EXPORT CKTapPipelinedCards Core_pollPipelinedCards(CKTapContext* context, const int8_t wait) {
+    if (context == nullptr) {
+        return rejectNullContext<CKTapPipelinedCards>();
     }
+    const cktap::ContextBinding binding{ context };
+    return pollPipelinedCards(wait != 0);
+}
 
-    return g_protocolThread->finalizeTransportResponse() ?
-        CKTapInterfaceErrorCode::success :
-        CKTapInterfaceErrorCode::threadResponseFinalizationFailed;
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_prewarm(CKTapContext* context, const CKTapPrewarmOptions options) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return startPrewarm(options);
 }
 
-FFI_FUNC_EXPORT CKTapThreadState Core_getThreadState() {
-    if (g_protocolThread == nullptr) {
-        return CKTapThreadState::notStarted;
+FFI_FUNC_EXPORT CKTapPrewarmReport Core_getPrewarmReport(CKTapContext* context, const int8_t wait) {
+    if (context == nullptr) {
+        return rejectNullContext<CKTapPrewarmReport>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return getPrewarmReport(wait != 0);
+}
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_saveCardCache(CKTapContext* context, const char* path) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
     }
+    const cktap::ContextBinding binding{ context };
+    return saveCardCache(path);
+}
 
-    return g_protocolThread->getState();
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_openAuditLog(CKTapContext* context, const char* path, const int64_t capacity) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    } else if (context->services == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    }
+    return context->services->auditLog.open(path, capacity);
 }
 
-FFI_FUNC_EXPORT CKTapProtoException Core_getTapProtoException() {
-    if (g_protocolThread != nullptr) {
-        auto e = CKTapProtoException{ };
-        if (g_protocolThread->getTapProtocolException(e)) {
-            return e;
-        }
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_syncAuditLog(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    } else if (context->services == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
     }
+    return context->services->auditLog.sync();
+}
 
-    return { };
+FFI_FUNC_EXPORT void Core_closeAuditLog(CKTapContext* context) {
+    if (context == nullptr || context->services == nullptr) {
+        return;
+    }
+    context->services->auditLog.close();
 }
 
 // ----------------------------------------------
 // CKTapCard:
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode CKTapCard_beginWait() {
-    return beginCardOp([=]() {
-        return g_protocolThread->beginCKTapCard_Wait();
-    });
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode CKTapCard_beginWait(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginWait();
 }
 
-FFI_FUNC_EXPORT WaitResponseParams CKTapCard_getWaitResponse() {
-    return getCardOpResponse<WaitResponseParams, CardOperation::CKTapCard_Wait>([](auto& result, auto response) {
-        result.success = response.success ? 1 : 0;
-        result.authDelay = response.auth_delay;
-    });
+FFI_FUNC_EXPORT WaitResponseParams CKTapCard_getWaitResponse(CKTapContext* context) {
+    if (context == nullptr) {
+        return rejectNullContext<WaitResponseParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    WaitResponseParams params;
+    std::memset(&params, 0, sizeof(params));
+
+    const auto response = cktap::waitResult();
+    fillOperationStatus(params.status, response.error());
+    if (response) {
+        params.success = response->success ? 1 : 0;
+        params.authDelay = response->authDelay;
+    }
+    return params;
 }
 
 // ----------------------------------------------
 // Satscard:
 
-FFI_FUNC_EXPORT SatscardConstructorParams Satscard_createConstructorParams(const int32_t handle) {
-    SatscardConstructorParams params;
+static void fillSatscardConstructorParams(const int32_t handle, SatscardConstructorParams& params) noexcept {
     std::memset(&params, 0, sizeof(params));
 
-    params.status = accessCard<tap_protocol::Satscard>(handle, [handle, &params](const SatscardWrapper& wrapper) {
-        const auto& card = *wrapper.card;
-        fillConstructorParams(params.base, handle, card);
-        params.activeSlotIndex = card.GetActiveSlotIndex();
-        params.numSlots = card.GetNumSlots();
-        params.hasUnusedSlots = card.HasUnusedSlots() ? 1 : 0;
-        params.isUsedUp = card.IsUsedUp() ? 1 : 0;
-        return CKTapInterfaceErrorCode::success;
-    });
-    return params;
+    const auto info = cktap::cardInfo(CKTapCardHandle{ handle, CKTapCardType::satscard });
+    if (!info) {
+        params.status.errorCode = info.error();
+        return;
+    }
+
+    params.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    try {
+        const auto& snapshot = info->snapshot;
+        fillConstructorParams(params.base, handle, snapshot);
+        params.activeSlotIndex = snapshot.activeSlotIndex;
+        params.numSlots = snapshot.numSlots;
+        params.hasUnusedSlots = snapshot.hasUnusedSlots ? 1 : 0;
+        params.isUsedUp = snapshot.isUsedUp ? 1 : 0;
+        params.status.errorCode = CKTapInterfaceErrorCode::success;
+    } catch (...) { }
 }
 
-FFI_FUNC_EXPORT SatscardSyncParams Satscard_createSyncParams(const int32_t handle) {
-    SatscardSyncParams params;
+static void fillSatscardSyncParams(const int32_t handle, SatscardSyncParams& params) noexcept {
     std::memset(&params, 0, sizeof(params));
 
-    params.status = accessCard<tap_protocol::Satscard>(handle, [handle, &params](const SatscardWrapper& wrapper) {
-        params.baseParams.isCertsChecked = wrapper.card->IsCertsChecked() ? 1 : 0;
-        params.baseParams.needSetup = wrapper.card->NeedSetup() ? 1 : 0;
-        params.baseParams.authDelay = wrapper.card->GetAuthDelay();
-        params.activeSlotIndex = wrapper.card->GetActiveSlotIndex();
-        params.hasUnusedSlots = wrapper.card->HasUnusedSlots() ? 1 : 0;
-        params.isUsedUp = wrapper.card->IsUsedUp() ? 1 : 0;
-        return CKTapInterfaceErrorCode::success;
-    });
+    const auto info = cktap::cardInfo(CKTapCardHandle{ handle, CKTapCardType::satscard });
+    if (!info) {
+        params.status.errorCode = info.error();
+        return;
+    }
+
+    fillSyncParams(params.baseParams, info->snapshot);
+    params.activeSlotIndex = info->snapshot.activeSlotIndex;
+    params.hasUnusedSlots = info->snapshot.hasUnusedSlots ? 1 : 0;
+    params.isUsedUp = info->snapshot.isUsedUp ? 1 : 0;
+    params.status.errorCode = CKTapInterfaceErrorCode::success;
+}
+
+FFI_FUNC_EXPORT SatscardConstructorParams Satscard_createConstructorParams(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardConstructorParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    SatscardConstructorParams params;
+    fillSatscardConstructorParams(handle, params);
     return params;
 }
 
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getActiveSlot(const int32_t handle) {
-    SatscardSlotResponse response;
-    std::memset(&response, 0, sizeof(response));
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_createConstructorParamsBatch(CKTapContext* context, const int32_t* handles, const int32_t count, SatscardConstructorParams* outParams) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return fillParamsBatch(handles, count, outParams, fillSatscardConstructorParams);
+}
 
-    response.status = accessCard<tap_protocol::Satscard>(handle, [=, &response](auto& wrapper) {
-        auto slot = wrapper.card->GetActiveSlot();
-        const auto index = slot.index;
-        if (index >= wrapper.slots.size()) {
-            wrapper.slots.resize(slot.index + 1);
-        }
-        fillConstructorParams(response.params, handle, slot);
-        wrapper.slots[index] = std::make_unique<tap_protocol::Satscard::Slot>(std::move(slot));
-        return CKTapInterfaceErrorCode::success;
-    });
-    return response;
+FFI_FUNC_EXPORT SatscardSyncParams Satscard_createSyncParams(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardSyncParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    SatscardSyncParams params;
+    fillSatscardSyncParams(handle, params);
+    return params;
+}
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_createSyncParamsBatch(CKTapContext* context, const int32_t* handles, const int32_t count, SatscardSyncParams* outParams) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return fillParamsBatch(handles, count, outParams, fillSatscardSyncParams);
 }
 
-FFI_FUNC_EXPORT SlotToWifResponse Satscard_slotToWif(const int32_t handle, const int32_t index) {
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getActiveSlot(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardSlotResponse>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return makeSlotResponse(handle, cktap::activeSlot(handle));
+}
+
+FFI_FUNC_EXPORT SlotToWifResponse Satscard_slotToWif(CKTapContext* context, const int32_t handle, const int32_t index) {
+    if (context == nullptr) {
+        return rejectNullContext<SlotToWifResponse>();
+    }
+    const cktap::ContextBinding binding{ context };
     SlotToWifResponse response;
     std::memset(&response, 0, sizeof(response));
 
-    response.status = accessCard<tap_protocol::Satscard>(handle, [=, &response](const auto& wrapper) {
-        if (index < 0 || index >= wrapper.slots.size() || !wrapper.slots[index]) {
-            return CKTapInterfaceErrorCode::unknownSlotForGivenSatscardHandle;
-        }
-        response.wif = allocateCStringFromCpp(wrapper.slots[index]->to_wif());
-        return CKTapInterfaceErrorCode::success;
-    });
+    const auto wif = cktap::slotWif(handle, index);
+    if (!wif) {
+        response.status.errorCode = wif.error();
+        return response;
+    }
+    response.wif = allocateSecureCString(wif->c_str(), wif->size());
+    response.status.errorCode = CKTapInterfaceErrorCode::success;
     return response;
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginCertificateCheck() {
-    return beginCardOp([=]() {
-        return g_protocolThread->beginSatscard_CertificateCheck();
-    });
+FFI_FUNC_EXPORT SatscardWifBatch Satscard_exportWifsBatch(CKTapContext* context, const int32_t* handles, const int32_t count) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardWifBatch>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return exportSatscardWifs(handles, count);
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginGetSlot(const int32_t slot, const char* spendCode) {
-    return beginCardOp([=]() {
-        return g_protocolThread->beginSatscard_GetSlot(slot, spendCode);
-    });
+FFI_FUNC_EXPORT SlotAddressVerification Satscard_verifySlotAddresses(CKTapContext* context) {
+    if (context == nullptr) {
+        return rejectNullContext<SlotAddressVerification>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return verifySatscardSlotAddresses();
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginListSlots(const char* spendCode, const int32_t limit) {
-    return beginCardOp([=]() {
-        return g_protocolThread->beginSatscard_ListSlots(spendCode, limit);
-    });
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginCertificateCheck(CKTapContext* context) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginCertificateCheck();
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginNew(const char* chainCode, const char* spendCode) {
-    return beginCardOp([=]() {
-        return g_protocolThread->beginSatscard_New(chainCode, spendCode);
-    });
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginGetSlot(CKTapContext* context, const int32_t slot, const char* spendCode) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginGetSlot(slot, spendCode);
 }
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginUnseal(const char* spendCode) {
-    return beginCardOp([=]() {
-        return g_protocolThread->beginSatscard_Unseal(spendCode);
-    });
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginListSlots(CKTapContext* context, const char* spendCode, const int32_t limit) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginListSlots(spendCode, limit);
 }
 
-FFI_FUNC_EXPORT CertificateCheckParams Satscard_getCertificateCheckResponse() {
-    return getCardOpResponse<CertificateCheckParams, CardOperation::Satscard_CertificateCheck>([](auto& result, auto response) {
-        result.isCertsChecked = response ? 1 : 0;
-    });
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginNew(CKTapContext* context, const char* chainCode, const char* spendCode) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginNewSlot(chainCode, spendCode);
 }
 
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getGetSlotResponse(const int32_t handle) {
-    return getCardOpResponse<SatscardSlotResponse, CardOperation::Satscard_GetSlot>([=](auto& result, auto slot) {
-        fillConstructorParams(result.params, handle, slot);
-        storeSatscardSlot(handle, std::move(slot));
-    });
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginUnseal(CKTapContext* context, const char* spendCode) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return cktap::beginUnseal(spendCode);
+}
+
+FFI_FUNC_EXPORT CertificateCheckParams Satscard_getCertificateCheckResponse(CKTapContext* context) {
+    if (context == nullptr) {
+        return rejectNullContext<CertificateCheckParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    CertificateCheckParams params;
+    std::memset(&params, 0, sizeof(params));
+
+    const auto isCertsChecked = cktap::certificateCheckResult();
+    fillOperationStatus(params.status, isCertsChecked.error());
+    params.isCertsChecked = isCertsChecked && *isCertsChecked ? 1 : 0;
+    return params;
+}
+
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getGetSlotResponse(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardSlotResponse>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return makeSlotResponse(handle, cktap::getSlotResult(handle));
 }
 
-FFI_FUNC_EXPORT SatscardListSlotsParams Satscard_getListSlotsResponse(const int32_t handle) {
-    return getCardOpResponse<SatscardListSlotsParams, CardOperation::Satscard_ListSlots>([=](auto& result, auto slots) {
-        result.array = allocateCArray<SlotConstructorParams>(slots.size());
-        result.length = static_cast<int32_t>(slots.size());
-        for (size_t i { 0 }; i < slots.size(); ++i) {
-            fillConstructorParams(result.array[i], handle, slots[i]);
-            storeSatscardSlot(handle, std::move(slots[i]));
+FFI_FUNC_EXPORT SatscardListSlotsParams Satscard_getListSlotsResponse(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardListSlotsParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    SatscardListSlotsParams params;
+    std::memset(&params, 0, sizeof(params));
+
+    const auto slots = cktap::listSlotsResult(handle);
+    if (!slots) {
+        fillOperationStatus(params.status, slots.error());
+        return params;
+    }
+
+    params.array = allocateCArray<SlotConstructorParams>(slots->size);
+    if (params.array == nullptr && slots->size > 0) {
+        params.status.errorCode = CKTapInterfaceErrorCode::unexpectedExceptionWhenGettingCardOperationResult;
+        return params;
+    }
+
+    params.status.errorCode = CKTapInterfaceErrorCode::success;
+    for (const auto& slot : *slots) {
+        const auto errorCode = fillStoredSlotParams(params.array[params.length], handle, slot);
+        if (errorCode != CKTapInterfaceErrorCode::success) {
+            params.status.errorCode = errorCode;
+            break;
         }
-    });
+        ++params.length;
+    }
+    return params;
 }
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getNewResponse(const int32_t handle) {
-    return getCardOpResponse<SatscardSlotResponse, CardOperation::Satscard_New>([=](auto& result, auto slot) {
-        fillConstructorParams(result.params, handle, slot);
-        storeSatscardSlot(handle, std::move(slot));
-    });
+
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getNewResponse(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardSlotResponse>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return makeSlotResponse(handle, cktap::newSlotResult(handle));
 }
 
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getUnsealResponse(const int32_t handle) {
-    return getCardOpResponse<SatscardSlotResponse, CardOperation::Satscard_Unseal>([=](auto& result, auto slot) {
-        fillConstructorParams(result.params, handle, slot);
-        storeSatscardSlot(handle, std::move(slot));
-    });
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getUnsealResponse(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<SatscardSlotResponse>();
+    }
+    const cktap::ContextBinding binding{ context };
+    return makeSlotResponse(handle, cktap::unsealResult(handle));
 }
 
 // ----------------------------------------------
 // Tapsigner:
 
-FFI_FUNC_EXPORT TapsignerConstructorParams Tapsigner_createConstructorParams(const int32_t handle) {
-    TapsignerConstructorParams params;
+static void fillTapsignerConstructorParams(const int32_t handle, TapsignerConstructorParams& params) noexcept {
     std::memset(&params, 0, sizeof(params));
 
-    params.status = accessCard<tap_protocol::Tapsigner>(handle, [handle, &params](const TapsignerWrapper& wrapper) {
-        const auto& card = *wrapper.card;
-        fillConstructorParams(params.base, handle, card);
-        params.numberOfBackups = card.GetNumberOfBackups();
-        if (const auto path = card.GetDerivationPath()) {
-            if (path.has_value()) {
-                params.derivationPath = allocateCStringFromCpp(path.value());
-            }
-        }
-        return CKTapInterfaceErrorCode::success;
-    });
-    return params;
+    const auto info = cktap::cardInfo(CKTapCardHandle{ handle, CKTapCardType::tapsigner });
+    if (!info) {
+        params.status.errorCode = info.error();
+        return;
+    }
+
+    params.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    try {
+        fillConstructorParams(params.base, handle, info->snapshot);
+        params.numberOfBackups = info->snapshot.numberOfBackups;
+        params.derivationPath = allocateCStringFromBuffer(info->derivationPath.data());
+        params.status.errorCode = CKTapInterfaceErrorCode::success;
+    } catch (...) { }
 }
 
-FFI_FUNC_EXPORT TapsignerSyncParams Tapsigner_createSyncParams(const int32_t handle) {
-    TapsignerSyncParams params;
+static void fillTapsignerSyncParams(const int32_t handle, TapsignerSyncParams& params) noexcept {
     std::memset(&params, 0, sizeof(params));
 
-    params.status = accessCard<tap_protocol::Tapsigner>(handle, [handle, &params](const TapsignerWrapper& wrapper) {
-        params.baseParams.isCertsChecked = wrapper.card->IsCertsChecked() ? 1 : 0;
-        params.baseParams.needSetup = wrapper.card->NeedSetup() ? 1 : 0;
-        params.baseParams.authDelay = wrapper.card->GetAuthDelay();
-        params.numberOfBackups = wrapper.card->GetNumberOfBackups();
-        if (const auto path = wrapper.card->GetDerivationPath()) {
-            if (path.has_value()) {
-                params.derivationPath = allocateCStringFromCpp(path.value());
-            }
-        }
-        return CKTapInterfaceErrorCode::success;
-    });
+    const auto info = cktap::cardInfo(CKTapCardHandle{ handle, CKTapCardType::tapsigner });
+    if (!info) {
+        params.status.errorCode = info.error();
+        return;
+    }
+
+    params.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    try {
+        fillSyncParams(params.baseParams, info->snapshot);
+        params.numberOfBackups = info->snapshot.numberOfBackups;
+        params.derivationPath = allocateCStringFromBuffer(info->derivationPath.data());
+        params.status.errorCode = CKTapInterfaceErrorCode::success;
+    } catch (...) { }
+}
+
+FFI_FUNC_EXPORT TapsignerConstructorParams Tapsigner_createConstructorParams(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<TapsignerConstructorParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    TapsignerConstructorParams params;
+    fillTapsignerConstructorParams(handle, params);
     return params;
 }
 
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Tapsigner_createConstructorParamsBatch(CKTapContext* context, const int32_t* handles, const int32_t count, TapsignerConstructorParams* outParams) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return fillParamsBatch(handles, count, outParams, fillTapsignerConstructorParams);
+}
+
+FFI_FUNC_EXPORT TapsignerSyncParams Tapsigner_createSyncParams(CKTapContext* context, const int32_t handle) {
+    if (context == nullptr) {
+        return rejectNullContext<TapsignerSyncParams>();
+    }
+    const cktap::ContextBinding binding{ context };
+    TapsignerSyncParams params;
+    fillTapsignerSyncParams(handle, params);
+    return params;
+}
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Tapsigner_createSyncParamsBatch(CKTapContext* context, const int32_t* handles, const int32_t count, TapsignerSyncParams* outParams) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return fillParamsBatch(handles, count, outParams, fillTapsignerSyncParams);
+}
+
+// ----------------------------------------------
+// Readers:
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Reader_startAll(CKTapContext* context, const int32_t cardType) {
+    if (context == nullptr) {
+        return CKTapInterfaceErrorCode::invalidContext;
+    }
+    const cktap::ContextBinding binding{ context };
+    return startReaderWorkers(cardType);
+}
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Reader_stopAll() {
+    return stopReaderWorkers();
+}
+
+FFI_FUNC_EXPORT CKTapReaderStatsList Reader_getStats() {
+    return getReaderStats();
+}
+
 // ----------------------------------------------
 // Utility:
 
@@ -459,14 +781,27 @@ FFI_FUNC_EXPORT void Utility_freeCBinaryArray(CBinaryArray array) {
     freeCBinaryArray(array);
 }
 
+FFI_FUNC_EXPORT void Utility_freeCKTapChangedCards(CKTapChangedCards changedCards) {
+    freeCKTapInterfaceStatus(changedCards.status);
+    freePointer(changedCards.array);
+}
+
 FFI_FUNC_EXPORT void Utility_freeCKTapInterfaceStatus(CKTapInterfaceStatus status) {
     freeCKTapInterfaceStatus(status);
 }
 
+FFI_FUNC_EXPORT void Utility_freeCKTapPipelinedCards(CKTapPipelinedCards cards) {
+    freePipelinedCards(cards);
+}
+
 FFI_FUNC_EXPORT void Utility_freeCKTapProtoException(CKTapProtoException exception) {
     freeCKTapProtoException(exception);
 }
 
+FFI_FUNC_EXPORT void Utility_freeCKTapReaderStatsList(CKTapReaderStatsList list) {
+    freeReaderStatsList(list);
+}
+
 FFI_FUNC_EXPORT void Utility_freeCString(char* cString) {
     freePointer(cString);
 }
@@ -475,6 +810,13 @@ FFI_FUNC_EXPORT void Utility_freeSatscardConstructorParams(SatscardConstructorPa
     freeSatscardConstructorParams(params);
 }
 
+FFI_FUNC_EXPORT void Utility_freeSatscardConstructorParamsBatch(SatscardConstructorParams* params, const int32_t count) {
+    freeParamsBatch(params, count, [](SatscardConstructorParams& element) {
+        freeCKTapInterfaceStatus(element.status);
+        freeSatscardConstructorParams(element);
+    });
+}
+
 FFI_FUNC_EXPORT void Utility_freeSatscardListSlotsParams(SatscardListSlotsParams params) {
     freeSatscardListSlotsParams(params);
 }
@@ -484,7 +826,19 @@ FFI_FUNC_EXPORT void Utility_freeSatscardSlotResponse(SatscardSlotResponse respo
 }
 
 FFI_FUNC_EXPORT void Utility_freeSatscardSyncParams(SatscardSyncParams params) {
-    freeCKTapInterfaceStatus(params.status);
+    freeSatscardSyncParams(params);
+}
+
+FFI_FUNC_EXPORT void Utility_freeSatscardSyncParamsBatch(SatscardSyncParams* params, const int32_t count) {
+    freeParamsBatch(params, count, freeSatscardSyncParams);
+}
+
+FFI_FUNC_EXPORT void Utility_freeSatscardWifBatch(SatscardWifBatch batch) {
+    freeSatscardWifBatch(batch);
+}
+
+FFI_FUNC_EXPORT void Utility_freeSlotAddressVerification(SlotAddressVerification verification) {
+    freeSlotAddressVerification(verification);
 }
 
 FFI_FUNC_EXPORT void Utility_freeSlotConstructorParams(SlotConstructorParams params) {
@@ -499,7 +853,17 @@ FFI_FUNC_EXPORT void Utility_freeTapsignerConstructorParams(TapsignerConstructor
     freeTapsignerConstructorParams(params);
 }
 
+FFI_FUNC_EXPORT void Utility_freeTapsignerConstructorParamsBatch(TapsignerConstructorParams* params, const int32_t count) {
+    freeParamsBatch(params, count, [](TapsignerConstructorParams& element) {
+        freeCKTapInterfaceStatus(element.status);
+        freeTapsignerConstructorParams(element);
+    });
+}
+
 FFI_FUNC_EXPORT void Utility_freeTapsignerSyncParams(TapsignerSyncParams params) {
-    freeCKTapInterfaceStatus(params.status);
-    freePointer(params.derivationPath);
+    freeTapsignerSyncParams(params);
+}
+
+FFI_FUNC_EXPORT void Utility_freeTapsignerSyncParamsBatch(TapsignerSyncParams* params, const int32_t count) {
+    freeParamsBatch(params, count, freeTapsignerSyncParams);
 }
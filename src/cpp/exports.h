@@ -10,95 +10,202 @@
 // ----------------------------------------------
 // Core Bindings:
 
-/// Ensures the library and native thread are initialized
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_initializeLibrary();
-
-/// Must be called first to restore the native thread to its initial state
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_newOperation();
+/// Creates an engine context with its own native thread, card registry, pipeline, audit log, scheduling and watchdog
+/// timeout, returns null if it couldn't be allocated. Every isolate should create its own and pass it to each call
+/// below that takes one, contexts only share the secure pool, the session pool, the metrics totals and the readers.
+/// Passing them null fails with invalidContext rather than falling back to a shared context
+FFI_FUNC_EXPORT CKTapContext* Core_createContext();
+/// Cancels any operation in progress and frees the context, it mustn't be used again
+FFI_FUNC_EXPORT void Core_destroyContext(CKTapContext* context);
+
+/// Must be called first to restore the native thread to its initial state. Returns operationStillInProgress
+/// straight away while a cancelled operation is unwinding, rather than waiting for it
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_newOperation(CKTapContext* context);
 /// Must be called last to store and retrieve Satscard/Tapsigner data
-FFI_FUNC_EXPORT CKTapOperationResponse Core_endOperation();
-/// Signals cancellation of the current operation, causing the thread to enter a
-/// resettable state
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_requestCancelOperation();
+FFI_FUNC_EXPORT CKTapOperationResponse Core_endOperation(CKTapContext* context);
+/// Signals cancellation of the current operation, causing the thread to enter a resettable state. Never waits,
+/// returns operationStillInProgress until the operation has unwound so the host can call it again to poll
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_requestCancelOperation(CKTapContext* context);
+/// Configures the time limits of subsequent operations. [operationTimeoutMs] bounds a whole operation and 0
+/// disables it, [transportTimeoutMs] bounds each message and 0 restores the default of one minute. When
+/// [isAdaptive] is set each message's timeout is derived from recent round trip times instead
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setOperationDeadline(CKTapContext* context, int32_t operationTimeoutMs, int32_t transportTimeoutMs, int8_t isAdaptive);
+/// Sets how many of the most recently used cards keep their live tap_protocol object between operations, so going
+/// back to one of them needs no handshake. Each attached card holds a few KiB more than a detached one. Defaults to
+/// 4, 0 detaches every card once its operation ends. Takes effect straight away unless an operation is in progress
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setAttachedCardLimit(CKTapContext* context, int32_t cardCount);
+/// Has a native watchdog cancel any of the context's operations, including those of the PC/SC readers started from
+/// it, that has made no progress for [stallTimeoutMs], such as when the host stops answering transport requests. The
+/// operation fails with sessionStalled and Core_newOperation succeeds once it has unwound. Must be at least 250, 0
+/// leaves the context's operations alone, which is the default
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setWatchdogOptions(CKTapContext* context, int32_t stallTimeoutMs);
+/// Sets the priority and CPU affinity of the threads which run the context's card sessions, both the protocol thread
+/// of each operation and each PC/SC reader started from it, so they aren't delayed by rendering on a loaded device.
+/// Refused changes leave the scheduling as it was, except SCHED_FIFO which falls back to the nice value and returns
+/// workerSchedulingNotPermitted. Check the wake latency jitter in Core_getMetrics to see the effect
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setWorkerSchedulingOptions(CKTapContext* context, CKTapWorkerSchedulingOptions options);
+/// Runs the card operations of every context as fibers on [threadCount] shared workers instead of a thread per
+/// operation, so many sessions waiting on their hosts need few threads. 0 restores a thread per operation, which is
+/// the default. Fails with sessionPoolNotSupported on builds without CKTAP_ENABLE_SESSION_POOL, which is Linux only
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_setSessionPoolThreads(int32_t threadCount);
 
 /// Searches for the specified card and gives the native thread access so
 /// further operations can be performed on it
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_prepareCardOperation(int32_t handle, int32_t cardType);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_prepareCardOperation(CKTapContext* context, int32_t handle, int32_t cardType);
 /// Attempts to perform an initial handshake with a CKTapCard
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_beginAsyncHandshake(int32_t cardType);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_beginAsyncHandshake(CKTapContext* context, int32_t cardType);
 /// Must be called at the end of every async action
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeAsyncAction();
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeAsyncAction(CKTapContext* context);
 
 /// Retrieves a pointer to the current transport request
 /// Returns nullptr if the native thread isn't ready or is invalid
-FFI_FUNC_EXPORT const uint8_t* Core_getTransportRequestPointer();
+FFI_FUNC_EXPORT const uint8_t* Core_getTransportRequestPointer(CKTapContext* context);
 /// Retrieves the size of the current transport request in bytes
 /// Returns 0 if the native thread isn't ready or is invalid
-FFI_FUNC_EXPORT int32_t Core_getTransportRequestLength();
+FFI_FUNC_EXPORT int32_t Core_getTransportRequestLength(CKTapContext* context);
 
 /// Ensures that the transport response buffer will be appropriately sized
 /// Returns a pointer to the buffer if valid, nullptr if not
-FFI_FUNC_EXPORT uint8_t* Core_allocateTransportResponseBuffer(int32_t sizeInBytes);
+FFI_FUNC_EXPORT uint8_t* Core_allocateTransportResponseBuffer(CKTapContext* context, int32_t sizeInBytes);
 /// Informs the native thread that it's now safe to read the previously allocated buffer
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeTransportResponse();
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_finalizeTransportResponse(CKTapContext* context);
 
 /// Gets the current native thread state atomically
-FFI_FUNC_EXPORT CKTapThreadState Core_getThreadState();
+FFI_FUNC_EXPORT CKTapThreadState Core_getThreadState(CKTapContext* context);
 /// Gets the most recent tap_protocol::TapProtoException ONLY if the current thread state is
 /// CKTapThreadState::tapProtocolError
-FFI_FUNC_EXPORT CKTapProtoException Core_getTapProtoException();
+FFI_FUNC_EXPORT CKTapProtoException Core_getTapProtoException(CKTapContext* context);
+
+/// Gets a snapshot of the context's performance counters alongside the process-wide ones, see CKTapMetrics
+FFI_FUNC_EXPORT CKTapMetrics Core_getMetrics(CKTapContext* context);
+/// Zeroes the context's performance counters and the process-wide ones
+FFI_FUNC_EXPORT void Core_resetMetrics(CKTapContext* context);
+
+/// Lists every card which changed after the given version along with what changed, so only those cards need to be
+/// synced. Pass 0 to list everything then pass the returned version next time. Note: must use
+/// [Utility_freeCKTapChangedCards] when you are finished using the data to deallocate memory
+FFI_FUNC_EXPORT CKTapChangedCards Core_getChangedCardsSince(CKTapContext* context, int64_t version);
+
+/// Used instead of [Core_endOperation] when cards are tapped back-to-back. Hands the card from the finished handshake
+/// to the pipeline's worker for post-processing and resets the native thread, so [Core_beginAsyncHandshake] can be
+/// called for the next card straight away. This only pays off while the next handshake waits on the NFC link and
+/// another core is free, on one core or a link answering instantly it's slower than [Core_endOperation]
+FFI_FUNC_EXPORT CKTapPipelineTicket Core_enqueuePipelinedCard(CKTapContext* context);
+/// Registers every card whose post-processing has finished, in the order they were enqueued. Pass a non-zero [wait]
+/// to block until every enqueued card is done. Note: must use [Utility_freeCKTapPipelinedCards] when you are
+/// finished using the data to deallocate memory
+FFI_FUNC_EXPORT CKTapPipelinedCards Core_pollPipelinedCards(CKTapContext* context, int8_t wait);
+
+/// Initializes the library if needed, reserves the registry then pays the one-time costs of the first tap on a
+/// background thread: starting a thread, the crypto used for slots and WIFs, the secure pool and reading the card
+/// cache. Fails with prewarmAlreadyRunning until the previous prewarm's report has been fetched
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_prewarm(CKTapContext* context, CKTapPrewarmOptions options);
+/// Gets the report of the most recent prewarm and registers the cached cards once it has finished. Pass a non-zero
+/// [wait] to block until it's done
+FFI_FUNC_EXPORT CKTapPrewarmReport Core_getPrewarmReport(CKTapContext* context, int8_t wait);
+/// Writes every registered card to [path] for a later Core_prewarm. Private keys are never written
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_saveCardCache(CKTapContext* context, const char* path);
+
+/// Records every card operation of the context from now on, including those of the PC/SC readers started from it, in
+/// the memory-mapped log at [path]. A new log is created with room for [capacity] records, or 65536 when it's 0, while
+/// an existing one is appended to. Opening another log closes this one, it's also closed once the context is destroyed
+/// and the readers started from it have stopped. See tools/audit_log_reader.cpp to read it
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_openAuditLog(CKTapContext* context, const char* path, int64_t capacity);
+/// Flushes the context's audit log to storage. Records survive the app crashing without this, only power loss needs it
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Core_syncAuditLog(CKTapContext* context);
+/// Flushes and closes the context's audit log, its operations are no longer recorded
+FFI_FUNC_EXPORT void Core_closeAuditLog(CKTapContext* context);
 
 // ----------------------------------------------
 // CKTapCard:
 
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode CKTapCard_beginWait();
-FFI_FUNC_EXPORT WaitResponseParams CKTapCard_getWaitResponse();
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode CKTapCard_beginWait(CKTapContext* context);
+FFI_FUNC_EXPORT WaitResponseParams CKTapCard_getWaitResponse(CKTapContext* context);
 
 // ----------------------------------------------
 // Satscard:
 
 /// Gets a C representation of parameters required to construct a [Satscard] in dart. Note: must use
 /// [Utility_freeSatscardConstructorParams] when you are finished using the data to deallocate memory
-FFI_FUNC_EXPORT SatscardConstructorParams Satscard_createConstructorParams(int32_t handle);
-FFI_FUNC_EXPORT SatscardSyncParams Satscard_createSyncParams(int32_t handle);
-
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getActiveSlot(int32_t handle);
-FFI_FUNC_EXPORT SlotToWifResponse Satscard_slotToWif(int32_t handle, int32_t index);
-
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginCertificateCheck();
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginGetSlot(int32_t slot, const char* spendCode);
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginListSlots(const char* spendCode, int32_t limit);
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginNew(const char* chainCode, const char* spendCode);
-FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginUnseal(const char* spendCode);
-
-FFI_FUNC_EXPORT CertificateCheckParams Satscard_getCertificateCheckResponse();
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getGetSlotResponse(int32_t handle);
-FFI_FUNC_EXPORT SatscardListSlotsParams Satscard_getListSlotsResponse(int32_t handle);
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getNewResponse(int32_t handle);
-FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getUnsealResponse(int32_t handle);
+FFI_FUNC_EXPORT SatscardConstructorParams Satscard_createConstructorParams(CKTapContext* context, int32_t handle);
+FFI_FUNC_EXPORT SatscardSyncParams Satscard_createSyncParams(CKTapContext* context, int32_t handle);
+
+/// Batch versions of the above which fill `outParams[i]` for each `handles[i]`. Both arrays are owned by the caller
+/// and must hold at least `count` elements. Each element has its own status, use the matching
+/// Utility_free*Batch function to free the contents of every element at once
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_createConstructorParamsBatch(CKTapContext* context, const int32_t* handles, int32_t count, SatscardConstructorParams* outParams);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_createSyncParamsBatch(CKTapContext* context, const int32_t* handles, int32_t count, SatscardSyncParams* outParams);
+
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getActiveSlot(CKTapContext* context, int32_t handle);
+FFI_FUNC_EXPORT SlotToWifResponse Satscard_slotToWif(CKTapContext* context, int32_t handle, int32_t index);
+/// Converts every unsealed slot of the given satscards to a WIF in parallel, pass a null `handles` to export every
+/// registered satscard. Reports how long the conversion took along with its throughput. Note: must use
+/// [Utility_freeSatscardWifBatch] when you are finished using the data to zero and deallocate memory
+FFI_FUNC_EXPORT SatscardWifBatch Satscard_exportWifsBatch(CKTapContext* context, const int32_t* handles, int32_t count);
+/// Checks that every stored slot's address was derived from its public key, across every registered satscard.
+/// Note: must use [Utility_freeSlotAddressVerification] when you are finished using the data to deallocate memory
+FFI_FUNC_EXPORT SlotAddressVerification Satscard_verifySlotAddresses(CKTapContext* context);
+
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginCertificateCheck(CKTapContext* context);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginGetSlot(CKTapContext* context, int32_t slot, const char* spendCode);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginListSlots(CKTapContext* context, const char* spendCode, int32_t limit);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginNew(CKTapContext* context, const char* chainCode, const char* spendCode);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Satscard_beginUnseal(CKTapContext* context, const char* spendCode);
+
+FFI_FUNC_EXPORT CertificateCheckParams Satscard_getCertificateCheckResponse(CKTapContext* context);
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getGetSlotResponse(CKTapContext* context, int32_t handle);
+FFI_FUNC_EXPORT SatscardListSlotsParams Satscard_getListSlotsResponse(CKTapContext* context, int32_t handle);
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getNewResponse(CKTapContext* context, int32_t handle);
+FFI_FUNC_EXPORT SatscardSlotResponse Satscard_getUnsealResponse(CKTapContext* context, int32_t handle);
 
 // ----------------------------------------------
 // Tapsigner:
 
 /// Gets a C representation of parameters required to construct a [Tapsigner] in dart. Note: must use
 /// [Utility_freeTapsignerConstructorParams] when you are finished using the data to deallocate memory
-FFI_FUNC_EXPORT TapsignerConstructorParams Tapsigner_createConstructorParams(int32_t handle);
-FFI_FUNC_EXPORT TapsignerSyncParams Tapsigner_createSyncParams(int32_t handle);
+FFI_FUNC_EXPORT TapsignerConstructorParams Tapsigner_createConstructorParams(CKTapContext* context, int32_t handle);
+FFI_FUNC_EXPORT TapsignerSyncParams Tapsigner_createSyncParams(CKTapContext* context, int32_t handle);
+
+/// Batch versions of the above, see [Satscard_createConstructorParamsBatch] for details
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Tapsigner_createConstructorParamsBatch(CKTapContext* context, const int32_t* handles, int32_t count, TapsignerConstructorParams* outParams);
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Tapsigner_createSyncParamsBatch(CKTapContext* context, const int32_t* handles, int32_t count, TapsignerSyncParams* outParams);
+
+// ----------------------------------------------
+// Readers:
+
+/// Starts a native worker for every connected PC/SC reader, each one performing a handshake with the given card type
+/// on every card placed on it. The cards are added through the pipeline of [context], see [Core_pollPipelinedCards]. Only
+/// available in Linux builds with CKTAP_ENABLE_PCSC, otherwise returns pcscNotAvailable
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Reader_startAll(CKTapContext* context, int32_t cardType);
+/// Cancels any session in progress and waits for every reader worker to exit
+FFI_FUNC_EXPORT CKTapInterfaceErrorCode Reader_stopAll();
+/// Per-reader session counts and the combined throughput since the readers were started. Note: must use
+/// [Utility_freeCKTapReaderStatsList] when you are finished using the data to deallocate memory
+FFI_FUNC_EXPORT CKTapReaderStatsList Reader_getStats();
 
 // ----------------------------------------------
 // Utility:
 
 FFI_FUNC_EXPORT void Utility_freeCBinaryArray(CBinaryArray array);
+FFI_FUNC_EXPORT void Utility_freeCKTapChangedCards(CKTapChangedCards changedCards);
 FFI_FUNC_EXPORT void Utility_freeCKTapInterfaceStatus(CKTapInterfaceStatus status);
+FFI_FUNC_EXPORT void Utility_freeCKTapPipelinedCards(CKTapPipelinedCards cards);
 FFI_FUNC_EXPORT void Utility_freeCKTapProtoException(CKTapProtoException exception);
+FFI_FUNC_EXPORT void Utility_freeCKTapReaderStatsList(CKTapReaderStatsList list);
 FFI_FUNC_EXPORT void Utility_freeCString(char* cString);
 FFI_FUNC_EXPORT void Utility_freeSatscardConstructorParams(SatscardConstructorParams params);
+FFI_FUNC_EXPORT void Utility_freeSatscardConstructorParamsBatch(SatscardConstructorParams* params, int32_t count);
 FFI_FUNC_EXPORT void Utility_freeSatscardListSlotsParams(SatscardListSlotsParams params);
 FFI_FUNC_EXPORT void Utility_freeSatscardSlotResponse(SatscardSlotResponse response);
 FFI_FUNC_EXPORT void Utility_freeSatscardSyncParams(SatscardSyncParams params);
+FFI_FUNC_EXPORT void Utility_freeSatscardSyncParamsBatch(SatscardSyncParams* params, int32_t count);
+FFI_FUNC_EXPORT void Utility_freeSatscardWifBatch(SatscardWifBatch batch);
+FFI_FUNC_EXPORT void Utility_freeSlotAddressVerification(SlotAddressVerification verification);
 FFI_FUNC_EXPORT void Utility_freeSlotConstructorParams(SlotConstructorParams params);
 FFI_FUNC_EXPORT void Utility_freeSlotToWifResponse(SlotToWifResponse response);
 FFI_FUNC_EXPORT void Utility_freeTapsignerConstructorParams(TapsignerConstructorParams params);
+FFI_FUNC_EXPORT void Utility_freeTapsignerConstructorParamsBatch(TapsignerConstructorParams* params, int32_t count);
 FFI_FUNC_EXPORT void Utility_freeTapsignerSyncParams(TapsignerSyncParams params);
+FFI_FUNC_EXPORT void Utility_freeTapsignerSyncParamsBatch(TapsignerSyncParams* params, int32_t count);
 
 #endif // __CKTAP_PROTOCOL__EXPORTS_H__
@@ -0,0 +1,281 @@
+#include <internal/audit_log.h>
+
+// libc
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+/// 1 GiB of records, larger requests are clamped so a typo can't fill the disk
+constexpr int64_t maxAuditLogCapacity = 16 * 1024 * 1024;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+struct AuditLogMapping {
+    uint8_t* base{ nullptr };
+    size_t size{ 0 };
+    AuditLogHeader* header{ nullptr };
+    AuditRecord* records{ nullptr };
+    uint64_t capacity{ 0 };
+#if defined(_WIN32)
+    HANDLE file{ INVALID_HANDLE_VALUE };
+    HANDLE mapping{ nullptr };
+#else
+    int file{ -1 };
+#endif
+};
+
+/// Fields in the mapping which are shared between threads, and processes if the log is opened twice
+static std::atomic<uint64_t>& atomicField(uint64_t& field) noexcept {
+    return *reinterpret_cast<std::atomic<uint64_t>*>(&field);
+}
+
+#if defined(_WIN32)
+static bool openAuditFile(const char* path, AuditLogMapping& log, uint64_t& fileSize) noexcept {
+    log.file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size{ };
+    if (log.file == INVALID_HANDLE_VALUE || !GetFileSizeEx(log.file, &size)) {
+        return false;
+    }
+    fileSize = static_cast<uint64_t>(size.QuadPart);
+    return true;
+}
+
+static bool resizeAuditFile(AuditLogMapping& log, const uint64_t size) noexcept {
+    LARGE_INTEGER end{ };
+    end.QuadPart = static_cast<LONGLONG>(size);
+    return SetFilePointerEx(log.file, end, nullptr, FILE_BEGIN) && SetEndOfFile(log.file);
+}
+
+static bool mapAuditFile(AuditLogMapping& log) noexcept {
+    log.mapping = CreateFileMappingA(log.file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (log.mapping == nullptr) {
+        return false;
+    }
+    log.base = static_cast<uint8_t*>(MapViewOfFile(log.mapping, FILE_MAP_ALL_ACCESS, 0, 0, log.size));
+    return log.base != nullptr;
+}
+
+static bool syncAuditMapping(const AuditLogMapping& log) noexcept {
+    return FlushViewOfFile(log.base, log.size) && FlushFileBuffers(log.file);
+}
+
+static void unmapAuditFile(AuditLogMapping& log) noexcept {
+    if (log.base != nullptr) {
+        UnmapViewOfFile(log.base);
+    }
+    if (log.mapping != nullptr) {
+        CloseHandle(log.mapping);
+    }
+    if (log.file != INVALID_HANDLE_VALUE) {
+        CloseHandle(log.file);
+    }
+}
+#else
+static bool openAuditFile(const char* path, AuditLogMapping& log, uint64_t& fileSize) noexcept {
+    log.file = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    struct stat status{ };
+    if (log.file < 0 || fstat(log.file, &status) != 0) {
+        return false;
+    }
+    fileSize = static_cast<uint64_t>(status.st_size);
+    return true;
+}
+
+static bool resizeAuditFile(AuditLogMapping& log, const uint64_t size) noexcept {
+    // Allocating the blocks up front means a full disk fails here rather than as a SIGBUS on a later append
+#if defined(__linux__)
+    return posix_fallocate(log.file, 0, static_cast<off_t>(size)) == 0;
+#else
+    return ftruncate(log.file, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+static bool mapAuditFile(AuditLogMapping& log) noexcept {
+    void* mapping = mmap(nullptr, log.size, PROT_READ | PROT_WRITE, MAP_SHARED, log.file, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    log.base = static_cast<uint8_t*>(mapping);
+    return true;
+}
+
+static bool syncAuditMapping(const AuditLogMapping& log) noexcept {
+    return msync(log.base, log.size, MS_SYNC) == 0;
+}
+
+static void unmapAuditFile(AuditLogMapping& log) noexcept {
+    if (log.base != nullptr) {
+        munmap(log.base, log.size);
+    }
+    if (log.file >= 0) {
+        close(log.file);
+    }
+}
+#endif
+
+static bool isValidAuditHeader(const AuditLogHeader& header, const uint64_t fileSize) noexcept {
+    return header.magic == auditLogMagic &&
+           header.version == auditLogVersion &&
+           header.recordSize == auditRecordSize &&
+           header.capacity > 0 &&
+           header.capacity <= static_cast<uint64_t>(maxAuditLogCapacity) &&
+           (header.capacity + 1) * auditRecordSize <= fileSize;
+}
+
+/// Opens and maps the file, creating and sizing it when it's empty. [log] holds whatever was opened even when this
+/// fails, so it can be released
+static CKTapInterfaceErrorCode mapAuditLog(const char* path, int64_t capacity, AuditLogMapping& log) noexcept {
+    uint64_t fileSize{ 0 };
+    if (!openAuditFile(path, log, fileSize)) {
+        return CKTapInterfaceErrorCode::auditLogUnavailable;
+    }
+
+    const auto isNew = fileSize == 0;
+    if (isNew) {
+        capacity = capacity > 0 ? (std::min)(capacity, maxAuditLogCapacity) : defaultAuditLogCapacity;
+        fileSize = (static_cast<uint64_t>(capacity) + 1) * auditRecordSize;
+        if (!resizeAuditFile(log, fileSize)) {
+            return CKTapInterfaceErrorCode::auditLogUnavailable;
+        }
+    } else if (fileSize < sizeof(AuditLogHeader)) {
+        return CKTapInterfaceErrorCode::auditLogIncompatible;
+    }
+
+    log.size = static_cast<size_t>(fileSize);
+    if (!mapAuditFile(log)) {
+        return CKTapInterfaceErrorCode::auditLogUnavailable;
+    }
+    log.header = reinterpret_cast<AuditLogHeader*>(log.base);
+    log.records = reinterpret_cast<AuditRecord*>(log.base + sizeof(AuditLogHeader));
+
+    if (isNew) {
+        AuditLogHeader header{ };
+        header.magic = auditLogMagic;
+        header.version = auditLogVersion;
+        header.recordSize = auditRecordSize;
+        header.capacity = static_cast<uint64_t>(capacity);
+        header.createdMicros = auditTimestampMicros();
+        std::memcpy(log.header, &header, sizeof(header));
+    } else if (!isValidAuditHeader(*log.header, fileSize)) {
+        return CKTapInterfaceErrorCode::auditLogIncompatible;
+    }
+    log.capacity = log.header->capacity;
+    return CKTapInterfaceErrorCode::success;
+}
+
+AuditLog::~AuditLog() {
+    close();
+}
+
+void AuditLog::_retire(AuditLogMapping* mapping) noexcept {
+    if (mapping == nullptr) {
+        return;
+    }
+    while (_writers.load() != 0) {
+        std::this_thread::yield();
+    }
+    syncAuditMapping(*mapping);
+    unmapAuditFile(*mapping);
+    delete mapping;
+}
+
+CKTapInterfaceErrorCode AuditLog::open(const char* path, const int64_t capacity) noexcept {
+    if (path == nullptr || *path == '\0') {
+        return CKTapInterfaceErrorCode::auditLogUnavailable;
+    }
+
+    auto* mapping = new (std::nothrow) AuditLogMapping{ };
+    if (mapping == nullptr) {
+        return CKTapInterfaceErrorCode::auditLogUnavailable;
+    }
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    const auto errorCode = mapAuditLog(path, capacity, *mapping);
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        unmapAuditFile(*mapping);
+        delete mapping;
+        return errorCode;
+    }
+
+    _retire(_mapping.exchange(mapping));
+    return CKTapInterfaceErrorCode::success;
+}
+
+void AuditLog::close() noexcept {
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _retire(_mapping.exchange(nullptr));
+}
+
+CKTapInterfaceErrorCode AuditLog::sync() noexcept {
+    std::lock_guard<std::mutex> lock{ _mutex };
+    const auto* mapping = _mapping.load();
+    if (mapping == nullptr) {
+        return CKTapInterfaceErrorCode::auditLogUnavailable;
+    }
+    return syncAuditMapping(*mapping) ? CKTapInterfaceErrorCode::success : CKTapInterfaceErrorCode::auditLogUnavailable;
+}
+
+bool AuditLog::isOpen() const noexcept {
+    return _mapping.load(std::memory_order_relaxed) != nullptr;
+}
+
+void AuditLog::append(const AuditRecord& record) noexcept {
+    // Registering before loading the mapping pairs with _retire swapping it out before waiting, both sequentially
+    // consistent, so a writer either sees the swap or is waited for
+    _writers.fetch_add(1);
+    const auto* mapping = _mapping.load();
+    if (mapping != nullptr) {
+        const auto position = atomicField(mapping->header->reservedRecords).fetch_add(1, std::memory_order_relaxed);
+        if (position < mapping->capacity) {
+            // Everything but the sequence is copied first, the sequence then publishes the record
+            auto* destination = reinterpret_cast<uint8_t*>(&mapping->records[position]);
+            const auto* source = reinterpret_cast<const uint8_t*>(&record);
+            constexpr auto payloadOffset = sizeof(record.sequence);
+            std::memcpy(destination + payloadOffset, source + payloadOffset, sizeof(AuditRecord) - payloadOffset);
+            atomicField(mapping->records[position].sequence).store(position + 1, std::memory_order_release);
+            _recordsWritten.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            _recordsDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    _writers.fetch_sub(1, std::memory_order_release);
+}
+
+void AuditLog::resetCounts() noexcept {
+    _recordsWritten = 0;
+    _recordsDropped = 0;
+}
+
+int64_t auditTimestampMicros() noexcept {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+const char* auditOperationName(const uint16_t operation) noexcept {
+    switch (static_cast<AuditOperation>(operation)) {
+        case AuditOperation::handshake: return "handshake";
+        case AuditOperation::wait: return "wait";
+        case AuditOperation::certificateCheck: return "certificateCheck";
+        case AuditOperation::getSlot: return "getSlot";
+        case AuditOperation::listSlots: return "listSlots";
+        case AuditOperation::newSlot: return "newSlot";
+        case AuditOperation::unseal: return "unseal";
+    }
+    return "unknown";
+}
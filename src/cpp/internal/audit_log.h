@@ -0,0 +1,119 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_AUDIT_LOG_H__
+#define __CKTAP_PROTOCOL__INTERNAL_AUDIT_LOG_H__
+
+// Project
+#include <enums.h>
+
+// STL
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+constexpr uint32_t auditLogMagic = 0x4C41544B; // "KTAL"
+constexpr uint32_t auditLogVersion = 1;
+constexpr size_t auditRecordSize = 64;
+/// Used when a new log is created without a capacity, 4 MiB of records
+constexpr int64_t defaultAuditLogCapacity = 65536;
+
+/// Operations which are recorded, one record per operation whether or not it succeeded
+enum class AuditOperation : uint16_t {
+    handshake          = 0,
+    wait               = 1,
+    certificateCheck   = 2,
+    getSlot            = 3,
+    listSlots          = 4,
+    newSlot            = 5,
+    unseal             = 6,
+};
+
+/// The first record-sized block of the file. Records follow it back to back, the file is sized for [capacity]
+/// records when it's created so appending never has to grow it
+struct AuditLogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+    uint64_t capacity;
+    /// How many records have been handed out, including any a crash interrupted. Only changed atomically
+    uint64_t reservedRecords;
+    int64_t createdMicros;
+    uint8_t padding[24];
+};
+
+/// One operation as it's stored in the file. Times are microseconds since the Unix epoch
+struct AuditRecord {
+    /// The record's position plus one, written last so a record is only valid once it matches. A crash part way
+    /// through an append leaves it zeroed, which readers skip
+    uint64_t sequence;
+    int64_t startedMicros;
+    int64_t finishedMicros;
+    int32_t errorCode;
+    uint16_t operation;
+    int8_t cardType;
+    /// -1 when the operation isn't about one slot
+    int8_t slotIndex;
+    /// Empty when no card was identified, such as a failed handshake
+    std::array<char, 32> ident;
+};
+static_assert(sizeof(AuditLogHeader) == auditRecordSize);
+static_assert(sizeof(AuditRecord) == auditRecordSize);
+static_assert(std::is_trivially_copyable_v<AuditRecord>);
+
+struct AuditLogMapping;
+
+/// The memory-mapped log a context records its operations in, including those of the PC/SC readers started from it.
+/// Each context has its own, so isolates can log to separate files
+class AuditLog {
+public:
+
+    AuditLog() noexcept = default;
+    AuditLog(const AuditLog&) = delete;
+    AuditLog& operator=(const AuditLog&) = delete;
+    ~AuditLog();
+
+    /// Maps the log at [path], creating it with room for [capacity] records if it doesn't exist. An existing log
+    /// keeps its capacity and is appended to. Replaces any log which is already open, so logs can be rotated
+    CKTapInterfaceErrorCode open(const char* path, int64_t capacity) noexcept;
+
+    /// Stops recording then flushes and unmaps the log, waiting for appends which are already underway
+    void close() noexcept;
+
+    /// Flushes the mapped records to storage. They already survive the process crashing without this, it's only
+    /// needed to survive the device losing power
+    CKTapInterfaceErrorCode sync() noexcept;
+
+    /// Whether a log is open, so callers can skip building a record which would be dropped
+    bool isOpen() const noexcept;
+
+    /// Copies the record into the next free position of the open log. Lock-free and safe from any thread, the
+    /// position is reserved with a single atomic increment. Records are dropped once the log is full
+    void append(const AuditRecord& record) noexcept;
+
+    /// Records appended since the counts were last reset, and those dropped because the log was full
+    int64_t recordsWritten() const noexcept { return _recordsWritten.load(std::memory_order_relaxed); }
+    int64_t recordsDropped() const noexcept { return _recordsDropped.load(std::memory_order_relaxed); }
+    void resetCounts() noexcept;
+
+private:
+
+    /// Waits for appends which loaded [mapping] before it was swapped out, then releases it
+    void _retire(AuditLogMapping* mapping) noexcept;
+
+    /// Only held to open, close and sync the log. Appends never take it, they register in [_writers] instead so
+    /// closing can wait for them to leave the mapping before it's unmapped
+    std::mutex _mutex{ };
+    std::atomic<AuditLogMapping*> _mapping{ nullptr };
+    std::atomic<int32_t> _writers{ 0 };
+    std::atomic<int64_t> _recordsWritten{ 0 };
+    std::atomic<int64_t> _recordsDropped{ 0 };
+};
+
+/// Microseconds since the Unix epoch, used for the record times
+int64_t auditTimestampMicros() noexcept;
+
+const char* auditOperationName(uint16_t operation) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_AUDIT_LOG_H__
@@ -0,0 +1,270 @@
+#include <internal/card_cache.h>
+
+// Project
+#include <internal/globals.h>
+
+// libc
+#include <errno.h>
+
+// STL
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+/// The cache is a plain dump of fixed-size records in native byte order. It only ever moves between runs of the
+/// same app on the same device, so the layout is checked rather than converted
+constexpr uint32_t cardCacheMagic = 0x43544B43; // "CKTC"
+constexpr uint32_t cardCacheVersion = 1;
+/// Anything bigger than this is a corrupt file rather than a real collection
+constexpr uint32_t maxCachedCards = 100000;
+constexpr uint32_t maxCachedDerivationPathLength = 256;
+
+struct CardCacheHeader {
+    uint32_t magic{ cardCacheMagic };
+    uint32_t version{ cardCacheVersion };
+    uint32_t snapshotSize{ sizeof(CardSnapshot) };
+    uint32_t slotRecordSize{ 0 };
+    uint32_t satscardCount{ 0 };
+    uint32_t tapsignerCount{ 0 };
+};
+
+/// Everything [SlotTable] keeps about a slot apart from its private key
+struct CardCacheSlotRecord {
+    int32_t index;
+    int32_t status;
+    char address[slotAddressCapacity];
+    uint8_t publicKey[slotPublicKeySize];
+    uint8_t publicKeyLength;
+    uint8_t masterPublicKey[slotPublicKeySize];
+    uint8_t masterPublicKeyLength;
+    uint8_t chainCode[slotChainCodeSize];
+    uint8_t chainCodeLength;
+};
+
+using CacheFile = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+template <typename T>
+static bool writeCacheValue(std::FILE* file, const T& value) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return std::fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+static bool readCacheValue(std::FILE* file, T& value) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+static bool isTerminated(const char* string, const size_t capacity) noexcept {
+    return std::memchr(string, '\0', capacity) != nullptr;
+}
+
+static bool isValidCachedSnapshot(const CardSnapshot& snapshot, const bool isTapsigner) noexcept {
+    return snapshot.isTapsigner == isTapsigner &&
+           isTerminated(snapshot.ident.data(), snapshot.ident.size()) &&
+           isTerminated(snapshot.appletVersion.data(), snapshot.appletVersion.size());
+}
+
+template <size_t N>
+static void copyCachedKey(uint8_t (&destination)[N], uint8_t& length, const uint8_t* key, const size_t keyLength) noexcept {
+    length = static_cast<uint8_t>(std::min(keyLength, N));
+    std::memcpy(destination, key, length);
+}
+
+template <size_t N>
+static nlohmann::json::binary_t makeCachedKey(const uint8_t (&key)[N], const uint8_t length) {
+    return nlohmann::json::binary_t{ std::vector<uint8_t>(key, key + std::min<size_t>(length, N)) };
+}
+
+static bool writeCachedSatscard(std::FILE* file, const SatscardWrapper& wrapper) noexcept {
+    uint32_t slotCount{ 0 };
+    for (int32_t index{ 0 }; index < static_cast<int32_t>(maxSatscardSlots); ++index) {
+        slotCount += wrapper.slots.contains(index) ? 1 : 0;
+    }
+    if (!writeCacheValue(file, wrapper.snapshot) || !writeCacheValue(file, slotCount)) {
+        return false;
+    }
+
+    for (int32_t index{ 0 }; index < static_cast<int32_t>(maxSatscardSlots); ++index) {
+        if (!wrapper.slots.contains(index)) {
+            continue;
+        }
+
+        const auto& slots = wrapper.slots;
+        CardCacheSlotRecord record{ };
+        record.index = index;
+        record.status = static_cast<int32_t>(slots.status(index));
+        std::strncpy(record.address, slots.address(index), sizeof(record.address) - 1);
+        copyCachedKey(record.publicKey, record.publicKeyLength, slots.publicKey(index), slots.publicKeyLength(index));
+        copyCachedKey(record.masterPublicKey, record.masterPublicKeyLength, slots.masterPublicKey(index), slots.masterPublicKeyLength(index));
+        copyCachedKey(record.chainCode, record.chainCodeLength, slots.chainCode(index), slots.chainCodeLength(index));
+        if (!writeCacheValue(file, record)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool writeCachedTapsigner(std::FILE* file, const TapsignerWrapper& wrapper) noexcept {
+    const auto length = static_cast<uint32_t>(std::min<size_t>(wrapper.derivationPath.size(), maxCachedDerivationPathLength));
+    return writeCacheValue(file, wrapper.snapshot) &&
+           writeCacheValue(file, length) &&
+           std::fwrite(wrapper.derivationPath.data(), 1, length, file) == length;
+}
+
+static bool readCachedSatscard(std::FILE* file, CachedSatscard& satscard) {
+    uint32_t slotCount{ 0 };
+    if (!readCacheValue(file, satscard.snapshot) || !isValidCachedSnapshot(satscard.snapshot, false) ||
+        !readCacheValue(file, slotCount) || slotCount > maxSatscardSlots) {
+        return false;
+    }
+
+    for (uint32_t i{ 0 }; i < slotCount; ++i) {
+        CardCacheSlotRecord record{ };
+        if (!readCacheValue(file, record) || !isTerminated(record.address, sizeof(record.address)) ||
+            record.status < CKTapSatscardSlotStatus::UNUSED || record.status > CKTapSatscardSlotStatus::UNSEALED) {
+            return false;
+        }
+
+        tap_protocol::Satscard::Slot slot{ };
+        slot.index = record.index;
+        slot.status = static_cast<tap_protocol::Satscard::SlotStatus>(record.status);
+        slot.address = record.address;
+        slot.pubkey = makeCachedKey(record.publicKey, record.publicKeyLength);
+        slot.master_pk = makeCachedKey(record.masterPublicKey, record.masterPublicKeyLength);
+        slot.chain_code = makeCachedKey(record.chainCode, record.chainCodeLength);
+        if (!satscard.slots.store(slot)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readCachedTapsigner(std::FILE* file, CachedTapsigner& tapsigner) {
+    uint32_t length{ 0 };
+    if (!readCacheValue(file, tapsigner.snapshot) || !isValidCachedSnapshot(tapsigner.snapshot, true) ||
+        !readCacheValue(file, length) || length > maxCachedDerivationPathLength) {
+        return false;
+    }
+
+    tapsigner.derivationPath.resize(length);
+    return std::fread(tapsigner.derivationPath.data(), 1, length, file) == length;
+}
+
+CKTapInterfaceErrorCode saveCardCache(const char* path) noexcept {
+    if (path == nullptr || *path == '\0') {
+        return CKTapInterfaceErrorCode::cardCacheUnwritable;
+    }
+
+    try {
+        // Written beside the cache then renamed over it, so a crash midway leaves the previous cache intact
+        const auto temporaryPath = std::string{ path } + ".tmp";
+        CacheFile file{ std::fopen(temporaryPath.c_str(), "wb"), std::fclose };
+        if (!file) {
+            return CKTapInterfaceErrorCode::cardCacheUnwritable;
+        }
+
+        const auto& context = currentContext();
+        CardCacheHeader header{ };
+        header.slotRecordSize = sizeof(CardCacheSlotRecord);
+        header.satscardCount = static_cast<uint32_t>(std::min<size_t>(context.satscards.size(), maxCachedCards));
+        header.tapsignerCount = static_cast<uint32_t>(std::min<size_t>(context.tapsigners.size(), maxCachedCards));
+
+        auto isWritten = writeCacheValue(file.get(), header);
+        for (uint32_t i{ 0 }; isWritten && i < header.satscardCount; ++i) {
+            isWritten = writeCachedSatscard(file.get(), context.satscards[i]);
+        }
+        for (uint32_t i{ 0 }; isWritten && i < header.tapsignerCount; ++i) {
+            isWritten = writeCachedTapsigner(file.get(), context.tapsigners[i]);
+        }
+        isWritten = isWritten && std::fflush(file.get()) == 0;
+        isWritten = std::fclose(file.release()) == 0 && isWritten;
+
+        if (!isWritten || std::rename(temporaryPath.c_str(), path) != 0) {
+            std::remove(temporaryPath.c_str());
+            return CKTapInterfaceErrorCode::cardCacheUnwritable;
+        }
+        return CKTapInterfaceErrorCode::success;
+    } catch (...) {
+        return CKTapInterfaceErrorCode::cardCacheUnwritable;
+    }
+}
+
+Result<CardCache> loadCardCache(const std::string& path) noexcept {
+    using CacheResult = Result<CardCache>;
+
+    try {
+        CacheFile file{ std::fopen(path.c_str(), "rb"), std::fclose };
+        if (!file) {
+            // Nothing has been cached yet on the first launch
+            return errno == ENOENT ? CacheResult{ CardCache{ } } : CacheResult::failure(CKTapInterfaceErrorCode::cardCacheUnreadable);
+        }
+
+        CardCacheHeader header{ };
+        if (!readCacheValue(file.get(), header) ||
+            header.magic != cardCacheMagic ||
+            header.version != cardCacheVersion ||
+            header.snapshotSize != sizeof(CardSnapshot) ||
+            header.slotRecordSize != sizeof(CardCacheSlotRecord) ||
+            header.satscardCount > maxCachedCards ||
+            header.tapsignerCount > maxCachedCards) {
+            return CacheResult::failure(CKTapInterfaceErrorCode::cardCacheUnreadable);
+        }
+
+        CardCache cache{ };
+        cache.satscards.resize(header.satscardCount);
+        for (auto& satscard : cache.satscards) {
+            if (!readCachedSatscard(file.get(), satscard)) {
+                return CacheResult::failure(CKTapInterfaceErrorCode::cardCacheUnreadable);
+            }
+        }
+        cache.tapsigners.resize(header.tapsignerCount);
+        for (auto& tapsigner : cache.tapsigners) {
+            if (!readCachedTapsigner(file.get(), tapsigner)) {
+                return CacheResult::failure(CKTapInterfaceErrorCode::cardCacheUnreadable);
+            }
+        }
+        return CacheResult{ std::move(cache) };
+    } catch (...) {
+        return CacheResult::failure(CKTapInterfaceErrorCode::cardCacheUnreadable);
+    }
+}
+
+/// Adds a detached card restored from the cache unless a card with its ident is already registered
+template <typename WrapperType, typename... Args>
+static bool registerCachedCard(std::vector<WrapperType>& wrappers, CardIdentIndex& idents, const CardSnapshot& snapshot,
+                               Args&&... args) {
+    const auto index = wrappers.size();
+    if (!idents.emplace(snapshot.ident, index).second) {
+        return false;
+    }
+    try {
+        wrappers.emplace_back(snapshot, std::forward<Args>(args)...);
+    } catch (...) {
+        idents.erase(snapshot.ident);
+        throw;
+    }
+    return true;
+}
+
+void registerCachedCards(const CardCache& cache, int32_t& satscardCount, int32_t& tapsignerCount) noexcept {
+    satscardCount = 0;
+    tapsignerCount = 0;
+    auto& context = currentContext();
+    try {
+        for (const auto& satscard : cache.satscards) {
+            if (registerCachedCard(context.satscards, context.satscardIdents, satscard.snapshot, satscard.slots)) {
+                markCardAdded(CKTapCardType::satscard, context.satscards.size() - 1);
+                ++satscardCount;
+            }
+        }
+        for (const auto& tapsigner : cache.tapsigners) {
+            if (registerCachedCard(context.tapsigners, context.tapsignerIdents, tapsigner.snapshot, tapsigner.derivationPath)) {
+                markCardAdded(CKTapCardType::tapsigner, context.tapsigners.size() - 1);
+                ++tapsignerCount;
+            }
+        }
+    } catch (...) { }
+}
@@ -0,0 +1,44 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CARD_CACHE_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CARD_CACHE_H__
+
+// Project
+#include <internal/card_snapshot.h>
+#include <internal/result.h>
+#include <internal/slot_table.h>
+#include <structs.h>
+
+// STL
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct CachedSatscard {
+    CardSnapshot snapshot{ };
+    SlotTable slots{ };
+};
+
+struct CachedTapsigner {
+    CardSnapshot snapshot{ };
+    std::string derivationPath{ };
+};
+
+/// The registry as it was when the cache was saved. Private keys are never written, so unsealed slots restored
+/// from the cache can't be exported until the card is read again
+struct CardCache {
+    std::vector<CachedSatscard> satscards{ };
+    std::vector<CachedTapsigner> tapsigners{ };
+};
+
+/// Writes every registered card to [path], replacing the previous cache in one step. Must be called from the
+/// caller's thread like anything else touching the registry
+CKTapInterfaceErrorCode saveCardCache(const char* path) noexcept;
+
+/// Reads a cache written by [saveCardCache] without touching the registry, so it's safe on any thread. A missing
+/// file gives an empty cache, a cache from another build of the library is rejected
+Result<CardCache> loadCardCache(const std::string& path) noexcept;
+
+/// Registers the cached cards detached, skipping any which are already registered since those are more recent.
+/// Returns how many of each type were added through [satscardCount] and [tapsignerCount]
+void registerCachedCards(const CardCache& cache, int32_t& satscardCount, int32_t& tapsignerCount) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CARD_CACHE_H__
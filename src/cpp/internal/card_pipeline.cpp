@@ -0,0 +1,386 @@
+#include <internal/card_pipeline.h>
+
+// Project
+#include <internal/card_snapshot.h>
+#include <internal/globals.h>
+#include <internal/macros.h>
+#include <internal/slot_verification.h>
+#include <internal/tap_protocol_thread.h>
+#include <internal/utils.h>
+
+// STL
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/// Everything a worker prepares for one card, only the registry update is left for the caller's thread
+struct ProcessedCard {
+    std::unique_ptr<tap_protocol::Satscard> satscard{ };
+    std::unique_ptr<tap_protocol::Tapsigner> tapsigner{ };
+    std::optional<tap_protocol::Satscard::Slot> activeSlot{ };
+    CKTapPipelinedCard entry{ };
+    bool shouldDetach{ false };
+};
+
+/// A card waiting for the pipeline's worker
+struct SubmittedCard {
+    std::unique_ptr<tap_protocol::Satscard> satscard{ };
+    std::unique_ptr<tap_protocol::Tapsigner> tapsigner{ };
+    int64_t ticket{ 0 };
+    std::chrono::steady_clock::time_point submitted{ };
+    bool shouldDetach{ false };
+};
+
+/// Each context has its own, the PC/SC readers hold on to the one of the context which started them. A single
+/// worker, started with the first card, processes the cards in the order they were submitted and hands them back
+/// through [processedCards]. Keeping it running saves starting a thread for every card
+struct CardPipeline {
+    std::mutex mutex{ };
+    std::condition_variable workSubmitted{ };
+    std::condition_variable workProcessed{ };
+    std::deque<SubmittedCard> submittedCards{ };
+    std::deque<ProcessedCard> processedCards{ };
+    bool isProcessing{ false };
+    bool isStopping{ false };
+    std::thread worker{ };
+    int64_t nextTicket{ 1 };
+
+    CardPipeline() noexcept = default;
+    CardPipeline(const CardPipeline&) = delete;
+    CardPipeline& operator=(const CardPipeline&) = delete;
+    ~CardPipeline();
+
+    /// Cards submitted but not yet taken by the caller
+    size_t cardCount() const noexcept {
+        return submittedCards.size() + processedCards.size() + (isProcessing ? 1 : 0);
+    }
+};
+
+static CKTapPipelinedCard makePipelinedCard(const int64_t ticket, const CKTapCardType type) noexcept {
+    CKTapPipelinedCard entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.ticket = ticket;
+    entry.response = makeTapOperationResponse(CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction);
+    entry.response.handle.type = type;
+    return entry;
+}
+
+/// The constructor params are filled with a placeholder handle, the real one is only known once the card has
+/// been registered
+static ProcessedCard processSatscard(std::unique_ptr<tap_protocol::Satscard> satscard, const int64_t ticket,
+                                     const std::chrono::steady_clock::time_point submitted) noexcept {
+    ProcessedCard processed{ };
+    auto& entry = processed.entry;
+    entry = makePipelinedCard(ticket, CKTapCardType::satscard);
+
+    auto& status = entry.satscard.status;
+    status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    try {
+        const auto snapshot = makeCardSnapshot(*satscard);
+        fillConstructorParams(entry.satscard.base, 0, snapshot);
+        entry.satscard.activeSlotIndex = snapshot.activeSlotIndex;
+        entry.satscard.numSlots = snapshot.numSlots;
+        entry.satscard.hasUnusedSlots = snapshot.hasUnusedSlots ? 1 : 0;
+        entry.satscard.isUsedUp = snapshot.isUsedUp ? 1 : 0;
+
+        auto slot = satscard->GetActiveSlot();
+        if (!slot.pubkey.empty()) {
+            const auto isVerified = isSlotAddressDerivedFrom(slot.pubkey.data(), slot.pubkey.size(), slot.address.c_str(),
+                                                             snapshot.isTestnet);
+            entry.isActiveSlotChecked = 1;
+            entry.isActiveSlotVerified = isVerified ? 1 : 0;
+        }
+        processed.activeSlot = std::move(slot);
+        status.errorCode = CKTapInterfaceErrorCode::success;
+    } CATCH_TAP_PROTO_EXCEPTION(e, {
+        status.errorCode = CKTapInterfaceErrorCode::caughtTapProtocolException;
+        status.exception = allocateCKTapProtoException(e);
+    }) catch (...) {}
+
+    entry.response.errorCode = status.errorCode;
+    processed.satscard = std::move(satscard);
+    entry.processingMicros = microsSince(submitted);
+    return processed;
+}
+
+static ProcessedCard processTapsigner(std::unique_ptr<tap_protocol::Tapsigner> tapsigner, const int64_t ticket,
+                                      const std::chrono::steady_clock::time_point submitted) noexcept {
+    ProcessedCard processed{ };
+    auto& entry = processed.entry;
+    entry = makePipelinedCard(ticket, CKTapCardType::tapsigner);
+
+    auto& status = entry.tapsigner.status;
+    status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    try {
+        const auto snapshot = makeCardSnapshot(*tapsigner);
+        fillConstructorParams(entry.tapsigner.base, 0, snapshot);
+        entry.tapsigner.numberOfBackups = snapshot.numberOfBackups;
+        entry.tapsigner.derivationPath = allocateCStringFromCpp(tapsigner->GetDerivationPath().value_or(std::string{ }));
+        status.errorCode = CKTapInterfaceErrorCode::success;
+    } CATCH_TAP_PROTO_EXCEPTION(e, {
+        status.errorCode = CKTapInterfaceErrorCode::caughtTapProtocolException;
+        status.exception = allocateCKTapProtoException(e);
+    }) catch (...) {}
+
+    entry.response.errorCode = status.errorCode;
+    processed.tapsigner = std::move(tapsigner);
+    entry.processingMicros = microsSince(submitted);
+    return processed;
+}
+
+static void freePipelinedCard(CKTapPipelinedCard& entry) noexcept {
+    freeCKTapInterfaceStatus(entry.satscard.status);
+    freeSatscardConstructorParams(entry.satscard);
+    freeCKTapInterfaceStatus(entry.tapsigner.status);
+    freeTapsignerConstructorParams(entry.tapsigner);
+}
+
+static void runPipelineWorker(CardPipeline& pipeline) noexcept {
+    std::unique_lock<std::mutex> lock{ pipeline.mutex };
+    while (true) {
+        pipeline.workSubmitted.wait(lock, [&pipeline]() {
+            return pipeline.isStopping || !pipeline.submittedCards.empty();
+        });
+        if (pipeline.isStopping) {
+            return;
+        }
+
+        auto card = std::move(pipeline.submittedCards.front());
+        pipeline.submittedCards.pop_front();
+        pipeline.isProcessing = true;
+        lock.unlock();
+
+        auto processed = card.satscard ?
+            processSatscard(std::move(card.satscard), card.ticket, card.submitted) :
+            processTapsigner(std::move(card.tapsigner), card.ticket, card.submitted);
+        processed.shouldDetach = card.shouldDetach;
+
+        lock.lock();
+        pipeline.isProcessing = false;
+        try {
+            pipeline.processedCards.push_back(std::move(processed));
+        } catch (...) {
+            // Without room to hand it back the card is dropped, its ticket is never polled
+            freePipelinedCard(processed.entry);
+        }
+        pipeline.workProcessed.notify_all();
+    }
+}
+
+CardPipeline::~CardPipeline() {
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        isStopping = true;
+    }
+    workSubmitted.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    for (auto& processed : processedCards) {
+        freePipelinedCard(processed.entry);
+    }
+}
+
+/// Cards which failed on the worker are reported but never registered
+static void registerProcessedCard(ProcessedCard& processed) noexcept {
+    auto& entry = processed.entry;
+    if (entry.response.errorCode != CKTapInterfaceErrorCode::success) {
+        return;
+    }
+
+    auto& context = currentContext();
+    const auto type = entry.response.handle.type;
+    const auto index = type == CKTapCardType::satscard ?
+        updateVectorWithCard(context.satscards, context.satscardIdents, processed.satscard) :
+        updateVectorWithCard(context.tapsigners, context.tapsignerIdents, processed.tapsigner);
+    if (index == invalidIndex) {
+        entry.response.errorCode = CKTapInterfaceErrorCode::invalidHandlingOfCardDuringFinalization;
+        return;
+    }
+
+    const auto handle = static_cast<int32_t>(index);
+    markCardAdded(type, index);
+    if (processed.activeSlot.has_value()) {
+        storeSatscardSlot(handle, std::move(*processed.activeSlot));
+        processed.activeSlot.reset();
+    }
+
+    // The card's transport belongs to the thread which tapped it, so cards from other threads are only kept as
+    // snapshots and get reattached by the protocol thread when they're next used
+    if (processed.shouldDetach) {
+        if (type == CKTapCardType::satscard) {
+            context.satscards[index].card.reset();
+        } else {
+            context.tapsigners[index].card.reset();
+        }
+    }
+
+    entry.response.handle.index = handle;
+    entry.satscard.base.handle = type == CKTapCardType::satscard ? handle : 0;
+    entry.tapsigner.base.handle = type == CKTapCardType::tapsigner ? handle : 0;
+}
+
+std::shared_ptr<CardPipeline> currentCardPipeline() noexcept {
+    auto& context = currentContext();
+    if (context.pipeline == nullptr) {
+        try {
+            context.pipeline = std::make_shared<CardPipeline>();
+        } catch (...) { }
+    }
+    return context.pipeline;
+}
+
+CKTapPipelineTicket submitPipelinedCard(CardPipeline& pipeline, TapProtocolThread& thread, const bool shouldDetach) noexcept {
+    CKTapPipelineTicket result{ 0, CKTapInterfaceErrorCode::success };
+    const auto fail = [&result](const CKTapInterfaceErrorCode errorCode) {
+        result.errorCode = errorCode;
+        return result;
+    };
+
+    if (!thread.hasStarted()) {
+        return fail(CKTapInterfaceErrorCode::threadNotYetStarted);
+    }
+    if (thread.isThreadActive()) {
+        return fail(CKTapInterfaceErrorCode::operationStillInProgress);
+    }
+    if (thread.getRecentErrorCode() == CKTapInterfaceErrorCode::pending) {
+        return fail(CKTapInterfaceErrorCode::threadNotYetFinalized);
+    }
+    if (thread.hasFailed() || !thread.getConstructedCardType().has_value()) {
+        return fail(CKTapInterfaceErrorCode::operationFailed);
+    }
+
+    std::unique_lock<std::mutex> lock{ pipeline.mutex };
+    if (pipeline.cardCount() >= maxPipelinedCards) {
+        return fail(CKTapInterfaceErrorCode::pipelineQueueFull);
+    }
+
+    const auto ticket = pipeline.nextTicket;
+    try {
+        if (!pipeline.worker.joinable()) {
+            pipeline.worker = std::thread{ runPipelineWorker, std::ref(pipeline) };
+        }
+
+        SubmittedCard card{ };
+        card.ticket = ticket;
+        card.submitted = std::chrono::steady_clock::now();
+        card.shouldDetach = shouldDetach;
+        const auto type = thread.getConstructedCardType().value();
+        if (type == CKTapCardType::satscard) {
+            card.satscard = thread.releaseConstructedSatscard();
+            if (!card.satscard) {
+                return fail(CKTapInterfaceErrorCode::expectedSatscardButReceivedNothing);
+            }
+        } else if (type == CKTapCardType::tapsigner) {
+            card.tapsigner = thread.releaseConstructedTapsigner();
+            if (!card.tapsigner) {
+                return fail(CKTapInterfaceErrorCode::expectedTapsignerButReceivedNothing);
+            }
+        } else {
+            return fail(CKTapInterfaceErrorCode::invalidCardDuringHandshake);
+        }
+        pipeline.submittedCards.push_back(std::move(card));
+    } catch (...) {
+        return fail(CKTapInterfaceErrorCode::threadAllocationFailed);
+    }
+
+    ++pipeline.nextTicket;
+    lock.unlock();
+    pipeline.workSubmitted.notify_one();
+    result.ticket = ticket;
+    return result;
+}
+
+CKTapPipelineTicket enqueuePipelinedCard() noexcept {
+    auto& context = currentContext();
+    if (context.protocolThread == nullptr) {
+        return CKTapPipelineTicket{ 0, CKTapInterfaceErrorCode::libraryNotInitialized };
+    }
+    const auto pipeline = currentCardPipeline();
+    if (pipeline == nullptr) {
+        return CKTapPipelineTicket{ 0, CKTapInterfaceErrorCode::unexpectedStdException };
+    }
+
+    const auto result = submitPipelinedCard(*pipeline, *context.protocolThread, false);
+    if (result.errorCode != CKTapInterfaceErrorCode::success) {
+        return result;
+    }
+
+    // The card now belongs to the worker, so the transport is free for the next handshake. A failed reset is
+    // reported again by Core_beginAsyncHandshake
+    context.operationCard = CKTapCardHandle{ -1, CKTapCardType::unknownCard };
+    context.protocolThread->reset();
+    return result;
+}
+
+CKTapPipelinedCards pollPipelinedCards(const bool wait) noexcept {
+    CKTapPipelinedCards cards;
+    std::memset(&cards, 0, sizeof(cards));
+    cards.status.errorCode = CKTapInterfaceErrorCode::success;
+
+    const auto pipeline = currentCardPipeline();
+    if (pipeline == nullptr) {
+        cards.status.errorCode = CKTapInterfaceErrorCode::unexpectedStdException;
+        return cards;
+    }
+
+    // Readers may submit while the caller is polling, so the finished cards are taken out under the lock and
+    // registered after it's released
+    std::vector<ProcessedCard> readyCards{ };
+    try {
+        std::unique_lock<std::mutex> lock{ pipeline->mutex };
+        if (wait) {
+            pipeline->workProcessed.wait(lock, [&pipeline]() {
+                return pipeline->submittedCards.empty() && !pipeline->isProcessing;
+            });
+        }
+
+        auto& processedCards = pipeline->processedCards;
+        readyCards.reserve(processedCards.size());
+        while (!processedCards.empty()) {
+            readyCards.push_back(std::move(processedCards.front()));
+            processedCards.pop_front();
+        }
+        cards.pendingCount = static_cast<int32_t>(pipeline->cardCount());
+    } catch (...) {
+        cards.status.errorCode = CKTapInterfaceErrorCode::unexpectedStdException;
+        return cards;
+    }
+
+    if (readyCards.empty()) {
+        return cards;
+    }
+
+    cards.array = allocateCArray<CKTapPipelinedCard>(readyCards.size());
+    if (cards.array == nullptr) {
+        cards.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+        return cards;
+    }
+
+    // Registering in submission order keeps handles stable when the same card was tapped twice in a row
+    for (auto& processed : readyCards) {
+        registerProcessedCard(processed);
+        cards.array[cards.length++] = processed.entry;
+    }
+
+    detachIdleCards();
+    return cards;
+}
+
+void freePipelinedCards(CKTapPipelinedCards& cards) noexcept {
+    freeCKTapInterfaceStatus(cards.status);
+    if (cards.array == nullptr) {
+        return;
+    }
+
+    for (int32_t i{ 0 }; i < cards.length; ++i) {
+        freePipelinedCard(cards.array[i]);
+    }
+    freePointer(cards.array);
+}
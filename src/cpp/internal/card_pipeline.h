@@ -0,0 +1,38 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CARD_PIPELINE_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CARD_PIPELINE_H__
+
+// Project
+#include <structs.h>
+
+// STL
+#include <cstddef>
+#include <memory>
+
+// Types
+class TapProtocolThread;
+struct CardPipeline;
+
+/// How many cards may be waiting for post-processing or registration before the caller has to poll
+constexpr size_t maxPipelinedCards = 8;
+
+/// Takes the card constructed by the finished handshake and resets the protocol thread, so the next card's
+/// handshake can start straight away. Taking the snapshot, checking the active slot's address and building the
+/// constructor params happen on the pipeline's worker thread while the next card is being tapped. Registering the
+/// card stays on the thread that polls, as the context's card lists aren't shared between threads
+CKTapPipelineTicket enqueuePipelinedCard() noexcept;
+
+/// The current context's pipeline, created the first time it's needed. Null when it couldn't be allocated
+std::shared_ptr<CardPipeline> currentCardPipeline() noexcept;
+
+/// Takes the card constructed by the thread's finished handshake and starts post-processing it. Safe to call from
+/// any thread, the native reader workers submit their cards this way. The thread isn't reset. Set [shouldDetach]
+/// when the thread isn't the context's protocol thread, the card is then registered without its live object
+CKTapPipelineTicket submitPipelinedCard(CardPipeline& pipeline, TapProtocolThread& thread, bool shouldDetach) noexcept;
+
+/// Registers the processed cards in the order they were enqueued, stopping at the first one which isn't ready
+/// yet unless [wait] is set. The registry is only ever changed here, on the caller's thread
+CKTapPipelinedCards pollPipelinedCards(bool wait) noexcept;
+
+void freePipelinedCards(CKTapPipelinedCards& cards) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CARD_PIPELINE_H__
@@ -0,0 +1,87 @@
+#include <internal/card_snapshot.h>
+
+// Project
+#include <internal/utils.h>
+
+// STL
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+/// Copies as much of the string as fits whilst leaving room for the null terminator
+template <size_t N>
+static void copyToFixedString(std::array<char, N>& destination, const std::string& source) noexcept {
+    const auto length = std::min(source.size(), N - 1);
+    std::memcpy(destination.data(), source.data(), length);
+    destination[length] = '\0';
+}
+
+static CardSnapshot makeBaseSnapshot(const tap_protocol::CKTapCard& card) {
+    CardSnapshot snapshot{ };
+    copyToFixedString(snapshot.ident, card.GetIdent());
+    copyToFixedString(snapshot.appletVersion, card.GetAppletVersion());
+    snapshot.authDelay = card.GetAuthDelay();
+    snapshot.birthHeight = card.GetBirthHeight();
+    snapshot.isTapsigner = card.IsTapsigner();
+    snapshot.isCertsChecked = card.IsCertsChecked();
+    snapshot.isTampered = card.IsTampered();
+    snapshot.isTestnet = card.IsTestnet();
+    snapshot.needSetup = card.NeedSetup();
+    return snapshot;
+}
+
+CardSnapshot makeCardSnapshot(const tap_protocol::Satscard& satscard) {
+    auto snapshot = makeBaseSnapshot(satscard);
+    snapshot.hasUnusedSlots = satscard.HasUnusedSlots();
+    snapshot.isUsedUp = satscard.IsUsedUp();
+    snapshot.activeSlotIndex = satscard.GetActiveSlotIndex();
+    snapshot.numSlots = satscard.GetNumSlots();
+    return snapshot;
+}
+
+CardSnapshot makeCardSnapshot(const tap_protocol::Tapsigner& tapsigner) {
+    auto snapshot = makeBaseSnapshot(tapsigner);
+    snapshot.numberOfBackups = tapsigner.GetNumberOfBackups();
+    return snapshot;
+}
+
+bool hasIdent(const CardSnapshot& snapshot, const std::string& ident) noexcept {
+    return ident.size() < snapshot.ident.size() && ident == snapshot.ident.data();
+}
+
+bool makeCardIdent(const std::string& ident, CardIdent& output) noexcept {
+    if (ident.size() >= output.size()) {
+        return false;
+    }
+    copyToFixedString(output, ident);
+    return true;
+}
+
+size_t CardIdentHash::operator()(const CardIdent& ident) const noexcept {
+    const auto length = static_cast<size_t>(std::find(ident.begin(), ident.end(), '\0') - ident.begin());
+    return std::hash<std::string_view>{ }(std::string_view{ ident.data(), length });
+}
+
+bool CardIdentEqual::operator()(const CardIdent& first, const CardIdent& second) const noexcept {
+    return std::strncmp(first.data(), second.data(), first.size()) == 0;
+}
+
+void fillConstructorParams(CKTapCardConstructorParams& params, const size_t index, const CardSnapshot& snapshot) {
+    params.handle = static_cast<int32_t>(index);
+    params.type = snapshot.isTapsigner ? CKTapCardType::tapsigner : CKTapCardType::satscard;
+    params.ident = allocateCStringFromBuffer(snapshot.ident.data());
+    params.appletVersion = allocateCStringFromBuffer(snapshot.appletVersion.data());
+    params.authDelay = snapshot.authDelay;
+    params.birthHeight = snapshot.birthHeight;
+    params.isCertsChecked = snapshot.isCertsChecked ? 1 : 0;
+    params.isTampered = snapshot.isTampered ? 1 : 0;
+    params.isTestnet = snapshot.isTestnet ? 1 : 0;
+    params.needSetup = snapshot.needSetup ? 1 : 0;
+}
+
+void fillSyncParams(CKTapCardSyncParams& params, const CardSnapshot& snapshot) noexcept {
+    params.isCertsChecked = snapshot.isCertsChecked ? 1 : 0;
+    params.needSetup = snapshot.needSetup ? 1 : 0;
+    params.authDelay = snapshot.authDelay;
+}
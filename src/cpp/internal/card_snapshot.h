@@ -0,0 +1,66 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CARD_SNAPSHOT_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CARD_SNAPSHOT_H__
+
+// Project
+#include <structs.h>
+
+// Third party
+#include <tap_protocol/cktapcard.h>
+
+// STL
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+/// A card's ident, null terminated
+using CardIdent = std::array<char, 32>;
+
+/// The read-only state the registry keeps for every card. It's a small trivially copyable value, unlike the
+/// tap_protocol objects which hold a transport closure and JSON state and are only kept while they're in use
+struct CardSnapshot {
+    CardIdent ident{ };
+    std::array<char, 16> appletVersion{ };
+    int32_t authDelay{ 0 };
+    int32_t birthHeight{ 0 };
+    bool isTapsigner{ false };
+    bool isCertsChecked{ false };
+    bool isTampered{ false };
+    bool isTestnet{ false };
+    bool needSetup{ false };
+
+    // Satscard
+    bool hasUnusedSlots{ false };
+    bool isUsedUp{ false };
+    int32_t activeSlotIndex{ 0 };
+    int32_t numSlots{ 0 };
+
+    // Tapsigner
+    int32_t numberOfBackups{ 0 };
+};
+static_assert(std::is_trivially_copyable_v<CardSnapshot>);
+
+CardSnapshot makeCardSnapshot(const tap_protocol::Satscard& satscard);
+CardSnapshot makeCardSnapshot(const tap_protocol::Tapsigner& tapsigner);
+
+/// Whether the snapshot was taken from the card with the given identity
+bool hasIdent(const CardSnapshot& snapshot, const std::string& ident) noexcept;
+
+/// Copies [ident] into [output], failing if it doesn't fit with its null terminator
+bool makeCardIdent(const std::string& ident, CardIdent& output) noexcept;
+
+/// Idents compare up to their null terminator, whatever follows it
+struct CardIdentHash {
+    size_t operator()(const CardIdent& ident) const noexcept;
+};
+struct CardIdentEqual {
+    bool operator()(const CardIdent& first, const CardIdent& second) const noexcept;
+};
+/// Finds a registered card's index from its ident, so registering a card doesn't compare it with every other
+using CardIdentIndex = std::unordered_map<CardIdent, size_t, CardIdentHash, CardIdentEqual>;
+
+void fillConstructorParams(CKTapCardConstructorParams& params, size_t index, const CardSnapshot& snapshot);
+void fillSyncParams(CKTapCardSyncParams& params, const CardSnapshot& snapshot) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CARD_SNAPSHOT_H__
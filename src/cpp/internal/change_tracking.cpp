@@ -0,0 +1,52 @@
+#include <internal/change_tracking.h>
+
+// Project
+#include <internal/globals.h>
+
+static_assert(CKTapCardChange::derivationPathChanged == 1 << 8, "CardChangeTracker::_fieldCount is out of date");
+
+uint64_t currentChangeVersion() noexcept {
+    return currentContext().changeVersion;
+}
+
+void CardChangeTracker::markChanged(const uint32_t changes) noexcept {
+    if (changes == 0) {
+        return;
+    }
+
+    const auto version = ++currentContext().changeVersion;
+    for (size_t field{ 0 }; field < _fieldCount; ++field) {
+        if ((changes & (1u << field)) != 0) {
+            _fieldVersions[field] = version;
+        }
+    }
+}
+
+void CardChangeTracker::update(const CardSnapshot& before, const CardSnapshot& after, const uint32_t extraChanges) noexcept {
+    uint32_t changes{ extraChanges };
+    const auto compare = [&changes](const auto& oldValue, const auto& newValue, const CKTapCardChange flag) {
+        if (oldValue != newValue) {
+            changes |= flag;
+        }
+    };
+
+    compare(before.isCertsChecked, after.isCertsChecked, CKTapCardChange::certsCheckedChanged);
+    compare(before.needSetup, after.needSetup, CKTapCardChange::needSetupChanged);
+    compare(before.authDelay, after.authDelay, CKTapCardChange::authDelayChanged);
+    compare(before.activeSlotIndex, after.activeSlotIndex, CKTapCardChange::activeSlotChanged);
+    compare(before.hasUnusedSlots, after.hasUnusedSlots, CKTapCardChange::slotUsageChanged);
+    compare(before.isUsedUp, after.isUsedUp, CKTapCardChange::slotUsageChanged);
+    compare(before.numberOfBackups, after.numberOfBackups, CKTapCardChange::numberOfBackupsChanged);
+
+    markChanged(changes);
+}
+
+uint32_t CardChangeTracker::changesSince(const uint64_t version) const noexcept {
+    uint32_t changes{ 0 };
+    for (size_t field{ 0 }; field < _fieldCount; ++field) {
+        if (_fieldVersions[field] > version) {
+            changes |= 1u << field;
+        }
+    }
+    return changes;
+}
@@ -0,0 +1,37 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CHANGE_TRACKING_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CHANGE_TRACKING_H__
+
+// Project
+#include <enums.h>
+#include <internal/card_snapshot.h>
+
+// STL
+#include <array>
+#include <cstdint>
+
+/// The most recent version handed out in the current context, versions start at 1 so 0 can be used to request every
+/// change
+uint64_t currentChangeVersion() noexcept;
+
+/// Remembers the version at which each field of a card last changed, allowing callers to sync only what's new. Versions
+/// come from the context the card is registered in, so it must be bound when they change
+class CardChangeTracker {
+public:
+
+    /// Records the given CKTapCardChange flags at a new version
+    void markChanged(uint32_t changes) noexcept;
+
+    /// Records every field which differs between the snapshots along with any extra CKTapCardChange flags
+    void update(const CardSnapshot& before, const CardSnapshot& after, uint32_t extraChanges = 0) noexcept;
+
+    /// The CKTapCardChange flags for every field which changed after the given version
+    uint32_t changesSince(uint64_t version) const noexcept;
+
+private:
+
+    static constexpr size_t _fieldCount = 9;
+
+    std::array<uint64_t, _fieldCount> _fieldVersions{ };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CHANGE_TRACKING_H__
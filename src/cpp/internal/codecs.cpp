@@ -0,0 +1,336 @@
+#include <internal/codecs.h>
+
+// Project
+#include <internal/cpu_features.h>
+#include <internal/hashing.h>
+#include <internal/secure_memory.h>
+
+// libc
+#if CKTAP_HAS_X86_KERNELS
+    #include <immintrin.h>
+#elif CKTAP_HAS_NEON_KERNELS
+    #include <arm_neon.h>
+#endif
+
+// STL
+#include <array>
+#include <cstring>
+
+static constexpr char hexDigits[]{ "0123456789abcdef" };
+static constexpr char bech32Charset[]{ "qpzry9x8gf2tvdw0s3jn54khce6mua7l" };
+static constexpr char base58Alphabet[]{ "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz" };
+constexpr size_t bech32ChecksumLength = 6;
+constexpr size_t base58CheckChecksumLength = 4;
+/// The largest power of 58 which fits in 32 bits, so five base58 digits are produced per long division pass
+constexpr uint64_t base58LimbDivisor = 58ULL * 58 * 58 * 58 * 58;
+constexpr size_t base58DigitsPerLimb = 5;
+/// Each byte needs log(256) / log(58) ~ 1.37 digits, plus a partial limb from the final division pass
+constexpr size_t maxBase58Digits = 128;
+static_assert((maxBase58CheckPayloadLength + 4) * 137 / 100 + 2 * base58DigitsPerLimb <= maxBase58Digits,
+              "Base58 digit buffer is too small");
+
+// ----------------------------------------------
+// Hex:
+
+static int hexValue(const char character) noexcept {
+    if (character >= '0' && character <= '9') {
+        return character - '0';
+    } else if (character >= 'a' && character <= 'f') {
+        return character - 'a' + 10;
+    } else if (character >= 'A' && character <= 'F') {
+        return character - 'A' + 10;
+    }
+    return -1;
+}
+
+#if CKTAP_HAS_X86_KERNELS
+/// Looks up both nibbles of 16 bytes at once with pshufb then interleaves them. Returns how many bytes were encoded
+__attribute__((target("ssse3")))
+static size_t encodeHexSsse3(const uint8_t* data, const size_t length, char* output) noexcept {
+    const auto digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hexDigits));
+    const auto lowNibbleMask = _mm_set1_epi8(0x0f);
+
+    size_t i{ 0 };
+    for (; i + 16 <= length; i += 16) {
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const auto high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibbleMask));
+        const auto low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, lowNibbleMask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+/// Converts 16 hex characters into 8 bytes held in the low bytes of 16 bit lanes, [isValid] is set to whether
+/// every character was hex
+__attribute__((target("ssse3")))
+static __m128i decodeHexBlockSsse3(const char* characters, bool& isValid) noexcept {
+    const auto raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters));
+    const auto lower = _mm_or_si128(raw, _mm_set1_epi8(0x20));
+    const auto isDigit = _mm_and_si128(_mm_cmpgt_epi8(raw, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(raw, _mm_set1_epi8('9' + 1)));
+    const auto isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    isValid = _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) == 0xFFFF;
+
+    const auto digitValues = _mm_and_si128(isDigit, _mm_sub_epi8(raw, _mm_set1_epi8('0')));
+    const auto letterValues = _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    // Each pair of nibbles becomes high * 16 + low
+    return _mm_maddubs_epi16(_mm_or_si128(digitValues, letterValues), _mm_set1_epi16(0x0110));
+}
+
+/// Converts 32 characters into 16 bytes per iteration. Returns how many bytes were decoded, stopping early with
+/// [isValid] cleared at the first block containing a character which isn't hex
+__attribute__((target("ssse3")))
+static size_t decodeHexSsse3(const char* hex, const size_t byteCount, uint8_t* output, bool& isValid) noexcept {
+    size_t i{ 0 };
+    for (; i + 16 <= byteCount; i += 16) {
+        bool isFirstValid{ false }, isSecondValid{ false };
+        const auto first = decodeHexBlockSsse3(hex + i * 2, isFirstValid);
+        const auto second = decodeHexBlockSsse3(hex + i * 2 + 16, isSecondValid);
+        if (!isFirstValid || !isSecondValid) {
+            isValid = false;
+            return i;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(first, second));
+    }
+    return i;
+}
+#elif CKTAP_HAS_NEON_KERNELS
+/// Looks up both nibbles of 16 bytes with tbl and lets the interleaving store pair them up
+static size_t encodeHexNeon(const uint8_t* data, const size_t length, char* output) noexcept {
+    const auto digits = vld1q_u8(reinterpret_cast<const uint8_t*>(hexDigits));
+    const auto lowNibbleMask = vdupq_n_u8(0x0f);
+
+    size_t i{ 0 };
+    for (; i + 16 <= length; i += 16) {
+        const auto bytes = vld1q_u8(data + i);
+        uint8x16x2_t characters;
+        characters.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(bytes, 4));
+        characters.val[1] = vqtbl1q_u8(digits, vandq_u8(bytes, lowNibbleMask));
+        vst2q_u8(reinterpret_cast<uint8_t*>(output + i * 2), characters);
+    }
+    return i;
+}
+#endif
+
+void encodeHex(const uint8_t* data, const size_t length, char* output) noexcept {
+    size_t i{ 0 };
+#if CKTAP_HAS_X86_KERNELS
+    if (cpuFeatures().hasSsse3) {
+        i = encodeHexSsse3(data, length, output);
+    }
+#elif CKTAP_HAS_NEON_KERNELS
+    i = encodeHexNeon(data, length, output);
+#endif
+
+    for (; i < length; ++i) {
+        output[i * 2] = hexDigits[data[i] >> 4];
+        output[i * 2 + 1] = hexDigits[data[i] & 0x0f];
+    }
+}
+
+bool decodeHex(const char* hex, const size_t hexLength, uint8_t* output) noexcept {
+    if (hexLength % 2 != 0) {
+        return false;
+    }
+
+    const auto byteCount = hexLength / 2;
+    size_t i{ 0 };
+#if CKTAP_HAS_X86_KERNELS
+    if (cpuFeatures().hasSsse3) {
+        auto isValid = true;
+        i = decodeHexSsse3(hex, byteCount, output, isValid);
+        if (!isValid) {
+            return false;
+        }
+    }
+#endif
+
+    for (; i < byteCount; ++i) {
+        const auto high = hexValue(hex[i * 2]);
+        const auto low = hexValue(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        output[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+// ----------------------------------------------
+// Bech32:
+
+/// The generator terms selected by the top five bits of the checksum, replacing five conditional XORs per step
+static constexpr std::array<uint32_t, 32> makeBech32GeneratorTable() {
+    constexpr uint32_t generators[5]{ 0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3 };
+    std::array<uint32_t, 32> table{ };
+    for (size_t top{ 0 }; top < table.size(); ++top) {
+        for (size_t bit{ 0 }; bit < 5; ++bit) {
+            if (top & (size_t{ 1 } << bit)) {
+                table[top] ^= generators[bit];
+            }
+        }
+    }
+    return table;
+}
+
+static constexpr auto bech32GeneratorTable = makeBech32GeneratorTable();
+
+static inline uint32_t bech32PolymodStep(const uint32_t checksum, const uint8_t value) noexcept {
+    return (((checksum & 0x1ffffff) << 5) ^ value) ^ bech32GeneratorTable[checksum >> 25];
+}
+
+Bech32Encoder::Bech32Encoder(const char* humanReadablePart) noexcept {
+    const auto length = std::strlen(humanReadablePart);
+    if (length == 0 || length > maxBech32HumanReadablePartLength) {
+        return;
+    }
+
+    std::memcpy(_humanReadablePart, humanReadablePart, length);
+    _humanReadablePartLength = length;
+    for (size_t i{ 0 }; i < length; ++i) {
+        _prefixChecksum = bech32PolymodStep(_prefixChecksum, static_cast<uint8_t>(humanReadablePart[i]) >> 5);
+    }
+    _prefixChecksum = bech32PolymodStep(_prefixChecksum, 0);
+    for (size_t i{ 0 }; i < length; ++i) {
+        _prefixChecksum = bech32PolymodStep(_prefixChecksum, static_cast<uint8_t>(humanReadablePart[i]) & 31);
+    }
+}
+
+size_t Bech32Encoder::encodeSegwitV0(const uint8_t* program, const size_t programLength, char* output,
+                                     const size_t capacity) const noexcept {
+    const auto dataLength = 1 + (programLength * 8 + 4) / 5;
+    const auto length = _humanReadablePartLength + 1 + dataLength + bech32ChecksumLength;
+    if (_humanReadablePartLength == 0 || length + 1 > capacity || length > maxBech32AddressLength - 1) {
+        return 0;
+    }
+
+    std::memcpy(output, _humanReadablePart, _humanReadablePartLength);
+    output[_humanReadablePartLength] = '1';
+    auto* data = output + _humanReadablePartLength + 1;
+
+    // Witness version followed by the program regrouped from 8 bit bytes into 5 bit values
+    auto checksum = _prefixChecksum;
+    size_t written{ 0 };
+    const auto append = [&](const uint8_t value) {
+        checksum = bech32PolymodStep(checksum, value);
+        data[written++] = bech32Charset[value];
+    };
+    append(0);
+
+    uint32_t accumulator{ 0 };
+    int bits{ 0 };
+    for (size_t i{ 0 }; i < programLength; ++i) {
+        accumulator = (accumulator << 8) | program[i];
+        bits += 8;
+        while (bits >= 5) {
+            bits -= 5;
+            append(static_cast<uint8_t>((accumulator >> bits) & 31));
+        }
+    }
+    if (bits > 0) {
+        append(static_cast<uint8_t>((accumulator << (5 - bits)) & 31));
+    }
+
+    for (size_t i{ 0 }; i < bech32ChecksumLength; ++i) {
+        checksum = bech32PolymodStep(checksum, 0);
+    }
+    checksum ^= 1;
+    for (size_t i{ 0 }; i < bech32ChecksumLength; ++i) {
+        data[written++] = bech32Charset[(checksum >> (5 * (bech32ChecksumLength - 1 - i))) & 31];
+    }
+
+    output[length] = '\0';
+    return length;
+}
+
+size_t encodeSegwitV0Addresses(const Bech32Encoder& encoder, const uint8_t* programs, const size_t programLength,
+                               const size_t count, char* output, const size_t stride) noexcept {
+    for (size_t i{ 0 }; i < count; ++i) {
+        if (encoder.encodeSegwitV0(programs + i * programLength, programLength, output + i * stride, stride) == 0) {
+            return i;
+        }
+    }
+    return count;
+}
+
+// ----------------------------------------------
+// Base58:
+
+size_t encodeBase58Check(const uint8_t* payload, const size_t length, char* output, const size_t capacity) noexcept {
+    if (length > maxBase58CheckPayloadLength) {
+        return 0;
+    }
+
+    // Big endian 32 bit words with the payload right aligned, followed by the checksum
+    constexpr size_t maxWords = (maxBase58CheckPayloadLength + base58CheckChecksumLength + 3) / 4;
+    const auto totalLength = length + base58CheckChecksumLength;
+    const auto wordCount = (totalLength + 3) / 4;
+    uint8_t bytes[maxWords * 4]{ };
+    const auto padding = wordCount * 4 - totalLength;
+    std::memcpy(bytes + padding, payload, length);
+    const auto firstHash = sha256(payload, length);
+    const auto checksum = sha256(firstHash.data(), firstHash.size());
+    std::memcpy(bytes + padding + length, checksum.data(), base58CheckChecksumLength);
+
+    size_t leadingZeros{ 0 };
+    while (leadingZeros < totalLength && bytes[padding + leadingZeros] == 0) {
+        ++leadingZeros;
+    }
+
+    uint32_t words[maxWords]{ };
+    for (size_t i{ 0 }; i < wordCount; ++i) {
+        words[i] = (static_cast<uint32_t>(bytes[i * 4]) << 24) | (static_cast<uint32_t>(bytes[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(bytes[i * 4 + 2]) << 8) | static_cast<uint32_t>(bytes[i * 4 + 3]);
+    }
+    secureZero(bytes, sizeof(bytes));
+
+    // Repeatedly divides by 58^5, each remainder gives five digits, least significant first
+    uint8_t digits[maxBase58Digits]{ };
+    size_t digitCount{ 0 };
+    size_t firstWord{ 0 };
+    while (firstWord < wordCount && words[firstWord] == 0) {
+        ++firstWord;
+    }
+    while (firstWord < wordCount) {
+        uint64_t remainder{ 0 };
+        for (auto i = firstWord; i < wordCount; ++i) {
+            const auto current = (remainder << 32) | words[i];
+            words[i] = static_cast<uint32_t>(current / base58LimbDivisor);
+            remainder = current % base58LimbDivisor;
+        }
+        for (size_t i{ 0 }; i < base58DigitsPerLimb; ++i) {
+            digits[digitCount++] = static_cast<uint8_t>(remainder % 58);
+            remainder /= 58;
+        }
+        while (firstWord < wordCount && words[firstWord] == 0) {
+            ++firstWord;
+        }
+    }
+    while (digitCount > 0 && digits[digitCount - 1] == 0) {
+        --digitCount;
+    }
+
+    const auto encodedLength = leadingZeros + digitCount;
+    if (encodedLength + 1 <= capacity) {
+        std::memset(output, base58Alphabet[0], leadingZeros);
+        for (size_t i{ 0 }; i < digitCount; ++i) {
+            output[leadingZeros + i] = base58Alphabet[digits[digitCount - 1 - i]];
+        }
+        output[encodedLength] = '\0';
+    }
+    secureZero(words, sizeof(words));
+    secureZero(digits, sizeof(digits));
+    return encodedLength + 1 <= capacity ? encodedLength : 0;
+}
+
+size_t encodeWif(const uint8_t* privateKey, const bool isTestnet, char* output, const size_t capacity) noexcept {
+    // Version byte, the key, then a flag marking the public key as compressed
+    uint8_t payload[wifPrivateKeySize + 2];
+    payload[0] = isTestnet ? 0xef : 0x80;
+    std::memcpy(payload + 1, privateKey, wifPrivateKeySize);
+    payload[wifPrivateKeySize + 1] = 0x01;
+
+    const auto length = encodeBase58Check(payload, sizeof(payload), output, capacity);
+    secureZero(payload, sizeof(payload));
+    return length;
+}
@@ -0,0 +1,56 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CODECS_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CODECS_H__
+
+// STL
+#include <cstddef>
+#include <cstdint>
+
+/// Enough for a bech32 address with a 40 byte witness program plus the null terminator
+constexpr size_t maxBech32AddressLength = 91;
+constexpr size_t maxBech32HumanReadablePartLength = 16;
+/// Base58check payloads are at most this long, larger inputs are rejected
+constexpr size_t maxBase58CheckPayloadLength = 64;
+constexpr size_t wifPrivateKeySize = 32;
+/// A compressed WIF is 52 characters plus the null terminator
+constexpr size_t wifBufferSize = 53;
+
+/// Writes two lower case hex characters per byte, the output isn't null terminated. Uses SSSE3 or NEON when
+/// available to convert 16 bytes at a time
+void encodeHex(const uint8_t* data, size_t length, char* output) noexcept;
+
+/// Decodes [hexLength] characters of upper or lower case hex into hexLength / 2 bytes. Returns false if the length
+/// is odd or any character isn't hex, the output may have been partially written in that case
+bool decodeHex(const char* hex, size_t hexLength, uint8_t* output) noexcept;
+
+/// Encodes segwit addresses for one network. The checksum state after the human readable part is worked out
+/// once up front, so encoding many addresses only hashes their witness programs
+class Bech32Encoder {
+public:
+
+    explicit Bech32Encoder(const char* humanReadablePart) noexcept;
+
+    /// Writes the null terminated address for a version 0 witness program, such as the hash160 of a P2WPKH public
+    /// key. Returns the address length, or 0 if it doesn't fit in [capacity]
+    size_t encodeSegwitV0(const uint8_t* program, size_t programLength, char* output, size_t capacity) const noexcept;
+
+private:
+
+    char _humanReadablePart[maxBech32HumanReadablePartLength + 1]{ };
+    size_t _humanReadablePartLength{ 0 };
+    uint32_t _prefixChecksum{ 1 };
+};
+
+/// Encodes [count] witness programs stored back to back, writing each address at [output] + i * [stride]. Returns
+/// how many were encoded before one didn't fit
+size_t encodeSegwitV0Addresses(const Bech32Encoder& encoder, const uint8_t* programs, size_t programLength,
+                               size_t count, char* output, size_t stride) noexcept;
+
+/// Writes the null terminated base58 encoding of the payload followed by the first four bytes of its double
+/// SHA-256. Returns the length, or 0 if the payload is too large or the result doesn't fit in [capacity]
+size_t encodeBase58Check(const uint8_t* payload, size_t length, char* output, size_t capacity) noexcept;
+
+/// Writes the compressed WIF for a 32 byte private key, see [encodeBase58Check]. The temporary payload holding
+/// the key is zeroed before returning
+size_t encodeWif(const uint8_t* privateKey, bool isTestnet, char* output, size_t capacity) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CODECS_H__
@@ -0,0 +1,22 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CONTEXT_SERVICES_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CONTEXT_SERVICES_H__
+
+// Project
+#include <internal/audit_log.h>
+#include <internal/worker_scheduling.h>
+
+// STL
+#include <atomic>
+#include <cstdint>
+
+/// The settings and audit log of one context. Shared with every protocol thread it runs operations on, including
+/// those of the PC/SC readers started from it, so a reader keeps them alive after the context is destroyed
+struct ContextServices {
+    AuditLog auditLog{ };
+    WorkerScheduling workerScheduling{ };
+    /// Milliseconds the watchdog lets an operation go without progress, zero leaves them alone. See
+    /// [setWatchdogStallTimeout]
+    std::atomic<int64_t> stallTimeout{ 0 };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CONTEXT_SERVICES_H__
@@ -0,0 +1,26 @@
+#include <internal/cpu_features.h>
+
+// libc
+#if CKTAP_HAS_X86_KERNELS
+    #include <cpuid.h>
+#endif
+
+static CpuFeatures detectCpuFeatures() noexcept {
+    CpuFeatures features{ };
+#if CKTAP_HAS_X86_KERNELS
+    unsigned int eax{ 0 }, ebx{ 0 }, ecx{ 0 }, edx{ 0 };
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        features.hasSsse3 = (ecx & bit_SSSE3) != 0;
+        features.hasSse41 = (ecx & bit_SSE4_1) != 0;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        features.hasSha = (ebx & (1u << 29)) != 0;
+    }
+#endif
+    return features;
+}
+
+const CpuFeatures& cpuFeatures() noexcept {
+    static const auto features = detectCpuFeatures();
+    return features;
+}
@@ -0,0 +1,28 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_CPU_FEATURES_H__
+#define __CKTAP_PROTOCOL__INTERNAL_CPU_FEATURES_H__
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    /// x86 kernels are compiled with target attributes and chosen at runtime, MSVC uses the portable code
+    #define CKTAP_HAS_X86_KERNELS 1
+#else
+    #define CKTAP_HAS_X86_KERNELS 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    /// NEON is mandatory on arm64 so these kernels don't need a runtime check
+    #define CKTAP_HAS_NEON_KERNELS 1
+#else
+    #define CKTAP_HAS_NEON_KERNELS 0
+#endif
+
+/// Instruction set extensions which the optimized codec and hashing kernels rely on
+struct CpuFeatures {
+    bool hasSsse3{ false };
+    bool hasSse41{ false };
+    bool hasSha{ false };
+};
+
+/// Queried once on first use, always false for extensions of other architectures
+const CpuFeatures& cpuFeatures() noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_CPU_FEATURES_H__
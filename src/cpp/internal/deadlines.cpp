@@ -0,0 +1,24 @@
+#include <internal/deadlines.h>
+
+// STL
+#include <algorithm>
+
+void RoundTripTracker::record(const std::chrono::microseconds roundTrip) noexcept {
+    _samples[_next] = roundTrip;
+    _next = (_next + 1) % _windowSize;
+    _count = std::min(_count + 1, _windowSize);
+}
+
+std::chrono::microseconds RoundTripTracker::adaptiveTimeout(const std::chrono::microseconds fallback) const noexcept {
+    if (_count < _minimumSamples) {
+        return fallback;
+    }
+
+    // Work on a copy so the window order is preserved, it's small enough to live on the stack
+    auto sorted = _samples;
+    const auto percentile = sorted.begin() + (_count * 95) / 100;
+    std::nth_element(sorted.begin(), percentile, sorted.begin() + _count);
+
+    const auto timeout = *percentile * _headroomMultiplier;
+    return std::clamp(timeout, std::min(minimumAdaptiveTransportTimeout, fallback), fallback);
+}
@@ -0,0 +1,45 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_DEADLINES_H__
+#define __CKTAP_PROTOCOL__INTERNAL_DEADLINES_H__
+
+// STL
+#include <array>
+#include <chrono>
+
+/// How long to wait for a single transport response when nothing else has been configured
+constexpr std::chrono::microseconds defaultTransportTimeout = std::chrono::minutes{ 1 };
+/// Adaptive timeouts never drop below this, it leaves room for the user repositioning the card
+constexpr std::chrono::microseconds minimumAdaptiveTransportTimeout = std::chrono::milliseconds{ 250 };
+
+/// The time limits applied to card operations
+struct DeadlineOptions {
+    /// Bounds an entire operation, zero means there is no limit
+    std::chrono::microseconds operationTimeout{ 0 };
+    /// Bounds each individual transport request
+    std::chrono::microseconds transportTimeout{ defaultTransportTimeout };
+    /// Derive the transport timeout from recently observed round trip times
+    bool isTransportTimeoutAdaptive{ false };
+};
+
+/// Keeps a rolling window of transport round trip times so the per-message timeout can adapt to the speed of
+/// the reader and card actually in use
+class RoundTripTracker {
+public:
+
+    void record(std::chrono::microseconds roundTrip) noexcept;
+
+    /// Derives a timeout from the 95th percentile of recent round trips, giving generous headroom. Returns
+    /// `fallback` until enough samples have been gathered and never exceeds it
+    std::chrono::microseconds adaptiveTimeout(std::chrono::microseconds fallback) const noexcept;
+
+private:
+
+    static constexpr size_t _windowSize = 32;
+    static constexpr size_t _minimumSamples = 8;
+    static constexpr int _headroomMultiplier = 4;
+
+    std::array<std::chrono::microseconds, _windowSize> _samples{ };
+    size_t _count{ 0 };
+    size_t _next{ 0 };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_DEADLINES_H__
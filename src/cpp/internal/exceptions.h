@@ -4,37 +4,14 @@
 // STL
 #include <stdexcept>
 
-/// Thrown when the protocol thread cancels its current operation
-class CancelationException final : public std::runtime_error {
+/// Thrown from the transport callback to unwind tap_protocol when an operation is canceled, times out or the
+/// thread enters an invalid state. The reason is recorded by TapProtocolThread before throwing, so this
+/// carries no message and is the only exception the library throws itself
+class TransportAbortException final : public std::runtime_error {
 public:
-    explicit CancelationException(const std::string& message)
-        : std::runtime_error(message) {
-    }
-    explicit CancelationException(const char* message)
-        : std::runtime_error(message) {
-    }
-};
-
-/// Thrown when the protocol thread times out
-class TimeoutException final : public std::runtime_error {
-public:
-    explicit TimeoutException(const std::string& message)
-        : std::runtime_error(message) {
-    }
-    explicit TimeoutException(const char* message)
-        : std::runtime_error(message) {
-    }
-};
-
-/// Thrown when the async thread enters an invalid state whilst processing transport requests
-class TransportException final : public std::runtime_error {
-public:
-    explicit TransportException(const std::string& message)
-        : std::runtime_error(message) {
-    }
-    explicit TransportException(const char* message)
-        : std::runtime_error(message) {
+    TransportAbortException()
+        : std::runtime_error("Transport aborted by TapProtocolThread") {
     }
 };
 
-#endif // __CKTAP_PROTOCOL__INTERNAL_EXCEPTIONS_H__
\ No newline at end of file
+#endif // __CKTAP_PROTOCOL__INTERNAL_EXCEPTIONS_H__
@@ -1,28 +1,191 @@
 #include <internal/globals.h>
 
 // Project
+#include <internal/context_services.h>
+#include <internal/secure_memory.h>
 #include <internal/tap_protocol_thread.h>
 
-std::unique_ptr<TapProtocolThread> g_protocolThread{ };
-std::vector<SatscardWrapper> g_satscards{ };
-std::vector<TapsignerWrapper> g_tapsigners{ };
+// STL
+#include <utility>
 
-void storeSatscardSlot(int32_t satscardHandle, tap_protocol::Satscard::Slot slot) noexcept {
+/// Used by native hosts which never create a context, such as the daemon
+static CKTapContext g_defaultContext{ };
+static thread_local CKTapContext* g_boundContext{ nullptr };
+
+CKTapContext::CKTapContext() noexcept = default;
+
+CKTapContext::~CKTapContext() = default;
+
+CKTapContext& currentContext() noexcept {
+    return g_boundContext != nullptr ? *g_boundContext : g_defaultContext;
+}
+
+TapProtocolThread* currentProtocolThread() noexcept {
+    return currentContext().protocolThread.get();
+}
+
+CKTapContext* bindContext(CKTapContext* context) noexcept {
+    return std::exchange(g_boundContext, context);
+}
+
+static uint64_t nextAttachTime() noexcept {
+    return ++currentContext().attachClock;
+}
+
+SatscardWrapper::SatscardWrapper(std::shared_ptr<tap_protocol::Satscard> satscard)
+    : card{ std::move(satscard) },
+      snapshot{ makeCardSnapshot(*card) },
+      slots{ },
+      changes{ },
+      lastAttached{ nextAttachTime() } {
+}
+
+SatscardWrapper::SatscardWrapper(const CardSnapshot& cachedSnapshot, const SlotTable& cachedSlots)
+    : card{ },
+      snapshot{ cachedSnapshot },
+      slots{ cachedSlots },
+      changes{ },
+      lastAttached{ 0 } {
+}
+
+void SatscardWrapper::refreshSnapshot() {
+    if (!card) {
+        return;
+    }
+
+    const auto before = snapshot;
+    snapshot = makeCardSnapshot(*card);
+    changes.update(before, snapshot);
+}
+
+TapsignerWrapper::TapsignerWrapper(std::shared_ptr<tap_protocol::Tapsigner> tapsigner)
+    : card{ std::move(tapsigner) },
+      snapshot{ makeCardSnapshot(*card) },
+      derivationPath{ card->GetDerivationPath().value_or(std::string{ }) },
+      changes{ },
+      lastAttached{ nextAttachTime() } {
+}
+
+TapsignerWrapper::TapsignerWrapper(const CardSnapshot& cachedSnapshot, std::string cachedDerivationPath) noexcept
+    : card{ },
+      snapshot{ cachedSnapshot },
+      derivationPath{ std::move(cachedDerivationPath) },
+      changes{ },
+      lastAttached{ 0 } {
+}
+
+void TapsignerWrapper::refreshSnapshot() {
+    if (!card) {
+        return;
+    }
+
+    const auto before = snapshot;
+    snapshot = makeCardSnapshot(*card);
+
+    auto path = card->GetDerivationPath().value_or(std::string{ });
+    const uint32_t pathChange = path != derivationPath ? CKTapCardChange::derivationPathChanged : 0;
+    derivationPath = std::move(path);
+    changes.update(before, snapshot, pathChange);
+}
+
+bool storeSatscardSlot(int32_t satscardHandle, tap_protocol::Satscard::Slot slot) noexcept {
+    bool isStored{ false };
     try {
-        if (satscardHandle < 0) {
-            return;
+        auto& satscards = currentContext().satscards;
+        if (satscardHandle >= 0 && satscardHandle < satscards.size() && satscards[satscardHandle].slots.store(slot)) {
+            satscards[satscardHandle].changes.markChanged(CKTapCardChange::slotsChanged);
+            isStored = true;
         }
-        if (satscardHandle >= g_satscards.size()) {
-            return;
+    } catch (...) { }
+
+    secureZero(slot.privkey.data(), slot.privkey.size());
+    return isStored;
+}
+
+void markCardAdded(const CKTapCardType type, const size_t index) noexcept {
+    const auto handle = static_cast<int32_t>(index);
+    if (type == CKTapCardType::satscard) {
+        if (auto wrapper = findCardWrapper<tap_protocol::Satscard>(handle)) {
+            (*wrapper)->changes.markChanged(CKTapCardChange::cardAdded);
         }
-        const auto slotIndex = slot.index;
-        if (slotIndex < 0) {
-            return;
+    } else if (type == CKTapCardType::tapsigner) {
+        if (auto wrapper = findCardWrapper<tap_protocol::Tapsigner>(handle)) {
+            (*wrapper)->changes.markChanged(CKTapCardChange::cardAdded);
         }
-        auto& slots = g_satscards[satscardHandle].slots;
-        if (slotIndex >= slots.size()) {
-            slots.resize(slotIndex + 1);
+    }
+}
+
+template <typename CardType>
+static void refreshCard(const int32_t index, const std::shared_ptr<tap_protocol::CKTapCard>& reattached) {
+    auto wrapper = findCardWrapper<CardType>(index);
+    if (!wrapper) {
+        return;
+    }
+
+    auto& stored = **wrapper;
+    if (auto card = std::dynamic_pointer_cast<CardType>(reattached)) {
+        stored.card = std::move(card);
+    }
+    if (stored.card) {
+        stored.lastAttached = nextAttachTime();
+        stored.refreshSnapshot();
+    }
+}
+
+void refreshOperationCard() noexcept {
+    try {
+        auto& context = currentContext();
+        const auto reattached = context.protocolThread != nullptr ?
+            context.protocolThread->releaseReattachedCard() :
+            nullptr;
+
+        const auto operationCard = context.operationCard;
+        if (operationCard.type == CKTapCardType::satscard) {
+            refreshCard<tap_protocol::Satscard>(operationCard.index, reattached);
+        } else if (operationCard.type == CKTapCardType::tapsigner) {
+            refreshCard<tap_protocol::Tapsigner>(operationCard.index, reattached);
         }
-        slots[slotIndex] = std::make_unique<tap_protocol::Satscard::Slot>(std::move(slot));
     } catch (...) { }
-}
\ No newline at end of file
+
+    detachIdleCards();
+}
+
+template <typename WrapperType>
+static WrapperType* findOldestAttachedCard(std::vector<WrapperType>& vector, size_t& attachedCount) noexcept {
+    WrapperType* oldest{ nullptr };
+    for (auto& wrapper : vector) {
+        if (!wrapper.card) {
+            continue;
+        }
+
+        ++attachedCount;
+        if (oldest == nullptr || wrapper.lastAttached < oldest->lastAttached) {
+            oldest = &wrapper;
+        }
+    }
+    return oldest;
+}
+
+void detachIdleCards() noexcept {
+    auto& context = currentContext();
+    while (true) {
+        size_t attachedCount{ 0 };
+        auto* satscard = findOldestAttachedCard(context.satscards, attachedCount);
+        auto* tapsigner = findOldestAttachedCard(context.tapsigners, attachedCount);
+        if (attachedCount <= context.attachedCardLimit) {
+            return;
+        }
+
+        if (tapsigner == nullptr || (satscard != nullptr && satscard->lastAttached < tapsigner->lastAttached)) {
+            // Keep the active slot so Satscard_getActiveSlot still works whilst detached
+            try {
+                auto slot = satscard->card->GetActiveSlot();
+                satscard->slots.store(slot);
+                secureZero(slot.privkey.data(), slot.privkey.size());
+            } catch (...) { }
+            satscard->card.reset();
+        } else {
+            tapsigner->card.reset();
+        }
+    }
+}
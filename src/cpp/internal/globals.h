@@ -2,7 +2,12 @@
 #define __CKTAP_PROTOCOL__INTERNAL_GLOBALS_H__
 
 // Project
+#include <internal/card_snapshot.h>
+#include <internal/change_tracking.h>
 #include <internal/macros.h>
+#include <internal/metrics.h>
+#include <internal/result.h>
+#include <internal/slot_table.h>
 #include <internal/utils.h>
 #include <structs.h>
 
@@ -10,82 +15,167 @@
 #include <tap_protocol/cktapcard.h>
 
 // STL
+#include <cstring>
 #include <memory>
 #include <numeric>
 
 // Types
 class TapProtocolThread;
+struct CardPipeline;
+struct ContextServices;
+struct PrewarmState;
+
+/// How many live tap_protocol objects a context keeps between operations unless Core_setAttachedCardLimit says
+/// otherwise. The most recently used cards stay attached so operations on them don't need another handshake, a host
+/// switching between a few cards would otherwise pay an extra NFC round trip every time it went back to one
+constexpr size_t defaultAttachedCardLimit = 4;
+
+/// Cards are registered with a compact snapshot of their state. The live tap_protocol object is only attached
+/// while it's needed for an operation, [detachIdleCards] drops it once it's no longer among the most recently used
+/// and it's reattached with a fresh handshake the next time the card is used. A satscard's wrapper is 200 bytes, its
+/// SlotTable adds about 230 bytes on the heap for each slot that has been read
 struct SatscardWrapper {
     std::shared_ptr<tap_protocol::Satscard> card { };
-    std::vector<std::unique_ptr<tap_protocol::Satscard::Slot>> slots { };
+    CardSnapshot snapshot { };
+    SlotTable slots { };
+    CardChangeTracker changes { };
+    uint64_t lastAttached { 0 };
 
-    SatscardWrapper(std::shared_ptr<tap_protocol::Satscard> satscard)
-        : card{ std::move(satscard) }, slots{ } {
-    }
+    explicit SatscardWrapper(std::shared_ptr<tap_protocol::Satscard> satscard);
+    /// A detached card restored from the card cache, it's reattached the first time it's used
+    SatscardWrapper(const CardSnapshot& cachedSnapshot, const SlotTable& cachedSlots);
+
+    /// Re-reads the snapshot from the attached card and records what changed
+    void refreshSnapshot();
 };
 struct TapsignerWrapper {
     std::shared_ptr<tap_protocol::Tapsigner> card { };
+    CardSnapshot snapshot { };
+    std::string derivationPath { };
+    CardChangeTracker changes { };
+    uint64_t lastAttached { 0 };
 
-    TapsignerWrapper(std::shared_ptr<tap_protocol::Tapsigner> tapsigner)
-        : card{ std::move(tapsigner) } {
-    }
+    explicit TapsignerWrapper(std::shared_ptr<tap_protocol::Tapsigner> tapsigner);
+    /// A detached card restored from the card cache, it's reattached the first time it's used
+    TapsignerWrapper(const CardSnapshot& cachedSnapshot, std::string cachedDerivationPath) noexcept;
+
+    /// Re-reads the snapshot from the attached card and records what changed
+    void refreshSnapshot();
 };
 
-// Globals
-extern std::unique_ptr<TapProtocolThread> g_protocolThread;
-extern std::vector<SatscardWrapper> g_satscards;
-extern std::vector<TapsignerWrapper> g_tapsigners;
+/// One engine: a protocol thread, the registry of cards it produced, its settings and its operation metrics. Each
+/// Dart isolate creates its own with Core_createContext so they never contend, native hosts which don't create one,
+/// such as the daemon, use the process's default context. A context must only be used from one thread at a time.
+/// Contexts share the watchdog's thread, the metrics totals and the pools which synchronize themselves. The secure
+/// pool stays process-wide because secrets are freed through Utility_free* calls which take no context and
+/// RLIMIT_MEMLOCK is a per-process budget, and the session pool's workers are meant to be shared between contexts
+struct CKTapContext {
+    /// Created with the protocol thread, which shares it along with the PC/SC readers started from this context
+    std::shared_ptr<ContextServices> services{ };
+    /// Declared before the protocol thread, which records into it until it's destroyed
+    OperationMetrics operationMetrics{ };
+    std::unique_ptr<TapProtocolThread> protocolThread{ };
+    std::vector<SatscardWrapper> satscards{ };
+    std::vector<TapsignerWrapper> tapsigners{ };
+    CardIdentIndex satscardIdents{ };
+    CardIdentIndex tapsignerIdents{ };
+    CKTapCardHandle operationCard{ -1, CKTapCardType::unknownCard };
+    /// The most recent version handed out to this registry's change trackers
+    uint64_t changeVersion{ 0 };
+    uint64_t attachClock{ 0 };
+    size_t attachedCardLimit{ defaultAttachedCardLimit };
+    bool isSessionOpen{ false };
+    /// Created on first use. Shared with the PC/SC readers which were started from this context
+    std::shared_ptr<CardPipeline> pipeline{ };
+    std::shared_ptr<PrewarmState> prewarm{ };
+
+    CKTapContext() noexcept;
+    CKTapContext(const CKTapContext&) = delete;
+    CKTapContext& operator=(const CKTapContext&) = delete;
+    ~CKTapContext();
+};
+
+/// The context bound to the calling thread, or the default context when none is
+CKTapContext& currentContext() noexcept;
+
+/// The current context's protocol thread, null until the library's initialized
+TapProtocolThread* currentProtocolThread() noexcept;
+
+/// Binds [context] to the calling thread, or unbinds it when null, and returns the previous binding so it can be
+/// restored. See [cktap::ContextBinding]
+CKTapContext* bindContext(CKTapContext* context) noexcept;
 
 // Constants
 constexpr size_t invalidIndex = std::numeric_limits<size_t>::max();
 
+/// The current context's registry of cards of the given type
+template <typename CardType>
+auto& cardWrappers() noexcept {
+    if constexpr (std::is_same_v<CardType, tap_protocol::Satscard>) {
+        return currentContext().satscards;
+    } else {
+        static_assert(std::is_same_v<CardType, tap_protocol::Tapsigner>, "Unsupported CKTapCard");
+        return currentContext().tapsigners;
+    }
+}
+
+/// Looks up the wrapper for the given handle, failing with the relevant unknown handle error
+template <typename CardType>
+auto findCardWrapper(const int32_t index) noexcept {
+    auto& vector = cardWrappers<CardType>();
+    using WrapperResult = Result<remove_cvref_t<decltype(vector[0])>*>;
+
+    if (index < 0 || static_cast<size_t>(index) >= vector.size()) {
+        return WrapperResult::failure(std::is_same_v<CardType, tap_protocol::Satscard> ?
+            CKTapInterfaceErrorCode::unknownSatscardHandle :
+            CKTapInterfaceErrorCode::unknownTapsignerHandle
+        );
+    }
+    return WrapperResult{ &vector[static_cast<size_t>(index)] };
+}
+
 /// An exception-safe means of quickly getting a Satscard or Tapsigner to either read from or
-/// write to it
+/// write to it. Only the given function is guarded because it's where tap_protocol may throw
 template <typename CardType, typename Func>
 CKTapInterfaceStatus accessCard(const int32_t index, const Func& function) noexcept {
-    constexpr bool isSatscard = std::is_same_v<CardType, tap_protocol::Satscard>;
-    constexpr bool isTapsigner = std::is_same_v<CardType, tap_protocol::Tapsigner>;
+    CKTapInterfaceStatus status;
+    std::memset(&status, 0, sizeof(CKTapInterfaceStatus));
 
-    const auto processCard = [index, &function](auto& vector) noexcept {
-        CKTapInterfaceStatus status;
-        std::memset(&status, 0, sizeof(CKTapInterfaceStatus));
-        status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
-
-        if (index < 0 || index >= vector.size()) {
-            status.errorCode = isSatscard ?
-            CKTapInterfaceErrorCode::unknownSatscardHandle :
-            CKTapInterfaceErrorCode::unknownTapsignerHandle;
-        } else {
-            auto& wrapper = vector[static_cast<size_t>(index)];
-            try {
-                status.errorCode = function(wrapper);
-            } CATCH_TAP_PROTO_EXCEPTION(e, {
-                status.errorCode = CKTapInterfaceErrorCode::caughtTapProtocolException;
-                status.exception = allocateCKTapProtoException(e);
-            }) catch (...) {}
-        }
+    auto wrapper = findCardWrapper<CardType>(index);
+    if (!wrapper) {
+        status.errorCode = wrapper.error();
         return status;
-    };
-
-    if constexpr (isSatscard) {
-        return processCard(g_satscards);
-    }
-    else if constexpr (isTapsigner) {
-        return processCard(g_tapsigners);
-    }
-    else {
-        static_assert("Unsupported CKTapCard");
     }
+
+    status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    try {
+        status.errorCode = function(**wrapper);
+    } CATCH_TAP_PROTO_EXCEPTION(e, {
+        status.errorCode = CKTapInterfaceErrorCode::caughtTapProtocolException;
+        status.exception = allocateCKTapProtoException(e);
+    }) catch (...) {}
+    return status;
 }
 
-/// A quick helper to store the given slot of a Satscard
-void storeSatscardSlot(int32_t satscardHandle, tap_protocol::Satscard::Slot slot) noexcept;
+/// A quick helper to store the given slot of a Satscard, returning whether it was stored. The slot's private key is
+/// zeroed either way
+bool storeSatscardSlot(int32_t satscardHandle, tap_protocol::Satscard::Slot slot) noexcept;
+
+/// Records that the card stored at the given index was added or replaced by a handshake
+void markCardAdded(CKTapCardType type, size_t index) noexcept;
+
+/// Stores any card the protocol thread had to reattach, then refreshes the snapshot of the card prepared with
+/// Core_prepareCardOperation and records which fields its operation changed
+void refreshOperationCard() noexcept;
+
+/// Drops the live tap_protocol objects of all but the context's [attachedCardLimit] most recently used cards
+void detachIdleCards() noexcept;
 
 /// An exception-safe way to update the given vector with the given card. If a card with the same
 /// identity already exists then the old data will be overwritten, otherwise the card will be added
-/// to the vector
+/// to the vector. [idents] is the vector's ident index, it's looked up rather than comparing every card
 template <typename WrapperType, typename CardType>
-size_t updateVectorWithCard(std::vector<WrapperType>& vector, std::unique_ptr<CardType>& card) noexcept {
+size_t updateVectorWithCard(std::vector<WrapperType>& vector, CardIdentIndex& idents, std::unique_ptr<CardType>& card) noexcept {
     static_assert(std::is_same_v<
         std::remove_reference_t<decltype(*card)>,
         std::remove_reference_t<decltype(*vector[0].card)>
@@ -95,16 +185,27 @@ size_t updateVectorWithCard(std::vector<WrapperType>& vector, std::unique_ptr<Ca
         return invalidIndex;
     }
     try {
-        for (size_t index{ 0 }; index < vector.size(); ++index) {
-            auto& stored = vector[index];
-            if (stored.card && stored.card->GetIdent() == card->GetIdent()) {
-                stored = WrapperType{ std::shared_ptr<CardType>(std::move(card)) };
-                return index;
+        // Idents too long to store are never matched, so those cards are always added
+        CardIdent ident{ };
+        const auto isIndexed = makeCardIdent(card->GetIdent(), ident);
+        if (isIndexed) {
+            const auto found = idents.find(ident);
+            if (found != idents.end()) {
+                vector[found->second] = WrapperType{ std::shared_ptr<CardType>(std::move(card)) };
+                return found->second;
             }
         }
 
         const auto index = vector.size();
         vector.emplace_back(std::shared_ptr<CardType>(std::move(card)));
+        if (isIndexed) {
+            try {
+                idents.emplace(ident, index);
+            } catch (...) {
+                vector.pop_back();
+                throw;
+            }
+        }
         return index;
     }
     catch (...) {
@@ -0,0 +1,308 @@
+#include <internal/hashing.h>
+
+// Project
+#include <internal/cpu_features.h>
+
+// libc
+#if CKTAP_HAS_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+// STL
+#include <cstring>
+
+constexpr size_t sha256BlockSize = 64;
+constexpr size_t ripemd160BlockSize = 64;
+
+alignas(16) static constexpr uint32_t sha256RoundConstants[64]{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+using Sha256Transform = void (*)(uint32_t* state, const uint8_t* blocks, size_t blockCount);
+
+static inline uint32_t rotateRight(const uint32_t value, const int bits) noexcept {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static inline uint32_t rotateLeft(const uint32_t value, const int bits) noexcept {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t readBigEndian32(const uint8_t* bytes) noexcept {
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+static inline uint32_t readLittleEndian32(const uint8_t* bytes) noexcept {
+    return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+static void sha256TransformPortable(uint32_t* state, const uint8_t* blocks, size_t blockCount) {
+    for (; blockCount > 0; --blockCount, blocks += sha256BlockSize) {
+        uint32_t w[64];
+        for (size_t i{ 0 }; i < 16; ++i) {
+            w[i] = readBigEndian32(blocks + i * 4);
+        }
+        for (size_t i{ 16 }; i < 64; ++i) {
+            const auto s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const auto s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (size_t i{ 0 }; i < 64; ++i) {
+            const auto s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+            const auto choice = (e & f) ^ (~e & g);
+            const auto t1 = h + s1 + choice + sha256RoundConstants[i] + w[i];
+            const auto s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+            const auto majority = (a & b) ^ (a & c) ^ (b & c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + s0 + majority;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if CKTAP_HAS_X86_KERNELS
+/// Runs four rounds per pair of sha256rnds2 instructions, the message schedule is kept in a ring of four vectors
+__attribute__((target("sha,sse4.1")))
+static void sha256TransformShaNi(uint32_t* state, const uint8_t* blocks, size_t blockCount) {
+    const auto byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions expect the state split as ABEF and CDGH
+    auto cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    auto efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+    auto cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; blockCount > 0; --blockCount, blocks += sha256BlockSize) {
+        const auto abefStart = abef;
+        const auto cdghStart = cdgh;
+
+        __m128i message[4];
+        for (size_t i{ 0 }; i < 4; ++i) {
+            message[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + i * 16)), byteSwap);
+        }
+
+        for (size_t group{ 0 }; group < 16; ++group) {
+            auto& words = message[group & 3];
+            if (group >= 4) {
+                const auto& previous = message[(group + 3) & 3];
+                const auto partial = _mm_sha256msg1_epu32(words, message[(group + 1) & 3]);
+                const auto shifted = _mm_alignr_epi8(previous, message[(group + 2) & 3], 4);
+                words = _mm_sha256msg2_epu32(_mm_add_epi32(partial, shifted), previous);
+            }
+
+            const auto roundInput = _mm_add_epi32(words, _mm_load_si128(reinterpret_cast<const __m128i*>(sha256RoundConstants + group * 4)));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, roundInput);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(roundInput, 0x0E));
+        }
+
+        abef = _mm_add_epi32(abef, abefStart);
+        cdgh = _mm_add_epi32(cdgh, cdghStart);
+    }
+
+    const auto feba = _mm_shuffle_epi32(abef, 0x1B);
+    const auto dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
+static Sha256Transform selectSha256Transform() noexcept {
+#if CKTAP_HAS_X86_KERNELS
+    const auto& features = cpuFeatures();
+    if (features.hasSha && features.hasSsse3 && features.hasSse41) {
+        return sha256TransformShaNi;
+    }
+#endif
+    return sha256TransformPortable;
+}
+
+static Sha256Transform sha256Transform() noexcept {
+    static const auto transform = selectSha256Transform();
+    return transform;
+}
+
+bool isHardwareSha256Enabled() noexcept {
+    return sha256Transform() != sha256TransformPortable;
+}
+
+/// Both hashes pad the message the same way, only the byte order of the length differs
+static size_t padFinalBlocks(uint8_t (&finalBlocks)[128], const uint8_t* tail, const size_t tailLength,
+                             const uint64_t messageLength, const bool isBigEndian) noexcept {
+    std::memset(finalBlocks, 0, sizeof(finalBlocks));
+    std::memcpy(finalBlocks, tail, tailLength);
+    finalBlocks[tailLength] = 0x80;
+
+    const auto paddedLength = tailLength + 9 <= 64 ? size_t{ 64 } : size_t{ 128 };
+    const auto bitLength = messageLength * 8;
+    for (size_t i{ 0 }; i < 8; ++i) {
+        const auto shift = isBigEndian ? (56 - i * 8) : (i * 8);
+        finalBlocks[paddedLength - 8 + i] = static_cast<uint8_t>(bitLength >> shift);
+    }
+    return paddedLength;
+}
+
+Sha256Digest sha256(const uint8_t* data, const size_t length) noexcept {
+    uint32_t state[8]{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    const auto transform = sha256Transform();
+
+    const auto fullBlocks = length / sha256BlockSize;
+    transform(state, data, fullBlocks);
+
+    uint8_t finalBlocks[128];
+    const auto consumed = fullBlocks * sha256BlockSize;
+    const auto paddedLength = padFinalBlocks(finalBlocks, data + consumed, length - consumed, length, true);
+    transform(state, finalBlocks, paddedLength / sha256BlockSize);
+
+    Sha256Digest digest{ };
+    for (size_t i{ 0 }; i < 8; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    }
+    return digest;
+}
+
+static constexpr uint8_t ripemd160LeftWords[80]{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+    3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+    1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+    4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13,
+};
+static constexpr uint8_t ripemd160RightWords[80]{
+    5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+    6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+    15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+    8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+    12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11,
+};
+static constexpr uint8_t ripemd160LeftShifts[80]{
+    11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+    7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+    11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+    11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+    9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6,
+};
+static constexpr uint8_t ripemd160RightShifts[80]{
+    8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+    9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+    9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+    15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+    8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11,
+};
+static constexpr uint32_t ripemd160LeftConstants[5]{ 0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e };
+static constexpr uint32_t ripemd160RightConstants[5]{ 0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000 };
+
+template <size_t Function>
+static inline uint32_t ripemd160Mix(const uint32_t x, const uint32_t y, const uint32_t z) noexcept {
+    if constexpr (Function == 0) {
+        return x ^ y ^ z;
+    } else if constexpr (Function == 1) {
+        return (x & y) | (~x & z);
+    } else if constexpr (Function == 2) {
+        return (x | ~y) ^ z;
+    } else if constexpr (Function == 3) {
+        return (x & z) | (y & ~z);
+    } else {
+        return x ^ (y | ~z);
+    }
+}
+
+struct Ripemd160Line {
+    uint32_t a, b, c, d, e;
+};
+
+/// Runs the 16 steps of one round on both lines, the right line uses the mixing functions in reverse order so
+/// each round is a separate instantiation with both functions fixed at compile time
+template <size_t Round>
+static inline void ripemd160Round(Ripemd160Line& left, Ripemd160Line& right, const uint32_t* words) noexcept {
+    for (size_t step{ 0 }; step < 16; ++step) {
+        const auto i = Round * 16 + step;
+        auto t = rotateLeft(left.a + ripemd160Mix<Round>(left.b, left.c, left.d) + words[ripemd160LeftWords[i]] +
+                            ripemd160LeftConstants[Round], ripemd160LeftShifts[i]) + left.e;
+        left = Ripemd160Line{ left.e, t, left.b, rotateLeft(left.c, 10), left.d };
+
+        t = rotateLeft(right.a + ripemd160Mix<4 - Round>(right.b, right.c, right.d) + words[ripemd160RightWords[i]] +
+                       ripemd160RightConstants[Round], ripemd160RightShifts[i]) + right.e;
+        right = Ripemd160Line{ right.e, t, right.b, rotateLeft(right.c, 10), right.d };
+    }
+}
+
+static void ripemd160Transform(uint32_t* state, const uint8_t* block) noexcept {
+    uint32_t words[16];
+    for (size_t i{ 0 }; i < 16; ++i) {
+        words[i] = readLittleEndian32(block + i * 4);
+    }
+
+    Ripemd160Line left{ state[0], state[1], state[2], state[3], state[4] };
+    auto right = left;
+    ripemd160Round<0>(left, right, words);
+    ripemd160Round<1>(left, right, words);
+    ripemd160Round<2>(left, right, words);
+    ripemd160Round<3>(left, right, words);
+    ripemd160Round<4>(left, right, words);
+
+    const auto t = state[1] + left.c + right.d;
+    state[1] = state[2] + left.d + right.e;
+    state[2] = state[3] + left.e + right.a;
+    state[3] = state[4] + left.a + right.b;
+    state[4] = state[0] + left.b + right.c;
+    state[0] = t;
+}
+
+Ripemd160Digest ripemd160(const uint8_t* data, const size_t length) noexcept {
+    uint32_t state[5]{ 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+    const auto fullBlocks = length / ripemd160BlockSize;
+    for (size_t i{ 0 }; i < fullBlocks; ++i) {
+        ripemd160Transform(state, data + i * ripemd160BlockSize);
+    }
+
+    uint8_t finalBlocks[128];
+    const auto consumed = fullBlocks * ripemd160BlockSize;
+    const auto paddedLength = padFinalBlocks(finalBlocks, data + consumed, length - consumed, length, false);
+    for (size_t offset{ 0 }; offset < paddedLength; offset += ripemd160BlockSize) {
+        ripemd160Transform(state, finalBlocks + offset);
+    }
+
+    Ripemd160Digest digest{ };
+    for (size_t i{ 0 }; i < 5; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(state[i]);
+        digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 8);
+        digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 16);
+        digest[i * 4 + 3] = static_cast<uint8_t>(state[i] >> 24);
+    }
+    return digest;
+}
+
+Ripemd160Digest hash160(const uint8_t* data, const size_t length) noexcept {
+    const auto digest = sha256(data, length);
+    return ripemd160(digest.data(), digest.size());
+}
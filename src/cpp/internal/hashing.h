@@ -0,0 +1,22 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_HASHING_H__
+#define __CKTAP_PROTOCOL__INTERNAL_HASHING_H__
+
+// STL
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+using Sha256Digest = std::array<uint8_t, 32>;
+using Ripemd160Digest = std::array<uint8_t, 20>;
+
+/// Whether SHA-256 is computed with the CPU's SHA extensions rather than the portable implementation. Decided
+/// once per process from the CPU's feature flags
+bool isHardwareSha256Enabled() noexcept;
+
+Sha256Digest sha256(const uint8_t* data, size_t length) noexcept;
+Ripemd160Digest ripemd160(const uint8_t* data, size_t length) noexcept;
+
+/// RIPEMD-160 of the SHA-256 of the data, as used by Bitcoin for public key hashes
+Ripemd160Digest hash160(const uint8_t* data, size_t length) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_HASHING_H__
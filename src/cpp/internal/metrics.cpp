@@ -0,0 +1,225 @@
+#include <internal/metrics.h>
+
+// libc
+#if defined(_WIN32)
+    #include <malloc.h>
+#endif
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+Metrics g_metrics{ };
+#if CKTAP_TRACK_ALLOCATIONS
+thread_local int64_t t_threadAllocations{ 0 };
+#endif
+
+void LatencyStatistics::record(const int64_t micros) noexcept {
+    samples.fetch_add(1, std::memory_order_relaxed);
+    totalMicros.fetch_add(micros, std::memory_order_relaxed);
+    totalSquaredMicros.fetch_add(micros * micros, std::memory_order_relaxed);
+
+    auto currentMax = maxMicros.load(std::memory_order_relaxed);
+    while (micros > currentMax && !maxMicros.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed)) { }
+}
+
+void LatencyStatistics::fill(int64_t& mean, int64_t& standardDeviation, int64_t& max) const noexcept {
+    const auto count = samples.load(std::memory_order_relaxed);
+    max = maxMicros.load(std::memory_order_relaxed);
+    if (count == 0) {
+        mean = 0;
+        standardDeviation = 0;
+        return;
+    }
+
+    const auto average = static_cast<double>(totalMicros.load(std::memory_order_relaxed)) / count;
+    const auto variance = static_cast<double>(totalSquaredMicros.load(std::memory_order_relaxed)) / count - average * average;
+    mean = std::llround(average);
+    standardDeviation = variance > 0 ? std::llround(std::sqrt(variance)) : 0;
+}
+
+void LatencyStatistics::reset() noexcept {
+    samples = 0;
+    totalMicros = 0;
+    totalSquaredMicros = 0;
+    maxMicros = 0;
+}
+
+void OperationMetrics::beginOperation() noexcept {
+    startAllocations = g_metrics.totalAllocations.load();
+}
+
+void OperationMetrics::recordCancellationLatency(const int64_t micros) noexcept {
+    lastCancellationLatencyMicros = micros;
+    auto maxLatency = maxCancellationLatencyMicros.load();
+    while (micros > maxLatency && !maxCancellationLatencyMicros.compare_exchange_weak(maxLatency, micros)) { }
+}
+
+void OperationMetrics::reset() noexcept {
+    startAllocations = 0;
+    lastRoundTripMicros = 0;
+    transportTimeoutMicros = 0;
+    lastCancellationLatencyMicros = 0;
+    maxCancellationLatencyMicros = 0;
+}
+
+CKTapMetrics makeMetricsSnapshot(const OperationMetrics& operation, const AuditLog& auditLog) noexcept {
+    CKTapMetrics metrics;
+    std::memset(&metrics, 0, sizeof(metrics));
+
+    const auto allocations = g_metrics.totalAllocations.load();
+    metrics.isAllocationTrackingEnabled = CKTAP_TRACK_ALLOCATIONS ? 1 : 0;
+    metrics.totalAllocations = allocations;
+    // Another context resetting the totals part way through an operation would otherwise make this negative
+    metrics.operationAllocations = (std::max)(allocations - operation.startAllocations.load(), int64_t{ 0 });
+    metrics.illegalStateTransitions = g_metrics.illegalStateTransitions.load();
+    metrics.contendedStateTransitions = g_metrics.contendedStateTransitions.load();
+    metrics.lastRoundTripMicros = operation.lastRoundTripMicros.load();
+    metrics.transportTimeoutMicros = operation.transportTimeoutMicros.load();
+    metrics.lastCancellationLatencyMicros = operation.lastCancellationLatencyMicros.load();
+    metrics.maxCancellationLatencyMicros = operation.maxCancellationLatencyMicros.load();
+    metrics.securePoolBytesLocked = g_metrics.securePoolBytesLocked.load();
+    metrics.securePoolFallbacks = g_metrics.securePoolFallbacks.load();
+    metrics.auditRecordsWritten = auditLog.recordsWritten();
+    metrics.auditRecordsDropped = auditLog.recordsDropped();
+    metrics.watchdogInterventions = g_metrics.watchdogInterventions.load();
+    metrics.roundTripSamples = g_metrics.roundTrips.samples.load();
+    g_metrics.roundTrips.fill(metrics.meanRoundTripMicros, metrics.roundTripJitterMicros, metrics.maxRoundTripMicros);
+    g_metrics.wakeLatencies.fill(metrics.meanWakeLatencyMicros, metrics.wakeLatencyJitterMicros, metrics.maxWakeLatencyMicros);
+    metrics.workerSchedulingFailures = g_metrics.workerSchedulingFailures.load();
+    return metrics;
+}
+
+void resetMetrics(OperationMetrics& operation, AuditLog& auditLog) noexcept {
+    g_metrics.totalAllocations = 0;
+    g_metrics.illegalStateTransitions = 0;
+    g_metrics.contendedStateTransitions = 0;
+    operation.reset();
+    g_metrics.securePoolFallbacks = 0;
+    auditLog.resetCounts();
+    g_metrics.watchdogInterventions = 0;
+    g_metrics.roundTrips.reset();
+    g_metrics.wakeLatencies.reset();
+    g_metrics.workerSchedulingFailures = 0;
+}
+
+#if CKTAP_TRACK_ALLOCATIONS
+// Replace the global allocation functions so every allocation made through new, including those made by
+// the STL and tap_protocol, is counted. This is only intended for test and profiling builds
+static void* allocateTracked(std::size_t size) {
+    trackAllocation();
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{ };
+}
+
+void* operator new(std::size_t size) {
+    return allocateTracked(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocateTracked(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocateTracked(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocateTracked(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+// Over-aligned types are allocated through these instead, they have to be counted too and freed to match
+static void* allocateTrackedAligned(std::size_t size, std::align_val_t alignment) {
+    trackAllocation();
+    const auto bytes = size == 0 ? 1 : size;
+    const auto alignmentBytes = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+#if defined(_WIN32)
+    if (void* pointer = _aligned_malloc(bytes, alignmentBytes)) {
+        return pointer;
+    }
+#else
+    void* pointer{ nullptr };
+    if (posix_memalign(&pointer, alignmentBytes, bytes) == 0) {
+        return pointer;
+    }
+#endif
+    throw std::bad_alloc{ };
+}
+
+static void freeTrackedAligned(void* pointer) noexcept {
+#if defined(_WIN32)
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateTrackedAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateTrackedAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateTrackedAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateTrackedAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    freeTrackedAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    freeTrackedAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeTrackedAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeTrackedAligned(pointer);
+}
+#endif
@@ -0,0 +1,92 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_METRICS_H__
+#define __CKTAP_PROTOCOL__INTERNAL_METRICS_H__
+
+// Project
+#include <internal/audit_log.h>
+#include <structs.h>
+
+// STL
+#include <atomic>
+#include <cstdint>
+
+#if !defined(CKTAP_TRACK_ALLOCATIONS)
+    #define CKTAP_TRACK_ALLOCATIONS 0
+#endif
+
+/// Running totals from which the mean and standard deviation of a latency are derived. The sum of squares only
+/// overflows after millions of samples of a second or more, long before that the metrics will have been reset
+struct LatencyStatistics {
+    std::atomic<int64_t> samples{ 0 };
+    std::atomic<int64_t> totalMicros{ 0 };
+    std::atomic<int64_t> totalSquaredMicros{ 0 };
+    std::atomic<int64_t> maxMicros{ 0 };
+
+    void record(int64_t micros) noexcept;
+    /// The fields are read one at a time, so a sample recorded part way through may skew a snapshot slightly
+    void fill(int64_t& mean, int64_t& standardDeviation, int64_t& max) const noexcept;
+    void reset() noexcept;
+};
+
+/// Counters about the operations of one protocol thread, so concurrent contexts don't overwrite each other's. Each
+/// context and each PC/SC reader owns one, they're atomic as both the host and the protocol thread update them
+struct OperationMetrics {
+    std::atomic<int64_t> startAllocations{ 0 };
+    std::atomic<int64_t> lastRoundTripMicros{ 0 };
+    std::atomic<int64_t> transportTimeoutMicros{ 0 };
+    std::atomic<int64_t> lastCancellationLatencyMicros{ 0 };
+    std::atomic<int64_t> maxCancellationLatencyMicros{ 0 };
+
+    /// Marks the start of a new operation so that allocations can be attributed to it
+    void beginOperation() noexcept;
+    void recordCancellationLatency(int64_t micros) noexcept;
+    void reset() noexcept;
+};
+
+/// Performance counters which are shared across the library, totals over every context. Every member is atomic
+/// so they can be updated from both the host and the protocol threads without locking
+struct Metrics {
+    std::atomic<int64_t> totalAllocations{ 0 };
+    std::atomic<int64_t> illegalStateTransitions{ 0 };
+    std::atomic<int64_t> contendedStateTransitions{ 0 };
+    std::atomic<int64_t> securePoolBytesLocked{ 0 };
+    std::atomic<int64_t> securePoolFallbacks{ 0 };
+    std::atomic<int64_t> watchdogInterventions{ 0 };
+    LatencyStatistics roundTrips{ };
+    LatencyStatistics wakeLatencies{ };
+    std::atomic<int64_t> workerSchedulingFailures{ 0 };
+};
+
+// Globals
+extern Metrics g_metrics;
+
+#if CKTAP_TRACK_ALLOCATIONS
+/// The allocations made by each thread, so one thread's can be told apart from the protocol thread's
+extern thread_local int64_t t_threadAllocations;
+#endif
+
+/// Records a heap allocation made by the library. Only counts when built with
+/// CKTAP_TRACK_ALLOCATIONS, otherwise this compiles to nothing
+inline void trackAllocation() noexcept {
+#if CKTAP_TRACK_ALLOCATIONS
+    g_metrics.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    ++t_threadAllocations;
+#endif
+}
+
+/// The allocations made so far by the calling thread, always 0 without CKTAP_TRACK_ALLOCATIONS
+inline int64_t threadAllocationCount() noexcept {
+#if CKTAP_TRACK_ALLOCATIONS
+    return t_threadAllocations;
+#else
+    return 0;
+#endif
+}
+
+/// Takes a snapshot of the process-wide metrics alongside a context's [operation] metrics and the counts of its
+/// [auditLog], in a C-compatible format
+CKTapMetrics makeMetricsSnapshot(const OperationMetrics& operation, const AuditLog& auditLog) noexcept;
+
+/// Zeroes every process-wide counter and those of a context, gauges such as securePoolBytesLocked are left as they are
+void resetMetrics(OperationMetrics& operation, AuditLog& auditLog) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_METRICS_H__
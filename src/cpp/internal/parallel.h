@@ -0,0 +1,51 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_PARALLEL_H__
+#define __CKTAP_PROTOCOL__INTERNAL_PARALLEL_H__
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// Workers claim this many jobs at a time so the shared counter isn't hammered
+constexpr size_t parallelJobsPerClaim = 16;
+
+/// Splits [jobCount] jobs between short-lived worker threads and the caller's thread, calling [func] with each
+/// claimed range of job indices, which never holds more than [parallelJobsPerClaim] jobs. Spinning up a thread
+/// costs more than a handful of cheap jobs so there's at most one thread per [minJobsPerThread] jobs. [func] must
+/// not throw. Returns how many threads took part
+template <typename Func>
+size_t runInParallel(const size_t jobCount, const size_t minJobsPerThread, const Func& func) noexcept {
+    const auto hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const auto usefulThreads = (jobCount + minJobsPerThread - 1) / std::max<size_t>(minJobsPerThread, 1);
+    const auto threadCount = std::max<size_t>(std::min(hardwareThreads, usefulThreads), 1);
+
+    std::atomic<size_t> nextJob{ 0 };
+    const auto work = [jobCount, &func, &nextJob]() {
+        while (true) {
+            const auto begin = nextJob.fetch_add(parallelJobsPerClaim, std::memory_order_relaxed);
+            if (begin >= jobCount) {
+                return;
+            }
+            func(begin, std::min(begin + parallelJobsPerClaim, jobCount));
+        }
+    };
+
+    std::vector<std::thread> workers{ };
+    try {
+        workers.reserve(threadCount - 1);
+        for (size_t i{ 1 }; i < threadCount; ++i) {
+            workers.emplace_back(work);
+        }
+    } catch (...) {
+        // Couldn't start every worker, the ones which did start and the caller share the work instead
+    }
+
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return workers.size() + 1;
+}
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_PARALLEL_H__
@@ -0,0 +1,431 @@
+#include <internal/pcsc_readers.h>
+
+// Project
+#include <internal/utils.h>
+
+// STL
+#include <cstring>
+
+#if CKTAP_ENABLE_PCSC
+
+// Project
+#include <internal/card_pipeline.h>
+#include <internal/context_services.h>
+#include <internal/globals.h>
+#include <internal/metrics.h>
+#include <internal/result.h>
+#include <internal/tap_protocol_thread.h>
+
+// Third party
+#include <winscard.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/// How long a worker waits for a card before checking whether it should stop
+constexpr DWORD readerPollMillis = 250;
+/// Upper bound on how long a worker sleeps between transport requests, stopping wakes it sooner
+constexpr auto readerTransportWakeInterval = 50ms;
+constexpr auto readerPipelineRetryInterval = 10ms;
+
+/// Drives one reader. The worker thread plays the part the Dart host plays for the library's protocol thread,
+/// moving each transport request to the card with SCardTransmit and handing the reply back
+class ReaderWorker {
+public:
+
+    ReaderWorker(std::string name, int32_t cardType, std::shared_ptr<CardPipeline> pipeline,
+                 std::shared_ptr<ContextServices> services);
+    ~ReaderWorker();
+
+    bool start() noexcept;
+    void requestStop() noexcept;
+    void join() noexcept;
+    void fillStats(CKTapReaderStats& stats) const;
+
+private:
+
+    void _run() noexcept;
+    CKTapInterfaceErrorCode _runSession(SCARDCONTEXT context) noexcept;
+    CKTapInterfaceErrorCode _performHandshake(SCARDHANDLE card, DWORD protocol) noexcept;
+    CKTapInterfaceErrorCode _submitCard() noexcept;
+    void _recordSession(CKTapInterfaceErrorCode errorCode, std::chrono::microseconds duration) noexcept;
+
+    std::string _name{ };
+    int32_t _cardType{ CKTapCardType::unknownCard };
+    std::shared_ptr<CardPipeline> _pipeline{ };
+    std::shared_ptr<ContextServices> _services{ };
+    /// Kept apart from the starting context's so the readers' sessions don't overwrite its operation's metrics
+    OperationMetrics _operationMetrics{ };
+    std::unique_ptr<TapProtocolThread> _protocolThread{ };
+    std::vector<uint8_t> _responseBuffer{ };
+    std::thread _thread{ };
+
+    std::atomic<bool> _shouldStop{ false };
+    std::atomic<bool> _isRunning{ false };
+    std::atomic<int64_t> _completedSessions{ 0 };
+    std::atomic<int64_t> _failedSessions{ 0 };
+    std::atomic<int64_t> _totalSessionMicros{ 0 };
+    std::atomic<CKTapInterfaceErrorCode> _lastError{ CKTapInterfaceErrorCode::success };
+};
+
+/// The readers belong to the process rather than a context, since each one can only be connected to once. The mutex
+/// lets isolates start, stop and poll them concurrently
+static std::mutex g_readerWorkersMutex{ };
+static std::vector<std::unique_ptr<ReaderWorker>> g_readerWorkers{ };
+static std::chrono::steady_clock::time_point g_readersStarted{ };
+
+ReaderWorker::ReaderWorker(std::string name, const int32_t cardType, std::shared_ptr<CardPipeline> pipeline,
+                           std::shared_ptr<ContextServices> services)
+    : _name{ std::move(name) },
+      _cardType{ cardType },
+      _pipeline{ std::move(pipeline) },
+      _services{ std::move(services) },
+      _operationMetrics{ },
+      _protocolThread{ TapProtocolThread::createNew(_services, _operationMetrics) },
+      _responseBuffer(MAX_BUFFER_SIZE_EXTENDED) {
+}
+
+ReaderWorker::~ReaderWorker() {
+    requestStop();
+    join();
+}
+
+bool ReaderWorker::start() noexcept {
+    if (_protocolThread == nullptr || _thread.joinable()) {
+        return false;
+    }
+
+    try {
+        _isRunning = true;
+        _thread = std::thread{ [this]() { _run(); } };
+        return true;
+    } catch (...) {
+        _isRunning = false;
+        return false;
+    }
+}
+
+void ReaderWorker::requestStop() noexcept {
+    _shouldStop = true;
+    if (_protocolThread != nullptr) {
+        _protocolThread->requestCancel();
+    }
+}
+
+void ReaderWorker::join() noexcept {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void ReaderWorker::fillStats(CKTapReaderStats& stats) const {
+    const auto completed = _completedSessions.load();
+    const auto sessions = completed + _failedSessions.load();
+    stats.name = allocateCStringFromCpp(_name);
+    stats.isRunning = _isRunning ? 1 : 0;
+    stats.completedSessions = completed;
+    stats.failedSessions = _failedSessions;
+    stats.lastError = _lastError;
+    stats.averageSessionMicros = sessions > 0 ? _totalSessionMicros / sessions : 0;
+}
+
+void ReaderWorker::_run() noexcept {
+    SCARDCONTEXT context{ };
+    if (SCardEstablishContext(SCARD_SCOPE_SYSTEM, nullptr, nullptr, &context) != SCARD_S_SUCCESS) {
+        _lastError = CKTapInterfaceErrorCode::pcscReaderError;
+        _isRunning = false;
+        return;
+    }
+
+    SCARD_READERSTATE state;
+    std::memset(&state, 0, sizeof(state));
+    state.szReader = _name.c_str();
+    state.dwCurrentState = SCARD_STATE_UNAWARE;
+
+    // Every card is read once per placement, it has to be lifted off the reader before it's read again
+    bool isCardHandled{ false };
+    while (!_shouldStop) {
+        const auto result = SCardGetStatusChange(context, readerPollMillis, &state, 1);
+        if (result == SCARD_E_TIMEOUT) {
+            continue;
+        }
+        if (result != SCARD_S_SUCCESS) {
+            // Usually the reader was unplugged
+            _lastError = CKTapInterfaceErrorCode::pcscReaderError;
+            break;
+        }
+
+        state.dwCurrentState = state.dwEventState & ~static_cast<DWORD>(SCARD_STATE_CHANGED);
+        const bool isCardPresent =
+            (state.dwEventState & SCARD_STATE_PRESENT) != 0 &&
+            (state.dwEventState & SCARD_STATE_MUTE) == 0;
+        if (!isCardPresent) {
+            isCardHandled = false;
+        } else if (!isCardHandled) {
+            isCardHandled = true;
+            const auto startTime = std::chrono::steady_clock::now();
+            const auto errorCode = _runSession(context);
+            _recordSession(errorCode, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime));
+        }
+    }
+
+    SCardReleaseContext(context);
+    _isRunning = false;
+}
+
+CKTapInterfaceErrorCode ReaderWorker::_runSession(const SCARDCONTEXT context) noexcept {
+    // The reader thread carries the other half of every round trip, so it's scheduled like the protocol thread
+    _services->workerScheduling.apply();
+
+    SCARDHANDLE card{ };
+    DWORD protocol{ 0 };
+    if (SCardConnect(context, _name.c_str(), SCARD_SHARE_EXCLUSIVE, SCARD_PROTOCOL_T0 | SCARD_PROTOCOL_T1, &card, &protocol) != SCARD_S_SUCCESS) {
+        return CKTapInterfaceErrorCode::pcscReaderError;
+    }
+
+    auto errorCode = _performHandshake(card, protocol);
+    SCardDisconnect(card, SCARD_LEAVE_CARD);
+
+    // The card doesn't need the reader once the handshake is done, so the reader is released before waiting on
+    // the pipeline
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        errorCode = _submitCard();
+    }
+    _protocolThread->reset();
+    return errorCode;
+}
+
+CKTapInterfaceErrorCode ReaderWorker::_performHandshake(const SCARDHANDLE card, const DWORD protocol) noexcept {
+    const auto resetError = _protocolThread->reset();
+    if (resetError != CKTapInterfaceErrorCode::success) {
+        return resetError;
+    }
+    if (!_protocolThread->beginCardHandshake(_cardType)) {
+        return _protocolThread->finalizeOperation() ?
+            _protocolThread->getRecentErrorCode() :
+            CKTapInterfaceErrorCode::unknownErrorDuringHandshake;
+    }
+
+    const auto* sendPci = protocol == SCARD_PROTOCOL_T0 ? SCARD_PCI_T0 : SCARD_PCI_T1;
+    bool hasTransportFailed{ false };
+    while (_protocolThread->isThreadActive()) {
+        if (_shouldStop) {
+            _protocolThread->requestCancel();
+        }
+
+        // The request stays ready until the cancel unwinds the protocol thread, which only takes a moment
+        if (hasTransportFailed) {
+            _protocolThread->waitForCancellation(std::chrono::steady_clock::now() + readerTransportWakeInterval);
+            continue;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + readerTransportWakeInterval;
+        if (!_protocolThread->waitForTransportRequest(deadline)) {
+            continue;
+        }
+
+        const auto request = _protocolThread->getTransportRequest();
+        if (!request.has_value()) {
+            continue;
+        }
+
+        const auto& bytes = *request.value();
+        auto length = static_cast<DWORD>(_responseBuffer.size());
+        const auto result = SCardTransmit(card, sendPci, bytes.data(), static_cast<DWORD>(bytes.size()), nullptr,
+                                          _responseBuffer.data(), &length);
+        auto buffer = result == SCARD_S_SUCCESS ?
+            _protocolThread->allocateTransportResponseBuffer(length) :
+            std::optional<uint8_t*>{ };
+        if (!buffer.has_value()) {
+            // The protocol thread is waiting on a reply which will never come, cancelling unwinds it
+            hasTransportFailed = true;
+            _protocolThread->requestCancel();
+            continue;
+        }
+
+        std::memcpy(*buffer, _responseBuffer.data(), length);
+        _protocolThread->finalizeTransportResponse();
+    }
+
+    if (!_protocolThread->finalizeOperation()) {
+        return CKTapInterfaceErrorCode::unableToFinalizeAsyncAction;
+    }
+    return hasTransportFailed ?
+        CKTapInterfaceErrorCode::pcscReaderError :
+        _protocolThread->getRecentErrorCode();
+}
+
+CKTapInterfaceErrorCode ReaderWorker::_submitCard() noexcept {
+    while (true) {
+        const auto ticket = submitPipelinedCard(*_pipeline, *_protocolThread, true);
+        if (ticket.errorCode != CKTapInterfaceErrorCode::pipelineQueueFull) {
+            return ticket.errorCode;
+        }
+        if (_shouldStop) {
+            return CKTapInterfaceErrorCode::operationCanceled;
+        }
+        std::this_thread::sleep_for(readerPipelineRetryInterval);
+    }
+}
+
+void ReaderWorker::_recordSession(const CKTapInterfaceErrorCode errorCode, const std::chrono::microseconds duration) noexcept {
+    _totalSessionMicros += static_cast<int64_t>(duration.count());
+    if (errorCode == CKTapInterfaceErrorCode::success) {
+        ++_completedSessions;
+    } else {
+        ++_failedSessions;
+        _lastError = errorCode;
+    }
+}
+
+/// Reader names come back as one buffer of null terminated strings, ending with an empty string
+static Result<std::vector<std::string>> listReaderNames() {
+    using NamesResult = Result<std::vector<std::string>>;
+
+    SCARDCONTEXT context{ };
+    if (SCardEstablishContext(SCARD_SCOPE_SYSTEM, nullptr, nullptr, &context) != SCARD_S_SUCCESS) {
+        return NamesResult::failure(CKTapInterfaceErrorCode::pcscReaderError);
+    }
+
+    DWORD length{ 0 };
+    std::vector<char> buffer{ };
+    auto result = SCardListReaders(context, nullptr, nullptr, &length);
+    if (result == SCARD_S_SUCCESS) {
+        buffer.resize(length);
+        result = SCardListReaders(context, nullptr, buffer.data(), &length);
+    }
+    SCardReleaseContext(context);
+
+    if (result != SCARD_S_SUCCESS || buffer.empty()) {
+        return NamesResult::failure(CKTapInterfaceErrorCode::pcscReaderError);
+    }
+
+    std::vector<std::string> names{ };
+    for (const char* name = buffer.data(); *name != '\0'; name += std::strlen(name) + 1) {
+        names.emplace_back(name);
+    }
+    return NamesResult{ std::move(names) };
+}
+
+/// Every worker is told to stop before any is joined so their sessions unwind in parallel
+static void stopReaderWorkersLocked() noexcept {
+    for (auto& worker : g_readerWorkers) {
+        worker->requestStop();
+    }
+    g_readerWorkers.clear();
+}
+
+CKTapInterfaceErrorCode startReaderWorkers(const int32_t cardType) noexcept {
+    const auto pipeline = currentCardPipeline();
+    if (pipeline == nullptr) {
+        return CKTapInterfaceErrorCode::unexpectedStdException;
+    }
+    const auto services = currentContext().services;
+    if (services == nullptr) {
+        return CKTapInterfaceErrorCode::libraryNotInitialized;
+    }
+
+    std::lock_guard<std::mutex> lock{ g_readerWorkersMutex };
+    if (!g_readerWorkers.empty()) {
+        return CKTapInterfaceErrorCode::threadAlreadyInUse;
+    }
+
+    try {
+        const auto names = listReaderNames();
+        if (!names) {
+            return names.error();
+        }
+
+        for (const auto& name : *names) {
+            g_readerWorkers.push_back(std::make_unique<ReaderWorker>(name, cardType, pipeline, services));
+            if (!g_readerWorkers.back()->start()) {
+                stopReaderWorkersLocked();
+                return CKTapInterfaceErrorCode::threadAllocationFailed;
+            }
+        }
+    } catch (...) {
+        stopReaderWorkersLocked();
+        return CKTapInterfaceErrorCode::threadAllocationFailed;
+    }
+
+    g_readersStarted = std::chrono::steady_clock::now();
+    return CKTapInterfaceErrorCode::success;
+}
+
+CKTapInterfaceErrorCode stopReaderWorkers() noexcept {
+    std::lock_guard<std::mutex> lock{ g_readerWorkersMutex };
+    stopReaderWorkersLocked();
+    return CKTapInterfaceErrorCode::success;
+}
+
+CKTapReaderStatsList getReaderStats() noexcept {
+    CKTapReaderStatsList list;
+    std::memset(&list, 0, sizeof(list));
+    list.status.errorCode = CKTapInterfaceErrorCode::success;
+
+    std::lock_guard<std::mutex> lock{ g_readerWorkersMutex };
+    if (g_readerWorkers.empty()) {
+        return list;
+    }
+
+    list.array = allocateCArray<CKTapReaderStats>(g_readerWorkers.size());
+    if (list.array == nullptr) {
+        list.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+        return list;
+    }
+
+    int64_t completedSessions{ 0 };
+    try {
+        for (const auto& worker : g_readerWorkers) {
+            auto& stats = list.array[list.length++];
+            worker->fillStats(stats);
+            completedSessions += stats.completedSessions;
+        }
+    } catch (...) {
+        list.status.errorCode = CKTapInterfaceErrorCode::unexpectedStdException;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_readersStarted);
+    list.elapsedMicros = static_cast<int64_t>(elapsed.count());
+    list.cardsPerMinute = list.elapsedMicros > 0 ? completedSessions * 60'000'000 / list.elapsedMicros : 0;
+    return list;
+}
+
+#else
+
+CKTapInterfaceErrorCode startReaderWorkers(const int32_t) noexcept {
+    return CKTapInterfaceErrorCode::pcscNotAvailable;
+}
+
+CKTapInterfaceErrorCode stopReaderWorkers() noexcept {
+    return CKTapInterfaceErrorCode::pcscNotAvailable;
+}
+
+CKTapReaderStatsList getReaderStats() noexcept {
+    CKTapReaderStatsList list;
+    std::memset(&list, 0, sizeof(list));
+    list.status.errorCode = CKTapInterfaceErrorCode::pcscNotAvailable;
+    return list;
+}
+
+#endif // CKTAP_ENABLE_PCSC
+
+void freeReaderStatsList(CKTapReaderStatsList& list) noexcept {
+    freeCKTapInterfaceStatus(list.status);
+    if (list.array == nullptr) {
+        return;
+    }
+
+    for (int32_t i{ 0 }; i < list.length; ++i) {
+        freePointer(list.array[i].name);
+    }
+    freePointer(list.array);
+}
@@ -0,0 +1,30 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_PCSC_READERS_H__
+#define __CKTAP_PROTOCOL__INTERNAL_PCSC_READERS_H__
+
+// Project
+#include <structs.h>
+
+// STL
+#include <cstdint>
+
+/// The PC/SC backend needs pcsc-lite, it's only built on Linux when CKTAP_ENABLE_PCSC is set. Without it every
+/// function below fails with pcscNotAvailable
+#if !defined(CKTAP_ENABLE_PCSC)
+    #define CKTAP_ENABLE_PCSC 0
+#endif
+
+/// Starts a worker for every connected reader. Each worker owns a TapProtocolThread and sends its transport
+/// requests straight to the reader, so cards are read without going through Dart. A handshake is performed on
+/// every card placed on a reader and the card is submitted to the current context's pipeline, see
+/// [pollPipelinedCards]. There's one set of workers per process, whichever context started them receives the cards
+/// and lends them its scheduling, audit log and watchdog timeout
+CKTapInterfaceErrorCode startReaderWorkers(int32_t cardType) noexcept;
+
+/// Cancels any session in progress and waits for every worker to exit
+CKTapInterfaceErrorCode stopReaderWorkers() noexcept;
+
+CKTapReaderStatsList getReaderStats() noexcept;
+
+void freeReaderStatsList(CKTapReaderStatsList& list) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_PCSC_READERS_H__
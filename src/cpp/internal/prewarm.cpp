@@ -0,0 +1,173 @@
+#include <internal/prewarm.h>
+
+// Project
+#include <core.h>
+#include <internal/card_cache.h>
+#include <internal/codecs.h>
+#include <internal/cpu_features.h>
+#include <internal/globals.h>
+#include <internal/secure_memory.h>
+#include <internal/slot_verification.h>
+#include <internal/utils.h>
+
+// STL
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+
+/// The generator point and its P2WPKH address from BIP-173, any valid key and address would do
+static const uint8_t g_prewarmPublicKey[slotPublicKeySize]{
+    0x02, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62, 0x95, 0xCE, 0x87, 0x0B, 0x07,
+    0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8, 0x17, 0x98
+};
+constexpr const char* prewarmAddress = "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4";
+constexpr std::array<size_t, 4> prewarmSecureSizes{ 32, 64, 128, maxSecureAllocationSize };
+
+/// Everything the background thread produces, the cached cards are only registered on the caller's thread
+struct PrewarmResult {
+    CKTapPrewarmReport report{ };
+    std::optional<CardCache> cache{ };
+};
+
+static CKTapPrewarmReport makePrewarmReport(const CKTapInterfaceErrorCode errorCode) noexcept {
+    CKTapPrewarmReport report;
+    std::memset(&report, 0, sizeof(report));
+    report.errorCode = errorCode;
+    return report;
+}
+
+/// Each context prewarms on its own, the one-time costs are only paid by the first but every context has its registry
+/// reserved and its card cache read
+struct PrewarmState {
+    std::future<PrewarmResult> result{ };
+    /// An empty successful report until the first prewarm starts, so polling without one never waits forever
+    CKTapPrewarmReport report{ makePrewarmReport(CKTapInterfaceErrorCode::success) };
+};
+
+/// Runs [step] and returns how long it took
+template <typename Step>
+static int64_t timePrewarmStep(const Step& step) {
+    const auto started = std::chrono::steady_clock::now();
+    step();
+    return microsSince(started);
+}
+
+/// Picks the hashing kernels, builds both networks' bech32 encoders and runs base58check once. The result doesn't
+/// matter, only that every lazily initialized piece of the slot and WIF paths has been through once
+static void prewarmCrypto() noexcept {
+    (void)cpuFeatures();
+    (void)isSlotAddressDerivedFrom(g_prewarmPublicKey, sizeof(g_prewarmPublicKey), prewarmAddress, false);
+    (void)isSlotAddressDerivedFrom(g_prewarmPublicKey, sizeof(g_prewarmPublicKey), prewarmAddress, true);
+
+    auto* privateKey = static_cast<uint8_t*>(allocateSecure(wifPrivateKeySize));
+    if (privateKey == nullptr) {
+        return;
+    }
+    std::memset(privateKey, 0x01, wifPrivateKeySize);
+    char wif[wifBufferSize];
+    (void)encodeWif(privateKey, false, wif, sizeof(wif));
+    secureZero(wif, sizeof(wif));
+    freeSecure(privateKey);
+}
+
+/// Locks a chunk of the secure pool for every size class, the chunks are kept for later allocations
+static void prewarmSecureMemory() noexcept {
+    for (const auto size : prewarmSecureSizes) {
+        auto* pointer = allocateSecure(size);
+        if (pointer != nullptr) {
+            freeSecure(pointer);
+        }
+    }
+}
+
+static PrewarmResult runPrewarm(const std::string cardCachePath, const std::chrono::steady_clock::time_point started) noexcept {
+    PrewarmResult result{ };
+    auto& report = result.report;
+    report = makePrewarmReport(CKTapInterfaceErrorCode::success);
+
+    try {
+        // Operations and the pipeline each start a thread, so the loader and the first thread's stack are paid here
+        report.threadMicros = timePrewarmStep([] {
+            std::async(std::launch::async, [] { }).wait();
+        });
+        report.cryptoMicros = timePrewarmStep(prewarmCrypto);
+        report.secureMemoryMicros = timePrewarmStep(prewarmSecureMemory);
+
+        if (!cardCachePath.empty()) {
+            report.cardCacheMicros = timePrewarmStep([&] {
+                auto cache = loadCardCache(cardCachePath);
+                if (cache) {
+                    result.cache = std::move(*cache);
+                } else {
+                    report.errorCode = cache.error();
+                }
+            });
+        }
+    } catch (...) {
+        report.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    }
+    report.elapsedMicros = microsSince(started);
+    return result;
+}
+
+CKTapInterfaceErrorCode startPrewarm(const CKTapPrewarmOptions& options) noexcept {
+    auto& context = currentContext();
+    if (context.prewarm != nullptr && context.prewarm->result.valid()) {
+        return CKTapInterfaceErrorCode::prewarmAlreadyRunning;
+    }
+
+    const auto errorCode = cktap::initializeLibrary();
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return errorCode;
+    }
+
+    try {
+        if (context.prewarm == nullptr) {
+            context.prewarm = std::make_shared<PrewarmState>();
+        }
+        context.satscards.reserve(static_cast<size_t>(std::max(options.expectedSatscards, 0)));
+        context.tapsigners.reserve(static_cast<size_t>(std::max(options.expectedTapsigners, 0)));
+
+        std::string cardCachePath{ options.cardCachePath != nullptr ? options.cardCachePath : "" };
+        auto& prewarm = *context.prewarm;
+        prewarm.report = makePrewarmReport(CKTapInterfaceErrorCode::pending);
+        prewarm.result = std::async(std::launch::async, runPrewarm, std::move(cardCachePath), std::chrono::steady_clock::now());
+    } catch (const std::system_error&) {
+        return CKTapInterfaceErrorCode::threadAllocationFailed;
+    } catch (...) {
+        return CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+    }
+    return CKTapInterfaceErrorCode::success;
+}
+
+CKTapPrewarmReport getPrewarmReport(const bool wait) noexcept {
+    auto* prewarm = currentContext().prewarm.get();
+    if (prewarm == nullptr) {
+        return makePrewarmReport(CKTapInterfaceErrorCode::success);
+    }
+    if (!prewarm->result.valid()) {
+        return prewarm->report;
+    }
+    if (!wait && prewarm->result.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready) {
+        return prewarm->report;
+    }
+
+    auto result = prewarm->result.get();
+    auto& report = result.report;
+    if (result.cache.has_value()) {
+        // Counted in the cache's time and the total, since it's part of what the first tap no longer waits for
+        const auto registrationMicros = timePrewarmStep([&] {
+            registerCachedCards(*result.cache, report.cachedSatscards, report.cachedTapsigners);
+        });
+        report.cardCacheMicros += registrationMicros;
+        report.elapsedMicros += registrationMicros;
+    }
+    prewarm->report = report;
+    return prewarm->report;
+}
@@ -0,0 +1,16 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_PREWARM_H__
+#define __CKTAP_PROTOCOL__INTERNAL_PREWARM_H__
+
+// Project
+#include <structs.h>
+
+/// Reserves the registry then starts a background thread which pays the one-time costs of the first tap: creating
+/// a thread, choosing the hashing kernels and building the encoders, tap_protocol's random source and WIF encoding,
+/// and mapping the secure pool. The card cache is read on the same thread. Must be called from the caller's thread
+CKTapInterfaceErrorCode startPrewarm(const CKTapPrewarmOptions& options) noexcept;
+
+/// The progress of the most recent prewarm, `errorCode` is pending whilst it's still running unless [wait] is set.
+/// Cached cards are registered here once it has finished, so the registry is only changed on the caller's thread
+CKTapPrewarmReport getPrewarmReport(bool wait) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_PREWARM_H__
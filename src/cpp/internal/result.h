@@ -0,0 +1,48 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_RESULT_H__
+#define __CKTAP_PROTOCOL__INTERNAL_RESULT_H__
+
+// Project
+#include <enums.h>
+
+// STL
+#include <optional>
+#include <utility>
+
+/// Either a value or the error code explaining why there isn't one. Used to pass failures through the library
+/// without throwing, exceptions are only caught where tap_protocol is called
+template <typename T>
+class Result {
+public:
+
+    Result(T value)
+        : _value{ std::move(value) }, _error{ CKTapInterfaceErrorCode::success } {
+    }
+
+    static Result failure(const CKTapInterfaceErrorCode error) noexcept {
+        return Result{ error };
+    }
+
+    bool hasValue() const noexcept { return _value.has_value(); }
+    explicit operator bool() const noexcept { return hasValue(); }
+    CKTapInterfaceErrorCode error() const noexcept { return _error; }
+
+    T& value() & noexcept { return *_value; }
+    const T& value() const& noexcept { return *_value; }
+    T&& value() && noexcept { return std::move(*_value); }
+    T& operator*() & noexcept { return *_value; }
+    const T& operator*() const& noexcept { return *_value; }
+    T&& operator*() && noexcept { return std::move(*_value); }
+    T* operator->() noexcept { return &*_value; }
+    const T* operator->() const noexcept { return &*_value; }
+
+private:
+
+    explicit Result(const CKTapInterfaceErrorCode error) noexcept
+        : _value{ }, _error{ error } {
+    }
+
+    std::optional<T> _value{ };
+    CKTapInterfaceErrorCode _error{ CKTapInterfaceErrorCode::pending };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_RESULT_H__
@@ -0,0 +1,229 @@
+#include <internal/secure_memory.h>
+
+// Project
+#include <internal/metrics.h>
+
+// libc
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+// STL
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+/// Each chunk is locked with a single syscall and split into slots of one size class
+constexpr size_t secureChunkSize = 16 * 1024;
+constexpr size_t maxSecureChunks = 64;
+constexpr std::array<size_t, 4> secureSizeClasses{ 32, 64, 128, maxSecureAllocationSize };
+
+struct SecureChunk {
+    uint8_t* begin{ nullptr };
+    size_t slotSize{ 0 };
+};
+
+/// Freed slots store a pointer to the next free slot of the same size
+struct FreeSlot {
+    FreeSlot* next{ nullptr };
+};
+
+/// Maps zeroed pages and tries to lock them into RAM, [isLocked] is set to whether locking succeeded
+static uint8_t* mapLockedPages(const size_t sizeInBytes, bool* isLocked) noexcept {
+    auto locked = false;
+#if defined(_WIN32)
+    auto* pages = static_cast<uint8_t*>(VirtualAlloc(nullptr, sizeInBytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+    if (pages == nullptr) {
+        return nullptr;
+    }
+    locked = VirtualLock(pages, sizeInBytes) != 0;
+#else
+    void* mapping = mmap(nullptr, sizeInBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    auto* pages = static_cast<uint8_t*>(mapping);
+
+    // Locking can fail when RLIMIT_MEMLOCK is low, the memory is still zeroed on free so we carry on
+    locked = mlock(pages, sizeInBytes) == 0;
+    #if defined(MADV_DONTDUMP)
+    madvise(pages, sizeInBytes, MADV_DONTDUMP);
+    #endif
+#endif
+    if (locked) {
+        g_metrics.securePoolBytesLocked.fetch_add(static_cast<int64_t>(sizeInBytes));
+    }
+    if (isLocked != nullptr) {
+        *isLocked = locked;
+    }
+    return pages;
+}
+
+static void unmapLockedPages(uint8_t* pages, const size_t sizeInBytes, const bool isLocked) noexcept {
+    if (isLocked) {
+        g_metrics.securePoolBytesLocked.fetch_sub(static_cast<int64_t>(sizeInBytes));
+    }
+#if defined(_WIN32)
+    if (isLocked) {
+        VirtualUnlock(pages, sizeInBytes);
+    }
+    VirtualFree(pages, 0, MEM_RELEASE);
+#else
+    if (isLocked) {
+        munlock(pages, sizeInBytes);
+    }
+    munmap(pages, sizeInBytes);
+#endif
+}
+
+class SecurePool {
+public:
+
+    void* allocate(const size_t sizeInBytes) noexcept {
+        const auto sizeClass = _sizeClassFor(sizeInBytes);
+        if (sizeClass == secureSizeClasses.size()) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (_freeLists[sizeClass] == nullptr && !_addChunk(sizeClass)) {
+            return nullptr;
+        }
+
+        auto* slot = _freeLists[sizeClass];
+        _freeLists[sizeClass] = slot->next;
+        secureZero(slot, sizeof(FreeSlot));
+        return slot;
+    }
+
+    bool release(void* pointer) noexcept {
+        const auto* chunk = _findChunk(pointer);
+        if (chunk == nullptr) {
+            return false;
+        }
+
+        secureZero(pointer, chunk->slotSize);
+
+        std::lock_guard<std::mutex> lock{ _mutex };
+        const auto sizeClass = _sizeClassFor(chunk->slotSize);
+        auto* slot = static_cast<FreeSlot*>(pointer);
+        slot->next = _freeLists[sizeClass];
+        _freeLists[sizeClass] = slot;
+        return true;
+    }
+
+private:
+
+    static size_t _sizeClassFor(const size_t sizeInBytes) noexcept {
+        for (size_t i{ 0 }; i < secureSizeClasses.size(); ++i) {
+            if (sizeInBytes <= secureSizeClasses[i]) {
+                return i;
+            }
+        }
+        return secureSizeClasses.size();
+    }
+
+    /// Must be called with the mutex held
+    bool _addChunk(const size_t sizeClass) noexcept {
+        const auto count = _chunkCount.load(std::memory_order_relaxed);
+        if (count == maxSecureChunks) {
+            return false;
+        }
+
+        auto* pages = mapLockedPages(secureChunkSize, nullptr);
+        if (pages == nullptr) {
+            return false;
+        }
+
+        const auto slotSize = secureSizeClasses[sizeClass];
+        for (size_t offset{ 0 }; offset + slotSize <= secureChunkSize; offset += slotSize) {
+            auto* slot = reinterpret_cast<FreeSlot*>(pages + offset);
+            slot->next = _freeLists[sizeClass];
+            _freeLists[sizeClass] = slot;
+        }
+
+        _chunks[count] = SecureChunk{ pages, slotSize };
+        _chunkCount.store(count + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Chunks are never unmapped so this can safely run without the mutex
+    const SecureChunk* _findChunk(const void* pointer) const noexcept {
+        const auto* bytes = static_cast<const uint8_t*>(pointer);
+        const auto count = _chunkCount.load(std::memory_order_acquire);
+        for (size_t i{ 0 }; i < count; ++i) {
+            const auto& chunk = _chunks[i];
+            if (bytes >= chunk.begin && bytes < chunk.begin + secureChunkSize) {
+                return &chunk;
+            }
+        }
+        return nullptr;
+    }
+
+    std::mutex _mutex{ };
+    std::array<FreeSlot*, secureSizeClasses.size()> _freeLists{ };
+    std::array<SecureChunk, maxSecureChunks> _chunks{ };
+    std::atomic<size_t> _chunkCount{ 0 };
+};
+
+static SecurePool& securePool() noexcept {
+    static SecurePool pool{ };
+    return pool;
+}
+
+void* allocateSecure(const size_t sizeInBytes) noexcept {
+    return securePool().allocate(sizeInBytes);
+}
+
+bool freeSecure(void* pointer) noexcept {
+    return pointer != nullptr && securePool().release(pointer);
+}
+
+/// Sits at the start of every secure buffer so it can be unmapped given only the pointer handed out
+struct SecureBufferHeader {
+    size_t mappedSize{ 0 };
+    bool isLocked{ false };
+};
+constexpr size_t secureBufferHeaderSize = 64;
+static_assert(sizeof(SecureBufferHeader) <= secureBufferHeaderSize, "Secure buffer header doesn't fit");
+
+void* allocateSecureBuffer(const size_t sizeInBytes) noexcept {
+    if (sizeInBytes == 0 || sizeInBytes > SIZE_MAX - secureBufferHeaderSize) {
+        return nullptr;
+    }
+
+    const auto mappedSize = sizeInBytes + secureBufferHeaderSize;
+    auto isLocked = false;
+    auto* pages = mapLockedPages(mappedSize, &isLocked);
+    if (pages == nullptr) {
+        return nullptr;
+    }
+
+    *reinterpret_cast<SecureBufferHeader*>(pages) = SecureBufferHeader{ mappedSize, isLocked };
+    return pages + secureBufferHeaderSize;
+}
+
+void freeSecureBuffer(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+
+    auto* pages = static_cast<uint8_t*>(pointer) - secureBufferHeaderSize;
+    const auto header = *reinterpret_cast<const SecureBufferHeader*>(pages);
+    secureZero(pages, header.mappedSize);
+    unmapLockedPages(pages, header.mappedSize, header.isLocked);
+}
+
+void secureZero(void* pointer, const size_t sizeInBytes) noexcept {
+#if defined(_WIN32)
+    SecureZeroMemory(pointer, sizeInBytes);
+#else
+    // A plain memset is vectorized, the barrier stops it being dropped as a dead store
+    std::memset(pointer, 0, sizeInBytes);
+    __asm__ __volatile__("" : : "r"(pointer) : "memory");
+#endif
+}
@@ -0,0 +1,30 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_SECURE_MEMORY_H__
+#define __CKTAP_PROTOCOL__INTERNAL_SECURE_MEMORY_H__
+
+// STL
+#include <cstddef>
+
+/// The largest allocation the secure pool can serve, enough for a private key or WIF with room to spare
+constexpr size_t maxSecureAllocationSize = 256;
+
+/// Allocates memory for secret material such as private keys and WIFs. Memory comes from a pool of pages which
+/// are locked into RAM so they can't be swapped to disk. Pages are locked in batches, so the cost of the mlock
+/// syscall is shared across many allocations. Returns nullptr if the size is too large or the pool is exhausted
+void* allocateSecure(size_t sizeInBytes) noexcept;
+
+/// Zeroes and returns the given allocation to the secure pool. Returns false without touching the memory if it
+/// wasn't allocated with [allocateSecure], allowing callers to fall back to std::free
+bool freeSecure(void* pointer) noexcept;
+
+/// Allocates a dedicated block of locked pages for secrets which are too large for the pool, such as a batch of
+/// WIFs. Every call maps its own pages so this is meant for a few large buffers rather than many small ones.
+/// Returns nullptr if the pages can't be mapped, failing to lock them is tolerated as it is for the pool
+void* allocateSecureBuffer(size_t sizeInBytes) noexcept;
+
+/// Zeroes and unmaps a buffer from [allocateSecureBuffer]. Passing nullptr does nothing
+void freeSecureBuffer(void* pointer) noexcept;
+
+/// Overwrites memory in a way the compiler can't optimize out
+void secureZero(void* pointer, size_t sizeInBytes) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_SECURE_MEMORY_H__
@@ -0,0 +1,358 @@
+#include <internal/session_pool.h>
+
+#if CKTAP_ENABLE_SESSION_POOL
+#if !defined(__linux__) || defined(__ANDROID__)
+#error "The session pool switches fibers with ucontext, which is only supported on Linux"
+#endif
+
+// Project
+#include <internal/worker_scheduling.h>
+
+// libc
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class SessionWorker;
+
+enum class SessionFiberState { runnable, running, parked, finished };
+
+struct SessionFiber {
+    std::function<void()> function{ };
+    const WorkerScheduling* scheduling{ nullptr };
+    SessionWorker* worker{ nullptr };
+    SessionFiberState state{ SessionFiberState::runnable };
+    std::chrono::steady_clock::time_point deadline{ };
+    ucontext_t context{ };
+    void* stack{ nullptr };
+    size_t mappedSize{ 0 };
+};
+
+/// The fiber the calling worker is running, null on every other thread
+static thread_local SessionFiber* t_currentSessionFiber{ nullptr };
+
+static void unmapSessionFiberStack(SessionFiber* fiber) noexcept {
+    if (fiber->stack) {
+        munmap(fiber->stack, fiber->mappedSize);
+    }
+}
+
+/// Maps the stack with an inaccessible page below it, so an overflow faults instead of writing over another fiber
+static bool mapSessionFiberStack(SessionFiber* fiber) noexcept {
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto mappedSize = sessionFiberStackSize + pageSize;
+    auto* stack = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED) {
+        return false;
+    }
+
+    fiber->stack = stack;
+    fiber->mappedSize = mappedSize;
+    if (mprotect(stack, pageSize, PROT_NONE) != 0) {
+        unmapSessionFiberStack(fiber);
+        return false;
+    }
+
+    fiber->context.uc_stack.ss_sp = static_cast<uint8_t*>(stack) + pageSize;
+    fiber->context.uc_stack.ss_size = sessionFiberStackSize;
+    return true;
+}
+
+class SessionWorker {
+public:
+
+    /// The worker owns itself once started, it deletes itself after retiring and running its last fiber
+    static SessionWorker* startNew() noexcept {
+        auto* worker = new (std::nothrow) SessionWorker{ };
+        if (!worker) {
+            return nullptr;
+        }
+
+        try {
+            std::thread{ [worker] { worker->_run(); } }.detach();
+        } catch (...) {
+            delete worker;
+            return nullptr;
+        }
+        return worker;
+    }
+
+    size_t fiberCount() const noexcept {
+        return _fiberCount.load(std::memory_order_relaxed);
+    }
+
+    void start(SessionFiber* fiber) noexcept {
+        fiber->worker = this;
+        std::lock_guard<std::mutex> lock{ _mutex };
+        fiber->state = SessionFiberState::runnable;
+        _runnable.push_back(fiber);
+        _fiberCount.fetch_add(1, std::memory_order_relaxed);
+        _wake.notify_one();
+    }
+
+    void retire() noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _isRetiring = true;
+        _wake.notify_one();
+    }
+
+    /// Called by the running fiber just before it suspends, the worker can't resume it until it has swapped out
+    /// since both run on the same thread
+    void park(SessionFiber* fiber, const std::chrono::steady_clock::time_point deadline) noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        fiber->state = SessionFiberState::parked;
+        fiber->deadline = deadline;
+        _parked.push_back(fiber);
+    }
+
+    /// Ignores a fiber which isn't parked, such as one its deadline already woke
+    void resume(SessionFiber* fiber) noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (fiber->state != SessionFiberState::parked) {
+            return;
+        }
+
+        _parked.erase(std::find(_parked.begin(), _parked.end(), fiber));
+        fiber->state = SessionFiberState::runnable;
+        _runnable.push_back(fiber);
+        _wake.notify_one();
+    }
+
+    void suspend(SessionFiber* fiber) noexcept {
+        swapcontext(&fiber->context, &_context);
+    }
+
+    static void runFiber() noexcept {
+        auto* fiber = t_currentSessionFiber;
+        try {
+            fiber->function();
+        } catch (...) { }
+        fiber->state = SessionFiberState::finished;
+        swapcontext(&fiber->context, &fiber->worker->_context);
+    }
+
+private:
+
+    SessionWorker() noexcept = default;
+
+    void _run() noexcept {
+        std::unique_lock<std::mutex> lock{ _mutex };
+        while (true) {
+            _wakeExpiredFibers();
+            if (_runnable.empty()) {
+                if (_isRetiring && _fiberCount.load(std::memory_order_relaxed) == 0) {
+                    break;
+                }
+                _waitForWork(lock);
+                continue;
+            }
+
+            auto* fiber = _runnable.front();
+            _runnable.pop_front();
+            fiber->state = SessionFiberState::running;
+            lock.unlock();
+
+            fiber->scheduling->apply();
+            t_currentSessionFiber = fiber;
+            swapcontext(&_context, &fiber->context);
+            t_currentSessionFiber = nullptr;
+
+            if (fiber->state == SessionFiberState::finished) {
+                unmapSessionFiberStack(fiber);
+                delete fiber;
+                _fiberCount.fetch_sub(1, std::memory_order_relaxed);
+            }
+            lock.lock();
+        }
+
+        lock.unlock();
+        delete this;
+    }
+
+    void _wakeExpiredFibers() noexcept {
+        const auto now = std::chrono::steady_clock::now();
+        auto expired = std::partition(_parked.begin(), _parked.end(), [now](const SessionFiber* fiber) {
+            return fiber->deadline > now;
+        });
+        for (auto it = expired; it != _parked.end(); ++it) {
+            (*it)->state = SessionFiberState::runnable;
+            _runnable.push_back(*it);
+        }
+        _parked.erase(expired, _parked.end());
+    }
+
+    void _waitForWork(std::unique_lock<std::mutex>& lock) noexcept {
+        auto earliest = std::chrono::steady_clock::time_point::max();
+        for (const auto* fiber : _parked) {
+            earliest = std::min(earliest, fiber->deadline);
+        }
+
+        if (earliest == std::chrono::steady_clock::time_point::max()) {
+            _wake.wait(lock);
+        } else {
+            _wake.wait_until(lock, earliest);
+        }
+    }
+
+    std::mutex _mutex{ };
+    std::condition_variable _wake{ };
+    std::deque<SessionFiber*> _runnable{ };
+    std::vector<SessionFiber*> _parked{ };
+    std::atomic<size_t> _fiberCount{ 0 };
+    bool _isRetiring{ false };
+    ucontext_t _context{ };
+};
+
+class SessionPool {
+public:
+
+    CKTapInterfaceErrorCode setThreadCount(const int32_t threadCount) noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        std::vector<SessionWorker*> workers{ };
+        try {
+            workers.reserve(threadCount);
+        } catch (...) {
+            return CKTapInterfaceErrorCode::threadAllocationFailed;
+        }
+
+        for (int32_t i = 0; i < threadCount; ++i) {
+            auto* worker = SessionWorker::startNew();
+            if (!worker) {
+                for (auto* started : workers) {
+                    started->retire();
+                }
+                return CKTapInterfaceErrorCode::threadAllocationFailed;
+            }
+            workers.push_back(worker);
+        }
+
+        for (auto* worker : _workers) {
+            worker->retire();
+        }
+        _workers = std::move(workers);
+        _isEnabled = !_workers.empty();
+        return CKTapInterfaceErrorCode::success;
+    }
+
+    bool isEnabled() const noexcept {
+        return _isEnabled.load(std::memory_order_relaxed);
+    }
+
+    bool start(std::function<void()> function, const WorkerScheduling& scheduling) noexcept {
+        auto* fiber = new (std::nothrow) SessionFiber{ };
+        if (!fiber) {
+            return false;
+        }
+        if (getcontext(&fiber->context) != 0 || !mapSessionFiberStack(fiber)) {
+            delete fiber;
+            return false;
+        }
+        fiber->function = std::move(function);
+        fiber->scheduling = &scheduling;
+        makecontext(&fiber->context, &SessionWorker::runFiber, 0);
+
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (_workers.empty()) {
+            unmapSessionFiberStack(fiber);
+            delete fiber;
+            return false;
+        }
+
+        auto* worker = *std::min_element(_workers.begin(), _workers.end(), [](const auto* a, const auto* b) {
+            return a->fiberCount() < b->fiberCount();
+        });
+        worker->start(fiber);
+        return true;
+    }
+
+private:
+
+    std::mutex _mutex{ };
+    std::vector<SessionWorker*> _workers{ };
+    std::atomic<bool> _isEnabled{ false };
+};
+
+/// Never destroyed, fibers may still be finishing on retired workers during static destruction
+static SessionPool& sessionPool() noexcept {
+    static auto* instance = new SessionPool{ };
+    return *instance;
+}
+
+CKTapInterfaceErrorCode setSessionPoolThreads(const int32_t threadCount) noexcept {
+    if (threadCount < 0) {
+        return CKTapInterfaceErrorCode::invalidWorkerSchedulingOptions;
+    }
+    return sessionPool().setThreadCount(threadCount);
+}
+
+bool isSessionPoolEnabled() noexcept {
+    return sessionPool().isEnabled();
+}
+
+bool startOnSessionPool(std::function<void()> function, const WorkerScheduling& scheduling) noexcept {
+    return sessionPool().start(std::move(function), scheduling);
+}
+
+bool isOnSessionFiber() noexcept {
+    return t_currentSessionFiber != nullptr;
+}
+
+void FiberWaker::suspendUntil(const std::chrono::steady_clock::time_point deadline) noexcept {
+    auto* fiber = t_currentSessionFiber;
+    std::unique_lock<std::mutex> lock{ _mutex };
+    if (_isNotified) {
+        _isNotified = false;
+        return;
+    }
+
+    _parked = fiber;
+    fiber->worker->park(fiber, deadline);
+    lock.unlock();
+    fiber->worker->suspend(fiber);
+
+    // A notifier holds the lock whilst resuming, so the fiber can't finish underneath it
+    lock.lock();
+    _parked = nullptr;
+    _isNotified = false;
+}
+
+void FiberWaker::notify() noexcept {
+    std::lock_guard<std::mutex> lock{ _mutex };
+    if (_parked) {
+        _parked->worker->resume(_parked);
+    } else {
+        _isNotified = true;
+    }
+}
+#else
+CKTapInterfaceErrorCode setSessionPoolThreads(const int32_t threadCount) noexcept {
+    return threadCount == 0 ?
+        CKTapInterfaceErrorCode::success :
+        CKTapInterfaceErrorCode::sessionPoolNotSupported;
+}
+
+bool isSessionPoolEnabled() noexcept {
+    return false;
+}
+
+bool startOnSessionPool(std::function<void()>, const WorkerScheduling&) noexcept {
+    return false;
+}
+
+bool isOnSessionFiber() noexcept {
+    return false;
+}
+
+void FiberWaker::suspendUntil(std::chrono::steady_clock::time_point) noexcept { }
+
+void FiberWaker::notify() noexcept { }
+#endif
@@ -0,0 +1,52 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_SESSION_POOL_H__
+#define __CKTAP_PROTOCOL__INTERNAL_SESSION_POOL_H__
+
+// Project
+#include <enums.h>
+
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+/// Each session fiber reserves this much address space for its stack, only the pages it touches are committed
+constexpr size_t sessionFiberStackSize{ 256 * 1024 };
+
+struct SessionFiber;
+class WorkerScheduling;
+
+/// Runs the card operations of every context as fibers spread across [threadCount] workers, so a session waiting on
+/// its host costs a parked fiber rather than a blocked thread. Zero, the default, gives each operation a thread of
+/// its own again. Operations already running finish on the workers they started on. Returns
+/// sessionPoolNotSupported when built without CKTAP_ENABLE_SESSION_POOL
+CKTapInterfaceErrorCode setSessionPoolThreads(int32_t threadCount) noexcept;
+bool isSessionPoolEnabled() noexcept;
+
+/// Runs [function] on a new fiber of the least loaded worker. Returns false when the pool is disabled or the fiber
+/// couldn't be created, [function] hasn't run in either case. A fiber stays on the worker it started on since
+/// exception handling state is kept per thread. The worker applies [scheduling], which has to outlive the fiber,
+/// each time it resumes the fiber since the fibers it runs may belong to different contexts
+bool startOnSessionPool(std::function<void()> function, const WorkerScheduling& scheduling) noexcept;
+/// Whether the caller is a session fiber, which has to suspend through a [FiberWaker] rather than block its worker
+bool isOnSessionFiber() noexcept;
+
+/// Parks a session fiber until it's notified or a deadline passes, leaving its worker free to run other sessions.
+/// Only one fiber waits on a waker at a time. A notification with nothing parked is kept for the next suspend, so
+/// the waiter checks its condition, suspends and checks again just as it would with a condition variable
+class FiberWaker {
+public:
+
+    /// Only called from a session fiber
+    void suspendUntil(std::chrono::steady_clock::time_point deadline) noexcept;
+    void notify() noexcept;
+
+private:
+
+    std::mutex _mutex{ };
+    SessionFiber* _parked{ nullptr };
+    bool _isNotified{ false };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_SESSION_POOL_H__
@@ -0,0 +1,277 @@
+#include <internal/slot_table.h>
+
+// Project
+#include <internal/codecs.h>
+#include <internal/secure_memory.h>
+#include <internal/utils.h>
+
+// STL
+#include <array>
+#include <cstring>
+#include <new>
+#include <utility>
+
+static_assert(maxSatscardSlots <= 16, "SlotTable::_storedSlots is a 16 bit mask");
+static_assert(maxSatscardSlots < 256, "SlotTable's rows are numbered with a byte");
+
+/// Bytes per row of each SlotTable column, in the order of SlotTable::Column
+constexpr std::array<size_t, 10> slotColumnWidths{
+    sizeof(int32_t), slotPrivateKeySize, slotPublicKeySize, slotPublicKeySize, slotChainCodeSize, slotAddressCapacity,
+    1, 1, 1, 1,
+};
+constexpr size_t slotRowSize = sizeof(int32_t) + slotPrivateKeySize + slotPublicKeySize * 2 + slotChainCodeSize +
+    slotAddressCapacity + 4;
+/// What the fields of a slot which isn't stored read as
+constexpr uint8_t emptySlotField[slotAddressCapacity]{ };
+
+/// Where [column] starts in a block of [capacity] rows
+static size_t columnOffset(const size_t column, const size_t capacity) noexcept {
+    size_t offset{ 0 };
+    for (size_t i{ 0 }; i < column; ++i) {
+        offset += slotColumnWidths[i] * capacity;
+    }
+    return offset;
+}
+
+/// tap_protocol's WIF format is the reference, so the native encoder is only used once it has produced the same
+/// WIF for a fixed key
+static bool isNativeWifEncoderCompatible() noexcept {
+    static const auto isCompatible = []() {
+        try {
+            tap_protocol::Satscard::Slot slot{ };
+            slot.privkey = nlohmann::json::binary_t{ std::vector<uint8_t>(wifPrivateKeySize, 0x01) };
+            const auto expected = slot.to_wif();
+            char actual[wifBufferSize];
+            return encodeWif(slot.privkey.data(), false, actual, sizeof(actual)) != 0 && expected == actual;
+        } catch (...) {
+            return false;
+        }
+    }();
+    return isCompatible;
+}
+
+static nlohmann::json::binary_t makeBinary(const uint8_t* key, const size_t length) {
+    return nlohmann::json::binary_t{ std::vector<uint8_t>(key, key + length) };
+}
+
+SlotTable::SlotTable(const SlotTable& other)
+    : _block{ other._block ? std::make_unique<uint8_t[]>(other._capacity * slotRowSize) : nullptr },
+      _capacity{ other._capacity },
+      _rowCount{ other._rowCount },
+      _storedSlots{ other._storedSlots },
+      _rows{ other._rows } {
+    if (_block) {
+        std::memcpy(_block.get(), other._block.get(), _capacity * slotRowSize);
+    }
+}
+
+SlotTable::SlotTable(SlotTable&& other) noexcept
+    : _block{ std::move(other._block) },
+      _capacity{ other._capacity },
+      _rowCount{ other._rowCount },
+      _storedSlots{ other._storedSlots },
+      _rows{ other._rows } {
+    other._capacity = 0;
+    other._rowCount = 0;
+    other._storedSlots = 0;
+    other._rows = { };
+}
+
+SlotTable& SlotTable::operator=(const SlotTable& other) {
+    if (this != &other) {
+        *this = SlotTable{ other };
+    }
+    return *this;
+}
+
+SlotTable& SlotTable::operator=(SlotTable&& other) noexcept {
+    if (this != &other) {
+        _release();
+        _block = std::move(other._block);
+        _capacity = other._capacity;
+        _rowCount = other._rowCount;
+        _storedSlots = other._storedSlots;
+        _rows = other._rows;
+        other._capacity = 0;
+        other._rowCount = 0;
+        other._storedSlots = 0;
+        other._rows = { };
+    }
+    return *this;
+}
+
+SlotTable::~SlotTable() noexcept {
+    _release();
+}
+
+bool SlotTable::store(const tap_protocol::Satscard::Slot& slot) noexcept {
+    if (slot.index < 0 || slot.index >= static_cast<int>(maxSatscardSlots) ||
+        slot.address.size() >= slotAddressCapacity) {
+        return false;
+    }
+
+    const auto index = static_cast<size_t>(slot.index);
+    if (slot.privkey.size() > slotPrivateKeySize || slot.pubkey.size() > slotPublicKeySize ||
+        slot.master_pk.size() > slotPublicKeySize || slot.chain_code.size() > slotChainCodeSize) {
+        if (auto* privateKey = _field(privateKeys, slot.index)) {
+            secureZero(privateKey, slotPrivateKeySize);
+        }
+        _storedSlots &= static_cast<uint16_t>(~(1u << index));
+        return false;
+    }
+
+    if (_rows[index] == 0) {
+        if (_rowCount == _capacity && !_reserve(_capacity + 1u)) {
+            return false;
+        }
+        _rows[index] = ++_rowCount;
+    }
+    _storedSlots |= static_cast<uint16_t>(1u << index);
+
+    const auto copyField = [&](const Column column, const Column lengthColumn, const nlohmann::json::binary_t& source) {
+        auto* field = _field(column, slot.index);
+        secureZero(field, slotColumnWidths[column]);
+        std::memcpy(field, source.data(), source.size());
+        *_field(lengthColumn, slot.index) = static_cast<uint8_t>(source.size());
+    };
+    copyField(privateKeys, privateKeyLengths, slot.privkey);
+    copyField(publicKeys, publicKeyLengths, slot.pubkey);
+    copyField(masterPublicKeys, masterPublicKeyLengths, slot.master_pk);
+    copyField(chainCodes, chainCodeLengths, slot.chain_code);
+
+    std::memcpy(_field(addresses, slot.index), slot.address.c_str(), slot.address.size() + 1);
+    const auto status = static_cast<int32_t>(slot.status);
+    std::memcpy(_field(statuses, slot.index), &status, sizeof(status));
+    return true;
+}
+
+bool SlotTable::contains(const int32_t index) const noexcept {
+    return index >= 0 && index < static_cast<int32_t>(maxSatscardSlots) && (_storedSlots & (1u << index)) != 0;
+}
+
+bool SlotTable::isUnsealed(const int32_t index) const noexcept {
+    return status(index) == CKTapSatscardSlotStatus::UNSEALED;
+}
+
+const char* SlotTable::address(const int32_t index) const noexcept {
+    const auto* field = _field(addresses, index);
+    return reinterpret_cast<const char*>(field != nullptr ? field : emptySlotField);
+}
+
+const uint8_t* SlotTable::publicKey(const int32_t index) const noexcept {
+    const auto* field = _field(publicKeys, index);
+    return field != nullptr ? field : emptySlotField;
+}
+
+size_t SlotTable::publicKeyLength(const int32_t index) const noexcept {
+    const auto* field = _field(publicKeyLengths, index);
+    return field != nullptr ? *field : 0;
+}
+
+const uint8_t* SlotTable::masterPublicKey(const int32_t index) const noexcept {
+    const auto* field = _field(masterPublicKeys, index);
+    return field != nullptr ? field : emptySlotField;
+}
+
+size_t SlotTable::masterPublicKeyLength(const int32_t index) const noexcept {
+    const auto* field = _field(masterPublicKeyLengths, index);
+    return field != nullptr ? *field : 0;
+}
+
+const uint8_t* SlotTable::chainCode(const int32_t index) const noexcept {
+    const auto* field = _field(chainCodes, index);
+    return field != nullptr ? field : emptySlotField;
+}
+
+size_t SlotTable::chainCodeLength(const int32_t index) const noexcept {
+    const auto* field = _field(chainCodeLengths, index);
+    return field != nullptr ? *field : 0;
+}
+
+CKTapSatscardSlotStatus SlotTable::status(const int32_t index) const noexcept {
+    int32_t status{ CKTapSatscardSlotStatus::UNUSED };
+    if (const auto* field = _field(statuses, index)) {
+        std::memcpy(&status, field, sizeof(status));
+    }
+    return static_cast<CKTapSatscardSlotStatus>(status);
+}
+
+void SlotTable::fillConstructorParams(SlotConstructorParams& params, const int32_t satscardHandle, const int32_t index) const {
+    params.satscardHandle = satscardHandle;
+    params.index = index;
+    params.status = status(index);
+    params.address = allocateCStringFromBuffer(address(index));
+    const auto* privateKey = _field(privateKeys, index);
+    params.privkey = privateKey != nullptr ?
+        allocateSecureCBinaryArray(privateKey, *_field(privateKeyLengths, index)) :
+        allocateSecureCBinaryArray(emptySlotField, 0);
+    params.pubkey = allocateCBinaryArray(publicKey(index), publicKeyLength(index));
+    params.masterPK = allocateCBinaryArray(masterPublicKey(index), masterPublicKeyLength(index));
+    params.chainCode = allocateCBinaryArray(chainCode(index), chainCodeLength(index));
+}
+
+tap_protocol::Satscard::Slot SlotTable::makeSlot(const int32_t index) const {
+    tap_protocol::Satscard::Slot slot{ };
+    slot.index = index;
+    slot.status = static_cast<tap_protocol::Satscard::SlotStatus>(status(index));
+    slot.address = address(index);
+    if (const auto* privateKey = _field(privateKeys, index)) {
+        slot.privkey = makeBinary(privateKey, *_field(privateKeyLengths, index));
+    }
+    slot.pubkey = makeBinary(publicKey(index), publicKeyLength(index));
+    slot.master_pk = makeBinary(masterPublicKey(index), masterPublicKeyLength(index));
+    slot.chain_code = makeBinary(chainCode(index), chainCodeLength(index));
+    return slot;
+}
+
+size_t SlotTable::writeWif(const int32_t index, char* output, const size_t capacity) const {
+    const auto* privateKey = _field(privateKeys, index);
+    if (privateKey != nullptr && *_field(privateKeyLengths, index) == wifPrivateKeySize && isNativeWifEncoderCompatible()) {
+        return encodeWif(privateKey, false, output, capacity);
+    }
+
+    auto slot = makeSlot(index);
+    auto wif = slot.to_wif();
+    secureZero(slot.privkey.data(), slot.privkey.size());
+
+    const auto length = wif.size();
+    const auto fits = length + 1 <= capacity;
+    if (fits) {
+        std::memcpy(output, wif.c_str(), length + 1);
+    }
+    secureZero(wif.data(), wif.size());
+    return fits ? length : 0;
+}
+
+uint8_t* SlotTable::_field(const Column column, const int32_t index) const noexcept {
+    static_assert(slotColumnWidths.size() == columnCount, "Every column needs a width");
+    if (!contains(index)) {
+        return nullptr;
+    }
+
+    const auto row = static_cast<size_t>(_rows[static_cast<size_t>(index)] - 1);
+    return _block.get() + columnOffset(column, _capacity) + row * slotColumnWidths[column];
+}
+
+bool SlotTable::_reserve(const size_t capacity) noexcept {
+    std::unique_ptr<uint8_t[]> block{ new (std::nothrow) uint8_t[capacity * slotRowSize]{ } };
+    if (!block) {
+        return false;
+    }
+
+    for (size_t column{ 0 }; column < columnCount && _rowCount > 0; ++column) {
+        std::memcpy(block.get() + columnOffset(column, capacity), _block.get() + columnOffset(column, _capacity),
+                    slotColumnWidths[column] * _rowCount);
+    }
+    _release();
+    _block = std::move(block);
+    _capacity = static_cast<uint8_t>(capacity);
+    return true;
+}
+
+void SlotTable::_release() noexcept {
+    if (_block) {
+        secureZero(_block.get() + columnOffset(privateKeys, _capacity), slotPrivateKeySize * _capacity);
+        _block.reset();
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_SLOT_TABLE_H__
+#define __CKTAP_PROTOCOL__INTERNAL_SLOT_TABLE_H__
+
+// Project
+#include <structs.h>
+
+// Third party
+#include <tap_protocol/cktapcard.h>
+
+// STL
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// Satscards are manufactured with 10 slots
+constexpr size_t maxSatscardSlots = 10;
+constexpr size_t slotPrivateKeySize = 32;
+constexpr size_t slotPublicKeySize = 33;
+constexpr size_t slotChainCodeSize = 32;
+/// Enough for any segwit address including the null terminator
+constexpr size_t slotAddressCapacity = 96;
+/// Room for a WIF from either the native encoder or tap_protocol
+constexpr size_t maxWifBufferSize = 64;
+
+/// Stores the slots of a single Satscard in one heap block, allocated when the first slot is stored and grown a row
+/// at a time so it never holds more rows than the card has slots stored. Reading them never goes through
+/// tap_protocol or JSON. Each field lives in its own column of the block so scanning one field across every stored
+/// slot reads contiguous memory. An empty table is a couple of dozen bytes, each stored slot adds about 230. Private
+/// keys are zeroed when they're overwritten, when the block is reallocated and when the table is destroyed
+class SlotTable {
+public:
+
+    SlotTable() noexcept = default;
+    SlotTable(const SlotTable& other);
+    SlotTable(SlotTable&& other) noexcept;
+    SlotTable& operator=(const SlotTable& other);
+    SlotTable& operator=(SlotTable&& other) noexcept;
+    ~SlotTable() noexcept;
+
+    /// Copies the slot into the table. Fails if the index is out of range, a key is larger than expected or the
+    /// table couldn't grow
+    bool store(const tap_protocol::Satscard::Slot& slot) noexcept;
+    bool contains(int32_t index) const noexcept;
+    bool isUnsealed(int32_t index) const noexcept;
+
+    /// Direct views of a stored slot's fields, only valid while the table is alive and unchanged. Slots which
+    /// aren't stored read as empty
+    const char* address(int32_t index) const noexcept;
+    const uint8_t* publicKey(int32_t index) const noexcept;
+    size_t publicKeyLength(int32_t index) const noexcept;
+    const uint8_t* masterPublicKey(int32_t index) const noexcept;
+    size_t masterPublicKeyLength(int32_t index) const noexcept;
+    const uint8_t* chainCode(int32_t index) const noexcept;
+    size_t chainCodeLength(int32_t index) const noexcept;
+    CKTapSatscardSlotStatus status(int32_t index) const noexcept;
+
+    /// Fills the params for a stored slot, the private key is allocated from the secure pool
+    void fillConstructorParams(SlotConstructorParams& params, int32_t satscardHandle, int32_t index) const;
+
+    /// Rebuilds a tap_protocol slot, used where tap_protocol has to do the work itself such as WIF encoding
+    tap_protocol::Satscard::Slot makeSlot(int32_t index) const;
+
+    /// Writes the slot's null terminated WIF into [output] and returns its length, or 0 if it doesn't fit. Uses the
+    /// native base58check encoder straight from the table, temporary copies of the key are zeroed before returning
+    size_t writeWif(int32_t index, char* output, size_t capacity) const;
+
+private:
+
+    /// The columns of the block in the order they're laid out, each [_capacity] rows long
+    enum Column : size_t {
+        statuses,
+        privateKeys,
+        publicKeys,
+        masterPublicKeys,
+        chainCodes,
+        addresses,
+        privateKeyLengths,
+        publicKeyLengths,
+        masterPublicKeyLengths,
+        chainCodeLengths,
+        columnCount,
+    };
+
+    /// The row of a stored slot's fields, or null when it isn't stored
+    uint8_t* _field(Column column, int32_t index) const noexcept;
+    /// Reallocates the block with room for [capacity] rows, zeroing the private keys of the old one
+    bool _reserve(size_t capacity) noexcept;
+    void _release() noexcept;
+
+    std::unique_ptr<uint8_t[]> _block{ };
+    uint8_t _capacity{ 0 };
+    uint8_t _rowCount{ 0 };
+    uint16_t _storedSlots{ 0 };
+    /// One more than the row each slot's fields are in, 0 for slots which never had one
+    std::array<uint8_t, maxSatscardSlots> _rows{ };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_SLOT_TABLE_H__
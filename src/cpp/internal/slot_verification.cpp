@@ -0,0 +1,159 @@
+#include <internal/slot_verification.h>
+
+// Project
+#include <internal/codecs.h>
+#include <internal/globals.h>
+#include <internal/hashing.h>
+#include <internal/parallel.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+constexpr size_t compressedPublicKeySize = 33;
+constexpr size_t minVerificationJobsPerThread = 256;
+
+struct SlotVerificationJob {
+    const SlotTable* slots{ nullptr };
+    const Bech32Encoder* encoder{ nullptr };
+    int32_t slotIndex{ 0 };
+    size_t bit{ 0 };
+};
+
+static const Bech32Encoder& bech32EncoderFor(const bool isTestnet) noexcept {
+    static const Bech32Encoder mainnet{ "bc" };
+    static const Bech32Encoder testnet{ "tb" };
+    return isTestnet ? testnet : mainnet;
+}
+
+/// Bech32 may be written in upper case, the encoder always writes lower case
+static bool isSameAddress(const char* expected, const char* actual) noexcept {
+    size_t i{ 0 };
+    for (; expected[i] != '\0'; ++i) {
+        const auto character = actual[i] >= 'A' && actual[i] <= 'Z' ? static_cast<char>(actual[i] - 'A' + 'a') : actual[i];
+        if (character != expected[i]) {
+            return false;
+        }
+    }
+    return actual[i] == '\0';
+}
+
+/// Hashes the range's public keys into one contiguous array, then encodes each run of slots which share a network
+/// in a single batch before comparing against the stored addresses
+static void verifySlotRange(const std::vector<SlotVerificationJob>& jobs, const size_t begin, const size_t end,
+                            uint8_t* results) noexcept {
+    constexpr auto programLength = std::tuple_size<Ripemd160Digest>::value;
+    uint8_t programs[parallelJobsPerClaim * programLength];
+    char addresses[parallelJobsPerClaim][maxBech32AddressLength];
+    bool hasValidKey[parallelJobsPerClaim];
+
+    const auto count = end - begin;
+    for (size_t i{ 0 }; i < count; ++i) {
+        const auto& job = jobs[begin + i];
+        hasValidKey[i] = job.slots->publicKeyLength(job.slotIndex) == compressedPublicKeySize;
+        const auto keyHash = hasValidKey[i] ? hash160(job.slots->publicKey(job.slotIndex), compressedPublicKeySize) : Ripemd160Digest{ };
+        std::memcpy(programs + i * programLength, keyHash.data(), programLength);
+    }
+
+    for (size_t runStart{ 0 }; runStart < count;) {
+        const auto* encoder = jobs[begin + runStart].encoder;
+        auto runEnd = runStart + 1;
+        while (runEnd < count && jobs[begin + runEnd].encoder == encoder) {
+            ++runEnd;
+        }
+
+        const auto encoded = runStart + encodeSegwitV0Addresses(*encoder, programs + runStart * programLength, programLength,
+                                                                runEnd - runStart, addresses[runStart], maxBech32AddressLength);
+        for (auto i = runStart; i < runEnd; ++i) {
+            const auto& job = jobs[begin + i];
+            results[begin + i] = hasValidKey[i] && i < encoded && isSameAddress(addresses[i], job.slots->address(job.slotIndex)) ? 1 : 0;
+        }
+        runStart = runEnd;
+    }
+}
+
+bool isSlotAddressDerivedFrom(const uint8_t* publicKey, const size_t publicKeyLength, const char* address,
+                              const bool isTestnet) noexcept {
+    if (publicKey == nullptr || address == nullptr || publicKeyLength != compressedPublicKeySize) {
+        return false;
+    }
+
+    const auto keyHash = hash160(publicKey, publicKeyLength);
+    char expected[maxBech32AddressLength];
+    if (bech32EncoderFor(isTestnet).encodeSegwitV0(keyHash.data(), keyHash.size(), expected, sizeof(expected)) == 0) {
+        return false;
+    }
+    return isSameAddress(expected, address);
+}
+
+static std::vector<SlotVerificationJob> collectSlotVerificationJobs() {
+    const auto& satscards = currentContext().satscards;
+    std::vector<SlotVerificationJob> jobs{ };
+    for (size_t handle{ 0 }; handle < satscards.size(); ++handle) {
+        const auto& wrapper = satscards[handle];
+        const auto& encoder = bech32EncoderFor(wrapper.snapshot.isTestnet);
+        for (int32_t index{ 0 }; index < static_cast<int32_t>(maxSatscardSlots); ++index) {
+            if (wrapper.slots.contains(index)) {
+                const auto bit = handle * maxSatscardSlots + static_cast<size_t>(index);
+                jobs.push_back(SlotVerificationJob{ &wrapper.slots, &encoder, index, bit });
+            }
+        }
+    }
+    return jobs;
+}
+
+SlotAddressVerification verifySatscardSlotAddresses() noexcept {
+    SlotAddressVerification verification;
+    std::memset(&verification, 0, sizeof(verification));
+    verification.status.errorCode = CKTapInterfaceErrorCode::success;
+    verification.slotsPerCard = static_cast<int32_t>(maxSatscardSlots);
+    verification.isHardwareHashingEnabled = isHardwareSha256Enabled() ? 1 : 0;
+
+    try {
+        const auto jobs = collectSlotVerificationJobs();
+        const auto bitmapLength = (currentContext().satscards.size() * maxSatscardSlots + 7) / 8;
+        if (bitmapLength == 0) {
+            return verification;
+        }
+
+        // Neighbouring slots share a byte of the bitmap, so each job records its own result and they're packed
+        // once every thread has finished
+        std::vector<uint8_t> results(jobs.size(), 0);
+        const auto startTime = std::chrono::steady_clock::now();
+        runInParallel(jobs.size(), minVerificationJobsPerThread, [&](const size_t begin, const size_t end) {
+            verifySlotRange(jobs, begin, end, results.data());
+        });
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+        verification.elapsedMicros = static_cast<int64_t>(elapsed.count());
+
+        std::vector<uint8_t> passed(bitmapLength, 0);
+        std::vector<uint8_t> checked(bitmapLength, 0);
+        for (size_t i{ 0 }; i < jobs.size(); ++i) {
+            const auto mask = static_cast<uint8_t>(1u << (jobs[i].bit % 8));
+            checked[jobs[i].bit / 8] |= mask;
+            passed[jobs[i].bit / 8] |= results[i] ? mask : 0;
+        }
+
+        verification.checkedCount = static_cast<int32_t>(jobs.size());
+        verification.failedCount = static_cast<int32_t>(std::count(results.begin(), results.end(), 0));
+        verification.passed = allocateCBinaryArray(passed.data(), passed.size());
+        verification.checked = allocateCBinaryArray(checked.data(), checked.size());
+        if (verification.passed.ptr == nullptr || verification.checked.ptr == nullptr) {
+            freeSlotAddressVerification(verification);
+            verification.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+        }
+    } catch (...) {
+        freeSlotAddressVerification(verification);
+        verification.status.errorCode = CKTapInterfaceErrorCode::unexpectedStdException;
+    }
+    return verification;
+}
+
+void freeSlotAddressVerification(SlotAddressVerification& verification) noexcept {
+    freeCKTapInterfaceStatus(verification.status);
+    freeCBinaryArray(verification.passed);
+    freeCBinaryArray(verification.checked);
+}
@@ -0,0 +1,21 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_SLOT_VERIFICATION_H__
+#define __CKTAP_PROTOCOL__INTERNAL_SLOT_VERIFICATION_H__
+
+// Project
+#include <structs.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+
+/// Recomputes the P2WPKH address of every stored slot on every registered satscard from its public key and
+/// compares it against the address the card reported. Slots are hashed in parallel, see [runInParallel]
+SlotAddressVerification verifySatscardSlotAddresses() noexcept;
+
+/// Whether [address] is the P2WPKH address of the compressed public key on the given network, used to check a
+/// single slot without going through the registry
+bool isSlotAddressDerivedFrom(const uint8_t* publicKey, size_t publicKeyLength, const char* address, bool isTestnet) noexcept;
+
+void freeSlotAddressVerification(SlotAddressVerification& verification) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_SLOT_VERIFICATION_H__
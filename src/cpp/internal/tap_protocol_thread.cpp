@@ -3,7 +3,9 @@
 // Project
 #include <internal/exceptions.h>
 #include <internal/macros.h>
+#include <internal/metrics.h>
 #include <internal/utils.h>
+#include <internal/watchdog.h>
 
 // Third party
 #include <tap_protocol/cktapcard.h>
@@ -12,52 +14,204 @@
 // STL
 #include <chrono>
 #include <cstring>
+#include <utility>
 
 using namespace std::chrono_literals;
 
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "cppcoreguidelines-pro-type-static-cast-downcast"
+/// The state the thread should end in after an async action returns the given error code
+static CKTapThreadState terminalStateForErrorCode(const CKTapInterfaceErrorCode errorCode) noexcept {
+    switch (errorCode) {
+        case CKTapInterfaceErrorCode::success:
+            return CKTapThreadState::finished;
+        case CKTapInterfaceErrorCode::failedToPerformHandshake:
+            return CKTapThreadState::invalidCardProduced;
+        case CKTapInterfaceErrorCode::operationCanceled:
+            return CKTapThreadState::canceled;
+        case CKTapInterfaceErrorCode::timeoutDuringTransport:
+        case CKTapInterfaceErrorCode::sessionStalled:
+            return CKTapThreadState::timeout;
+        case CKTapInterfaceErrorCode::invalidThreadStateDuringTransportSignaling:
+            return CKTapThreadState::transportException;
+        case CKTapInterfaceErrorCode::caughtTapProtocolException:
+            return CKTapThreadState::tapProtocolError;
+        default:
+            return CKTapThreadState::failed;
+    }
+}
+
 template <typename Func>
-bool TapProtocolThread::_startAsyncCardOperation(Func&& func) noexcept {
+bool TapProtocolThread::_startAsyncCardOperation(const AuditOperation operation, Func&& func) noexcept {
+    constexpr uint32_t readyStates =
+        stateBit(CKTapThreadState::notStarted) |
+        stateBit(CKTapThreadState::awaitingCardOperation);
+    if (!_state.transitionFromAny(readyStates, CKTapThreadState::asyncActionStarting)) {
+        return false;
+    }
+
+    const auto operationTimeout = _deadlineOptions.operationTimeout;
+    _operationDeadline = operationTimeout.count() > 0 ?
+        std::chrono::steady_clock::now() + operationTimeout :
+        std::chrono::steady_clock::time_point::max();
+    _auditOperation = operation;
+    _operationStartedMicros = auditTimestampMicros();
+    _operationFinishedMicros = 0;
+    _lastProgressTime = std::chrono::steady_clock::now().time_since_epoch().count();
+
     try {
-        _state = CKTapThreadState::asyncActionStarting;
-        _future = std::async(std::launch::async, [this, func=std::forward<Func>(func)]() {
-            try {
-                const CKTapInterfaceErrorCode errorCode = func();
-                _state = errorCode == CKTapInterfaceErrorCode::success ?
-                    CKTapThreadState::finished :
-                    CKTapThreadState::failed;
-
-                return errorCode;
-            } catch (const CancelationException& e) {
-                _state = CKTapThreadState::canceled;
-                return CKTapInterfaceErrorCode::operationCanceled;
-            } catch (const TimeoutException& e) {
-                _state = CKTapThreadState::timeout;
-                return CKTapInterfaceErrorCode::timeoutDuringTransport;
-            } catch (const TransportException& e) {
-                _state = CKTapThreadState::transportException;
-                return CKTapInterfaceErrorCode::invalidThreadStateDuringTransportSignaling;
-            } CATCH_TAP_PROTO_EXCEPTION(e, {
-                _tapProtoException = e;
-                _state = CKTapThreadState::tapProtocolError;
-                return CKTapInterfaceErrorCode::caughtTapProtocolException;
-            }) catch (...) { }
-            _state = CKTapThreadState::failed;
-            return CKTapInterfaceErrorCode::unknownErrorDuringAsyncOperation;
-        });
+        auto runOperation = [this, func=std::forward<Func>(func)]() {
+            _services->workerScheduling.apply();
+
+            // A cancel which arrives before tap_protocol is entered has nothing to unwind
+            const auto errorCode = _shouldCancel ?
+                _cancellationError() :
+                _invokeTapProtocol(func);
+            _operationFinishedMicros = auditTimestampMicros();
 
-        return _future.valid();
+            if (errorCode == CKTapInterfaceErrorCode::operationCanceled || errorCode == CKTapInterfaceErrorCode::sessionStalled) {
+                _recordCancellationLatency();
+            }
+            _state.transitionFromAny(activeThreadStates, terminalStateForErrorCode(errorCode));
+            _notifyStateChange();
+            return errorCode;
+        };
+
+        if (isSessionPoolEnabled()) {
+            auto task = std::make_shared<std::packaged_task<CKTapInterfaceErrorCode()>>(std::move(runOperation));
+            auto future = task->get_future();
+            if (startOnSessionPool([task]() { (*task)(); }, _services->workerScheduling)) {
+                _future = std::move(future);
+                return true;
+            }
+        } else {
+            _future = std::async(std::launch::async, std::move(runOperation));
+            if (_future.valid()) {
+                return true;
+            }
+        }
     } catch (...) {}
 
+    // Never leave the thread looking active when it failed to start
+    _state.transition<CKTapThreadState::asyncActionStarting, CKTapThreadState::failed>();
+    _notifyStateChange();
     return false;
 }
+
+template <typename Func>
+CKTapInterfaceErrorCode TapProtocolThread::_invokeTapProtocol(const Func& func) noexcept {
+    try {
+        return func();
+    } catch (const TransportAbortException&) {
+    } CATCH_TAP_PROTO_EXCEPTION(e, {
+        // tap_protocol is free to wrap our abort in its own exception, the recorded reason takes priority
+        if (_abortReason.load() == CKTapInterfaceErrorCode::pending) {
+            _tapProtoException = e;
+            return CKTapInterfaceErrorCode::caughtTapProtocolException;
+        }
+    }) catch (...) { }
+
+    const auto reason = _abortReason.load();
+    return reason != CKTapInterfaceErrorCode::pending ?
+        reason :
+        CKTapInterfaceErrorCode::unknownErrorDuringAsyncOperation;
+}
+
+template <typename CardType, typename Func>
+bool TapProtocolThread::_startOperationOnCard(const AuditOperation operation, Func&& func) noexcept {
+    auto card = _lockCard<CardType>();
+    if (!card) {
+        const bool canReattach =
+            (std::is_same_v<CardType, tap_protocol::Satscard> && _detachedCardType == CKTapCardType::satscard) ||
+            (std::is_same_v<CardType, tap_protocol::Tapsigner> && _detachedCardType == CKTapCardType::tapsigner) ||
+            (std::is_same_v<CardType, tap_protocol::CKTapCard> && _detachedCardType != CKTapCardType::unknownCard);
+        if (!canReattach) {
+            return false;
+        }
+    }
+
+    return _startAsyncCardOperation(operation, [this, card=std::move(card), func=std::forward<Func>(func)]() {
+        auto target = card;
+        if (!target) {
+            auto reattached = _reattachCard<CardType>();
+            if (!reattached) {
+                return reattached.error();
+            }
+            target = std::move(*reattached);
+        }
+        return func(*target);
+    });
+}
+
+template <typename CardType>
+std::shared_ptr<CardType> TapProtocolThread::_lockCard() const noexcept {
+    if constexpr (std::is_same_v<CardType, tap_protocol::Satscard>) {
+        return _satscard.lock();
+    } else if constexpr (std::is_same_v<CardType, tap_protocol::Tapsigner>) {
+        return _tapsigner.lock();
+    } else {
+        return _lockCardForOperation();
+    }
+}
+
+template <typename CardType>
+Result<std::shared_ptr<CardType>> TapProtocolThread::_reattachCard() {
+    using ReattachResult = Result<std::shared_ptr<CardType>>;
+
+    auto handshake = _performHandshake(_detachedCardType);
+    if (!handshake) {
+        return ReattachResult::failure(handshake.error());
+    }
+
+    std::shared_ptr<tap_protocol::CKTapCard> card{ std::move(*handshake) };
+    auto typedCard = std::dynamic_pointer_cast<CardType>(card);
+    if (!typedCard || card->GetIdent() != _detachedCardIdent) {
+        return ReattachResult::failure(CKTapInterfaceErrorCode::wrongCardForOperation);
+    }
+
+    _reattachedCard = std::move(card);
+    return ReattachResult{ std::move(typedCard) };
+}
 #pragma clang diagnostic pop
 
-TapProtocolThread* TapProtocolThread::createNew() noexcept {
+template <typename Predicate>
+void TapProtocolThread::_waitForStateChange(const std::chrono::steady_clock::time_point deadline,
+                                            const Predicate& predicate) const {
+    std::unique_lock<std::mutex> lock{ _stateChangeMutex };
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+        _stateChanged.wait(lock, predicate);
+    } else {
+        _stateChanged.wait_until(lock, deadline, predicate);
+    }
+}
+
+template <typename Predicate>
+void TapProtocolThread::_waitForHost(const std::chrono::steady_clock::time_point deadline,
+                                     const Predicate& predicate) const {
+    if (!isOnSessionFiber()) {
+        _waitForStateChange(deadline, predicate);
+        return;
+    }
+
+    while (!predicate() && std::chrono::steady_clock::now() < deadline) {
+        _fiberWaker.suspendUntil(deadline);
+    }
+}
+
+TapProtocolThread::TapProtocolThread(std::shared_ptr<ContextServices> services, OperationMetrics& metrics) noexcept
+    : _services{ std::move(services) },
+      _metrics{ metrics } {
+}
+
+TapProtocolThread* TapProtocolThread::createNew(std::shared_ptr<ContextServices> services, OperationMetrics& metrics) noexcept {
+    if (services == nullptr) {
+        return nullptr;
+    }
+
     try {
-        auto thread = new TapProtocolThread{ };
+        auto thread = new TapProtocolThread{ std::move(services), metrics };
         if (thread->reset() == CKTapInterfaceErrorCode::success) {
+            watchProtocolThread(thread);
             return thread;
         }
 
@@ -66,28 +220,106 @@ TapProtocolThread* TapProtocolThread::createNew() noexcept {
     return nullptr;
 }
 
+TapProtocolThread::~TapProtocolThread() {
+    unwatchProtocolThread(this);
+
+    // The worker uses the thread's members until it returns, so it has to be joined before any are destroyed
+    if (_future.valid()) {
+        requestCancel();
+        _future.wait();
+    }
+}
+
 CKTapInterfaceErrorCode TapProtocolThread::reset() noexcept {
-    if (isThreadActive()) {
+    if (!_state.reset()) {
         return CKTapInterfaceErrorCode::threadAlreadyInUse;
     }
 
+    // An operation whose result was never collected, such as a handshake handed to the pipeline, still happened
+    if (_future.valid()) {
+        _collectResult();
+    }
     _future = std::future<CKTapInterfaceErrorCode>{ };
-    _state = CKTapThreadState::notStarted;
-    _shouldCancel = false;
+    {
+        // The watchdog checks the state and cancels under the same lock, so it can't cancel the next operation
+        // with a decision it made about this one
+        std::lock_guard<std::mutex> lock{ _stateChangeMutex };
+        _shouldCancel = false;
+        _cancelReason = CKTapInterfaceErrorCode::pending;
+    }
+    _cancelRequestTime = 0;
+    _abortReason = CKTapInterfaceErrorCode::pending;
     _recentError = CKTapInterfaceErrorCode::pending;
     _tapProtoException = tap_protocol::TapProtoException{ 0, { } };
-    _pendingTransportRequest.clear();
+    _transportRequest.clear();
     _transportResponse.clear();
     _constructedCard.reset();
     _satscard.reset();
     _tapsigner.reset();
+    _detachedCardType = CKTapCardType::unknownCard;
+    _detachedCardIdent.clear();
+    _reattachedCard.reset();
     _cardOperationResponse = CardResponseVariant{ };
+    _hasResponse = false;
+    _auditSlotIndex = -1;
+    _metrics.beginOperation();
 
     return CKTapInterfaceErrorCode::success;
 }
 
-void TapProtocolThread::requestCancel() noexcept {
-    _shouldCancel = true;
+void TapProtocolThread::requestCancel(const CKTapInterfaceErrorCode reason) noexcept {
+    _setCancelled(reason);
+    _notifyStateChange();
+}
+
+bool TapProtocolThread::cancelIfStalled(const std::chrono::steady_clock::time_point now) noexcept {
+    const auto timeout = stallTimeout();
+    if (timeout.count() == 0) {
+        return false;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock{ _stateChangeMutex };
+        if (!isThreadActive() || _shouldCancel) {
+            return false;
+        }
+
+        const auto lastProgress = std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ _lastProgressTime.load() } };
+        if (now - lastProgress < timeout) {
+            return false;
+        }
+        _setCancelled(CKTapInterfaceErrorCode::sessionStalled);
+    } catch (...) {
+        return false;
+    }
+
+    _notifyStateChange();
+    return true;
+}
+
+bool TapProtocolThread::waitForCancellation(const std::chrono::steady_clock::time_point deadline) const noexcept {
+    if (!_shouldCancel) {
+        return !isThreadActive();
+    }
+
+    try {
+        _waitForStateChange(deadline, [this]() { return !isThreadActive(); });
+    } catch (...) { }
+    return !isThreadActive();
+}
+
+std::chrono::milliseconds TapProtocolThread::stallTimeout() const noexcept {
+    return std::chrono::milliseconds{ _services->stallTimeout.load(std::memory_order_relaxed) };
+}
+
+bool TapProtocolThread::setDeadlineOptions(const DeadlineOptions& options) noexcept {
+    // The protocol thread reads the options without synchronization
+    if (isThreadActive()) {
+        return false;
+    }
+
+    _deadlineOptions = options;
+    return true;
 }
 
 bool TapProtocolThread::prepareCardOperation(std::weak_ptr<tap_protocol::Satscard> satscard) noexcept {
@@ -95,8 +327,11 @@ bool TapProtocolThread::prepareCardOperation(std::weak_ptr<tap_protocol::Satscar
         return false;
     }
     _satscard = std::move(satscard);
-    _state = CKTapThreadState::awaitingCardOperation;
-    return true;
+    _detachedCardType = CKTapCardType::unknownCard;
+    return _state.transitionFromAny(
+        stateBit(CKTapThreadState::notStarted) | stateBit(CKTapThreadState::awaitingCardOperation),
+        CKTapThreadState::awaitingCardOperation
+    );
 }
 
 bool TapProtocolThread::prepareCardOperation(std::weak_ptr<tap_protocol::Tapsigner> tapsigner) noexcept {
@@ -104,123 +339,120 @@ bool TapProtocolThread::prepareCardOperation(std::weak_ptr<tap_protocol::Tapsign
         return false;
     }
     _tapsigner = std::move(tapsigner);
-    _state = CKTapThreadState::awaitingCardOperation;
-    return true;
+    _detachedCardType = CKTapCardType::unknownCard;
+    return _state.transitionFromAny(
+        stateBit(CKTapThreadState::notStarted) | stateBit(CKTapThreadState::awaitingCardOperation),
+        CKTapThreadState::awaitingCardOperation
+    );
+}
+
+bool TapProtocolThread::prepareDetachedCardOperation(const CKTapCardType type, std::string ident) noexcept {
+    if (isThreadActive() || type == CKTapCardType::unknownCard || ident.empty()) {
+        return false;
+    }
+    _satscard.reset();
+    _tapsigner.reset();
+    _detachedCardType = type;
+    _detachedCardIdent = std::move(ident);
+    return _state.transitionFromAny(
+        stateBit(CKTapThreadState::notStarted) | stateBit(CKTapThreadState::awaitingCardOperation),
+        CKTapThreadState::awaitingCardOperation
+    );
 }
 
 bool TapProtocolThread::beginCardHandshake(const int32_t cardType) noexcept {
-    return _startAsyncCardOperation([this, cardType]() {
-        if (auto card = _performHandshake(cardType)) {
-            // Perform additional validation because tap_protocol doesn't detect an error when constructing a Tapsigner
-            // and communicating with a Satscard
-            if ((cardType == CKTapCardType::satscard && !card->IsTapsigner()) ||
-                (cardType == CKTapCardType::tapsigner && card->IsTapsigner()) ||
-                (cardType == CKTapCardType::unknownCard)) {
-                _constructedCard = std::move(card);
-                _state = CKTapThreadState::finished;
-                return CKTapInterfaceErrorCode::success;
-            }
+    return _startAsyncCardOperation(AuditOperation::handshake, [this, cardType]() {
+        auto card = _performHandshake(cardType);
+        if (!card) {
+            return card.error();
+        }
+
+        // Perform additional validation because tap_protocol doesn't detect an error when constructing a Tapsigner
+        // and communicating with a Satscard
+        if (*card != nullptr && (
+            (cardType == CKTapCardType::satscard && !(*card)->IsTapsigner()) ||
+            (cardType == CKTapCardType::tapsigner && (*card)->IsTapsigner()) ||
+            (cardType == CKTapCardType::unknownCard))) {
+            _constructedCard = std::move(*card);
+            return CKTapInterfaceErrorCode::success;
         }
-        _state = CKTapThreadState::invalidCardProduced;
         return CKTapInterfaceErrorCode::failedToPerformHandshake;
     });
 }
 
 bool TapProtocolThread::beginCKTapCard_Wait() {
-    if (auto card = _lockCardForOperation()) {
-        return _startAsyncCardOperation([=]() {
-            _setResponse<CardOperation::CKTapCard_Wait>(card->Wait());
-            return CKTapInterfaceErrorCode::success;
-        });
-    }
-    return false;
+    return _startOperationOnCard<tap_protocol::CKTapCard>(AuditOperation::wait, [this](tap_protocol::CKTapCard& card) {
+        _setResponse<CardOperation::CKTapCard_Wait>(card.Wait());
+        return CKTapInterfaceErrorCode::success;
+    });
 }
 
 bool TapProtocolThread::beginSatscard_CertificateCheck() {
-    if (auto card = _satscard.lock()) {
-        return _startAsyncCardOperation([=]() {
-            card->CertificateCheck();
-            _setResponse<CardOperation::Satscard_CertificateCheck>(card->IsCertsChecked());
-            return CKTapInterfaceErrorCode::success;
-        });
-    }
-    return false;
+    return _startOperationOnCard<tap_protocol::Satscard>(AuditOperation::certificateCheck, [this](tap_protocol::Satscard& card) {
+        card.CertificateCheck();
+        _setResponse<CardOperation::Satscard_CertificateCheck>(card.IsCertsChecked());
+        return CKTapInterfaceErrorCode::success;
+    });
 }
 
 bool TapProtocolThread::beginSatscard_GetSlot(int32_t slot, const char* cvc) {
-    if (auto card = _satscard.lock()) {
-        return _startAsyncCardOperation([=, cvc = makeCvc(cvc)]() {
-            _setResponse<CardOperation::Satscard_GetSlot>(card->GetSlot(slot, cvc));
-            return CKTapInterfaceErrorCode::success;
-        });
-    }
-    return false;
+    // Recorded even if the slot can't be read, the request is what's being audited
+    _auditSlotIndex = static_cast<int8_t>(slot);
+    return _startOperationOnCard<tap_protocol::Satscard>(AuditOperation::getSlot, [this, slot, cvc = makeCvc(cvc)](tap_protocol::Satscard& card) {
+        _setResponse<CardOperation::Satscard_GetSlot>(card.GetSlot(slot, cvc));
+        return CKTapInterfaceErrorCode::success;
+    });
 }
 
 bool TapProtocolThread::beginSatscard_ListSlots(const char* cvc, int32_t limit) {
-    if (auto card = _satscard.lock()) {
-        return _startAsyncCardOperation([=, cvc = makeCvc(cvc)]() {
-            auto result = card->ListSlots(cvc, static_cast<size_t>(limit));
-            _setResponse<CardOperation::Satscard_ListSlots>(std::move(result));
-            return CKTapInterfaceErrorCode::success;
-        });
-    }
-    return false;
+    return _startOperationOnCard<tap_protocol::Satscard>(AuditOperation::listSlots, [this, limit, cvc = makeCvc(cvc)](tap_protocol::Satscard& card) {
+        auto result = card.ListSlots(cvc, static_cast<size_t>(limit));
+        _setResponse<CardOperation::Satscard_ListSlots>(std::move(result));
+        return CKTapInterfaceErrorCode::success;
+    });
 }
 
 bool TapProtocolThread::beginSatscard_New(const char* chainCode, const char* cvc) {
-    if (auto card = _satscard.lock()) {
-        return _startAsyncCardOperation([=, chain = makeChainCode(chainCode), cvc = makeCvc(cvc)]() {
-            _setResponse<CardOperation::Satscard_New>(card->New(chain, cvc));
-            return CKTapInterfaceErrorCode::success;
-        });
-    }
-    return false;
+    return _startOperationOnCard<tap_protocol::Satscard>(AuditOperation::newSlot, [this, chain = makeChainCode(chainCode), cvc = makeCvc(cvc)](tap_protocol::Satscard& card) {
+        _setResponse<CardOperation::Satscard_New>(card.New(chain, cvc));
+        return CKTapInterfaceErrorCode::success;
+    });
 }
 
 bool TapProtocolThread::beginSatscard_Unseal(const char* cvc) {
-    if (auto card = _satscard.lock()) {
-        return _startAsyncCardOperation([=, cvc = makeCvc(cvc)]() {
-            _setResponse<CardOperation::Satscard_Unseal>(card->Unseal(cvc));
-            return CKTapInterfaceErrorCode::success;
-        });
-    }
-    return false;
+    return _startOperationOnCard<tap_protocol::Satscard>(AuditOperation::unseal, [this, cvc = makeCvc(cvc)](tap_protocol::Satscard& card) {
+        _setResponse<CardOperation::Satscard_Unseal>(card.Unseal(cvc));
+        return CKTapInterfaceErrorCode::success;
+    });
 }
 
 bool TapProtocolThread::finalizeOperation() noexcept {
     if ((hasFinished() || hasFailed()) && _future.valid()) {
-        try {
-            _recentError = _future.get();
-            return true;
-        }
-        catch (...) {
-            _recentError = CKTapInterfaceErrorCode::failedToRetrieveValueFromFuture;
-            return false;
-        }
+        return _collectResult();
     }
 
     return false;
 }
 
 bool TapProtocolThread::hasStarted() const noexcept {
-    return _state != CKTapThreadState::notStarted;
+    return _state.load() != CKTapThreadState::notStarted;
 }
 
 bool TapProtocolThread::hasFailed() const noexcept {
-    return _state > CKTapThreadState::finished;
+    return _state.load() > CKTapThreadState::finished;
 }
 
 bool TapProtocolThread::hasFinished() const noexcept {
-    return _state == CKTapThreadState::finished;
+    return _state.load() == CKTapThreadState::finished;
 }
 
 bool TapProtocolThread::isThreadActive() const noexcept {
-    return hasStarted() && !hasFinished() && !hasFailed();
+    const auto state = _state.load();
+    return state != CKTapThreadState::notStarted && state < CKTapThreadState::finished;
 }
 
 CKTapThreadState TapProtocolThread::getState() const noexcept {
-    return _state;
+    return _state.load();
 }
 
 CKTapInterfaceErrorCode TapProtocolThread::getRecentErrorCode() const noexcept {
@@ -228,7 +460,7 @@ CKTapInterfaceErrorCode TapProtocolThread::getRecentErrorCode() const noexcept {
 }
 
 bool TapProtocolThread::getTapProtocolException(CKTapProtoException& outException) const noexcept {
-    if (_state == CKTapThreadState::tapProtocolError) {
+    if (_state.load() == CKTapThreadState::tapProtocolError) {
         outException = allocateCKTapProtoException(_tapProtoException);
         return true;
     }
@@ -236,29 +468,53 @@ bool TapProtocolThread::getTapProtocolException(CKTapProtoException& outExceptio
     return false;
 }
 
+bool TapProtocolThread::waitForTransportRequest(const std::chrono::steady_clock::time_point deadline) const noexcept {
+    try {
+        _waitForStateChange(deadline, [this]() {
+            return _state.load() == CKTapThreadState::transportRequestReady || !isThreadActive();
+        });
+    } catch (...) { }
+    return _state.load() == CKTapThreadState::transportRequestReady;
+}
+
 std::optional<const tap_protocol::Bytes*> TapProtocolThread::getTransportRequest() const {
-    if (_state != CKTapThreadState::transportRequestReady) {
+    if (_state.load() != CKTapThreadState::transportRequestReady) {
         return { };
     }
 
-    return &_pendingTransportRequest;
+    return &_transportRequest.read();
 }
 
 std::optional<uint8_t*> TapProtocolThread::allocateTransportResponseBuffer(size_t sizeInBytes) {
-    if (_state != CKTapThreadState::transportRequestReady) {
+    if (_state.load() != CKTapThreadState::transportRequestReady) {
         return { };
     }
 
-    _transportResponse.resize(sizeInBytes);
-    return _transportResponse.data();
+    return _transportResponse.beginWrite(sizeInBytes);
 }
 
 bool TapProtocolThread::finalizeTransportResponse() {
-    if (_state != CKTapThreadState::transportRequestReady) {
+    if (_state.load() != CKTapThreadState::transportRequestReady) {
+        return false;
+    }
+
+    // Only a response written for the current request is handed over, never whatever a previous message left
+    if (!_transportResponse.hasUnpublishedWrite()) {
         return false;
     }
 
-    _state = CKTapThreadState::transportResponseReady;
+    // The protocol thread may time out or be canceled at any point. Publishing together with the transition, under
+    // the lock the protocol thread claims the response with, means it's only published once the protocol thread is
+    // certain to take it, and the protocol thread can never see the new state without the new response
+    {
+        std::lock_guard<std::mutex> lock{ _stateChangeMutex };
+        _responsePublishedTime = std::chrono::steady_clock::now().time_since_epoch().count();
+        if (!_state.transition<CKTapThreadState::transportRequestReady, CKTapThreadState::transportResponseReady>()) {
+            return false;
+        }
+        _transportResponse.publish();
+    }
+    _notifyStateChange();
     return true;
 }
 
@@ -286,10 +542,133 @@ std::unique_ptr<tap_protocol::Tapsigner> TapProtocolThread::releaseConstructedTa
         nullptr;
 }
 
-void TapProtocolThread::_cancelIfNecessary() {
-    if (_shouldCancel) {
-        throw CancelationException("Canceling operation in TapProtocolThread");
+std::shared_ptr<tap_protocol::CKTapCard> TapProtocolThread::releaseReattachedCard() noexcept {
+    return !isThreadActive() ? std::move(_reattachedCard) : nullptr;
+}
+
+void TapProtocolThread::_abortTransport(const CKTapInterfaceErrorCode reason) {
+    // Keep the first reason, anything after it is a consequence of unwinding
+    auto expected = CKTapInterfaceErrorCode::pending;
+    _abortReason.compare_exchange_strong(expected, reason);
+    throw TransportAbortException{ };
+}
+
+std::chrono::steady_clock::time_point TapProtocolThread::_transportDeadline(
+    const std::chrono::steady_clock::time_point requestTime) const noexcept {
+
+    const auto timeout = _deadlineOptions.isTransportTimeoutAdaptive ?
+        _roundTrips.adaptiveTimeout(_deadlineOptions.transportTimeout) :
+        _deadlineOptions.transportTimeout;
+    _metrics.transportTimeoutMicros = timeout.count();
+
+    return std::min(requestTime + timeout, _operationDeadline);
+}
+
+void TapProtocolThread::_recordCancellationLatency() noexcept {
+    const auto requestTime = _cancelRequestTime.load();
+    if (requestTime == 0) {
+        return;
     }
+
+    const auto elapsed = std::chrono::steady_clock::now().time_since_epoch() -
+        std::chrono::steady_clock::duration{ requestTime };
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    _metrics.recordCancellationLatency(latency);
+}
+
+void TapProtocolThread::_setCancelled(const CKTapInterfaceErrorCode reason) noexcept {
+    // The reason is set before the flag, so the protocol thread always finds it once it sees the cancel
+    auto expected = CKTapInterfaceErrorCode::pending;
+    _cancelReason.compare_exchange_strong(expected, reason);
+    if (!_shouldCancel.exchange(true)) {
+        _cancelRequestTime = std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    // A prepared operation has no worker to unwind it, so it's withdrawn instead of being left looking active
+    if (_state.load() == CKTapThreadState::awaitingCardOperation) {
+        _state.transition<CKTapThreadState::awaitingCardOperation, CKTapThreadState::notStarted>();
+    }
+}
+
+CKTapInterfaceErrorCode TapProtocolThread::_cancellationError() const noexcept {
+    const auto reason = _cancelReason.load();
+    return reason != CKTapInterfaceErrorCode::pending ? reason : CKTapInterfaceErrorCode::operationCanceled;
+}
+
+void TapProtocolThread::_notifyStateChange() const noexcept {
+    _lastProgressTime = std::chrono::steady_clock::now().time_since_epoch().count();
+
+    // Taking the lock orders the notification after any waiter has checked its predicate, otherwise a change made
+    // between the check and the wait would be missed
+    try {
+        std::lock_guard<std::mutex> lock{ _stateChangeMutex };
+    } catch (...) { }
+    _stateChanged.notify_all();
+    _fiberWaker.notify();
+}
+
+bool TapProtocolThread::_collectResult() noexcept {
+    bool isRetrieved{ true };
+    try {
+        _recentError = _future.get();
+    }
+    catch (...) {
+        _recentError = CKTapInterfaceErrorCode::failedToRetrieveValueFromFuture;
+        isRetrieved = false;
+    }
+
+    _recordAudit();
+    return isRetrieved;
+}
+
+/// The slot a response is about, for the operations which return a single slot
+static const tap_protocol::Satscard::Slot* auditedSlot(const CardResponseVariant& response) noexcept {
+    if (const auto* slot = std::get_if<static_cast<size_t>(CardOperation::Satscard_GetSlot)>(&response)) {
+        return slot;
+    } else if (const auto* slot = std::get_if<static_cast<size_t>(CardOperation::Satscard_New)>(&response)) {
+        return slot;
+    }
+    return std::get_if<static_cast<size_t>(CardOperation::Satscard_Unseal)>(&response);
+}
+
+void TapProtocolThread::_recordAudit() const noexcept {
+    auto& auditLog = _services->auditLog;
+    if (!auditLog.isOpen()) {
+        return;
+    }
+
+    AuditRecord record{ };
+    record.startedMicros = _operationStartedMicros;
+    record.finishedMicros = _operationFinishedMicros != 0 ? _operationFinishedMicros : auditTimestampMicros();
+    record.errorCode = static_cast<int32_t>(_recentError.load());
+    record.operation = static_cast<uint16_t>(_auditOperation);
+    record.cardType = static_cast<int8_t>(CKTapCardType::unknownCard);
+    record.slotIndex = _auditSlotIndex;
+
+    // The handshake's new card, the card reattached for the operation, or the registered card it ran on
+    std::shared_ptr<tap_protocol::CKTapCard> lockedCard{ };
+    const tap_protocol::CKTapCard* card = _constructedCard ? _constructedCard.get() : _reattachedCard.get();
+    if (card == nullptr) {
+        lockedCard = _lockCardForOperation();
+        card = lockedCard.get();
+    }
+
+    const char* ident{ nullptr };
+    if (card != nullptr) {
+        record.cardType = static_cast<int8_t>(card->IsTapsigner() ? CKTapCardType::tapsigner : CKTapCardType::satscard);
+        ident = card->GetIdent().c_str();
+    } else if (_detachedCardType != CKTapCardType::unknownCard) {
+        record.cardType = static_cast<int8_t>(_detachedCardType);
+        ident = _detachedCardIdent.c_str();
+    }
+    if (ident != nullptr) {
+        std::strncpy(record.ident.data(), ident, record.ident.size() - 1);
+    }
+
+    if (const auto* slot = _hasResponse ? auditedSlot(_cardOperationResponse) : nullptr) {
+        record.slotIndex = static_cast<int8_t>(slot->index);
+    }
+    auditLog.append(record);
 }
 
 std::shared_ptr<tap_protocol::CKTapCard> TapProtocolThread::_lockCardForOperation() const noexcept {
@@ -300,71 +679,107 @@ std::shared_ptr<tap_protocol::CKTapCard> TapProtocolThread::_lockCardForOperatio
     }
 }
 
-std::unique_ptr<tap_protocol::CKTapCard> TapProtocolThread::_performHandshake(const int32_t cardType) {
-    _state = CKTapThreadState::awaitingTransportRequest;
-    auto transport = tap_protocol::MakeDefaultTransport([this](const tap_protocol::Bytes& bytes) {
-        if (_state == CKTapThreadState::asyncActionStarting ||
-            _state == CKTapThreadState::processingTransportResponse) {
+Result<std::unique_ptr<tap_protocol::CKTapCard>> TapProtocolThread::_performHandshake(const int32_t cardType) {
+    using HandshakeResult = Result<std::unique_ptr<tap_protocol::CKTapCard>>;
+    if (!_state.transition<CKTapThreadState::asyncActionStarting, CKTapThreadState::awaitingTransportRequest>()) {
+        return HandshakeResult::failure(CKTapInterfaceErrorCode::invalidThreadStateDuringTransportSignaling);
+    }
 
-            // Sometimes we may need to send multiple messages during a single transmission
-            _state = CKTapThreadState::awaitingTransportRequest;
-        }
-        if (_state != CKTapThreadState::awaitingTransportRequest) {
+    // tap_protocol expects bytes back from this callback so throwing is the only way to stop it mid-operation
+    auto transport = tap_protocol::MakeDefaultTransport([this](const tap_protocol::Bytes& bytes) {
+        // Sometimes we may need to send multiple messages during a single transmission
+        constexpr uint32_t previousStates =
+            stateBit(CKTapThreadState::asyncActionStarting) |
+            stateBit(CKTapThreadState::processingTransportResponse);
+        if (_state.load() != CKTapThreadState::awaitingTransportRequest &&
+            !_state.transitionFromAny(previousStates, CKTapThreadState::awaitingTransportRequest)) {
             return tap_protocol::Bytes{ };
         }
 
         // Allow the library to take our transport data
-        _signalTransportRequestReady(bytes);
-
-        // Wait for our library to be transmitted through Flutter
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        const auto endTime = currentTime + 1min;
-        do {
-            _cancelIfNecessary();
-            std::this_thread::sleep_for(100ns);
-            std::this_thread::yield();
-            currentTime = std::chrono::high_resolution_clock::now();
-        } while (_state != CKTapThreadState::transportResponseReady && currentTime < endTime);
-
-        // Handle timeouts
-        if (_state != CKTapThreadState::transportResponseReady) {
-            throw TimeoutException(
-                "TapProtocolThread::_performHandshake::MakeDefaultTransport(): Timed out waiting for transport response, current state is \"" +
-                    std::to_string(_state) + '"'
-            );
+        auto allocationsBefore = threadAllocationCount();
+        if (!_signalTransportRequestReady(bytes)) {
+            _abortTransport(CKTapInterfaceErrorCode::invalidThreadStateDuringTransportSignaling);
         }
+        // The previous response went to tap_protocol along with its storage, its replacement is reserved whilst
+        // the host is busy with the card rather than once the response is back
+        _transportResponse.prepareTake();
+        _transportAllocations.fetch_add(threadAllocationCount() - allocationsBefore, std::memory_order_relaxed);
+
+        // Sleep until the host delivers the response or cancels, the thread uses no CPU while the request is in
+        // flight however long the host takes, and a pooled session leaves its worker free for the others
+        const auto requestTime = std::chrono::steady_clock::now();
+        _waitForHost(_transportDeadline(requestTime), [this]() {
+            return _shouldCancel || _state.load() == CKTapThreadState::transportResponseReady;
+        });
+        const auto currentTime = std::chrono::steady_clock::now();
 
-        _cancelIfNecessary();
-        _state = CKTapThreadState::processingTransportResponse;
-        return _transportResponse;
+        if (_shouldCancel) {
+            _abortTransport(_cancellationError());
+        }
+        if (_state.load() != CKTapThreadState::transportResponseReady) {
+            _abortTransport(CKTapInterfaceErrorCode::timeoutDuringTransport);
+        }
+
+        const auto roundTrip = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - requestTime);
+        _roundTrips.record(roundTrip);
+        _metrics.lastRoundTripMicros = roundTrip.count();
+        g_metrics.roundTrips.record(roundTrip.count());
+
+        // How long the response sat waiting for this thread to be scheduled, the part of the round trip which
+        // worker priority and affinity can shorten
+        const auto publishedTime = std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ _responsePublishedTime.load() } };
+        g_metrics.wakeLatencies.record(std::chrono::duration_cast<std::chrono::microseconds>(currentTime - publishedTime).count());
+
+        if (_shouldCancel) {
+            _abortTransport(_cancellationError());
+        }
+        // Claimed under the lock the host publishes with, so the response read below is the one just published
+        bool hasClaimedResponse{ false };
+        {
+            std::lock_guard<std::mutex> lock{ _stateChangeMutex };
+            hasClaimedResponse = _state.transition<CKTapThreadState::transportResponseReady, CKTapThreadState::processingTransportResponse>();
+        }
+        if (!hasClaimedResponse) {
+            _abortTransport(CKTapInterfaceErrorCode::invalidThreadStateDuringTransportSignaling);
+        }
+
+        // tap_protocol takes the response by value, so it's moved out of the buffer instead of being copied
+        allocationsBefore = threadAllocationCount();
+        auto response = _transportResponse.take();
+        _transportAllocations.fetch_add(threadAllocationCount() - allocationsBefore, std::memory_order_relaxed);
+        return response;
     });
 
     // Construct the classes directly if we've been given a hint
-    _cancelIfNecessary();
+    if (_shouldCancel) {
+        return HandshakeResult::failure(_cancellationError());
+    }
     if (cardType == CKTapCardType::satscard) {
-        return std::make_unique<tap_protocol::Satscard>(std::move(transport));
+        return HandshakeResult{ std::make_unique<tap_protocol::Satscard>(std::move(transport)) };
     } else if (cardType == CKTapCardType::tapsigner) {
-        return std::make_unique<tap_protocol::Tapsigner>(std::move(transport));
+        return HandshakeResult{ std::make_unique<tap_protocol::Tapsigner>(std::move(transport)) };
     }
 
     // We will have to manually figure out what the card is
     auto card = tap_protocol::CKTapCard(std::move(transport));
 
     // More transport operations may need to be performed when we turn the card into a Tapsigner or Satscard
-    _cancelIfNecessary();
+    if (_shouldCancel) {
+        return HandshakeResult::failure(_cancellationError());
+    }
     if (card.IsTapsigner()) {
-        return tap_protocol::ToTapsigner(std::move(card));
+        return HandshakeResult{ tap_protocol::ToTapsigner(std::move(card)) };
     } else {
-        return tap_protocol::ToSatscard(std::move(card));
+        return HandshakeResult{ tap_protocol::ToSatscard(std::move(card)) };
     }
 }
 
-void TapProtocolThread::_signalTransportRequestReady(const tap_protocol::Bytes& bytes) {
-    if (_state != CKTapThreadState::awaitingTransportRequest) {
-        throw TransportException("Attempt to set transport request when state was \"" +
-            std::to_string(_state) + '\"'
-        );
-    }
-    _pendingTransportRequest = bytes;
-    _state = CKTapThreadState::transportRequestReady;
+bool TapProtocolThread::_signalTransportRequestReady(const tap_protocol::Bytes& bytes) noexcept {
+    // The host only reads the request once the state changes so it's safe to write first
+    _transportRequest.write(bytes);
+    _transportRequest.publish();
+    const auto hasTransitioned = _state.transition<CKTapThreadState::awaitingTransportRequest, CKTapThreadState::transportRequestReady>();
+    _notifyStateChange();
+    return hasTransitioned;
 }
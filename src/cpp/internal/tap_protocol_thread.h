@@ -3,7 +3,15 @@
 
 // Project
 #include <enums.h>
+#include <internal/audit_log.h>
 #include <internal/card_operation.h>
+#include <internal/context_services.h>
+#include <internal/deadlines.h>
+#include <internal/metrics.h>
+#include <internal/result.h>
+#include <internal/session_pool.h>
+#include <internal/thread_state.h>
+#include <internal/transport_buffer.h>
 #include <structs.h>
 
 // Third party
@@ -11,18 +19,40 @@
 
 // STL
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 
 class TapProtocolThread {
 public:
 
-    static TapProtocolThread* createNew() noexcept;
+    /// The thread runs its operations with the scheduling, audit log and watchdog timeout of [services] and records
+    /// them in [metrics], which has to outlive it
+    static TapProtocolThread* createNew(std::shared_ptr<ContextServices> services, OperationMetrics& metrics) noexcept;
+    ~TapProtocolThread();
     CKTapInterfaceErrorCode reset() noexcept;
-    void requestCancel() noexcept;
+    /// Stops the running operation at its next transport message, it fails with [reason]. Only the first reason
+    /// given to an operation is kept
+    void requestCancel(CKTapInterfaceErrorCode reason = CKTapInterfaceErrorCode::operationCanceled) noexcept;
+    /// Cancels the running operation with sessionStalled if its state hasn't changed for [stallTimeout], such as
+    /// when the host stops answering transport requests. Returns whether it was cancelled
+    bool cancelIfStalled(std::chrono::steady_clock::time_point now) noexcept;
+    /// How long the watchdog lets this thread's operations go without progress, zero when it leaves them alone
+    std::chrono::milliseconds stallTimeout() const noexcept;
+    /// Waits for a cancelled operation to unwind, returning false straight away if it wasn't cancelled. Returns
+    /// whether the thread is free for the next operation
+    bool waitForCancellation(std::chrono::steady_clock::time_point deadline) const noexcept;
+    bool setDeadlineOptions(const DeadlineOptions& options) noexcept;
 
     bool prepareCardOperation(std::weak_ptr<tap_protocol::Satscard> satscard) noexcept;
     bool prepareCardOperation(std::weak_ptr<tap_protocol::Tapsigner> tapsigner) noexcept;
+    /// Prepares an operation on a card whose live object was detached from the registry. The operation begins
+    /// with a handshake to reattach it, failing if a card with a different identity is tapped
+    bool prepareDetachedCardOperation(CKTapCardType type, std::string ident) noexcept;
     bool beginCardHandshake(int32_t cardType) noexcept;
     bool beginCKTapCard_Wait();
     bool beginSatscard_CertificateCheck();
@@ -32,72 +62,142 @@ public:
     bool beginSatscard_Unseal(const char* cvc);
     bool finalizeOperation() noexcept;
 
+    /// Moves the response of the most recent operation out of the thread so it can be converted without
+    /// being copied. A response can only be taken once, an error is returned on subsequent calls, whilst the
+    /// thread is active, or if the response doesn't match the given operation
     template <CardOperation op, typename R = CardResponseType<op>>
-    std::optional<R> getResponse() const noexcept;
+    Result<R> takeResponse() noexcept;
 
     bool hasStarted() const noexcept;
     bool hasFailed() const noexcept;
     bool hasFinished() const noexcept;
     bool isThreadActive() const noexcept;
+    /// Whether the running operation has been asked to stop, by the host or the watchdog, and is unwinding
+    bool isCancelRequested() const noexcept { return _shouldCancel.load(); }
     CKTapThreadState getState() const noexcept;
     CKTapInterfaceErrorCode getRecentErrorCode() const noexcept;
     bool getTapProtocolException(CKTapProtoException& outException) const noexcept;
 
+    /// Blocks until a transport request is ready, the operation ends or [deadline] passes. Returns whether a
+    /// request is ready, so a native host can sleep between requests instead of polling [getState]
+    bool waitForTransportRequest(std::chrono::steady_clock::time_point deadline) const noexcept;
     std::optional<const tap_protocol::Bytes*> getTransportRequest() const;
     std::optional<uint8_t*> allocateTransportResponseBuffer(size_t sizeInBytes);
     bool finalizeTransportResponse();
+    /// Allocations the protocol thread has made passing transport messages to and from tap_protocol, outside of
+    /// tap_protocol itself. Always 0 without CKTAP_TRACK_ALLOCATIONS
+    int64_t transportAllocations() const noexcept { return _transportAllocations.load(std::memory_order_relaxed); }
 
     std::optional<CKTapCardType> getConstructedCardType() const;
     std::unique_ptr<tap_protocol::Satscard> releaseConstructedSatscard();
     std::unique_ptr<tap_protocol::Tapsigner> releaseConstructedTapsigner();
+    /// The card reattached by the most recent operation, see [prepareDetachedCardOperation]
+    std::shared_ptr<tap_protocol::CKTapCard> releaseReattachedCard() noexcept;
 
 private:
 
+    TapProtocolThread(std::shared_ptr<ContextServices> services, OperationMetrics& metrics) noexcept;
+
     template <CardOperation op, typename... Args>
     auto _setResponse(Args&&... args);
 
     template <typename Func>
-    bool _startAsyncCardOperation(Func&& func) noexcept;
-    void _cancelIfNecessary();
+    bool _startAsyncCardOperation(AuditOperation operation, Func&& func) noexcept;
+    template <typename Func>
+    CKTapInterfaceErrorCode _invokeTapProtocol(const Func& func) noexcept;
+    template <typename CardType, typename Func>
+    bool _startOperationOnCard(AuditOperation operation, Func&& func) noexcept;
+    template <typename CardType>
+    std::shared_ptr<CardType> _lockCard() const noexcept;
+    template <typename CardType>
+    Result<std::shared_ptr<CardType>> _reattachCard();
+    [[noreturn]] void _abortTransport(CKTapInterfaceErrorCode reason);
+    std::chrono::steady_clock::time_point _transportDeadline(std::chrono::steady_clock::time_point requestTime) const noexcept;
+    void _recordCancellationLatency() noexcept;
+    /// Takes the result of the finished operation then records it in the audit log, returning whether the
+    /// result could be retrieved
+    bool _collectResult() noexcept;
+    void _recordAudit() const noexcept;
+    /// Wakes whichever side is waiting on [_stateChanged], called after every change either side may wait for
+    void _notifyStateChange() const noexcept;
+    void _setCancelled(CKTapInterfaceErrorCode reason) noexcept;
+    /// The error a cancelled operation fails with
+    CKTapInterfaceErrorCode _cancellationError() const noexcept;
+    template <typename Predicate>
+    void _waitForStateChange(std::chrono::steady_clock::time_point deadline, const Predicate& predicate) const;
+    /// Waits on the host from the protocol side, parking the fiber instead of blocking when the operation runs on
+    /// the session pool
+    template <typename Predicate>
+    void _waitForHost(std::chrono::steady_clock::time_point deadline, const Predicate& predicate) const;
 
     std::shared_ptr<tap_protocol::CKTapCard> _lockCardForOperation() const noexcept;
-    std::unique_ptr<tap_protocol::CKTapCard> _performHandshake(int32_t cardType);
-    void _signalTransportRequestReady(const tap_protocol::Bytes& bytes);
+    Result<std::unique_ptr<tap_protocol::CKTapCard>> _performHandshake(int32_t cardType);
+    bool _signalTransportRequestReady(const tap_protocol::Bytes& bytes) noexcept;
 
+    std::shared_ptr<ContextServices> _services{ };
+    OperationMetrics& _metrics;
     std::future<CKTapInterfaceErrorCode> _future{ };
 
-    std::atomic<CKTapThreadState> _state{ CKTapThreadState::notStarted };
+    ThreadStateMachine _state{ };
+    mutable std::mutex _stateChangeMutex{ };
+    mutable std::condition_variable _stateChanged{ };
+    /// Wakes the operation's fiber when it runs on the session pool, notified alongside [_stateChanged]
+    mutable FiberWaker _fiberWaker{ };
     std::atomic<bool> _shouldCancel { false };
+    std::atomic<std::chrono::steady_clock::rep> _cancelRequestTime{ 0 };
+    std::atomic<CKTapInterfaceErrorCode> _cancelReason{ CKTapInterfaceErrorCode::pending };
+    /// When the state last changed, read by the watchdog
+    mutable std::atomic<std::chrono::steady_clock::rep> _lastProgressTime{ 0 };
+    std::atomic<CKTapInterfaceErrorCode> _abortReason{ CKTapInterfaceErrorCode::pending };
     std::atomic<CKTapInterfaceErrorCode> _recentError{ CKTapInterfaceErrorCode::threadNotYetStarted };
 
     tap_protocol::TapProtoException _tapProtoException{ 0, { } };
-    tap_protocol::Bytes _pendingTransportRequest{ };
-    tap_protocol::Bytes _transportResponse{ };
+    DeadlineOptions _deadlineOptions{ };
+    std::chrono::steady_clock::time_point _operationDeadline{ std::chrono::steady_clock::time_point::max() };
+    RoundTripTracker _roundTrips{ };
+    /// When the host last delivered a response, stored before the state change which wakes the protocol thread
+    std::atomic<std::chrono::steady_clock::rep> _responsePublishedTime{ 0 };
+
+    AuditOperation _auditOperation{ AuditOperation::handshake };
+    int8_t _auditSlotIndex{ -1 };
+    int64_t _operationStartedMicros{ 0 };
+    /// Written by the protocol thread as the operation returns, read once its future has been collected
+    int64_t _operationFinishedMicros{ 0 };
+
+    TransportBuffer _transportRequest{ };
+    TransportBuffer _transportResponse{ };
+    std::atomic<int64_t> _transportAllocations{ 0 };
 
     std::unique_ptr<tap_protocol::CKTapCard> _constructedCard{ };
     std::weak_ptr<tap_protocol::Satscard> _satscard{ };
     std::weak_ptr<tap_protocol::Tapsigner> _tapsigner{ };
+    CKTapCardType _detachedCardType{ CKTapCardType::unknownCard };
+    std::string _detachedCardIdent{ };
+    std::shared_ptr<tap_protocol::CKTapCard> _reattachedCard{ };
 
     /// Allows for us to store the response types to any CKTapCard/Satscard/Tapsigner function in a
     /// type-safe manner
     CardResponseVariant _cardOperationResponse{ };
+    bool _hasResponse{ false };
 };
 
 template <CardOperation op, typename R>
-std::optional<R> TapProtocolThread::getResponse() const noexcept {
-    try {
-        if (!isThreadActive()) {
-            constexpr size_t index = static_cast<size_t>(op);
-            return { std::get<index>(_cardOperationResponse) };
-        }
-    } catch (...) {
+Result<R> TapProtocolThread::takeResponse() noexcept {
+    constexpr size_t index = static_cast<size_t>(op);
+    if (isThreadActive()) {
+        return Result<R>::failure(CKTapInterfaceErrorCode::threadAlreadyInUse);
+    } else if (!_hasResponse || _cardOperationResponse.index() != index) {
+        return Result<R>::failure(CKTapInterfaceErrorCode::invalidResponseFromCardOperation);
     }
-    return { };
+
+    _hasResponse = false;
+    return Result<R>{ std::move(*std::get_if<index>(&_cardOperationResponse)) };
 }
 
 template <CardOperation op, typename... Args>
 auto TapProtocolThread::_setResponse(Args&&... args) {
     constexpr auto index = static_cast<size_t>(op);
+    _hasResponse = true;
     return _cardOperationResponse.emplace<index>(std::forward<Args>(args)...);
 }
 
@@ -0,0 +1,44 @@
+#include <internal/thread_state.h>
+
+// Project
+#include <internal/metrics.h>
+
+// Ensure the states fit in the bit masks
+static_assert(CKTapThreadState::transportException < 32);
+
+// Sanity check the table against the transport request loop
+static_assert(isValidTransition(CKTapThreadState::awaitingTransportRequest, CKTapThreadState::transportRequestReady));
+static_assert(isValidTransition(CKTapThreadState::transportRequestReady, CKTapThreadState::transportResponseReady));
+static_assert(isValidTransition(CKTapThreadState::transportResponseReady, CKTapThreadState::processingTransportResponse));
+static_assert(isValidTransition(CKTapThreadState::processingTransportResponse, CKTapThreadState::awaitingTransportRequest));
+static_assert(!isValidTransition(CKTapThreadState::finished, CKTapThreadState::failed));
+static_assert(!isValidTransition(CKTapThreadState::transportResponseReady, CKTapThreadState::transportRequestReady));
+
+CKTapThreadState ThreadStateMachine::load() const noexcept {
+    return _state.load(std::memory_order_acquire);
+}
+
+bool ThreadStateMachine::reset() noexcept {
+    return transitionFromAny(~activeThreadStates, CKTapThreadState::notStarted);
+}
+
+bool ThreadStateMachine::transitionFromAny(const uint32_t fromStates, const CKTapThreadState to) noexcept {
+    auto current = _state.load(std::memory_order_acquire);
+    while (true) {
+        // The caller expecting a different state is how it learns the other thread got there first or the
+        // operation isn't in the state it's asking about, only moves the table forbids are counted
+        if ((fromStates & stateBit(current)) == 0) {
+            return false;
+        }
+        if (!isValidTransition(current, to)) {
+            g_metrics.illegalStateTransitions.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (_state.compare_exchange_strong(current, to, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return true;
+        }
+
+        // Another thread got there first, re-validate against the state it left behind
+        g_metrics.contendedStateTransitions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
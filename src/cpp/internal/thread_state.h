@@ -0,0 +1,99 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_THREAD_STATE_H__
+#define __CKTAP_PROTOCOL__INTERNAL_THREAD_STATE_H__
+
+// Project
+#include <enums.h>
+
+// STL
+#include <atomic>
+#include <cstdint>
+
+/// A bit mask containing only the given state, used to describe sets of states
+constexpr uint32_t stateBit(const CKTapThreadState state) noexcept {
+    return 1u << static_cast<uint32_t>(state);
+}
+
+/// States in which the protocol thread is running
+constexpr uint32_t activeThreadStates =
+    stateBit(CKTapThreadState::asyncActionStarting) |
+    stateBit(CKTapThreadState::awaitingTransportRequest) |
+    stateBit(CKTapThreadState::transportRequestReady) |
+    stateBit(CKTapThreadState::transportResponseReady) |
+    stateBit(CKTapThreadState::processingTransportResponse);
+
+/// States which the protocol thread ends an operation in
+constexpr uint32_t terminalThreadStates =
+    stateBit(CKTapThreadState::finished) |
+    stateBit(CKTapThreadState::canceled) |
+    stateBit(CKTapThreadState::failed) |
+    stateBit(CKTapThreadState::invalidCardProduced) |
+    stateBit(CKTapThreadState::tapProtocolError) |
+    stateBit(CKTapThreadState::timeout) |
+    stateBit(CKTapThreadState::transportException);
+
+/// The transition table for [CKTapThreadState], returns every state that may legally follow the given one
+constexpr uint32_t allowedTransitionsFrom(const CKTapThreadState from) noexcept {
+    switch (from) {
+        case CKTapThreadState::notStarted:
+            return stateBit(CKTapThreadState::notStarted) |
+                stateBit(CKTapThreadState::awaitingCardOperation) |
+                stateBit(CKTapThreadState::asyncActionStarting);
+        case CKTapThreadState::awaitingCardOperation:
+            return stateBit(CKTapThreadState::notStarted) |
+                stateBit(CKTapThreadState::awaitingCardOperation) |
+                stateBit(CKTapThreadState::asyncActionStarting);
+        case CKTapThreadState::asyncActionStarting:
+            return stateBit(CKTapThreadState::awaitingTransportRequest) | terminalThreadStates;
+        case CKTapThreadState::awaitingTransportRequest:
+            return stateBit(CKTapThreadState::transportRequestReady) | terminalThreadStates;
+        case CKTapThreadState::transportRequestReady:
+            return stateBit(CKTapThreadState::transportResponseReady) | terminalThreadStates;
+        case CKTapThreadState::transportResponseReady:
+            return stateBit(CKTapThreadState::processingTransportResponse) | terminalThreadStates;
+        case CKTapThreadState::processingTransportResponse:
+            return stateBit(CKTapThreadState::awaitingTransportRequest) | terminalThreadStates;
+        case CKTapThreadState::finished:
+        case CKTapThreadState::canceled:
+        case CKTapThreadState::failed:
+        case CKTapThreadState::invalidCardProduced:
+        case CKTapThreadState::tapProtocolError:
+        case CKTapThreadState::timeout:
+        case CKTapThreadState::transportException:
+            return stateBit(CKTapThreadState::notStarted);
+    }
+    return 0;
+}
+
+constexpr bool isValidTransition(const CKTapThreadState from, const CKTapThreadState to) noexcept {
+    return (allowedTransitionsFrom(from) & stateBit(to)) != 0;
+}
+
+/// Holds the current [CKTapThreadState] and only allows it to change according to the transition table. Every
+/// change is made with a compare-and-swap so the host and the protocol thread can never overwrite each other's
+/// updates. Illegal and contended transitions are recorded in the library metrics
+class ThreadStateMachine {
+public:
+
+    CKTapThreadState load() const noexcept;
+
+    /// Moves from one specific state to another, the transition is validated at compile time. Fails if the
+    /// state is no longer `from` because another thread changed it first
+    template <CKTapThreadState from, CKTapThreadState to>
+    bool transition() noexcept {
+        static_assert(isValidTransition(from, to), "Illegal CKTapThreadState transition");
+        return transitionFromAny(stateBit(from), to);
+    }
+
+    /// Moves from whichever of the given states is current into `to`. Fails if the current state isn't in the
+    /// set or the transition isn't permitted by the table, only the latter counts as an illegal transition
+    bool transitionFromAny(uint32_t fromStates, CKTapThreadState to) noexcept;
+
+    /// Returns to notStarted, only possible whilst the thread isn't active
+    bool reset() noexcept;
+
+private:
+
+    std::atomic<CKTapThreadState> _state{ CKTapThreadState::notStarted };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_THREAD_STATE_H__
@@ -0,0 +1,61 @@
+#include <internal/transport_buffer.h>
+
+// STL
+#include <algorithm>
+
+TransportBuffer::TransportBuffer(const size_t initialCapacity)
+    : _spareCapacity{ initialCapacity } {
+    for (auto& buffer : _buffers) {
+        buffer.reserve(initialCapacity);
+    }
+}
+
+uint8_t* TransportBuffer::beginWrite(const size_t sizeInBytes) {
+    auto& back = _back();
+    back.resize(sizeInBytes);
+    _hasUnpublishedWrite = true;
+    return back.data();
+}
+
+void TransportBuffer::write(const tap_protocol::Bytes& bytes) {
+    // Assigning reuses the existing capacity instead of reallocating
+    _back().assign(bytes.begin(), bytes.end());
+    _hasUnpublishedWrite = true;
+}
+
+void TransportBuffer::publish() noexcept {
+    _front.store(1 - _front.load(std::memory_order_relaxed), std::memory_order_release);
+    _hasUnpublishedWrite = false;
+}
+
+const tap_protocol::Bytes& TransportBuffer::read() const noexcept {
+    return _buffers[_front.load(std::memory_order_acquire)];
+}
+
+void TransportBuffer::prepareTake() {
+    if (_spare.capacity() < _spareCapacity) {
+        _spare.reserve(_spareCapacity);
+    }
+}
+
+tap_protocol::Bytes TransportBuffer::take() noexcept {
+    auto& front = _buffers[_front.load(std::memory_order_acquire)];
+    // The spare matches the largest message taken so far, so the producer can write into it without growing it
+    _spareCapacity = std::max(_spareCapacity, front.capacity());
+    tap_protocol::Bytes message{ std::move(front) };
+    front = std::move(_spare);
+    _spare = tap_protocol::Bytes{ };
+    return message;
+}
+
+void TransportBuffer::clear() noexcept {
+    for (auto& buffer : _buffers) {
+        buffer.clear();
+    }
+    _front.store(0, std::memory_order_release);
+    _hasUnpublishedWrite = false;
+}
+
+tap_protocol::Bytes& TransportBuffer::_back() noexcept {
+    return _buffers[1 - _front.load(std::memory_order_relaxed)];
+}
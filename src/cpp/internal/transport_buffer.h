@@ -0,0 +1,60 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_TRANSPORT_BUFFER_H__
+#define __CKTAP_PROTOCOL__INTERNAL_TRANSPORT_BUFFER_H__
+
+// Third party
+#include <tap_protocol/tap_protocol.h>
+
+// STL
+#include <array>
+#include <atomic>
+
+/// The capacity reserved up front for each transport buffer. CKTap messages are short APDUs so this
+/// comfortably covers every request and response without needing to grow
+constexpr size_t defaultTransportBufferCapacity = 512;
+
+/// A double-buffered, single-producer/single-consumer byte buffer used to pass transport data
+/// between the host and the protocol thread. The producer always writes to the back buffer whilst the
+/// consumer reads from the front, so the producer can prepare the next message whilst the previous one
+/// is still being parsed. Capacity is retained across messages, operations and resets so that steady
+/// state message passing doesn't touch the heap
+class TransportBuffer {
+public:
+
+    explicit TransportBuffer(size_t initialCapacity = defaultTransportBufferCapacity);
+
+    /// Producer: resizes the back buffer and returns a pointer to it so it can be written to
+    uint8_t* beginWrite(size_t sizeInBytes);
+    /// Producer: copies the given bytes into the back buffer
+    void write(const tap_protocol::Bytes& bytes);
+    /// Producer: swaps the buffers so the most recent write becomes visible to the consumer
+    void publish() noexcept;
+    /// Producer: whether the back buffer has been written since the last publish, so a publish would hand the
+    /// consumer a fresh message rather than a stale one
+    bool hasUnpublishedWrite() const noexcept { return _hasUnpublishedWrite; }
+
+    /// Consumer: the most recently published buffer
+    const tap_protocol::Bytes& read() const noexcept;
+    /// Consumer: makes sure a spare buffer is reserved for [take] to put in place of the message it hands out. Call
+    /// it before waiting for the message, so the allocation this may need happens whilst the message is in flight
+    void prepareTake();
+    /// Consumer: moves the most recently published buffer out, putting the spare in its place, so the message can be
+    /// handed on without being copied or allocating. Only valid whilst the producer isn't writing
+    tap_protocol::Bytes take() noexcept;
+
+    /// Empties both buffers without releasing their capacity
+    void clear() noexcept;
+
+private:
+
+    tap_protocol::Bytes& _back() noexcept;
+
+    std::array<tap_protocol::Bytes, 2> _buffers{ };
+    /// Only touched by the consumer, see [prepareTake]
+    tap_protocol::Bytes _spare{ };
+    size_t _spareCapacity{ 0 };
+    std::atomic<size_t> _front{ 0 };
+    /// Only touched by the producer
+    bool _hasUnpublishedWrite{ false };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_TRANSPORT_BUFFER_H__
@@ -1,6 +1,7 @@
 #include <internal/utils.h>
 
 // Project
+#include <internal/codecs.h>
 #include <internal/tap_protocol_thread.h>
 
 // Third party
@@ -10,24 +11,30 @@
 // STL
 #include <cstring>
 
-CBinaryArray allocateCBinaryArrayFromJSON(const nlohmann::json::binary_t& binary) {
+CBinaryArray allocateCBinaryArray(const uint8_t* data, const size_t length) {
     CBinaryArray array;
     std::memset(&array, 0, sizeof(CBinaryArray));
 
-    if (binary.empty()) {
+    if (length == 0) {
         return array;
     }
 
-    array.ptr = static_cast<uint8_t*>(std::malloc(binary.size()));
-    array.length = static_cast<int32_t>(binary.size());
+    trackAllocation();
+    array.ptr = static_cast<uint8_t*>(std::malloc(length));
+    array.length = static_cast<int32_t>(length);
     if (array.ptr != nullptr) {
-        std::memcpy(array.ptr, binary.data(), binary.size());
+        std::memcpy(array.ptr, data, length);
     }
 
     return array;
 }
 
+CBinaryArray allocateCBinaryArrayFromJSON(const nlohmann::json::binary_t& binary) {
+    return allocateCBinaryArray(binary.data(), binary.size());
+}
+
 CKTapProtoException allocateCKTapProtoException(const tap_protocol::TapProtoException& e) noexcept {
+    trackAllocation();
     CKTapProtoException result = {
         .code = e.code(),
         .message = strdup(e.what()),
@@ -41,21 +48,60 @@ char* allocateCStringFromCpp(const std::string& cppString) {
         return nullptr;
     }
 
+    trackAllocation();
     char* cString = strdup(cppString.c_str());
     return cString;
 }
 
-void fillConstructorParams(CKTapCardConstructorParams& params, const size_t index, const tap_protocol::CKTapCard& card) {
-    params.handle = static_cast<int32_t>(index);
-    params.type = card.IsTapsigner() ? CKTapCardType::tapsigner : CKTapCardType::satscard;
-    params.ident = allocateCStringFromCpp(card.GetIdent());
-    params.appletVersion = allocateCStringFromCpp(card.GetAppletVersion());
-    params.authDelay = card.GetAuthDelay();
-    params.birthHeight = card.GetBirthHeight();
-    params.isCertsChecked = card.IsCertsChecked() ? 1 : 0;
-    params.isTampered = card.IsTampered() ? 1 : 0;
-    params.isTestnet = card.IsTestnet() ? 1 : 0;
-    params.needSetup = card.NeedSetup() ? 1 : 0;
+char* allocateCStringFromBuffer(const char* cString) {
+    if (cString == nullptr || cString[0] == '\0') {
+        return nullptr;
+    }
+
+    trackAllocation();
+    return strdup(cString);
+}
+
+CBinaryArray allocateSecureCBinaryArray(const uint8_t* data, const size_t length) {
+    CBinaryArray array;
+    std::memset(&array, 0, sizeof(CBinaryArray));
+
+    if (length == 0) {
+        return array;
+    }
+
+    array.ptr = static_cast<uint8_t*>(allocateSecure(length));
+    if (array.ptr == nullptr) {
+        g_metrics.securePoolFallbacks.fetch_add(1, std::memory_order_relaxed);
+        return allocateCBinaryArray(data, length);
+    }
+
+    array.length = static_cast<int32_t>(length);
+    std::memcpy(array.ptr, data, length);
+    return array;
+}
+
+CBinaryArray allocateSecureCBinaryArrayFromJSON(const nlohmann::json::binary_t& binary) {
+    return allocateSecureCBinaryArray(binary.data(), binary.size());
+}
+
+char* allocateSecureCString(const char* cString, const size_t length) {
+    if (length == 0) {
+        return nullptr;
+    }
+
+    auto* copy = static_cast<char*>(allocateSecure(length + 1));
+    if (copy == nullptr) {
+        g_metrics.securePoolFallbacks.fetch_add(1, std::memory_order_relaxed);
+        trackAllocation();
+        copy = static_cast<char*>(std::malloc(length + 1));
+    }
+
+    if (copy != nullptr) {
+        std::memcpy(copy, cString, length);
+        copy[length] = '\0';
+    }
+    return copy;
 }
 
 void fillConstructorParams(SlotConstructorParams& params, const int32_t handle, const tap_protocol::Satscard::Slot& slot) {
@@ -63,7 +109,7 @@ void fillConstructorParams(SlotConstructorParams& params, const int32_t handle,
     params.index = slot.index;
     params.status = static_cast<int32_t>(slot.status);
     params.address = allocateCStringFromCpp(slot.address);
-    params.privkey = allocateCBinaryArrayFromJSON(slot.privkey);
+    params.privkey = allocateSecureCBinaryArrayFromJSON(slot.privkey);
     params.pubkey = allocateCBinaryArrayFromJSON(slot.pubkey);
     params.masterPK = allocateCBinaryArrayFromJSON(slot.master_pk);
     params.chainCode = allocateCBinaryArrayFromJSON(slot.chain_code);
@@ -71,7 +117,11 @@ void fillConstructorParams(SlotConstructorParams& params, const int32_t handle,
 
 void freeCBinaryArray(CBinaryArray& array) {
     if (array.ptr != nullptr) {
-        std::free(array.ptr);
+        // A private key which didn't fit in the secure pool fell back to the heap, it's wiped all the same
+        if (!freeSecure(array.ptr)) {
+            secureZero(array.ptr, static_cast<size_t>(array.length));
+            std::free(array.ptr);
+        }
         array.ptr = nullptr;
         array.length = 0;
     }
@@ -104,6 +154,20 @@ void freeSatscardListSlotsParams(SatscardListSlotsParams& params) {
     freePointer(params.array);
 }
 
+void freeSatscardSyncParams(SatscardSyncParams& params) {
+    freeCKTapInterfaceStatus(params.status);
+}
+
+void freeSecureCString(char*& cString) {
+    if (cString != nullptr) {
+        if (!freeSecure(cString)) {
+            secureZero(cString, std::strlen(cString));
+            std::free(cString);
+        }
+        cString = nullptr;
+    }
+}
+
 void freeSlotConstructorParams(SlotConstructorParams& params) {
     freePointer(params.address);
     freeCBinaryArray(params.privkey);
@@ -114,7 +178,7 @@ void freeSlotConstructorParams(SlotConstructorParams& params) {
 
 void freeSlotToWifResponse(SlotToWifResponse response) {
     freeCKTapInterfaceStatus(response.status);
-    freePointer(response.wif);
+    freeSecureCString(response.wif);
 }
 
 void freeTapsignerConstructorParams(TapsignerConstructorParams& params) {
@@ -122,11 +186,28 @@ void freeTapsignerConstructorParams(TapsignerConstructorParams& params) {
     freePointer(params.derivationPath);
 }
 
+void freeTapsignerSyncParams(TapsignerSyncParams& params) {
+    freeCKTapInterfaceStatus(params.status);
+    freePointer(params.derivationPath);
+}
+
+int64_t microsSince(const std::chrono::steady_clock::time_point start) noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
 tap_protocol::Bytes makeChainCode(const char* cString) {
     if (cString == nullptr) {
         return tap_protocol::RandomChainCode();
     }
-    return tap_protocol::Hex2Bytes(cString);
+
+    // Invalid hex gives an empty chain code which tap_protocol rejects when the operation runs
+    const auto length = std::strlen(cString);
+    tap_protocol::Bytes chainCode(length / 2);
+    if (!decodeHex(cString, length, chainCode.data())) {
+        chainCode.clear();
+    }
+    return chainCode;
 }
 
 std::string makeCvc(const char* cString) {
@@ -3,12 +3,15 @@
 
 // Project
 #include <enums.h>
+#include <internal/metrics.h>
+#include <internal/secure_memory.h>
 #include <structs.h>
 
 // Third party
 #include <tap_protocol/cktapcard.h>
 
 // STL
+#include <chrono>
 #include <type_traits>
 
 template <typename T>
@@ -16,20 +19,33 @@ using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
 template <typename T>
 T* allocateCArray(const size_t length) {
+    trackAllocation();
     return static_cast<T*>(std::malloc(sizeof(T) * length));
 }
 
+CBinaryArray allocateCBinaryArray(const uint8_t* data, size_t length);
 CBinaryArray allocateCBinaryArrayFromJSON(const nlohmann::json::binary_t& binary);
 CKTapProtoException allocateCKTapProtoException(const tap_protocol::TapProtoException& e) noexcept;
 char* allocateCStringFromCpp(const std::string& cppString);
+/// Copies a null terminated string such as one of the registry's fixed buffers. Going through a std::string first
+/// would allocate once more for anything past the small string buffer, which idents and addresses are
+char* allocateCStringFromBuffer(const char* cString);
+
+/// Like their non-secure counterparts but the memory comes from the locked, zeroizing secure pool. Falls back
+/// to a regular allocation if the pool can't serve the request so the caller still receives their data, those are
+/// counted in securePoolFallbacks and zeroed by [freeCBinaryArray] and [freeSecureCString] like pool allocations
+CBinaryArray allocateSecureCBinaryArray(const uint8_t* data, size_t length);
+CBinaryArray allocateSecureCBinaryArrayFromJSON(const nlohmann::json::binary_t& binary);
+char* allocateSecureCString(const char* cString, size_t length);
 
-void fillConstructorParams(CKTapCardConstructorParams& params, size_t index, const tap_protocol::CKTapCard& card);
 void fillConstructorParams(SlotConstructorParams& params, int32_t handle, const tap_protocol::Satscard::Slot& slot);
 
 template <typename T>
 void freePointer(T*& pointer) {
     if (pointer != nullptr) {
-        std::free(pointer);
+        if (!freeSecure(pointer)) {
+            std::free(pointer);
+        }
         pointer = nullptr;
     }
 }
@@ -41,11 +57,18 @@ void freeCKTapProtoException(CKTapProtoException& exception);
 void freeSatscardConstructorParams(SatscardConstructorParams& params);
 void freeSatscardGetSlotResponse(SatscardSlotResponse& response);
 void freeSatscardListSlotsParams(SatscardListSlotsParams& params);
+void freeSatscardSyncParams(SatscardSyncParams& params);
+/// Frees a string from [allocateSecureCString], wiping it first if it had fallen back to the regular heap
+void freeSecureCString(char*& cString);
 void freeSlotConstructorParams(SlotConstructorParams& params);
 void freeSlotToWifResponse(SlotToWifResponse response);
 void freeTapsignerConstructorParams(TapsignerConstructorParams& params);
+void freeTapsignerSyncParams(TapsignerSyncParams& params);
+
+int64_t microsSince(std::chrono::steady_clock::time_point start) noexcept;
 
 tap_protocol::Bytes makeChainCode(const char* cString);
+/// Spend codes are six digits so the result always fits in the small string buffer and never allocates
 std::string makeCvc(const char* cString);
 CKTapCardHandle makeTapCardHandle(int32_t index, int32_t type);
 CKTapCardType makeTapCardType(const int32_t type);
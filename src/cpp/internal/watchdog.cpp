@@ -0,0 +1,117 @@
+#include <internal/watchdog.h>
+
+// Project
+#include <internal/context_services.h>
+#include <internal/metrics.h>
+#include <internal/tap_protocol_thread.h>
+
+// STL
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Checking several times per timeout means a stalled operation is cancelled at most a quarter late
+constexpr int watchdogChecksPerTimeout = 4;
+
+class Watchdog {
+public:
+
+    /// Wakes the thread to pick up a changed timeout straight away rather than after the previous interval, starting
+    /// it first if [isNeeded] and it isn't running yet
+    CKTapInterfaceErrorCode refresh(const bool isNeeded) noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (isNeeded && !_thread.joinable()) {
+            try {
+                _thread = std::thread{ [this] { _run(); } };
+            } catch (...) {
+                return CKTapInterfaceErrorCode::threadAllocationFailed;
+            }
+        }
+        _wake.notify_all();
+        return CKTapInterfaceErrorCode::success;
+    }
+
+    void watch(TapProtocolThread* thread) noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        try {
+            _threads.push_back(thread);
+        } catch (...) { }
+        _wake.notify_all();
+    }
+
+    /// Blocks whilst the watchdog is checking, so the thread can be destroyed as soon as this returns
+    void unwatch(TapProtocolThread* thread) noexcept {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _threads.erase(std::remove(_threads.begin(), _threads.end(), thread), _threads.end());
+    }
+
+private:
+
+    /// A quarter of the shortest timeout among the watched threads, zero when none of them has one
+    std::chrono::milliseconds _checkInterval() const noexcept {
+        std::chrono::milliseconds shortest{ 0 };
+        for (const auto* thread : _threads) {
+            const auto stallTimeout = thread->stallTimeout();
+            if (stallTimeout.count() > 0 && (shortest.count() == 0 || stallTimeout < shortest)) {
+                shortest = stallTimeout;
+            }
+        }
+        return shortest.count() > 0 ?
+            std::max(shortest / watchdogChecksPerTimeout, std::chrono::milliseconds{ 1 }) :
+            shortest;
+    }
+
+    /// Runs until the process exits, the watchdog is never destroyed
+    void _run() noexcept {
+        std::unique_lock<std::mutex> lock{ _mutex };
+        while (true) {
+            const auto interval = _checkInterval();
+            if (interval.count() == 0) {
+                _wake.wait(lock);
+                continue;
+            }
+            _wake.wait_for(lock, interval);
+
+            const auto now = std::chrono::steady_clock::now();
+            for (auto* thread : _threads) {
+                if (thread->cancelIfStalled(now)) {
+                    g_metrics.watchdogInterventions.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    std::mutex _mutex{ };
+    std::condition_variable _wake{ };
+    std::vector<TapProtocolThread*> _threads{ };
+    std::thread _thread{ };
+};
+
+/// Never destroyed, protocol threads owned by other globals unwatch themselves during static destruction
+static Watchdog& watchdog() noexcept {
+    static auto* instance = new Watchdog{ };
+    return *instance;
+}
+
+CKTapInterfaceErrorCode setWatchdogStallTimeout(ContextServices& services, const std::chrono::milliseconds stallTimeout) noexcept {
+    if (stallTimeout.count() < 0 || (stallTimeout.count() > 0 && stallTimeout < minimumWatchdogStallTimeout)) {
+        return CKTapInterfaceErrorCode::invalidOperationDeadline;
+    }
+
+    const auto previous = services.stallTimeout.exchange(stallTimeout.count());
+    const auto errorCode = watchdog().refresh(stallTimeout.count() > 0);
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        services.stallTimeout = previous;
+    }
+    return errorCode;
+}
+
+void watchProtocolThread(TapProtocolThread* thread) noexcept {
+    watchdog().watch(thread);
+}
+
+void unwatchProtocolThread(TapProtocolThread* thread) noexcept {
+    watchdog().unwatch(thread);
+}
@@ -0,0 +1,26 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_WATCHDOG_H__
+#define __CKTAP_PROTOCOL__INTERNAL_WATCHDOG_H__
+
+// Project
+#include <enums.h>
+
+// STL
+#include <chrono>
+
+class TapProtocolThread;
+struct ContextServices;
+
+/// Operations can't be stalled for less than this, it leaves room for a slow card to answer one message
+constexpr std::chrono::milliseconds minimumWatchdogStallTimeout{ 250 };
+
+/// Has the watchdog cancel any operation of the context owning [services] that has made no progress for
+/// [stallTimeout], each one it cancels fails with sessionStalled and is counted in the metrics. Zero leaves the
+/// context's operations alone, which is the default. One thread watches every context, it's started the first time
+/// any sets a timeout and then sleeps whenever none has one
+CKTapInterfaceErrorCode setWatchdogStallTimeout(ContextServices& services, std::chrono::milliseconds stallTimeout) noexcept;
+
+/// Every protocol thread is watched from creation until it's destroyed, see [TapProtocolThread::createNew]
+void watchProtocolThread(TapProtocolThread* thread) noexcept;
+void unwatchProtocolThread(TapProtocolThread* thread) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_WATCHDOG_H__
@@ -0,0 +1,113 @@
+#include <internal/wif_export.h>
+
+// Project
+#include <internal/globals.h>
+#include <internal/parallel.h>
+#include <internal/secure_memory.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+constexpr size_t minWifExportJobsPerThread = 64;
+
+struct WifExportJob {
+    const SlotTable* slots{ nullptr };
+    int32_t satscardHandle{ 0 };
+    int32_t slotIndex{ 0 };
+};
+
+static void appendUnsealedSlots(std::vector<WifExportJob>& jobs, const int32_t handle) {
+    const auto& slots = currentContext().satscards[static_cast<size_t>(handle)].slots;
+    for (int32_t index{ 0 }; index < static_cast<int32_t>(maxSatscardSlots); ++index) {
+        if (slots.isUnsealed(index)) {
+            jobs.push_back(WifExportJob{ &slots, handle, index });
+        }
+    }
+}
+
+static CKTapInterfaceErrorCode collectWifExportJobs(const int32_t* handles, const int32_t count, std::vector<WifExportJob>& jobs) {
+    const auto& satscards = currentContext().satscards;
+    if (handles == nullptr) {
+        for (size_t handle{ 0 }; handle < satscards.size(); ++handle) {
+            appendUnsealedSlots(jobs, static_cast<int32_t>(handle));
+        }
+        return CKTapInterfaceErrorCode::success;
+    }
+
+    if (count < 0) {
+        return CKTapInterfaceErrorCode::invalidBatchArguments;
+    }
+    for (int32_t i{ 0 }; i < count; ++i) {
+        if (handles[i] < 0 || static_cast<size_t>(handles[i]) >= satscards.size()) {
+            return CKTapInterfaceErrorCode::unknownSatscardHandle;
+        }
+        appendUnsealedSlots(jobs, handles[i]);
+    }
+    return CKTapInterfaceErrorCode::success;
+}
+
+static void convertWifExportJobs(const std::vector<WifExportJob>& jobs, SlotWifEntry* entries, char* buffer,
+                                 const size_t begin, const size_t end) noexcept {
+    for (auto i = begin; i < end; ++i) {
+        const auto& job = jobs[i];
+        auto& entry = entries[i];
+        entry.satscardHandle = job.satscardHandle;
+        entry.slotIndex = job.slotIndex;
+        entry.wif = nullptr;
+
+        auto* output = buffer + i * wifExportStride;
+        try {
+            if (job.slots->writeWif(job.slotIndex, output, wifExportStride) != 0) {
+                entry.wif = output;
+            }
+        } catch (...) { }
+    }
+}
+
+SatscardWifBatch exportSatscardWifs(const int32_t* handles, const int32_t count) noexcept {
+    SatscardWifBatch batch;
+    std::memset(&batch, 0, sizeof(batch));
+
+    std::vector<WifExportJob> jobs{ };
+    try {
+        batch.status.errorCode = collectWifExportJobs(handles, count, jobs);
+    } catch (...) {
+        batch.status.errorCode = CKTapInterfaceErrorCode::unexpectedStdException;
+    }
+    if (batch.status.errorCode != CKTapInterfaceErrorCode::success || jobs.empty()) {
+        return batch;
+    }
+
+    auto* buffer = static_cast<char*>(allocateSecureBuffer(jobs.size() * wifExportStride));
+    batch.array = allocateCArray<SlotWifEntry>(jobs.size());
+    if (buffer == nullptr || batch.array == nullptr) {
+        freeSecureBuffer(buffer);
+        freePointer(batch.array);
+        batch.status.errorCode = CKTapInterfaceErrorCode::unknownErrorDuringTapProtocolFunction;
+        return batch;
+    }
+    batch.buffer = buffer;
+    batch.length = static_cast<int32_t>(jobs.size());
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto threadCount = runInParallel(jobs.size(), minWifExportJobsPerThread, [&](const size_t begin, const size_t end) {
+        convertWifExportJobs(jobs, batch.array, buffer, begin, end);
+    });
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    batch.elapsedMicros = static_cast<int64_t>(elapsed.count());
+    batch.slotsPerSecond = static_cast<int64_t>(jobs.size()) * 1000000 / std::max<int64_t>(batch.elapsedMicros, 1);
+    batch.workerCount = static_cast<int32_t>(threadCount);
+    return batch;
+}
+
+void freeSatscardWifBatch(SatscardWifBatch& batch) noexcept {
+    freeCKTapInterfaceStatus(batch.status);
+    freeSecureBuffer(batch.buffer);
+    batch.buffer = nullptr;
+    freePointer(batch.array);
+    batch.length = 0;
+}
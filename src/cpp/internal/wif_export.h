@@ -0,0 +1,22 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_WIF_EXPORT_H__
+#define __CKTAP_PROTOCOL__INTERNAL_WIF_EXPORT_H__
+
+// Project
+#include <internal/slot_table.h>
+#include <structs.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+
+/// Space reserved for each WIF in the batch buffer
+constexpr size_t wifExportStride = maxWifBufferSize;
+
+/// Converts every unsealed slot of the given satscards into a WIF, or of every registered satscard when
+/// [handles] is null. Conversion is spread across worker threads and the caller's thread, each one
+/// writing straight into its own entries of a single locked buffer so no WIF ever lives on the regular heap
+SatscardWifBatch exportSatscardWifs(const int32_t* handles, int32_t count) noexcept;
+
+void freeSatscardWifBatch(SatscardWifBatch& batch) noexcept;
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_WIF_EXPORT_H__
@@ -0,0 +1,209 @@
+#include <internal/worker_scheduling.h>
+
+// Project
+#include <internal/metrics.h>
+
+// libc
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #if defined(__linux__)
+        #include <sys/resource.h>
+        #include <sys/syscall.h>
+        #include <unistd.h>
+    #endif
+#endif
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <thread>
+
+constexpr int32_t minimumNiceValue = -20;
+constexpr int32_t maximumNiceValue = 19;
+constexpr int32_t maximumRealtimePriority = 99;
+
+/// Bumped by every change to any context's options, each takes the new value as its generation
+static std::atomic<uint64_t> g_workerSchedulingGenerations{ 0 };
+/// The generation of the options the calling thread last applied, whichever context they came from
+static thread_local uint64_t t_appliedWorkerSchedulingGeneration{ 0 };
+
+static bool isValidWorkerScheduling(const CKTapWorkerSchedulingOptions& options) noexcept {
+    return options.niceValue >= minimumNiceValue &&
+           options.niceValue <= maximumNiceValue &&
+           (options.useRealtimeScheduling == 0 || options.useRealtimeScheduling == 1) &&
+           options.realtimePriority >= 0 &&
+           options.realtimePriority <= maximumRealtimePriority;
+}
+
+#if defined(__linux__)
+/// The CPUs the process could use before any options were set, which a zero mask restores
+static cpu_set_t g_defaultAffinity{ };
+static std::once_flag g_defaultAffinityCaptured{ };
+
+static void captureDefaultAffinity() noexcept {
+    std::call_once(g_defaultAffinityCaptured, [] {
+        if (sched_getaffinity(getpid(), sizeof(g_defaultAffinity), &g_defaultAffinity) != 0) {
+            CPU_ZERO(&g_defaultAffinity);
+            for (int cpu{ 0 }; cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &g_defaultAffinity);
+            }
+        }
+    });
+}
+
+/// Every setting is applied whether or not it's the default, a worker lives across changes and contexts so it may
+/// be undoing other options
+static CKTapInterfaceErrorCode applyToThisThread(const CKTapWorkerSchedulingOptions& options, bool& isRealtimeRefused) noexcept {
+    cpu_set_t cpus{ g_defaultAffinity };
+    if (options.cpuAffinityMask != 0) {
+        CPU_ZERO(&cpus);
+        for (int cpu{ 0 }; cpu < 64; ++cpu) {
+            if ((options.cpuAffinityMask >> cpu) & 1) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+    }
+    // Zero is the calling thread rather than the process
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        return errno == EINVAL ?
+            CKTapInterfaceErrorCode::invalidWorkerSchedulingOptions :
+            CKTapInterfaceErrorCode::workerSchedulingNotPermitted;
+    }
+
+    sched_param parameters{ };
+    if (options.useRealtimeScheduling != 0) {
+        parameters.sched_priority = std::max(options.realtimePriority, sched_get_priority_min(SCHED_FIFO));
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0) {
+            return CKTapInterfaceErrorCode::success;
+        }
+        isRealtimeRefused = true;
+    }
+
+    parameters.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &parameters);
+    // Linux keeps a nice value per thread, which is what PRIO_PROCESS changes when given a thread id
+    const auto threadId = static_cast<id_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, threadId, options.niceValue) == 0 ?
+        CKTapInterfaceErrorCode::success :
+        CKTapInterfaceErrorCode::workerSchedulingNotPermitted;
+}
+#elif defined(_WIN32)
+/// Windows has no nice values, they're mapped onto the nearest of its relative thread priorities
+static int threadPriorityForNiceValue(const int32_t niceValue) noexcept {
+    if (niceValue <= -10) {
+        return THREAD_PRIORITY_HIGHEST;
+    } else if (niceValue < 0) {
+        return THREAD_PRIORITY_ABOVE_NORMAL;
+    } else if (niceValue == 0) {
+        return THREAD_PRIORITY_NORMAL;
+    } else if (niceValue < 10) {
+        return THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    return THREAD_PRIORITY_LOWEST;
+}
+
+static CKTapInterfaceErrorCode applyToThisThread(const CKTapWorkerSchedulingOptions& options, bool& isRealtimeRefused) noexcept {
+    DWORD_PTR processAffinity{ 0 };
+    DWORD_PTR systemAffinity{ 0 };
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processAffinity, &systemAffinity)) {
+        return CKTapInterfaceErrorCode::workerSchedulingNotPermitted;
+    }
+    const auto affinity = options.cpuAffinityMask != 0 ?
+        static_cast<DWORD_PTR>(options.cpuAffinityMask) & processAffinity :
+        processAffinity;
+    if (affinity == 0) {
+        return CKTapInterfaceErrorCode::invalidWorkerSchedulingOptions;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), affinity) == 0) {
+        return CKTapInterfaceErrorCode::workerSchedulingNotPermitted;
+    }
+
+    // The closest to SCHED_FIFO which doesn't move the whole process into the realtime priority class
+    if (options.useRealtimeScheduling != 0) {
+        if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            return CKTapInterfaceErrorCode::success;
+        }
+        isRealtimeRefused = true;
+    }
+    return SetThreadPriority(GetCurrentThread(), threadPriorityForNiceValue(options.niceValue)) ?
+        CKTapInterfaceErrorCode::success :
+        CKTapInterfaceErrorCode::workerSchedulingNotPermitted;
+}
+#else
+/// Other platforms such as Apple's have neither per-thread nice values nor hard affinity, only the policy can change
+static CKTapInterfaceErrorCode applyToThisThread(const CKTapWorkerSchedulingOptions& options, bool& isRealtimeRefused) noexcept {
+    if (options.niceValue != 0 || options.cpuAffinityMask != 0) {
+        return CKTapInterfaceErrorCode::workerSchedulingNotSupported;
+    }
+
+    sched_param parameters{ };
+    if (options.useRealtimeScheduling != 0) {
+        parameters.sched_priority = std::max(options.realtimePriority, sched_get_priority_min(SCHED_FIFO));
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0) {
+            return CKTapInterfaceErrorCode::success;
+        }
+        isRealtimeRefused = true;
+    }
+
+    parameters.sched_priority = sched_get_priority_min(SCHED_OTHER);
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &parameters);
+    return CKTapInterfaceErrorCode::success;
+}
+#endif
+
+CKTapInterfaceErrorCode WorkerScheduling::setOptions(const CKTapWorkerSchedulingOptions& options) noexcept {
+    if (!isValidWorkerScheduling(options)) {
+        return CKTapInterfaceErrorCode::invalidWorkerSchedulingOptions;
+    }
+#if defined(__linux__)
+    try {
+        captureDefaultAffinity();
+    } catch (...) {
+        return CKTapInterfaceErrorCode::unexpectedStdException;
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    auto errorCode{ CKTapInterfaceErrorCode::success };
+    bool isRealtimeRefused{ false };
+    try {
+        std::thread probe{ [&] { errorCode = applyToThisThread(options, isRealtimeRefused); } };
+        probe.join();
+    } catch (...) {
+        return CKTapInterfaceErrorCode::threadAllocationFailed;
+    }
+    if (errorCode != CKTapInterfaceErrorCode::success) {
+        return errorCode;
+    }
+
+    _options = options;
+    _generation = g_workerSchedulingGenerations.fetch_add(1) + 1;
+    return isRealtimeRefused ?
+        CKTapInterfaceErrorCode::workerSchedulingNotPermitted :
+        CKTapInterfaceErrorCode::success;
+}
+
+void WorkerScheduling::apply() const noexcept {
+    // A context which never set any options still has to undo those another context's operation left behind
+    if (_generation.load(std::memory_order_acquire) == t_appliedWorkerSchedulingGeneration) {
+        return;
+    }
+
+    CKTapWorkerSchedulingOptions options{ };
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        options = _options;
+        t_appliedWorkerSchedulingGeneration = _generation.load();
+    }
+
+    bool isRealtimeRefused{ false };
+    const auto errorCode = applyToThisThread(options, isRealtimeRefused);
+    if (errorCode != CKTapInterfaceErrorCode::success || isRealtimeRefused) {
+        g_metrics.workerSchedulingFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef __CKTAP_PROTOCOL__INTERNAL_WORKER_SCHEDULING_H__
+#define __CKTAP_PROTOCOL__INTERNAL_WORKER_SCHEDULING_H__
+
+// Project
+#include <enums.h>
+#include <structs.h>
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/// The scheduling a context's session workers apply to themselves, which is the protocol thread of each of its
+/// operations and the thread of each PC/SC reader started from it
+class WorkerScheduling {
+public:
+
+    /// The options are tried on a short-lived thread first so a refusal is reported here, the caller's own thread
+    /// is never changed. Fails without changing anything when the nice value or the affinity is refused, but when
+    /// only SCHED_FIFO is refused the options are kept with the workers falling back to the nice value, and
+    /// workerSchedulingNotPermitted is returned
+    CKTapInterfaceErrorCode setOptions(const CKTapWorkerSchedulingOptions& options) noexcept;
+
+    /// Applies the options to the calling thread unless it was the last to, which is a single atomic load. A worker
+    /// shared between contexts, such as one of the session pool's, reapplies them whenever it switches context.
+    /// Failures are counted in the metrics rather than stopping the worker
+    void apply() const noexcept;
+
+private:
+
+    mutable std::mutex _mutex{ };
+    CKTapWorkerSchedulingOptions _options{ };
+    /// Unique across every context so a thread can tell which options it last applied, zero until the first change
+    /// so workers skip straight past when nothing was configured
+    std::atomic<uint64_t> _generation{ 0 };
+};
+
+#endif // __CKTAP_PROTOCOL__INTERNAL_WORKER_SCHEDULING_H__
@@ -8,6 +8,10 @@
 // libc
 #include <stdint.h>
 
+/// An engine context, opaque to Dart. Each isolate creates its own with Core_createContext so its sessions and card
+/// registry are never seen by another
+FFI_TYPE_EXPORT typedef struct CKTapContext CKTapContext;
+
 FFI_TYPE_EXPORT typedef struct {
     uint8_t* ptr;
     int32_t length;
@@ -34,6 +38,64 @@ FFI_TYPE_EXPORT typedef struct {
     CKTapProtoException exception;
 } CKTapInterfaceStatus;
 
+/// A card which changed after the version given to Core_getChangedCardsSince
+FFI_TYPE_EXPORT typedef struct {
+    CKTapCardHandle handle;
+    /// Bitwise OR of every CKTapCardChange which applies
+    int32_t changes;
+} CKTapCardChangeEntry;
+
+FFI_TYPE_EXPORT typedef struct {
+    CKTapInterfaceStatus status;
+    /// Pass this to the next call to only receive newer changes
+    int64_t version;
+    CKTapCardChangeEntry* array;
+    int32_t length;
+} CKTapChangedCards;
+
+/// Performance counters gathered by the native library. The operation, round trip, cancellation and audit log fields
+/// belong to the context passed to Core_getMetrics, the rest are totals across the process
+FFI_TYPE_EXPORT typedef struct {
+    /// Allocation counts are only gathered when built with CKTAP_TRACK_ALLOCATIONS
+    int8_t isAllocationTrackingEnabled;
+    int64_t totalAllocations;
+    /// Allocations made since the context's most recent call to Core_newOperation, including those of other threads
+    int64_t operationAllocations;
+    /// Thread state changes rejected by the transition table
+    int64_t illegalStateTransitions;
+    /// Thread state changes which had to be retried because the other thread changed the state first
+    int64_t contendedStateTransitions;
+    /// Time between the most recent transport request and its response
+    int64_t lastRoundTripMicros;
+    /// The per-message timeout most recently applied, changes over time when adaptive
+    int64_t transportTimeoutMicros;
+    /// Time between a cancellation request and the protocol thread stopping
+    int64_t lastCancellationLatencyMicros;
+    int64_t maxCancellationLatencyMicros;
+    /// Memory locked into RAM by the secure pool which holds private keys and WIFs
+    int64_t securePoolBytesLocked;
+    /// Secrets which the secure pool couldn't hold and were copied to the regular heap instead. They're still
+    /// zeroed when freed but may be swapped to disk, so this should stay at zero
+    int64_t securePoolFallbacks;
+    /// Operations recorded in the context's audit log, and those which were lost because it was full
+    int64_t auditRecordsWritten;
+    int64_t auditRecordsDropped;
+    /// Operations the watchdog cancelled because they stopped making progress, see Core_setWatchdogOptions
+    int64_t watchdogInterventions;
+    /// Spread of the transport round trips, the jitter is their standard deviation
+    int64_t roundTripSamples;
+    int64_t meanRoundTripMicros;
+    int64_t roundTripJitterMicros;
+    int64_t maxRoundTripMicros;
+    /// Time between the host delivering a transport response and the protocol thread waking to process it, one sample
+    /// per round trip. Shows how long the worker waits for a CPU, see Core_setWorkerSchedulingOptions
+    int64_t meanWakeLatencyMicros;
+    int64_t wakeLatencyJitterMicros;
+    int64_t maxWakeLatencyMicros;
+    /// Times a worker thread couldn't be given the requested scheduling, including SCHED_FIFO falling back to nice
+    int64_t workerSchedulingFailures;
+} CKTapMetrics;
+
 FFI_TYPE_EXPORT typedef struct {
     int32_t handle;
     int32_t type;
@@ -71,6 +133,40 @@ FFI_TYPE_EXPORT typedef struct {
     char* wif;
 } SlotToWifResponse;
 
+FFI_TYPE_EXPORT typedef struct {
+    CKTapInterfaceStatus status;
+    /// Bit `handle * slotsPerCard + slotIndex`, least significant bit first, is set when that slot's address
+    /// matches the one derived from its public key
+    CBinaryArray passed;
+    /// Same layout as `passed`, set for every stored slot which was checked
+    CBinaryArray checked;
+    int32_t slotsPerCard;
+    int32_t checkedCount;
+    int32_t failedCount;
+    /// Whether SHA-256 ran on the CPU's SHA extensions
+    int8_t isHardwareHashingEnabled;
+    int64_t elapsedMicros;
+} SlotAddressVerification;
+
+/// One slot converted by Satscard_exportWifsBatch
+FFI_TYPE_EXPORT typedef struct {
+    int32_t satscardHandle;
+    int32_t slotIndex;
+    /// Points into the batch's locked buffer, null if this slot couldn't be converted
+    char* wif;
+} SlotWifEntry;
+
+FFI_TYPE_EXPORT typedef struct {
+    CKTapInterfaceStatus status;
+    SlotWifEntry* array;
+    int32_t length;
+    /// Holds every WIF in the batch, locked into RAM and zeroed when the batch is freed
+    char* buffer;
+    int32_t workerCount;
+    int64_t elapsedMicros;
+    int64_t slotsPerSecond;
+} SatscardWifBatch;
+
 FFI_TYPE_EXPORT typedef struct {
     CKTapInterfaceStatus status;
     CKTapCardConstructorParams base;
@@ -124,4 +220,91 @@ FFI_TYPE_EXPORT typedef struct {
     int32_t authDelay;
 } WaitResponseParams;
 
+/// Returned by Core_enqueuePipelinedCard, the ticket identifies the card in Core_pollPipelinedCards
+FFI_TYPE_EXPORT typedef struct {
+    int64_t ticket;
+    CKTapInterfaceErrorCode errorCode;
+} CKTapPipelineTicket;
+
+/// A card which finished post-processing and was added to the registry
+FFI_TYPE_EXPORT typedef struct {
+    int64_t ticket;
+    CKTapOperationResponse response;
+    /// Set when the satscard's active slot had a public key, `isActiveSlotVerified` is then whether its address
+    /// matched the one derived from that key
+    int8_t isActiveSlotChecked;
+    int8_t isActiveSlotVerified;
+    /// Only the params matching `response.handle.type` are filled
+    SatscardConstructorParams satscard;
+    TapsignerConstructorParams tapsigner;
+    /// Time spent on the worker, from submission until the card was ready to register
+    int64_t processingMicros;
+} CKTapPipelinedCard;
+
+FFI_TYPE_EXPORT typedef struct {
+    CKTapInterfaceStatus status;
+    CKTapPipelinedCard* array;
+    int32_t length;
+    /// Cards which are still being processed, poll again to receive them
+    int32_t pendingCount;
+} CKTapPipelinedCards;
+
+/// One PC/SC reader driven by its own native worker, see Reader_startAll
+FFI_TYPE_EXPORT typedef struct {
+    char* name;
+    int8_t isRunning;
+    /// Handshakes whose card was handed to the pipeline
+    int64_t completedSessions;
+    int64_t failedSessions;
+    /// The error of the most recent failed session
+    CKTapInterfaceErrorCode lastError;
+    int64_t averageSessionMicros;
+} CKTapReaderStats;
+
+FFI_TYPE_EXPORT typedef struct {
+    CKTapInterfaceStatus status;
+    CKTapReaderStats* array;
+    int32_t length;
+    /// Time since the readers were started
+    int64_t elapsedMicros;
+    /// Completed sessions per minute across every reader
+    int64_t cardsPerMinute;
+} CKTapReaderStatsList;
+
+/// Passed to Core_prewarm, a zero count reserves nothing and a null path skips the card cache
+FFI_TYPE_EXPORT typedef struct {
+    /// How many cards the registry should have room for without growing
+    int32_t expectedSatscards;
+    int32_t expectedTapsigners;
+    /// A cache written by Core_saveCardCache, a missing file isn't an error
+    const char* cardCachePath;
+} CKTapPrewarmOptions;
+
+/// Passed to Core_setWorkerSchedulingOptions, zeroing every field restores the default scheduling
+FFI_TYPE_EXPORT typedef struct {
+    /// From -20 to 19, lower runs sooner. Going below 0 usually needs CAP_SYS_NICE or a raised RLIMIT_NICE
+    int32_t niceValue;
+    /// Runs the workers with SCHED_FIFO at [realtimePriority], they fall back to [niceValue] where it isn't permitted
+    int8_t useRealtimeScheduling;
+    /// From 1 to 99, 0 uses the lowest
+    int32_t realtimePriority;
+    /// Bit n allows the workers to run on CPU n, 0 allows every CPU the process may use
+    uint64_t cpuAffinityMask;
+} CKTapWorkerSchedulingOptions;
+
+/// How long each part of Core_prewarm took, in microseconds
+FFI_TYPE_EXPORT typedef struct {
+    /// Pending whilst the prewarm is still running
+    CKTapInterfaceErrorCode errorCode;
+    int64_t elapsedMicros;
+    int64_t threadMicros;
+    int64_t cryptoMicros;
+    int64_t secureMemoryMicros;
+    /// Reading the card cache and registering its cards
+    int64_t cardCacheMicros;
+    /// Cards added from the cache, cards which were already registered aren't counted
+    int32_t cachedSatscards;
+    int32_t cachedTapsigners;
+} CKTapPrewarmReport;
+
 #endif // __CKTAP_PROTOCOL__STRUCTS_H__
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Project
+#include <tests/test_support.h>
+
+// STL
+#include <functional>
+
+/// Holds each export to the number of heap allocations it may make on the caller's thread, so a change which adds
+/// allocations to a hot path fails here instead of going unnoticed. Allocations made by the protocol thread and by
+/// tap_protocol on it aren't counted. Every export is run once beforehand so one-off setup isn't charged to it
+
+struct AllocationBudget {
+    const char* name;
+    int64_t maxAllocations;
+    std::function<void()> call;
+};
+
+/// Counts the allocations [call] makes on this thread
+static int64_t countCallerAllocations(const std::function<void()>& call) {
+    const auto before = threadAllocationCount();
+    call();
+    return threadAllocationCount() - before;
+}
+
+struct alignas(64) OverAlignedAllocation {
+    uint8_t bytes[64];
+};
+
+int main() {
+    // Over-aligned types go through the align_val_t overloads, which have to be counted like any other
+    const auto alignedBefore = threadAllocationCount();
+    auto* aligned = new OverAlignedAllocation{ };
+    CKTAP_EXPECT(reinterpret_cast<uintptr_t>(aligned) % alignof(OverAlignedAllocation) == 0);
+    delete aligned;
+    CKTAP_EXPECT(threadAllocationCount() - alignedBefore == 1);
+
+    auto* context = Core_createContext();
+    CKTAP_EXPECT(context != nullptr);
+    CKTAP_EXPECT(Core_getMetrics(context).isAllocationTrackingEnabled == 1);
+    const auto reply = makeScriptedSatscardReply();
+    const auto card = registerScriptedSatscard(context, reply);
+    CKTAP_EXPECT(card.index >= 0);
+
+    const std::vector<AllocationBudget> budgets{
+        // Starting an operation allocates its future's shared state and the thread running it
+        { "Core_beginAsyncHandshake", 3, [&] {
+            Core_newOperation(context);
+            Core_beginAsyncHandshake(context, CKTapCardType::satscard);
+        } },
+        { "transport exports, handshake", 0, [&] { runScriptedOperation(context, reply); } },
+        // The card is already registered, only the shared ownership of its live object is allocated
+        { "Core_endOperation", 1, [&] { Core_endOperation(context); } },
+        { "CKTapCard_beginWait", 3, [&] {
+            Core_newOperation(context);
+            Core_prepareCardOperation(context, card.index, card.type);
+            CKTapCard_beginWait(context);
+        } },
+        { "Core_getThreadState", 0, [&] { Core_getThreadState(context); } },
+        { "transport exports, wait", 0, [&] { runScriptedOperation(context, reply); } },
+        { "CKTapCard_getWaitResponse", 0, [&] { Utility_freeCKTapInterfaceStatus(CKTapCard_getWaitResponse(context).status); } },
+        { "Core_getMetrics", 0, [&] { Core_getMetrics(context); } },
+        { "Satscard_createSyncParams", 0, [&] { Utility_freeSatscardSyncParams(Satscard_createSyncParams(context, card.index)); } },
+        // The ident and applet version strings
+        { "Satscard_createConstructorParams", 2, [&] {
+            Utility_freeSatscardConstructorParams(Satscard_createConstructorParams(context, card.index));
+        } },
+        // The array of changed cards
+        { "Core_getChangedCardsSince", 1, [&] {
+            Utility_freeCKTapChangedCards(Core_getChangedCardsSince(context, 0));
+        } },
+    };
+
+    for (int pass{ 0 }; pass < 2; ++pass) {
+        for (const auto& budget : budgets) {
+            const auto allocations = countCallerAllocations(budget.call);
+            if (pass == 0) {
+                continue;
+            }
+            std::printf("%s: %lld allocations, budget %lld\n", budget.name, static_cast<long long>(allocations),
+                        static_cast<long long>(budget.maxAllocations));
+            if (allocations > budget.maxAllocations) {
+                ++g_testFailures;
+            }
+        }
+    }
+
+    Core_destroyContext(context);
+    return finishTest("allocation_budgets");
+}
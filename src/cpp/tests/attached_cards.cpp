@@ -0,0 +1,88 @@
+// Project
+#include <tests/test_support.h>
+
+/// Alternates Waits between two scripted satscards and counts the round trips each one takes. Within the attached
+/// card limit going back to a card needs no handshake, so alternating costs as many round trips as staying on one
+/// card. With a limit of one, or none, the card has to be reattached first
+
+constexpr int64_t attachedCardWaits = 200;
+
+struct ScriptedCard {
+    CKTapCardHandle handle{ -1, CKTapCardType::unknownCard };
+    std::vector<uint8_t> reply{ };
+};
+
+/// Like runScriptedOperation, returning the number of requests answered or -1 if the operation failed
+static int64_t countRoundTrips(CKTapContext* context, const std::vector<uint8_t>& reply) {
+    int64_t roundTrips{ 0 };
+    const auto deadline = std::chrono::steady_clock::now() + testOperationTimeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto state = Core_getThreadState(context);
+        if (state >= CKTapThreadState::finished) {
+            return Core_finalizeAsyncAction(context) == CKTapInterfaceErrorCode::success ? roundTrips : -1;
+        }
+        if (state == CKTapThreadState::transportRequestReady && answerTransportRequest(context, reply)) {
+            ++roundTrips;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    cancelScriptedOperation(context);
+    return -1;
+}
+
+/// Runs [attachedCardWaits] Waits, switching to the other card every time when [alternate] is set, and returns
+/// the round trips they took between them
+static int64_t countWaitRoundTrips(CKTapContext* context, const ScriptedCard (&cards)[2], const bool alternate) {
+    int64_t roundTrips{ 0 };
+    for (int64_t i{ 0 }; i < attachedCardWaits; ++i) {
+        const auto& card = cards[alternate ? i % 2 : 0];
+        CKTAP_EXPECT(Core_newOperation(context) == CKTapInterfaceErrorCode::success);
+        CKTAP_EXPECT(Core_prepareCardOperation(context, card.handle.index, card.handle.type) == CKTapInterfaceErrorCode::success);
+        CKTAP_EXPECT(CKTapCard_beginWait(context) == CKTapInterfaceErrorCode::success);
+
+        const auto operationRoundTrips = countRoundTrips(context, card.reply);
+        CKTAP_EXPECT(operationRoundTrips > 0);
+        roundTrips += operationRoundTrips;
+        Utility_freeCKTapInterfaceStatus(CKTapCard_getWaitResponse(context).status);
+    }
+    return roundTrips;
+}
+
+int main() {
+    auto* context = Core_createContext();
+    ScriptedCard cards[2]{ };
+    for (uint32_t i{ 0 }; i < 2; ++i) {
+        cards[i].reply = makeScriptedSatscardReply(i);
+        cards[i].handle = registerScriptedSatscard(context, cards[i].reply);
+        CKTAP_EXPECT(cards[i].handle.index >= 0);
+    }
+    if (cards[0].handle.index < 0 || cards[1].handle.index < 0) {
+        Core_destroyContext(context);
+        return finishTest("attached_cards");
+    }
+
+    // Both cards stay attached by default
+    const auto sameCardRoundTrips = countWaitRoundTrips(context, cards, false);
+    const auto alternatingRoundTrips = countWaitRoundTrips(context, cards, true);
+    std::printf("%lld Waits: %lld round trips on one card, %lld alternating\n", static_cast<long long>(attachedCardWaits),
+                static_cast<long long>(sameCardRoundTrips), static_cast<long long>(alternatingRoundTrips));
+    CKTAP_EXPECT(alternatingRoundTrips == sameCardRoundTrips);
+
+    // With room for one card each switch reattaches the other. Staying on one card only reattaches it once, as the
+    // alternating Waits ended on the other one
+    CKTAP_EXPECT(Core_setAttachedCardLimit(context, 1) == CKTapInterfaceErrorCode::success);
+    const auto singleCardRoundTrips = countWaitRoundTrips(context, cards, true);
+    std::printf("with one attached card: %lld alternating\n", static_cast<long long>(singleCardRoundTrips));
+    CKTAP_EXPECT(singleCardRoundTrips > alternatingRoundTrips);
+    const auto reattachRoundTrips = (singleCardRoundTrips - alternatingRoundTrips) / attachedCardWaits;
+    CKTAP_EXPECT(countWaitRoundTrips(context, cards, false) == sameCardRoundTrips + reattachRoundTrips);
+
+    // Without any every operation reattaches its card
+    CKTAP_EXPECT(Core_setAttachedCardLimit(context, 0) == CKTapInterfaceErrorCode::success);
+    CKTAP_EXPECT(countWaitRoundTrips(context, cards, false) == singleCardRoundTrips);
+
+    CKTAP_EXPECT(Core_setAttachedCardLimit(context, -1) == CKTapInterfaceErrorCode::invalidAttachedCardLimit);
+    Core_destroyContext(context);
+    return finishTest("attached_cards");
+}
@@ -0,0 +1,121 @@
+// Project
+#include <tests/test_support.h>
+
+// STL
+#include <cstdio>
+#include <thread>
+
+/// Runs two contexts side by side and checks neither sees the other's settings: each keeps its own transport
+/// timeout, audit log and watchdog timeout. Then destroys contexts with an operation still waiting on the host, on
+/// the thread that started it and from another one the way the Dart finalizer does, and checks null is refused by
+/// every kind of export rather than falling back to a shared context
+
+constexpr int32_t firstTransportTimeoutMs = 5000;
+constexpr int32_t secondTransportTimeoutMs = 7000;
+constexpr int32_t lifecycleStallTimeoutMs = 250;
+constexpr const char* lifecycleAuditLogPath = "cktap_test_context_audit.log";
+
+/// Starts a Wait on [card] which is left for the caller to answer, cancel or abandon
+static bool beginScriptedWait(CKTapContext* context, const CKTapCardHandle card) {
+    return Core_newOperation(context) == CKTapInterfaceErrorCode::success &&
+           Core_prepareCardOperation(context, card.index, card.type) == CKTapInterfaceErrorCode::success &&
+           CKTapCard_beginWait(context) == CKTapInterfaceErrorCode::success;
+}
+
+static CKTapInterfaceErrorCode runScriptedWait(CKTapContext* context, const CKTapCardHandle card,
+                                               const std::vector<uint8_t>& reply) {
+    if (!beginScriptedWait(context, card)) {
+        return CKTapInterfaceErrorCode::unknownErrorDuringAsyncOperation;
+    }
+    const auto errorCode = runScriptedOperation(context, reply);
+    Utility_freeCKTapInterfaceStatus(CKTapCard_getWaitResponse(context).status);
+    return errorCode;
+}
+
+/// Leaves a Wait unanswered on both contexts and checks only the one with a stall timeout is cancelled
+static void checkSeparateWatchdogTimeouts(CKTapContext* watched, const CKTapCardHandle watchedCard,
+                                          CKTapContext* unwatched, const CKTapCardHandle unwatchedCard,
+                                          const std::vector<uint8_t>& reply) {
+    CKTAP_EXPECT(Core_setWatchdogOptions(watched, lifecycleStallTimeoutMs) == CKTapInterfaceErrorCode::success);
+    CKTAP_EXPECT(beginScriptedWait(watched, watchedCard));
+    CKTAP_EXPECT(beginScriptedWait(unwatched, unwatchedCard));
+
+    const auto deadline = std::chrono::steady_clock::now() + testOperationTimeout;
+    while (Core_getThreadState(watched) < CKTapThreadState::finished && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    }
+    CKTAP_EXPECT(Core_finalizeAsyncAction(watched) == CKTapInterfaceErrorCode::sessionStalled);
+    Utility_freeCKTapInterfaceStatus(CKTapCard_getWaitResponse(watched).status);
+    CKTAP_EXPECT(Core_getMetrics(watched).watchdogInterventions == 1);
+
+    // By now the other Wait has been waiting well past the stall timeout, it must still complete
+    CKTAP_EXPECT(Core_getThreadState(unwatched) == CKTapThreadState::transportRequestReady);
+    CKTAP_EXPECT(runScriptedOperation(unwatched, reply) == CKTapInterfaceErrorCode::success);
+    Utility_freeCKTapInterfaceStatus(CKTapCard_getWaitResponse(unwatched).status);
+    CKTAP_EXPECT(Core_setWatchdogOptions(watched, 0) == CKTapInterfaceErrorCode::success);
+}
+
+/// Null used to be bound to the default context, so two isolates passing it shared one engine
+static void checkNullContextRejected() {
+    CKTAP_EXPECT(Core_newOperation(nullptr) == CKTapInterfaceErrorCode::invalidContext);
+    CKTAP_EXPECT(Core_setWatchdogOptions(nullptr, lifecycleStallTimeoutMs) == CKTapInterfaceErrorCode::invalidContext);
+    CKTAP_EXPECT(Core_openAuditLog(nullptr, lifecycleAuditLogPath, 0) == CKTapInterfaceErrorCode::invalidContext);
+    CKTAP_EXPECT(Core_getThreadState(nullptr) == CKTapThreadState::notStarted);
+    CKTAP_EXPECT(Core_getTransportRequestPointer(nullptr) == nullptr);
+    CKTAP_EXPECT(Core_endOperation(nullptr).errorCode == CKTapInterfaceErrorCode::invalidContext);
+    CKTAP_EXPECT(CKTapCard_getWaitResponse(nullptr).status.errorCode == CKTapInterfaceErrorCode::invalidContext);
+    CKTAP_EXPECT(Core_getMetrics(nullptr).transportTimeoutMicros == 0);
+    Core_destroyContext(nullptr);
+}
+
+int main() {
+    checkNullContextRejected();
+
+    auto* first = Core_createContext();
+    auto* second = Core_createContext();
+    CKTAP_EXPECT(first != nullptr && second != nullptr);
+    const auto reply = makeScriptedSatscardReply();
+    const auto firstCard = registerScriptedSatscard(first, reply);
+    const auto secondCard = registerScriptedSatscard(second, reply);
+    CKTAP_EXPECT(firstCard.index >= 0 && secondCard.index >= 0);
+    if (first == nullptr || second == nullptr || firstCard.index < 0 || secondCard.index < 0) {
+        Core_destroyContext(first);
+        Core_destroyContext(second);
+        return finishTest("context_lifecycle");
+    }
+
+    // Only the first context records its operations
+    std::remove(lifecycleAuditLogPath);
+    CKTAP_EXPECT(Core_openAuditLog(first, lifecycleAuditLogPath, 0) == CKTapInterfaceErrorCode::success);
+    Core_resetMetrics(first);
+    Core_resetMetrics(second);
+    CKTAP_EXPECT(Core_setOperationDeadline(first, 0, firstTransportTimeoutMs, 0) == CKTapInterfaceErrorCode::success);
+    CKTAP_EXPECT(Core_setOperationDeadline(second, 0, secondTransportTimeoutMs, 0) == CKTapInterfaceErrorCode::success);
+    CKTAP_EXPECT(runScriptedWait(first, firstCard, reply) == CKTapInterfaceErrorCode::success);
+    CKTAP_EXPECT(runScriptedWait(second, secondCard, reply) == CKTapInterfaceErrorCode::success);
+
+    const auto firstMetrics = Core_getMetrics(first);
+    const auto secondMetrics = Core_getMetrics(second);
+    std::printf("transport timeouts %lld us and %lld us, audit records %lld and %lld\n",
+                static_cast<long long>(firstMetrics.transportTimeoutMicros),
+                static_cast<long long>(secondMetrics.transportTimeoutMicros),
+                static_cast<long long>(firstMetrics.auditRecordsWritten),
+                static_cast<long long>(secondMetrics.auditRecordsWritten));
+    CKTAP_EXPECT(firstMetrics.transportTimeoutMicros == firstTransportTimeoutMs * 1000LL);
+    CKTAP_EXPECT(secondMetrics.transportTimeoutMicros == secondTransportTimeoutMs * 1000LL);
+    CKTAP_EXPECT(firstMetrics.auditRecordsWritten > 0);
+    CKTAP_EXPECT(secondMetrics.auditRecordsWritten == 0);
+    Core_closeAuditLog(first);
+    std::remove(lifecycleAuditLogPath);
+
+    checkSeparateWatchdogTimeouts(first, firstCard, second, secondCard, reply);
+
+    // Destroying a context cancels its operation rather than waiting on a host that will never answer, both on the
+    // thread which started it and from the finalizer's thread
+    CKTAP_EXPECT(beginScriptedWait(first, firstCard));
+    Core_destroyContext(first);
+    CKTAP_EXPECT(beginScriptedWait(second, secondCard));
+    std::thread finalizer{ [second] { Core_destroyContext(second); } };
+    finalizer.join();
+    return finishTest("context_lifecycle");
+}
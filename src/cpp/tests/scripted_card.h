@@ -0,0 +1,142 @@
+#ifndef __CKTAP_PROTOCOL__TESTS_SCRIPTED_CARD_H__
+#define __CKTAP_PROTOCOL__TESTS_SCRIPTED_CARD_H__
+
+// Project
+#include <exports.h>
+
+// STL
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+/// A satscard played back from canned replies, so the tests and benchmarks can drive the exports as the Dart host
+/// does without a reader or emulator
+
+/// How long a scripted operation may run before it's treated as hung
+constexpr auto scriptedOperationTimeout = std::chrono::seconds{ 10 };
+
+/// The status word of a reply the card accepted
+constexpr uint8_t cardSuccessStatus[]{ 0x90, 0x00 };
+/// A status word tap_protocol rejects, ending the operation after a single round trip
+constexpr uint8_t cardUnsupportedStatus[]{ 0x6D, 0x00 };
+
+/// Writes the head of a CBOR item, see RFC 8949 section 3
+inline void appendCborHead(std::vector<uint8_t>& out, const uint8_t majorType, const uint64_t value) {
+    const auto major = static_cast<uint8_t>(majorType << 5);
+    if (value < 24) {
+        out.push_back(static_cast<uint8_t>(major | value));
+    } else if (value <= 0xFF) {
+        out.insert(out.end(), { static_cast<uint8_t>(major | 24), static_cast<uint8_t>(value) });
+    } else if (value <= 0xFFFF) {
+        out.insert(out.end(), { static_cast<uint8_t>(major | 25), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) });
+    } else {
+        out.push_back(static_cast<uint8_t>(major | 26));
+        for (int shift{ 24 }; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+}
+
+inline void appendCborText(std::vector<uint8_t>& out, const char* text) {
+    const auto length = std::strlen(text);
+    appendCborHead(out, 3, length);
+    out.insert(out.end(), text, text + length);
+}
+
+inline void appendCborBytes(std::vector<uint8_t>& out, const uint8_t value, const size_t length) {
+    appendCborHead(out, 2, length);
+    out.insert(out.end(), length, value);
+}
+
+/// The reply of a satscard on its first slot of ten, which answers both the status and the wait commands. Keys a
+/// command doesn't read are ignored, so one reply serves every message of a handshake followed by waits. The card's
+/// identity comes from its public key, which is derived from [cardNumber] so differently numbered cards register
+/// separately
+inline std::vector<uint8_t> makeScriptedSatscardReply(const uint32_t cardNumber = 0) {
+    std::vector<uint8_t> reply{ };
+    appendCborHead(reply, 5, 9);
+    appendCborText(reply, "proto");
+    appendCborHead(reply, 0, 1);
+    appendCborText(reply, "ver");
+    appendCborText(reply, "1.0.0");
+    appendCborText(reply, "birth");
+    appendCborHead(reply, 0, 700000);
+    appendCborText(reply, "slots");
+    appendCborHead(reply, 4, 2);
+    appendCborHead(reply, 0, 0);
+    appendCborHead(reply, 0, 10);
+    appendCborText(reply, "addr");
+    appendCborText(reply, "bc1qscriptedcard");
+    appendCborText(reply, "pubkey");
+    appendCborHead(reply, 2, 33);
+    reply.insert(reply.end(), 29, 0x02);
+    for (int shift{ 24 }; shift >= 0; shift -= 8) {
+        reply.push_back(static_cast<uint8_t>(cardNumber >> shift));
+    }
+    appendCborText(reply, "card_nonce");
+    appendCborBytes(reply, 0x5A, 16);
+    appendCborText(reply, "auth_delay");
+    appendCborHead(reply, 0, 0);
+    appendCborText(reply, "success");
+    reply.push_back(0xF5);
+    reply.insert(reply.end(), std::begin(cardSuccessStatus), std::end(cardSuccessStatus));
+    return reply;
+}
+
+/// Answers [context]'s pending transport request with [reply] through the exports, as the Dart host does
+inline bool answerTransportRequest(CKTapContext* context, const std::vector<uint8_t>& reply) {
+    if (Core_getTransportRequestPointer(context) == nullptr) {
+        return false;
+    }
+    auto* buffer = Core_allocateTransportResponseBuffer(context, static_cast<int32_t>(reply.size()));
+    if (buffer == nullptr) {
+        return false;
+    }
+    std::memcpy(buffer, reply.data(), reply.size());
+    return Core_finalizeTransportResponse(context) == CKTapInterfaceErrorCode::success;
+}
+
+/// Cancels the running operation and finalizes it once it has unwound. Core_requestCancelOperation doesn't wait, so
+/// this polls it the way the Dart host does
+inline void cancelScriptedOperation(CKTapContext* context) {
+    const auto deadline = std::chrono::steady_clock::now() + scriptedOperationTimeout;
+    while (Core_requestCancelOperation(context) == CKTapInterfaceErrorCode::operationStillInProgress &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    Core_finalizeAsyncAction(context);
+}
+
+/// Answers every request of the running operation with [reply] until it stops, then finalizes it
+inline CKTapInterfaceErrorCode runScriptedOperation(CKTapContext* context, const std::vector<uint8_t>& reply) {
+    const auto deadline = std::chrono::steady_clock::now() + scriptedOperationTimeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto state = Core_getThreadState(context);
+        if (state >= CKTapThreadState::finished) {
+            return Core_finalizeAsyncAction(context);
+        }
+        if (state != CKTapThreadState::transportRequestReady || !answerTransportRequest(context, reply)) {
+            std::this_thread::yield();
+        }
+    }
+    cancelScriptedOperation(context);
+    return CKTapInterfaceErrorCode::operationStillInProgress;
+}
+
+/// Handshakes with the scripted satscard and registers it, returning its handle
+inline CKTapCardHandle registerScriptedSatscard(CKTapContext* context, const std::vector<uint8_t>& reply) {
+    if (Core_newOperation(context) != CKTapInterfaceErrorCode::success ||
+        Core_beginAsyncHandshake(context, CKTapCardType::satscard) != CKTapInterfaceErrorCode::success ||
+        runScriptedOperation(context, reply) != CKTapInterfaceErrorCode::success) {
+        return { -1, CKTapCardType::unknownCard };
+    }
+    const auto response = Core_endOperation(context);
+    return response.errorCode == CKTapInterfaceErrorCode::success ?
+        response.handle :
+        CKTapCardHandle{ -1, CKTapCardType::unknownCard };
+}
+
+#endif // __CKTAP_PROTOCOL__TESTS_SCRIPTED_CARD_H__
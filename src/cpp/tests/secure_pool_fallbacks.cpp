@@ -0,0 +1,56 @@
+// Project
+#include <internal/secure_memory.h>
+#include <internal/utils.h>
+#include <tests/test_support.h>
+
+/// Fills the secure pool until a private key no longer fits, then checks the key still reaches the caller from the
+/// regular heap, is counted in securePoolFallbacks and is released through the same free functions as a pooled one
+
+/// More than the pool's chunks can hold in the smallest size class
+constexpr size_t securePoolFillLimit = 64 * 1024;
+
+int main() {
+    // The pool is process-wide, the context only reports its metrics
+    auto* context = Core_createContext();
+    CKTAP_EXPECT(context != nullptr);
+    Core_resetMetrics(context);
+    const std::vector<uint8_t> privateKey(32, 0x5A);
+
+    std::vector<CBinaryArray> pooled{ };
+    while (pooled.size() < securePoolFillLimit) {
+        auto* pointer = allocateSecure(privateKey.size());
+        if (pointer == nullptr) {
+            break;
+        }
+        pooled.push_back(CBinaryArray{ static_cast<uint8_t*>(pointer), static_cast<int32_t>(privateKey.size()) });
+    }
+    CKTAP_EXPECT(pooled.size() < securePoolFillLimit);
+    CKTAP_EXPECT(Core_getMetrics(context).securePoolFallbacks == 0);
+
+    auto array = allocateSecureCBinaryArray(privateKey.data(), privateKey.size());
+    CKTAP_EXPECT(array.ptr != nullptr && array.length == static_cast<int32_t>(privateKey.size()));
+    CKTAP_EXPECT(array.ptr != nullptr && std::memcmp(array.ptr, privateKey.data(), privateKey.size()) == 0);
+    CKTAP_EXPECT(Core_getMetrics(context).securePoolFallbacks == 1);
+    freeCBinaryArray(array);
+    CKTAP_EXPECT(array.ptr == nullptr && array.length == 0);
+
+    const std::string wif{ "KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn" };
+    auto* copy = allocateSecureCString(wif.c_str(), wif.size());
+    CKTAP_EXPECT(copy != nullptr && wif == copy);
+    CKTAP_EXPECT(Core_getMetrics(context).securePoolFallbacks == 2);
+    freeSecureCString(copy);
+    CKTAP_EXPECT(copy == nullptr);
+
+    // Once there's room again secrets go back into the pool
+    freeCBinaryArray(pooled.back());
+    pooled.pop_back();
+    array = allocateSecureCBinaryArray(privateKey.data(), privateKey.size());
+    CKTAP_EXPECT(Core_getMetrics(context).securePoolFallbacks == 2);
+    pooled.push_back(array);
+
+    for (auto& entry : pooled) {
+        freeCBinaryArray(entry);
+    }
+    Core_destroyContext(context);
+    return finishTest("secure_pool_fallbacks");
+}
@@ -0,0 +1,26 @@
+#ifndef __CKTAP_PROTOCOL__TESTS_STAND_IN_NLOHMANN_JSON_HPP__
+#define __CKTAP_PROTOCOL__TESTS_STAND_IN_NLOHMANN_JSON_HPP__
+
+// STL
+#include <cstdint>
+#include <vector>
+
+/// The part of nlohmann::json which the library and tap-protocol's headers touch, binary values only. See
+/// tests/stand_in/tap_protocol.cpp
+
+namespace nlohmann {
+
+template <typename Container>
+struct byte_container_with_subtype : Container {
+    using Container::Container;
+    byte_container_with_subtype() = default;
+    byte_container_with_subtype(const Container& container) : Container(container) { }
+};
+
+struct json {
+    using binary_t = byte_container_with_subtype<std::vector<std::uint8_t>>;
+};
+
+} // namespace nlohmann
+
+#endif // __CKTAP_PROTOCOL__TESTS_STAND_IN_NLOHMANN_JSON_HPP__
@@ -0,0 +1,87 @@
+#ifndef __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_CKTAPCARD_H__
+#define __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_CKTAPCARD_H__
+
+// Third party
+#include <tap_protocol/tap_protocol.h>
+
+// STL
+#include <optional>
+
+namespace tap_protocol {
+
+class CKTapCard {
+public:
+
+    struct WaitResponse {
+        bool success{ };
+        int auth_delay{ };
+    };
+
+    explicit CKTapCard(std::unique_ptr<Transport> transport, bool first_look = true);
+    CKTapCard(CKTapCard&&) = default;
+    virtual ~CKTapCard() = default;
+
+    const std::string& GetIdent() const noexcept;
+    const std::string& GetAppletVersion() const noexcept;
+    int GetBirthHeight() const noexcept;
+    bool IsTestnet() const noexcept;
+    int GetAuthDelay() const noexcept;
+    bool IsTampered() const noexcept;
+    bool IsCertsChecked() const noexcept;
+    bool NeedSetup() const noexcept;
+    bool IsTapsigner() const noexcept;
+
+    WaitResponse Wait();
+    std::string CertificateCheck();
+
+protected:
+
+    std::unique_ptr<Transport> transport_;
+};
+
+class Satscard : public CKTapCard {
+public:
+
+    enum class SlotStatus { UNUSED, SEALED, UNSEALED };
+
+    struct Slot {
+        int index{ };
+        SlotStatus status{ };
+        std::string address{ };
+        nlohmann::json::binary_t privkey{ };
+        nlohmann::json::binary_t pubkey{ };
+        nlohmann::json::binary_t master_pk{ };
+        nlohmann::json::binary_t chain_code{ };
+
+        std::string to_wif(bool testnet = false) const;
+    };
+
+    explicit Satscard(std::unique_ptr<Transport> transport);
+
+    Slot GetActiveSlot() const;
+    int GetActiveSlotIndex() const noexcept;
+    int GetNumSlots() const noexcept;
+    bool HasUnusedSlots() const noexcept;
+    bool IsUsedUp() const noexcept;
+
+    Slot Unseal(const std::string& cvc);
+    Slot New(const Bytes& chain_code, const std::string& cvc);
+    std::vector<Slot> ListSlots(const std::string& cvc = { }, size_t limit = 10);
+    Slot GetSlot(int slot, const std::string& cvc = { });
+};
+
+class Tapsigner : public CKTapCard {
+public:
+
+    explicit Tapsigner(std::unique_ptr<Transport> transport);
+
+    int GetNumberOfBackups() const noexcept;
+    std::optional<std::string> GetDerivationPath() const noexcept;
+};
+
+std::unique_ptr<Tapsigner> ToTapsigner(CKTapCard&& cktapcard);
+std::unique_ptr<Satscard> ToSatscard(CKTapCard&& cktapcard);
+
+} // namespace tap_protocol
+
+#endif // __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_CKTAPCARD_H__
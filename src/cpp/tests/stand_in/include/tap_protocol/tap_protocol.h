@@ -0,0 +1,86 @@
+#ifndef __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_TAP_PROTOCOL_H__
+#define __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_TAP_PROTOCOL_H__
+
+// Third party
+#include <nlohmann/json.hpp>
+
+// STL
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// Declares the subset of tap-protocol's API which the library uses, with the same names and error codes. See
+/// tests/stand_in/tap_protocol.cpp
+
+namespace tap_protocol {
+
+using Bytes = std::vector<unsigned char>;
+
+class TapProtoException : public std::exception {
+public:
+    static constexpr int INVALID_DEVICE = 100;
+    static constexpr int UNLUCKY_NUMBER = 205;
+    static constexpr int BAD_ARGUMENTS = 400;
+    static constexpr int BAD_AUTH = 401;
+    static constexpr int NEED_AUTH = 403;
+    static constexpr int UNKNOW_COMMAND = 404;
+    static constexpr int INVALID_COMMAND = 405;
+    static constexpr int INVALID_STATE = 406;
+    static constexpr int WEAK_NONCE = 417;
+    static constexpr int BAD_CBOR = 422;
+    static constexpr int BACKUP_FIRST = 425;
+    static constexpr int RATE_LIMIT = 429;
+    static constexpr int DEFAULT_ERROR = 500;
+    static constexpr int MESSAGE_TOO_LONG = 601;
+    static constexpr int MISSING_KEY = 602;
+    static constexpr int ISO_SELECT_FAIL = 603;
+    static constexpr int SW_FAIL = 604;
+    static constexpr int INVALID_CVC_LENGTH = 605;
+    static constexpr int PICK_KEY_PAIR_FAIL = 606;
+    static constexpr int ECDH_FAIL = 607;
+    static constexpr int XCVC_FAIL = 608;
+    static constexpr int UNKNOW_PROTO_VERSION = 609;
+    static constexpr int INVALID_PUBKEY_LENGTH = 610;
+    static constexpr int NO_PRIVATE_KEY_PICKED = 611;
+    static constexpr int MALFORMED_BIP32_PATH = 612;
+    static constexpr int INVALID_HASH_LENGTH = 613;
+    static constexpr int SIG_VERIFY_ERROR = 614;
+    static constexpr int INVALID_DIGEST_LENGTH = 615;
+    static constexpr int INVALID_PATH_LENGTH = 616;
+    static constexpr int SERIALIZE_ERROR = 617;
+    static constexpr int EXCEEDED_RETRY = 618;
+    static constexpr int INVALID_CARD = 619;
+    static constexpr int SIGN_ERROR = 620;
+    static constexpr int SIG_TO_PUBKEY_FAIL = 621;
+    static constexpr int PSBT_PARSE_ERROR = 622;
+    static constexpr int PSBT_INVALID = 623;
+    static constexpr int INVALID_ADDRESS_TYPE = 624;
+    static constexpr int INVALID_BACKUP_KEY = 625;
+    static constexpr int INVALID_PUBKEY = 626;
+    static constexpr int INVALID_PRIVKEY = 627;
+    static constexpr int INVALID_SLOT = 628;
+
+    TapProtoException(const int code, std::string message) : _code{ code }, _message{ std::move(message) } { }
+
+    int code() const noexcept { return _code; }
+    const char* what() const noexcept override { return _message.c_str(); }
+
+private:
+
+    int _code;
+    std::string _message;
+};
+
+class Transport {
+public:
+    virtual ~Transport() = default;
+    virtual nlohmann::json Send(const nlohmann::json& message) = 0;
+};
+
+std::unique_ptr<Transport> MakeDefaultTransport(std::function<Bytes(const Bytes&)> sendReceiveFunc);
+
+} // namespace tap_protocol
+
+#endif // __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_TAP_PROTOCOL_H__
@@ -0,0 +1,15 @@
+#ifndef __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_UTILS_H__
+#define __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_UTILS_H__
+
+// Third party
+#include <tap_protocol/tap_protocol.h>
+
+namespace tap_protocol {
+
+Bytes Hex2Bytes(const std::string& hex);
+std::string Bytes2Hex(const Bytes& bytes);
+Bytes RandomChainCode();
+
+} // namespace tap_protocol
+
+#endif // __CKTAP_PROTOCOL__TESTS_STAND_IN_TAP_PROTOCOL_UTILS_H__
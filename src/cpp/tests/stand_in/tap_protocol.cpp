@@ -0,0 +1,255 @@
+// Third party
+#include <tap_protocol/cktapcard.h>
+#include <tap_protocol/utils.h>
+
+// STL
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/// A stand-in for tap-protocol, built instead of contrib/tap-protocol with CKTAP_USE_TAP_PROTOCOL_STAND_IN so the
+/// tests and benchmarks build without the submodule. Every call sends one APDU through the host's transport and
+/// fails with SW_FAIL unless the reply ends in 90 00, so a scripted card drives the library's threading, transport
+/// and cancellation exactly as a real one would. Nothing is parsed: each card is told apart by a hash of its first
+/// reply and reports fixed slots and keys. Never link it into the plugin
+
+namespace tap_protocol {
+
+namespace {
+
+/// A status command, the reply only has to end in a success status word
+const Bytes standInRequest{ 0x00, 0xCB, 0x00, 0x00, 0x05, 's', 't', 'a', 't', 'u' };
+const std::string standInAppletVersion{ "1.0.0" };
+const std::string standInIdent{ "STAND-INCAR-D0000-00000" };
+constexpr int standInSlotCount = 10;
+
+class StandInTransport : public Transport {
+public:
+
+    explicit StandInTransport(std::function<Bytes(const Bytes&)> sendReceive)
+        : _sendReceive{ std::move(sendReceive) } {
+    }
+
+    nlohmann::json Send(const nlohmann::json&) override {
+        const auto response = _sendReceive(standInRequest);
+        if (response.size() < 2 || response[response.size() - 2] != 0x90 || response.back() != 0x00) {
+            throw TapProtoException(TapProtoException::SW_FAIL, "Card replied with an error status");
+        }
+        if (_ident.empty()) {
+            // FNV-1a, so scripted cards with different replies get different idents
+            uint64_t hash{ 1469598103934665603ull };
+            for (const auto byte : response) {
+                hash = (hash ^ byte) * 1099511628211ull;
+            }
+            _ident = std::to_string(hash);
+        }
+        return { };
+    }
+
+    const std::string& ident() const noexcept {
+        return _ident.empty() ? standInIdent : _ident;
+    }
+
+    bool hasSent() const noexcept {
+        return !_ident.empty();
+    }
+
+private:
+
+    std::function<Bytes(const Bytes&)> _sendReceive;
+    std::string _ident{ };
+};
+
+StandInTransport& standInTransport(const std::unique_ptr<Transport>& transport) {
+    return static_cast<StandInTransport&>(*transport);
+}
+
+Satscard::Slot makeStandInSlot(const int index, const Satscard::SlotStatus status) {
+    Satscard::Slot slot{ };
+    slot.index = index;
+    slot.status = status;
+    slot.address = "bc1qstandinaddress";
+    slot.pubkey = nlohmann::json::binary_t(std::vector<uint8_t>(33, 0x02));
+    slot.chain_code = nlohmann::json::binary_t(std::vector<uint8_t>(32, 0x07));
+    if (status == Satscard::SlotStatus::UNSEALED) {
+        slot.privkey = nlohmann::json::binary_t(std::vector<uint8_t>(32, 0x09));
+    }
+    return slot;
+}
+
+/// Lets ToSatscard and ToTapsigner take the transport of the card they convert, as tap-protocol does
+struct CardTransport : CKTapCard {
+    using CKTapCard::transport_;
+};
+
+} // namespace
+
+std::unique_ptr<Transport> MakeDefaultTransport(std::function<Bytes(const Bytes&)> sendReceiveFunc) {
+    return std::make_unique<StandInTransport>(std::move(sendReceiveFunc));
+}
+
+// ----------------------------------------------
+// CKTapCard:
+
+CKTapCard::CKTapCard(std::unique_ptr<Transport> transport, const bool first_look)
+    : transport_{ std::move(transport) } {
+    // tap-protocol selects the applet then reads the status
+    if (first_look) {
+        transport_->Send({ });
+        transport_->Send({ });
+    }
+}
+
+const std::string& CKTapCard::GetIdent() const noexcept {
+    return transport_ ? standInTransport(transport_).ident() : standInIdent;
+}
+
+const std::string& CKTapCard::GetAppletVersion() const noexcept {
+    return standInAppletVersion;
+}
+
+int CKTapCard::GetBirthHeight() const noexcept {
+    return 1;
+}
+
+bool CKTapCard::IsTestnet() const noexcept {
+    return false;
+}
+
+int CKTapCard::GetAuthDelay() const noexcept {
+    return 0;
+}
+
+bool CKTapCard::IsTampered() const noexcept {
+    return false;
+}
+
+bool CKTapCard::IsCertsChecked() const noexcept {
+    return true;
+}
+
+bool CKTapCard::NeedSetup() const noexcept {
+    return false;
+}
+
+bool CKTapCard::IsTapsigner() const noexcept {
+    return false;
+}
+
+CKTapCard::WaitResponse CKTapCard::Wait() {
+    transport_->Send({ });
+    return { true, 0 };
+}
+
+std::string CKTapCard::CertificateCheck() {
+    transport_->Send({ });
+    return "Coinkite stand-in";
+}
+
+// ----------------------------------------------
+// Satscard:
+
+Satscard::Satscard(std::unique_ptr<Transport> transport)
+    : CKTapCard(std::move(transport), false) {
+    if (!standInTransport(transport_).hasSent()) {
+        transport_->Send({ });
+    }
+}
+
+Satscard::Slot Satscard::GetActiveSlot() const {
+    return makeStandInSlot(0, SlotStatus::SEALED);
+}
+
+int Satscard::GetActiveSlotIndex() const noexcept {
+    return 0;
+}
+
+int Satscard::GetNumSlots() const noexcept {
+    return standInSlotCount;
+}
+
+bool Satscard::HasUnusedSlots() const noexcept {
+    return true;
+}
+
+bool Satscard::IsUsedUp() const noexcept {
+    return false;
+}
+
+Satscard::Slot Satscard::Unseal(const std::string&) {
+    transport_->Send({ });
+    return makeStandInSlot(0, SlotStatus::UNSEALED);
+}
+
+Satscard::Slot Satscard::New(const Bytes&, const std::string&) {
+    transport_->Send({ });
+    return makeStandInSlot(1, SlotStatus::SEALED);
+}
+
+std::vector<Satscard::Slot> Satscard::ListSlots(const std::string&, const size_t limit) {
+    transport_->Send({ });
+    std::vector<Slot> slots{ };
+    for (int i{ 0 }; i < standInSlotCount && static_cast<size_t>(i) < limit; ++i) {
+        slots.push_back(makeStandInSlot(i, SlotStatus::SEALED));
+    }
+    return slots;
+}
+
+Satscard::Slot Satscard::GetSlot(const int slot, const std::string&) {
+    transport_->Send({ });
+    return makeStandInSlot(slot, SlotStatus::SEALED);
+}
+
+std::string Satscard::Slot::to_wif(bool) const {
+    return "KstandinWIF00000000000000000000000000000000000000000";
+}
+
+// ----------------------------------------------
+// Tapsigner:
+
+Tapsigner::Tapsigner(std::unique_ptr<Transport> transport)
+    : CKTapCard(std::move(transport), false) {
+}
+
+int Tapsigner::GetNumberOfBackups() const noexcept {
+    return 0;
+}
+
+std::optional<std::string> Tapsigner::GetDerivationPath() const noexcept {
+    return std::string{ "m/84h/0h/0h" };
+}
+
+std::unique_ptr<Tapsigner> ToTapsigner(CKTapCard&& cktapcard) {
+    return std::make_unique<Tapsigner>(std::move(static_cast<CardTransport&>(cktapcard).transport_));
+}
+
+std::unique_ptr<Satscard> ToSatscard(CKTapCard&& cktapcard) {
+    return std::make_unique<Satscard>(std::move(static_cast<CardTransport&>(cktapcard).transport_));
+}
+
+// ----------------------------------------------
+// Utils:
+
+Bytes Hex2Bytes(const std::string& hex) {
+    Bytes bytes{ };
+    for (size_t i{ 0 }; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<unsigned char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+std::string Bytes2Hex(const Bytes& bytes) {
+    constexpr const char* digits = "0123456789abcdef";
+    std::string hex{ };
+    for (const auto byte : bytes) {
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0x0F];
+    }
+    return hex;
+}
+
+Bytes RandomChainCode() {
+    return Bytes(32, 0x01);
+}
+
+} // namespace tap_protocol
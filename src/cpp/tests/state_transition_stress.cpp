@@ -0,0 +1,125 @@
+// Project
+#include <internal/thread_state.h>
+#include <tests/test_support.h>
+
+// STL
+#include <atomic>
+
+/// Races the host against the protocol thread's transport timeout. One thread hammers the transport exports,
+/// answering each request at a staggered delay, whilst the main thread runs sessions whose messages time out
+/// after a millisecond, so responses keep arriving just as the protocol thread gives up on them. Whichever side
+/// wins, the session has to end in the terminal state matching its result. When the timeout and the response used
+/// to overwrite each other the session was left looking active forever, which shows up here as a hung session.
+/// Losing those races is expected, so none of them may count as an illegal transition
+
+constexpr int stressSessionCount = 500;
+constexpr int32_t stressTransportTimeoutMs = 1;
+constexpr auto stressSessionTimeout = std::chrono::seconds{ 2 };
+
+/// The state an operation which finished with [errorCode] has to be left in
+static bool isStateConsistentWith(const CKTapThreadState state, const CKTapInterfaceErrorCode errorCode) {
+    switch (errorCode) {
+        case CKTapInterfaceErrorCode::success:
+            return state == CKTapThreadState::finished;
+        case CKTapInterfaceErrorCode::timeoutDuringTransport:
+            return state == CKTapThreadState::timeout;
+        case CKTapInterfaceErrorCode::caughtTapProtocolException:
+            return state == CKTapThreadState::tapProtocolError;
+        default:
+            return false;
+    }
+}
+
+/// Only moves the transition table forbids are illegal, not a caller finding the state isn't the one it expected
+static void checkIllegalTransitionCounting(CKTapContext* context) {
+    Core_resetMetrics(context);
+    ThreadStateMachine state{ };
+    CKTAP_EXPECT(!state.transitionFromAny(stateBit(CKTapThreadState::finished), CKTapThreadState::notStarted));
+    CKTAP_EXPECT((state.transition<CKTapThreadState::notStarted, CKTapThreadState::asyncActionStarting>()));
+    CKTAP_EXPECT(!state.reset());
+    CKTAP_EXPECT(!(state.transition<CKTapThreadState::transportRequestReady, CKTapThreadState::transportResponseReady>()));
+    CKTAP_EXPECT(Core_getMetrics(context).illegalStateTransitions == 0);
+
+    CKTAP_EXPECT(!state.transitionFromAny(activeThreadStates, CKTapThreadState::notStarted));
+    CKTAP_EXPECT(Core_getMetrics(context).illegalStateTransitions == 1);
+}
+
+int main() {
+    auto* context = Core_createContext();
+    CKTAP_EXPECT(context != nullptr);
+    checkIllegalTransitionCounting(context);
+
+    CKTAP_EXPECT(Core_setOperationDeadline(context, 0, stressTransportTimeoutMs, 0) == CKTapInterfaceErrorCode::success);
+    Core_resetMetrics(context);
+
+    const auto reply = makeScriptedSatscardReply();
+    std::atomic<bool> shouldStop{ false };
+    std::atomic<int64_t> answeredRequests{ 0 };
+    std::thread hammer{ [&] {
+        int64_t requestsSeen{ 0 };
+        while (!shouldStop.load(std::memory_order_relaxed)) {
+            if (Core_getThreadState(context) != CKTapThreadState::transportRequestReady) {
+                continue;
+            }
+
+            // Answers land anywhere from straight away to half again past the timeout, so many arrive right as
+            // the protocol thread gives up
+            const auto delay = std::chrono::microseconds{ (requestsSeen++ * 97) % (stressTransportTimeoutMs * 1500) };
+            const auto answerTime = std::chrono::steady_clock::now() + delay;
+            while (std::chrono::steady_clock::now() < answerTime) {
+                Core_getThreadState(context);
+            }
+            if (answerTransportRequest(context, reply)) {
+                answeredRequests.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    } };
+
+    int hungSessions{ 0 };
+    int inconsistentSessions{ 0 };
+    int succeededSessions{ 0 };
+    int timedOutSessions{ 0 };
+    for (int i{ 0 }; i < stressSessionCount; ++i) {
+        if (Core_newOperation(context) != CKTapInterfaceErrorCode::success ||
+            Core_beginAsyncHandshake(context, CKTapCardType::unknownCard) != CKTapInterfaceErrorCode::success) {
+            ++inconsistentSessions;
+            continue;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + stressSessionTimeout;
+        while (Core_getThreadState(context) < CKTapThreadState::finished && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        const auto state = Core_getThreadState(context);
+        if (state < CKTapThreadState::finished) {
+            ++hungSessions;
+            cancelScriptedOperation(context);
+            continue;
+        }
+
+        const auto errorCode = Core_finalizeAsyncAction(context);
+        if (!isStateConsistentWith(state, errorCode)) {
+            std::fprintf(stderr, "session %d finished with %d in state %d\n", i, errorCode, state);
+            ++inconsistentSessions;
+        }
+        succeededSessions += errorCode == CKTapInterfaceErrorCode::success;
+        timedOutSessions += errorCode == CKTapInterfaceErrorCode::timeoutDuringTransport;
+    }
+
+    shouldStop = true;
+    hammer.join();
+    const auto metrics = Core_getMetrics(context);
+    Core_destroyContext(context);
+
+    std::printf("%d sessions: %d succeeded, %d timed out, %lld requests answered\n", stressSessionCount,
+                succeededSessions, timedOutSessions, static_cast<long long>(answeredRequests.load()));
+    // Contended transitions are the races the state machine settled, reported for comparison between runs
+    std::printf("illegal transitions %lld, contended transitions %lld\n",
+                static_cast<long long>(metrics.illegalStateTransitions),
+                static_cast<long long>(metrics.contendedStateTransitions));
+
+    CKTAP_EXPECT(hungSessions == 0);
+    CKTAP_EXPECT(inconsistentSessions == 0);
+    CKTAP_EXPECT(metrics.illegalStateTransitions == 0);
+    return finishTest("state_transition_stress");
+}
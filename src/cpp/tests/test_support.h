@@ -0,0 +1,38 @@
+#ifndef __CKTAP_PROTOCOL__TESTS_TEST_SUPPORT_H__
+#define __CKTAP_PROTOCOL__TESTS_TEST_SUPPORT_H__
+
+// Project
+#include <exports.h>
+#include <internal/metrics.h>
+#include <tests/scripted_card.h>
+
+// STL
+#include <chrono>
+#include <cstdio>
+
+/// Shared by the tests built with CKTAP_BUILD_TESTS. Each test is a plain executable registered with CTest which
+/// prints every failed expectation and exits non-zero if there were any
+
+inline int g_testFailures{ 0 };
+
+#define CKTAP_EXPECT(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+            ++g_testFailures; \
+        } \
+    } while (false)
+
+inline int finishTest(const char* name) {
+    if (g_testFailures == 0) {
+        std::printf("%s passed\n", name);
+        return 0;
+    }
+    std::fprintf(stderr, "%s: %d expectations failed\n", name, g_testFailures);
+    return 1;
+}
+
+/// How long a test waits for an operation before treating it as hung
+constexpr auto testOperationTimeout = scriptedOperationTimeout;
+
+#endif // __CKTAP_PROTOCOL__TESTS_TEST_SUPPORT_H__
@@ -0,0 +1,131 @@
+// Project
+#include <core.h>
+#include <internal/globals.h>
+#include <internal/tap_protocol_thread.h>
+#include <internal/transport_buffer.h>
+#include <tests/test_support.h>
+
+/// Once the transport buffers have grown to fit the messages, passing an APDU between the host and the protocol
+/// thread mustn't touch the heap. This checks the double buffer on its own, then counts the allocations of both
+/// sides across every APDU of a run of operations. tap_protocol takes each response by value and frees it, so the
+/// protocol thread reserves one replacement per response whilst the request is in flight and nothing else. It also
+/// checks a response is only handed over once it has been written for the current request
+
+constexpr int transportBufferCycles = 1000;
+constexpr int transportOperationCount = 200;
+
+/// Answers every request of the running operation, adding the allocations the transport exports made to [allocations]
+static CKTapInterfaceErrorCode runCountingOperation(CKTapContext* context, const std::vector<uint8_t>& reply,
+                                                    int64_t& allocations, int64_t& apdus) {
+    const auto deadline = std::chrono::steady_clock::now() + testOperationTimeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto state = Core_getThreadState(context);
+        if (state >= CKTapThreadState::finished) {
+            return Core_finalizeAsyncAction(context);
+        }
+        if (state != CKTapThreadState::transportRequestReady) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const auto before = threadAllocationCount();
+        const auto isAnswered = answerTransportRequest(context, reply);
+        allocations += threadAllocationCount() - before;
+        apdus += isAnswered ? 1 : 0;
+    }
+    return CKTapInterfaceErrorCode::operationStillInProgress;
+}
+
+static bool waitForTransportRequestState(CKTapContext* context) {
+    const auto deadline = std::chrono::steady_clock::now() + testOperationTimeout;
+    while (Core_getThreadState(context) != CKTapThreadState::transportRequestReady) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+static bool beginWaitOn(CKTapContext* context, const CKTapCardHandle card) {
+    return Core_newOperation(context) == CKTapInterfaceErrorCode::success &&
+        Core_prepareCardOperation(context, card.index, card.type) == CKTapInterfaceErrorCode::success &&
+        CKTapCard_beginWait(context) == CKTapInterfaceErrorCode::success;
+}
+
+int main() {
+    // The buffer on its own, with messages up to its reserved capacity
+    TransportBuffer buffer{ };
+    const tap_protocol::Bytes message(defaultTransportBufferCapacity, 0xAB);
+    const auto bufferAllocationsBefore = threadAllocationCount();
+    for (int i{ 0 }; i < transportBufferCycles; ++i) {
+        buffer.write(message);
+        buffer.publish();
+        CKTAP_EXPECT(buffer.read().size() == message.size());
+
+        auto* response = buffer.beginWrite(static_cast<size_t>(i) % defaultTransportBufferCapacity + 1);
+        response[0] = 0x90;
+        buffer.publish();
+        if (i % 100 == 0) {
+            buffer.clear();
+        }
+    }
+    CKTAP_EXPECT(threadAllocationCount() == bufferAllocationsBefore);
+
+    // Taking responses out of the buffer, only reserving the spare may allocate
+    int64_t prepareAllocations{ 0 };
+    for (int i{ 0 }; i < transportBufferCycles; ++i) {
+        const auto prepareBefore = threadAllocationCount();
+        buffer.prepareTake();
+        prepareAllocations += threadAllocationCount() - prepareBefore;
+
+        auto* response = buffer.beginWrite(static_cast<size_t>(i) % defaultTransportBufferCapacity + 1);
+        response[0] = 0x90;
+        buffer.publish();
+        const auto takeBefore = threadAllocationCount();
+        const auto taken = buffer.take();
+        CKTAP_EXPECT(threadAllocationCount() == takeBefore);
+        CKTAP_EXPECT(taken.size() == static_cast<size_t>(i) % defaultTransportBufferCapacity + 1 && taken[0] == 0x90);
+    }
+    CKTAP_EXPECT(prepareAllocations <= transportBufferCycles);
+
+    auto* context = Core_createContext();
+    CKTAP_EXPECT(context != nullptr);
+    CKTAP_EXPECT(Core_getMetrics(context).isAllocationTrackingEnabled == 1);
+    const auto reply = makeScriptedSatscardReply();
+    const auto card = registerScriptedSatscard(context, reply);
+    CKTAP_EXPECT(card.index >= 0);
+
+    // Both sides of every APDU. Starting each operation allocates, only the transport exports are counted on the
+    // host and only the hand-offs to and from tap_protocol on the protocol thread
+    const auto workerAllocationsBefore = [context]() {
+        const cktap::ContextBinding binding{ context };
+        return currentProtocolThread()->transportAllocations();
+    }();
+    int64_t apduAllocations{ 0 };
+    int64_t apdus{ 0 };
+    for (int i{ 0 }; i < transportOperationCount; ++i) {
+        CKTAP_EXPECT(beginWaitOn(context, card));
+        CKTAP_EXPECT(runCountingOperation(context, reply, apduAllocations, apdus) == CKTapInterfaceErrorCode::success);
+    }
+    const auto workerAllocations = [context]() {
+        const cktap::ContextBinding binding{ context };
+        return currentProtocolThread()->transportAllocations();
+    }() - workerAllocationsBefore;
+    std::printf("%lld APDUs, %lld allocations in the transport exports, %lld on the protocol thread\n",
+                static_cast<long long>(apdus), static_cast<long long>(apduAllocations),
+                static_cast<long long>(workerAllocations));
+    CKTAP_EXPECT(apdus >= transportOperationCount);
+    CKTAP_EXPECT(apduAllocations == 0);
+    CKTAP_EXPECT(workerAllocations <= apdus);
+
+    // Finalizing without writing a response for the current request would hand over the previous one
+    CKTAP_EXPECT(beginWaitOn(context, card));
+    CKTAP_EXPECT(waitForTransportRequestState(context));
+    CKTAP_EXPECT(Core_finalizeTransportResponse(context) == CKTapInterfaceErrorCode::threadResponseFinalizationFailed);
+    CKTAP_EXPECT(Core_getThreadState(context) == CKTapThreadState::transportRequestReady);
+    CKTAP_EXPECT(runScriptedOperation(context, reply) == CKTapInterfaceErrorCode::success);
+
+    Core_destroyContext(context);
+    return finishTest("transport_allocations");
+}
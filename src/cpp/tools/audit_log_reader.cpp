@@ -0,0 +1,133 @@
+// Project
+#include <internal/audit_log.h>
+
+// libc
+#include <time.h>
+
+// STL
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/// Prints the records of an audit log written by Core_openAuditLog. The log is only read, so it's safe to run
+/// against a log which the app is still appending to
+
+constexpr size_t auditReaderBatchSize = 4096;
+
+using AuditLogFile = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+/// ISO 8601 in UTC with microseconds
+static void formatAuditTime(const int64_t micros, char (&output)[32]) {
+    const auto seconds = static_cast<time_t>(micros / 1000000);
+    tm utc{ };
+    gmtime_r(&seconds, &utc);
+    const auto length = strftime(output, sizeof(output), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(output + length, sizeof(output) - length, ".%06dZ", static_cast<int>(micros % 1000000));
+}
+
+static const char* auditCardTypeName(const int8_t cardType) noexcept {
+    switch (cardType) {
+        case CKTapCardType::satscard: return "satscard";
+        case CKTapCardType::tapsigner: return "tapsigner";
+        default: return "unknown";
+    }
+}
+
+static void printAuditRecord(const AuditRecord& record, const bool isCsv) {
+    char started[32];
+    char finished[32];
+    formatAuditTime(record.startedMicros, started);
+    formatAuditTime(record.finishedMicros, finished);
+
+    char ident[sizeof(record.ident) + 1]{ };
+    std::memcpy(ident, record.ident.data(), sizeof(record.ident));
+
+    const auto* format = isCsv ?
+        "%" PRIu64 ",%s,%s,%" PRId64 ",%s,%s,%s,%d,%d\n" :
+        "%-8" PRIu64 " %s %s %8" PRId64 "us %-16s %-9s %-24s slot %-3d error %d\n";
+    std::printf(format, record.sequence, started, finished, record.finishedMicros - record.startedMicros,
+                auditOperationName(record.operation), auditCardTypeName(record.cardType),
+                *ident != '\0' ? ident : "-", record.slotIndex, record.errorCode);
+}
+
+static void printReaderUsage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--csv] LOG\n"
+        "  --csv  one comma separated record per line with a header row\n",
+        program);
+}
+
+int main(int argc, char** argv) {
+    const char* path{ nullptr };
+    bool isCsv{ false };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            isCsv = true;
+        } else if (path == nullptr && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            printReaderUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (path == nullptr) {
+        printReaderUsage(argv[0]);
+        return 2;
+    }
+
+    AuditLogFile file{ std::fopen(path, "rb"), std::fclose };
+    if (!file) {
+        std::fprintf(stderr, "unable to open %s\n", path);
+        return 1;
+    }
+
+    AuditLogHeader header{ };
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 || header.magic != auditLogMagic) {
+        std::fprintf(stderr, "%s isn't an audit log\n", path);
+        return 1;
+    }
+    if (header.version != auditLogVersion || header.recordSize != auditRecordSize) {
+        std::fprintf(stderr, "%s is version %u, this reader understands version %u\n", path, header.version,
+                     auditLogVersion);
+        return 1;
+    }
+
+    // Positions past the reservation count were never handed out, reservations past the capacity were dropped
+    const auto reserved = std::min(header.reservedRecords, header.capacity);
+    if (isCsv) {
+        std::printf("sequence,started,finished,durationMicros,operation,cardType,ident,slot,errorCode\n");
+    }
+
+    std::vector<AuditRecord> batch(auditReaderBatchSize);
+    uint64_t position{ 0 };
+    uint64_t incomplete{ 0 };
+    while (position < reserved) {
+        const auto wanted = static_cast<size_t>(std::min<uint64_t>(batch.size(), reserved - position));
+        const auto count = std::fread(batch.data(), sizeof(AuditRecord), wanted, file.get());
+        for (size_t i{ 0 }; i < count; ++i, ++position) {
+            // Zeroed when the app stopped part way through writing it
+            if (batch[i].sequence != position + 1) {
+                ++incomplete;
+                continue;
+            }
+            printAuditRecord(batch[i], isCsv);
+        }
+        if (count < wanted) {
+            std::fprintf(stderr, "%s is truncated after record %" PRIu64 "\n", path, position);
+            return 1;
+        }
+    }
+
+    char created[32];
+    formatAuditTime(header.createdMicros, created);
+    std::fprintf(stderr, "%" PRIu64 " of %" PRIu64 " records used, %" PRIu64 " incomplete, created %s\n", reserved,
+                 header.capacity, incomplete, created);
+    if (header.reservedRecords > header.capacity) {
+        std::fprintf(stderr, "the log is full, %" PRIu64 " records were dropped\n",
+                     header.reservedRecords - header.capacity);
+    }
+    return 0;
+}